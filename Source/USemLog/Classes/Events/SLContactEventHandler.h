@@ -31,7 +31,7 @@ private:
 	void AddNewContactEvent(const FSLContactResult& InResult);
 
 	// Finish then publish the event
-	bool FinishContactEvent(const FSLEntity&, float EndTime);
+	bool FinishContactEvent(const FSLEntity& InSelf, const FSLEntity& InOther, float EndTime);
 
 	// Start new supported by event
 	void AddNewSupportedByEvent(const FSLEntity& Supported, const FSLEntity& Supporting, float StartTime, const uint64 EventPairId);
@@ -58,11 +58,11 @@ private:
 	// Parent semantic overlap area
 	class ISLContactShapeInterface* Parent = nullptr;
 
-	// Array of started contact events
-	TArray<TSharedPtr<FSLContactEvent>> StartedContactEvents;
+	// Started contact events, keyed by the cantor pair of the unique ids
+	TMap<uint64, TSharedPtr<FSLContactEvent>> StartedContactEvents;
 
-	// Array of started supported by events
-	TArray<TSharedPtr<FSLSupportedByEvent>> StartedSupportedByEvents;
+	// Started supported by events, keyed by their pair id
+	TMap<uint64, TSharedPtr<FSLSupportedByEvent>> StartedSupportedByEvents;
 	
 	/* Constant values */
 	constexpr static float ContactEventMin = 0.3f;
@@ -0,0 +1,74 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SLOwlExperiment.h"
+#include "Utils/SLCompressedFile.h"
+
+// Forward declaration
+class ISLEvent;
+class IFileHandle;
+
+/**
+ * Appends the finished events to the owl file as they arrive, the document header is written at start,
+ * the experiment individual and the closing root tag at finish (a file cut by a crash only misses these
+ * and the events written since the last flush), the file is flushed once enough bytes accumulated or when flushed by the owner
+ */
+class FSLEventStreamWriter
+{
+public:
+	// Default ctor
+	FSLEventStreamWriter();
+
+	// Dtor
+	~FSLEventStreamWriter();
+
+	// Open the file and write the header of the document template
+	bool Start(TSharedPtr<FSLOwlExperiment> InDoc, const FString& FilePath, ESLFileCompression InCompression);
+
+	// Write the event with the timepoints and objects it introduces, the document only keeps the registered keys
+	void Write(const TSharedPtr<ISLEvent>& Event);
+
+	// Flush the events written since the last flush to disk (with compression as a block)
+	void Flush();
+
+	// Write the experiment individual and the footer and close the file
+	void Finish();
+
+	// Max time (s) the owner should let the written events wait before flushing them
+	static constexpr float FlushInterval = 1.f;
+
+	// True if the file is open
+	bool IsStarted() const { return bIsStarted; };
+
+private:
+	// Serialize the individuals moved out of the document
+	void WriteNewIndividuals();
+
+	// Write the serialized bytes to the file
+	void WriteBuffer();
+
+private:
+	// Set when the file is open
+	bool bIsStarted;
+
+	// Document template, collects the individuals of one event at a time
+	TSharedPtr<FSLOwlExperiment> Doc;
+
+	// Output file
+	IFileHandle* FileHandle;
+
+	// Block compression of the file (optional)
+	TUniquePtr<FSLCompressedFileWriter> CompressedWriter;
+
+	// Reused array of the individuals to serialize
+	TArray<FSLOwlNode> NewIndividuals;
+
+	// Reused utf8 output buffer
+	FSLOwlWriteBuffer Buffer;
+
+	// Bytes written since the last flush
+	int64 NumUnflushedBytes;
+};
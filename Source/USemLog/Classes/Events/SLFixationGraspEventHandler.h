@@ -45,6 +45,6 @@ private:
 	UObject* Parent;
 #endif // SL_WITH_MC_GRASP
 
-	// Array of started events
-	TArray<TSharedPtr<FSLGraspEvent>> StartedEvents;
+	// Started events, keyed by the unique id of the grasped object
+	TMap<uint32, TSharedPtr<FSLGraspEvent>> StartedEvents;
 };
@@ -41,8 +41,8 @@ private:
 	// Parent
 	class USLManipulatorListener* Parent;
 
-	// Array of started events
-	TArray<TSharedPtr<FSLGraspEvent>> StartedEvents;
+	// Started events, keyed by the unique id of the grasped object
+	TMap<uint32, TSharedPtr<FSLGraspEvent>> StartedEvents;
 	
 	/* Constant values */
 	constexpr static float GraspEventMin = 0.25f;
@@ -30,7 +30,7 @@ private:
 	void AddNewEvent(const FSLContactResult& InResult);
 
 	// Finish then publish the event
-	bool FinishEvent(const FSLEntity&, float EndTime);
+	bool FinishEvent(const FSLEntity& InSelf, const FSLEntity& InOther, float EndTime);
 
 	// Terminate and publish started events (this usually is called at end play)
 	void FinishAllEvents(float EndTime);
@@ -45,6 +45,6 @@ private:
 	// Parent semantic overlap area
 	class USLManipulatorListener* Parent = nullptr;
 
-	// Array of started contact events
-	TArray<TSharedPtr<FSLContactEvent>> StartedEvents;
+	// Started contact events, keyed by the cantor pair of the unique ids
+	TMap<uint64, TSharedPtr<FSLContactEvent>> StartedEvents;
 };
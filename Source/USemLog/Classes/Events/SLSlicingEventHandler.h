@@ -54,6 +54,6 @@ private:
 	UObject* Parent;
 #endif // SL_WITH_Slicing
 
-	// Array of started events
-	TArray<TSharedPtr<FSLSlicingEvent>> StartedEvents;
+	// Started events, keyed by the unique id of the cut object
+	TMap<uint32, TSharedPtr<FSLSlicingEvent>> StartedEvents;
 };
@@ -6,10 +6,14 @@
 #include "USemLog.h"
 #include "SLOwlExperiment.h"
 #include "Events/ISLEventHandler.h"
+#include "Utils/SLCompressedFile.h"
+#include "Events/SLEventStreamWriter.h"
+#include "Engine/EngineTypes.h"
 #include "SLEventLogger.generated.h"
 
 // Forward declaration
 class ISLEvent;
+class FSLOverlapEndScheduler;
 
 /**
 * Parameters for creating an event logger
@@ -31,6 +35,9 @@ struct FSLEventWriterParams
 	//// Server Port (optional)
 	//uint16 ServerPort;
 
+	// Streaming compression of the owl file (optional)
+	ESLFileCompression FileCompression = ESLFileCompression::None;
+
 	// Constructor
 	FSLEventWriterParams(
 		const FString& InTaskId,
@@ -90,8 +97,14 @@ private:
 	// Called when a semantic event is done
 	void OnSemanticEvent(TSharedPtr<ISLEvent> Event);
 
-	// Write events to file
-	bool WriteToFile();
+	// Open the owl file and write the document header (the events are appended as they finish)
+	bool StartEventStream();
+
+	// Flush the events written since the last flush (timer callback)
+	void FlushEventStream();
+
+	// Write the events timelines to file
+	bool WriteTimelines();
 
 	// Create events doc template
 	TSharedPtr<FSLOwlExperiment> CreateEventsDocTemplate(
@@ -119,15 +132,27 @@ private:
 	// Save events to timelines
 	bool bWriteTimelines;
 
-	// Array of finished events
+	// Compression of the owl file
+	ESLFileCompression FileCompression;
+
+	// Array of finished events (only kept for the timelines)
 	TArray<TSharedPtr<ISLEvent>> FinishedEvents;
 
-	// Owl document of the finished events
+	// Owl document template of the finished events
 	TSharedPtr<FSLOwlExperiment> ExperimentDoc;
 
+	// Appends the finished events to the owl file
+	FSLEventStreamWriter EventStream;
+
+	// Periodically flushes the event stream
+	FTimerHandle EventStreamFlushTimerHandle;
+
 	// Semantic event handlers (takes input raw events, outputs finished semantic events)
 	TArray<TSharedPtr<ISLEventHandler>> EventHandlers;
 
+	// Delays the overlap ends of all the contact shapes and manipulator overlaps for possible concatenations
+	TSharedPtr<FSLOverlapEndScheduler> OverlapEndScheduler;
+
 	// List of the contact trigger shapes, stored to call Start and Finish on them
 	TArray<class ISLContactShapeInterface*> ContactShapes;
 
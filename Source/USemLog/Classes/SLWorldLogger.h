@@ -11,7 +11,7 @@
 
 /**
  * Raw (subsymbolic) data logger, 
- * it synchronizes(ticks) the async worker on saving the world state at given timepoints.
+ * it captures the world state on the game thread at given timepoints and lets the async worker write it.
  * Inherit from FTickableGameObject to have it's own tick
  */
 UCLASS()
@@ -26,8 +26,8 @@ public:
 	// Destructor
 	~USLWorldLogger();
 
-	// Init Logger
-	void Init(ESLWorldWriterType WriterType, const FSLWorldWriterParams& InWriterParams);
+	// Init Logger (every writer type gets its own writer, fed from the same capture)
+	void Init(const TArray<ESLWorldWriterType>& WriterTypes, const FSLWorldWriterParams& InWriterParams);
 
 	// Start logger
 	void Start(const float UpdateRate);
@@ -57,6 +57,19 @@ private:
 	// Delay function to set tick to true (avoid logging first frame twice)
 	void DelaySetTickTrue();
 
+	// Subscribe to the actor spawn and destroy events, the entities are updated incrementally
+	void BindEntityEvents();
+
+	// Unsubscribe from the actor spawn and destroy events
+	void UnbindEntityEvents();
+
+	// Called when an actor is spawned in the world
+	void OnActorSpawned(AActor* Actor);
+
+	// Called when an actor is destroyed
+	UFUNCTION()
+	void OnActorDestroyed(AActor* DestroyedActor);
+
 private:
 	// Set when logger is initialized
 	bool bIsInit;
@@ -73,6 +86,12 @@ private:
 	// Timer handle for custom update rate
 	FTimerHandle TimerHandle;
 
+	// Actor spawned delegate handle
+	FDelegateHandle ActorSpawnedHandle;
+
+	// Actors whose destroy event is bound
+	TSet<TWeakObjectPtr<AActor>> DestroyBoundActors;
+
 	// Async worker to log the raw data on a separate thread
 	FAsyncTask<FSLWorldAsyncWorker>* AsyncWorker;
 };
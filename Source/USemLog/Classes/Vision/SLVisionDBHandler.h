@@ -6,6 +6,7 @@
 #include "CoreMinimal.h"
 #include "Vision/SLVisionStructs.h"
 #include "Animation/SkeletalMeshActor.h"
+#include "World/SLWorldPoseCodec.h"
 
 #if SL_WITH_LIBMONGO_C
 class ASLVisionPoseableMeshActor;
@@ -36,7 +37,7 @@ public:
 	// Disconnect and clean db connection
 	void Disconnect() const;
 
-	// Create indexes on the inserted data
+	// Create indexes on the vision collection (done on connect, before any data is inserted)
 	void CreateIndexes() const;
 
 	// Get episode data from the database (UpdateRate = 0 means all the data)
@@ -55,16 +56,24 @@ private:
 	void DropPreviousEntries(const FString& DBName, const FString& CollName) const;
 
 #if SL_WITH_LIBMONGO_C
-	// Helper function to get the entities data out of the bson iterator, returns false if there are no entities
+	// Helper function to get the entities data out of the bson iterator, returns false if there are no entities,
+	// the rigid children markers are resolved from the last poses of the children and of their group roots
 	bool GetEntitiesData(bson_iter_t* doc,
 		TMap<AStaticMeshActor*, FTransform>& OutEntityPoses,
-		TMap<ASLVisionCamera*, FTransform>& OutVirtualCameraPoses) const;
+		TMap<ASLVisionCamera*, FTransform>& OutVirtualCameraPoses);
 
 	// Helper function to get the entities data out of the bson iterator, returns false if there are no entities
 	bool GetSkeletalEntitiesData(bson_iter_t* doc,
 		const TMap<ASkeletalMeshActor*, ASLVisionPoseableMeshActor*>& InSkelToPoseableMap,
 		TMap<ASLVisionPoseableMeshActor*, TMap<FName, FTransform>>& OutSkeletalPoses) const;
 
+	// Rebuild the delta slots from a keyframe document (entities, then skeletal entities followed by their bones)
+	void ReadKeyframeSlots(const bson_t* doc, double LocPrecision,
+		const TMap<ASkeletalMeshActor*, ASLVisionPoseableMeshActor*>& InSkelToPoseableMap);
+
+	// Apply the pose deltas of the document to the frame, returns false if there are no deltas
+	bool GetDeltasData(const bson_t* doc, FSLVisionFrame& OutFrame);
+
 	// Save image to gridfs, get the file oid and return true if succeeded
 	bool AddToGridFs(const TArray<uint8>& InData, bson_oid_t* out_oid) const;
 
@@ -98,4 +107,22 @@ private:
 	// Store image binaries
 	mongoc_gridfs_t* gridfs;
 #endif //SL_WITH_LIBMONGO_C	
+
+	// Entity or bone the delta slot refers to
+	struct FSLVisionDeltaSlot
+	{
+		AStaticMeshActor* Actor = nullptr;
+		ASLVisionCamera* Camera = nullptr;
+		ASLVisionPoseableMeshActor* Poseable = nullptr;
+		FName BoneName;
+	};
+
+	// Delta slots of the last keyframe
+	TArray<FSLVisionDeltaSlot> DeltaSlots;
+
+	// Last read pose of every entity (by id), used to resolve the rigid children markers
+	TMap<FString, FTransform> LastEntityPoses;
+
+	// Reconstructs the poses written between keyframes
+	FSLWorldPoseDecoder PoseDecoder;
 };
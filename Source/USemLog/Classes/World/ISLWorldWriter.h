@@ -6,6 +6,62 @@
 #include "SLStructs.h"
 #include "SLSkeletalDataComponent.h"
 #include "SLGazeDataHandler.h"
+#include "SLWorldStateBuffer.h"
+#include "SLWorldChangeDetector.h"
+#include "SLWorldTelemetry.h"
+#include "Utils/SLCompressedFile.h"
+#include "Utils/SLMongoIndexes.h"
+
+/**
+* Batching parameters of the mongo writer
+*/
+struct FSLWorldWriterMongoBatchParams
+{
+	// Max number of documents in a batch (0 disables batching, every document is inserted with a separate round-trip)
+	int32 MaxNumDocs = 0;
+
+	// Max size (bytes) of the documents in a batch
+	int32 MaxNumBytes = 8 * 1024 * 1024;
+
+	// Max time (s) a document waits in a batch before it is flushed
+	float MaxInterval = 1.f;
+
+	// Write concern of the bulk inserts (0 - unacknowledged, 1 - acknowledged by the primary, n - acknowledged by n members)
+	int32 WriteConcern = 1;
+
+	// Max size (bytes) of the documents waiting in memory, the overflow is spilled to a local journal (0 - unbounded)
+	int64 MaxQueueBytes = 256 * 1024 * 1024;
+};
+
+/**
+* Keyframe and delta compression parameters of the bson based writers
+*/
+struct FSLWorldWriterCompressionParams
+{
+	// Write keyframes (full poses) and quantized deltas in between
+	bool bEnabled = false;
+
+	// Time (s) between two keyframes
+	float KeyframeInterval = 10.f;
+
+	// Location quantization step of the deltas (in the logged units, m with the ROS conversions)
+	float LocPrecision = 0.0001f;
+};
+
+/**
+* Entity bucket layout of the mongo world state collection, one document per entity (or bone) and time window
+*/
+struct FSLWorldWriterMongoBucketParams
+{
+	// Write the entity buckets instead of one document per frame
+	bool bEnabled = false;
+
+	// Length (s) of the time windows
+	float BucketDuration = 1.f;
+
+	// Create the collection as a time series collection (requires MongoDB 5.0+, falls back to a regular collection)
+	bool bTimeSeries = true;
+};
 
 /**
 * Parameters for creating a world state data writer
@@ -33,6 +89,37 @@ struct FSLWorldWriterParams
 	// Overwrite exiting data
 	bool bOverwrite;
 
+	// Number of captured world states that can wait to be written before frames are dropped
+	int32 SnapshotBufferDepth;
+
+	// Only read and check the actors and components whose transform changed since the last capture
+	bool bDirtyTracking = false;
+
+	// Batching of the mongo inserts (optional)
+	FSLWorldWriterMongoBatchParams MongoBatch;
+
+	// Keyframe and delta compression of the poses (optional)
+	FSLWorldWriterCompressionParams Compression;
+
+	// Entity bucket layout of the mongo documents (optional)
+	FSLWorldWriterMongoBucketParams MongoBuckets;
+
+	// When to create the indexes of the mongo collection
+	ESLMongoIndexMode MongoIndexMode = ESLMongoIndexMode::Background;
+
+	// Streaming compression of the file outputs (optional)
+	ESLFileCompression FileCompression = ESLFileCompression::None;
+
+	// Update rates (s) of the entity classes which are captured slower than the world state (optional)
+	TMap<FString, float> ClassUpdateRates;
+
+	// Only log a marker with the group root for the attached entities which moved rigidly with it
+	// (mongo, bson and binary writers, the json writer keeps logging their poses)
+	bool bRigidGroups = false;
+
+	// Dump the per frame performance records (csv) and the latency histograms (json) at the end of the episode
+	bool bTelemetry = false;
+
 	// Constructor
 	FSLWorldWriterParams(
 		float InLinearDistance,
@@ -41,14 +128,16 @@ struct FSLWorldWriterParams
 		const FString& InEpisodeId,
 		const FString& InServerIp = "",
 		uint16 InServerPort = 0,
-		bool bInOverwrite = false) :
+		bool bInOverwrite = false,
+		int32 InSnapshotBufferDepth = 256) :
 		LinearDistanceSquared(InLinearDistance*InLinearDistance),
 		AngularDistance(InAngularDistance),
 		TaskId(InTaskId),
 		EpisodeId(InEpisodeId),
 		ServerIp(InServerIp),
 		ServerPort(InServerPort),
-		bOverwrite(bInOverwrite)
+		bOverwrite(bInOverwrite),
+		SnapshotBufferDepth(InSnapshotBufferDepth)
 	{};
 };
 
@@ -68,22 +157,27 @@ public:
 	// Finish
 	virtual void Finish() = 0;
 
-	// Write data (it also checks and removes invalid items from the array - e.g. destroyed actors)
-	//virtual void Write(TArray<TSLEntityPreviousPose<AActor>>& NonSkeletalActorPool,
-	//	TArray<TSLEntityPreviousPose<ASLSkeletalMeshActor>>& SkeletalActorPool,
-	//	TArray<TSLEntityPreviousPose<USceneComponent>>& NonSkeletalComponentPool,
-	//	float Timestamp) = 0;
-
-	virtual void Write(float Timestamp,
-		TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
-		TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
-		TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
-		FSLGazeData& GazeData,
-		bool bCheckAndRemoveInvalidEntities = true) = 0;
+	// Write the captured world state (the snapshot indexes match the entity arrays, only the moved entities are written)
+	virtual void Write(const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes,
+		const TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
+		const TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
+		const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities) = 0;
 
 	// True if the writer is valid
 	bool IsInit() const { return bIsInit; }
 
+	// Number of serialized bytes (written to file or passed to the database)
+	int64 GetNumBytesWritten() const { return NumBytesWritten; }
+
+	// Database round-trip latencies (empty for the file writers, complete after finish)
+	const FSLLatencyHistogram& GetRoundTripLatencies() const { return RoundTripLatencies; }
+
+	// Max size of the documents waiting in memory for the database (0 for the unbatched writers, complete after finish)
+	int64 GetMaxQueuedBytes() const { return MaxQueuedBytes; }
+
+	// Size of the documents spilled to the local journal (complete after finish)
+	int64 GetNumSpilledBytes() const { return NumSpilledBytes; }
+
 protected:
 	// Flag to show if it is valid
 	bool bIsInit;
@@ -96,4 +190,14 @@ protected:
 	
 	// Previous gaze data
 	FSLGazeData PreviousGazeData;
+
+	// Serialized bytes so far
+	int64 NumBytesWritten = 0;
+
+	// Database round-trip latencies
+	FSLLatencyHistogram RoundTripLatencies;
+
+	// Database queue statistics
+	int64 MaxQueuedBytes = 0;
+	int64 NumSpilledBytes = 0;
 };
@@ -6,6 +6,7 @@
 #include "CoreMinimal.h"
 #include "SLStructs.h"
 #include "Camera/PlayerCameraManager.h"
+#include "WorldCollision.h"
 
 /**
 * Structure holding the eye tracking data
@@ -76,10 +77,35 @@ public:
 	// Check if the eye tracking software is stopped
 	bool IsFinished() const { return bIsFinished; };
 
-	// Get the current gaze data, true if a raytrace hit occurs
+	// Get the gaze data of the last completed trace and issue the next one (game thread), true if the trace hit an entity
 	bool GetData(FSLGazeData& OutData);
 
 private:
+	// Result of the last completed trace, shared with the trace callbacks (which can outlive the handler)
+	struct FTraceState
+	{
+		// Gaze data of the last trace
+		FSLGazeData Data;
+
+		// True if the last trace hit an entity
+		bool bHit = false;
+
+		// True while a trace is in flight
+		bool bPending = false;
+
+		// Precomputed actor to entity table, actors spawned later are added on their first hit
+		TMap<TWeakObjectPtr<const AActor>, FSLEntity> ActorEntities;
+	};
+
+	// Cache the entities of the annotated actors
+	void BuildActorEntities();
+
+	// Issue the async trace, the result is harvested in the trace callback on the game thread
+	void IssueTrace();
+
+	// Trace callback, looks up the hit entity and draws the debug lines (game thread)
+	static void OnTraceCompleted(const FTraceDatum& TraceDatum, const TSharedRef<FTraceState>& State);
+
 	// True if the eye tracking framework is successfully working
 	bool bIsInit;
 
@@ -98,6 +124,9 @@ private:
 	// Custom made sranipal proxy to avoid compilation issues
 	class ASLGazeProxy* GazeProxy;
 
+	// Trace results (the callbacks only hold weak references)
+	TSharedRef<FTraceState> TraceState;
+
 	/* Constants */
 	constexpr static float RayLength = 1000.f;
 	constexpr static float RayRadius = 1.5f;
@@ -7,6 +7,11 @@
 #include "ISLWorldWriter.h"
 #include "SLStructs.h"
 #include "SLGazeDataHandler.h"
+#include "SLWorldStateBuffer.h"
+#include "SLWorldChangeDetector.h"
+#include "SLWorldWriterSink.h"
+#include "SLWorldStateScheduler.h"
+#include "SLWorldTelemetry.h"
 
 /**
 * Type of world state loggers
@@ -17,7 +22,8 @@ enum class ESLWorldWriterType : uint8
 	Json					UMETA(DisplayName = "Json"),
 	Bson					UMETA(DisplayName = "Bson"),
 	MongoC					UMETA(DisplayName = "MongoC"),
-	MongoCxx				UMETA(DisplayName = "MongoCxx")
+	MongoCxx				UMETA(DisplayName = "MongoCxx"),
+	Binary					UMETA(DisplayName = "Binary")
 };
 
 /**
@@ -36,9 +42,9 @@ public:
 	// Destructor
 	virtual ~FSLWorldAsyncWorker();
 
-	// Init worker, load models to log from world
+	// Init worker, load models to log from world (with several writer types each writes from its own thread)
 	void Init(UWorld* InWorld,
-		ESLWorldWriterType InWriterType,
+		const TArray<ESLWorldWriterType>& InWriterTypes,
 		const FSLWorldWriterParams& InParams);
 
 	// Prepare worker for starting to log
@@ -59,21 +65,113 @@ public:
 	// Remove all non-movable semantic items from the update pool
 	void RemoveStaticItems();
 
-	// TODO implement these for cutting
-	//// Remove entity from being logged
-	//bool RemoveEntity(UObject* Obj);
+	// Copy the current poses of the entities into the snapshot buffer (game thread), false if the buffer is full
+	bool Capture(float Timestamp);
 
-	//// Add new actor entity
-	//bool AddNewActorEntity(AActor* Actor);
+	// True if there are captured snapshots waiting for the change detection (the writer sinks keep the entities of their snapshots)
+	bool HasPendingSnapshots() const { return !SnapshotBuffer.IsEmpty(); };
 
-	//// Add new scene component entity
-	//bool AddNewComponentEntity(AActor* Actor);
+	// Number of captured snapshots waiting for the change detection (the buffer is full at its depth)
+	int32 GetNumPendingSnapshots() const { return SnapshotBuffer.Num(); };
+
+	// Expected time (s) between two captures, the later captures are counted as late (0 if captured every tick)
+	void SetCaptureInterval(float Interval) { Telemetry.SetExpectedInterval(Interval); };
+
+	// Queue a spawned actor to be logged with its annotated components (game thread, O(1)),
+	// it is registered at the next entity update since its tags can be set after spawning
+	void AddNewActorEntity(AActor* Actor);
+
+	// Queue the object (and the components of an actor) to be removed from logging and unregister it from the entities manager (game thread)
+	void RemoveEntity(UObject* Obj);
+
+	// True if entities are waiting to be added or removed
+	bool HasPendingEntityChanges() const { return bHasInvalidEntities || PendingRemovals.Num() > 0 || PendingNewActors.Num() > 0; };
+
+	// Add the queued actors and remove the queued and invalid entities (game thread, only call if the task is idle and no snapshot waits for the detection)
+	void UpdateEntities();
 
 
 private:
-	// FAsyncTask - async work done here
+	// FAsyncTask - async work done here (writes all pending snapshots)
 	void DoWork();
 
+	// Write all the pending snapshots (with several writers the changes are detected and the sinks notified)
+	void WritePendingSnapshots();
+
+	// Block until every writer sink is done with the pending snapshots, false on timeout
+	bool WaitForSinks(float Timeout) const;
+
+	// Create a writer of the given type, invalid if it could not be initialized
+	static TSharedPtr<ISLWorldWriter> CreateWriter(ESLWorldWriterType InWriterType, const FSLWorldWriterParams& InParams);
+
+	// Copy the poses of the given entities into the snapshot, returns false if any of them is invalid and not queued for removal
+	template<typename T>
+	bool CapturePoses(const TArray<TSLEntityPreviousPose<T>>& Entities, FSLPoseArrays& OutPoses) const;
+
+	// Copy the bone poses of the skeletal entities into the snapshot (the skeletals which are not due keep their cached bones)
+	void CaptureBones(FSLWorldStateSnapshot& OutSnapshot);
+
+	// Read the poses of the dirty entities into the cache and copy it into the snapshot, returns false if any of them is invalid and not queued for removal
+	// (with rate tiers the dirty entities which are not due stay dirty until the next captures)
+	template<typename T>
+	bool CaptureDirtyPoses(const TArray<TSLEntityPreviousPose<T>>& Entities, TArray<int32>& DirtyIdxs,
+		TArray<bool>& DirtyFlags, FSLPoseArrays& CachedPoses, FSLPoseArrays& OutPoses, TArray<int32>& OutDirtyIdxs,
+		const FSLScheduledGroup* Group = nullptr);
+
+	// Read the poses of the base and due tier entities into the cache and copy it into the snapshot, returns false if any of them is invalid and not queued for removal
+	template<typename T>
+	bool CaptureScheduledPoses(const TArray<TSLEntityPreviousPose<T>>& Entities, const FSLScheduledGroup& Group,
+		FSLPoseArrays& CachedPoses, FSLPoseArrays& OutPoses, TArray<int32>& OutReadIdxs);
+
+	// Share a copy of the entity arrays with the snapshots captured from now on (only used with the writer sinks)
+	void UpdateEntityLayout();
+
+	// Append the annotated actor, components and skeletals of the actor to the entity arrays
+	void AppendEntities(AActor* Actor);
+
+	// Append an entity and register its index
+	template<typename T>
+	static void AddEntity(TArray<TSLEntityPreviousPose<T>>& Entities, TMap<const UObject*, int32>& EntityIdxs, T* Obj, const FSLEntity& Entity,
+		TSharedPtr<const FSLEntityUtf8> Utf8);
+
+	// Remove the entity at the index, the last entity takes its place and its index is updated
+	template<typename T>
+	static void RemoveEntityAtSwap(TArray<TSLEntityPreviousPose<T>>& Entities, TMap<const UObject*, int32>& EntityIdxs, int32 Idx);
+
+	// Swap-remove the entity and mirror it in the change detector, the pose caches, the dirty flags, the delegates and the scheduler
+	void RemoveActorAt(int32 Idx);
+	void RemoveComponentAt(int32 Idx);
+	void RemoveSkeletalAt(int32 Idx);
+
+	// Swap-remove the dirty flag of the index, the dirty list refers to the new index of the moved entity
+	static void RemoveDirtyAtSwap(TArray<bool>& DirtyFlags, TArray<int32>& DirtyIdxs, int32 Idx);
+
+	// Get the update rate tier (s) of the entity from its tags or its class, 0 if it is read at every capture
+	float GetEntityUpdateRate(const FSLEntity& Entity) const;
+
+	// Assign the entities to their update rate tiers, the next capture reads every entity
+	void InitScheduler();
+
+	// Pass the topmost logged attachment ancestors of the actors and components to the change detector
+	void SetGroupRoots();
+
+	// Subscribe to the transform updates of the actors and components, every entity is marked as dirty
+	void BindTransformUpdates();
+
+	// Unsubscribe from the transform updates
+	void UnbindTransformUpdates();
+
+	// Subscribe to the transform updates of the actor or component at the index
+	void BindActorTransformUpdate(int32 Idx);
+	void BindComponentTransformUpdate(int32 Idx);
+
+	// Remove the transform update delegate
+	static void UnbindTransformUpdate(const TPair<TWeakObjectPtr<USceneComponent>, FDelegateHandle>& Handle);
+
+	// Transform update callbacks (game thread), mark the entity as dirty
+	void OnActorTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport, int32 Idx);
+	void OnComponentTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport, int32 Idx);
+
 	// Needed by unreal internally
 	FORCEINLINE TStatId GetStatId() const;
 
@@ -90,15 +188,21 @@ private:
 	// Pointer to world (access to timestamps)
 	UWorld* World;
 
-	// Cache of the writer thy that is active
-	ESLWorldWriterType WriterType;
-
 	// Distance squared threshold
 	float LinearDistanceSquared;
 
-	// Raw data writer
+	// Raw data writer (single writer, written from the async task)
 	TSharedPtr<ISLWorldWriter> Writer;
 
+	// Writers with their own threads (several writers, the async task only detects the changes)
+	TArray<TUniquePtr<FSLWorldWriterSink>> Sinks;
+
+	// Signaled by the sinks when they wrote all their available snapshots
+	FEvent* SinksIdleEvent;
+
+	// Entities of the next captured snapshots, read by the sinks (replaced at every entity change)
+	TSharedPtr<const FSLWorldEntityLayout, ESPMode::ThreadSafe> EntityLayout;
+
 	// Array of semantically annotated actors that are not skeletal
 	TArray<TSLEntityPreviousPose<AActor>> ActorEntitites;
 	
@@ -108,8 +212,75 @@ private:
 	// Array of semantical skeletal data components
 	TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>> SkeletalEntities;
 
+	// Index of the entities by their semantic object (actor, component or skeletal owner), removals are swap-removals
+	TMap<const UObject*, int32> ActorIdxs;
+	TMap<const UObject*, int32> ComponentIdxs;
+	TMap<const UObject*, int32> SkeletalIdxs;
+
 	// Gaze data handler
 	FSLGazeDataHandler GazeDataHandler;
+
+	// Poses captured on the game thread waiting to be written
+	FSLWorldStateBuffer SnapshotBuffer;
+
+	// Movement threshold check of the captured snapshots (writer side), the changes are shared by all writers
+	FSLWorldChangeDetector ChangeDetector;
+
+	// Set during capture if invalid entities were found (e.g. collected without a destroy notification)
+	bool bHasInvalidEntities;
+
+	// Actors spawned since the last entity update
+	TArray<TWeakObjectPtr<AActor>> PendingNewActors;
+
+	// Objects queued to be removed from logging (only used as keys)
+	TSet<const UObject*> PendingRemovals;
+
+	// Only read the actors and components whose transform changed since the last capture
+	bool bDirtyTracking;
+
+	// Only log a marker for the attached entities which moved rigidly with their group root
+	bool bRigidGroups;
+
+	// True while subscribed to the transform updates
+	bool bIsTransformUpdateBound;
+
+	// Subscribed transform update delegates (same indexes as the entity arrays, the delegates carry the index)
+	TArray<TPair<TWeakObjectPtr<USceneComponent>, FDelegateHandle>> ActorTransformHandles;
+	TArray<TPair<TWeakObjectPtr<USceneComponent>, FDelegateHandle>> ComponentTransformHandles;
+
+	// Dirty flags and indexes of the actors and components (game thread)
+	TArray<bool> bIsActorDirty;
+	TArray<bool> bIsComponentDirty;
+	TArray<int32> DirtyActorIdxs;
+	TArray<int32> DirtyComponentIdxs;
+
+	// Last read poses of the actors and components (game thread)
+	FSLPoseArrays CachedActorPoses;
+	FSLPoseArrays CachedComponentPoses;
+
+	// Update rates (s) of the entity classes slower than the capture rate
+	TMap<FString, float> ClassUpdateRates;
+
+	// Spreads the reads of the rate tier entities across the captures
+	FSLWorldStateScheduler Scheduler;
+
+	// Last read poses of the skeletals and their bones (game thread, only used with rate tiers)
+	FSLPoseArrays CachedSkeletalPoses;
+	FSLPoseArrays CachedBones;
+	TArray<int32> CachedBoneOffsets;
+
+	// Indexes of the skeletals read at the current capture
+	TArray<int32> ReadSkeletalIdxs;
+
+	// Capture, detection and serialization statistics
+	FSLWorldTelemetry Telemetry;
+
+	// Dump the telemetry at finish
+	bool bTelemetry;
+
+	// Location of the telemetry files
+	FString TelemetryTaskId;
+	FString TelemetryEpisodeId;
 	
 	
 	
@@ -0,0 +1,129 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SLWorldStateBuffer.h"
+
+/**
+* Last logged poses of a group of entities (structure of arrays, same indexes as the snapshot poses)
+*/
+struct FSLPreviousPoses
+{
+	// Last logged poses
+	FSLPoseArrays Poses;
+
+	// Time of the last logged poses (negative if never logged)
+	TArray<float> Times;
+
+	// Add or remove entries to match the given number, new entries are always logged at the next check
+	void SetNum(int32 InNum);
+
+	// Remove the entry of the given index, the last entry takes its place
+	void RemoveAtSwap(int32 Idx);
+
+	// Copy an entry from another group
+	void CopyEntry(const FSLPreviousPoses& Other, int32 OtherIdx, int32 Idx);
+
+	// Number of entries
+	int32 Num() const { return Times.Num(); }
+};
+
+/**
+ * Movement threshold check of all entities of a snapshot, the previous poses are stored as structure of arrays
+ * and compared four entities at a time using vector instructions
+ */
+class FSLWorldChangeDetector
+{
+public:
+	// Default ctor
+	FSLWorldChangeDetector();
+
+	// Set the movement thresholds
+	void Init(float InLinDistSqMin, float InAngDistMin);
+
+	// Forget the previous poses, every valid entity is reported as moved at the next check
+	void Reset();
+
+	// Compute the moved entities of the snapshot and store their poses as the last logged ones
+	void Detect(const FSLWorldStateSnapshot& Snapshot, FSLWorldStateChanges& OutChanges);
+
+	// Set the attachment group roots of the actors and components (same indexes as the entity arrays), the moved children
+	// which kept their pose relative to their moved root are reported as rigid
+	void SetGroupRoots(const TArray<FSLGroupRoot>& InActorRoots, const TArray<FSLGroupRoot>& InComponentRoots);
+
+	// Keep the previous poses in sync with the entity arrays when an entity is swap-removed (the group roots have to be set again)
+	void RemoveActorAtSwap(int32 Idx) { PrevActors.RemoveAtSwap(Idx); bHasGroupRoots = false; };
+	void RemoveComponentAtSwap(int32 Idx) { PrevComponents.RemoveAtSwap(Idx); bHasGroupRoots = false; };
+	void RemoveSkeletalAtSwap(int32 Idx);
+
+	// Append the indexes of the valid poses that moved more than the thresholds (vectorized, does not update the previous poses)
+	static void FindMoved(const FSLPoseArrays& Poses, const FSLPoseArrays& PrevPoses,
+		float LinDistSqMin, float QuatDotSqMin, TArray<int32>& OutIdxs);
+
+private:
+	// Check a group of entities and update the previous poses of the moved ones (unless disabled),
+	// if candidates are given (dirty tracking) only these are checked
+	void DetectGroup(const FSLPoseArrays& Poses, float Time, FSLPreviousPoses& Prev, TArray<int32>& OutIdxs,
+		const TArray<int32>* CandidateIdxs = nullptr, bool bUpdatePrevious = true) const;
+
+	// Move the children which kept their pose relative to their moved group root from the moved to the rigid lists,
+	// then update the previous poses (the rigid children get the pose the readers reconstruct)
+	void DetectRigidChildren(const FSLWorldStateSnapshot& Snapshot, FSLWorldStateChanges& OutChanges);
+
+	// Find the rigid children of the moved entities of a group (compares against the previous poses before they are updated)
+	void FindRigid(const FSLPoseArrays& Poses, const FSLPreviousPoses& Prev, const TArray<FSLGroupRoot>& Roots,
+		const TArray<int32>& MovedIdxs, const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes,
+		TArray<int32>& OutRigidIdxs, TArray<FSLGroupRoot>& OutRigidRoots, TArray<FTransform>& OutRigidPoses) const;
+
+	// Scalar check of the given candidates (ascending) against the last logged poses
+	void FindMovedCandidates(const FSLPoseArrays& Poses, const FSLPoseArrays& PrevPoses,
+		const TArray<int32>& CandidateIdxs, TArray<int32>& OutIdxs) const;
+
+	// Store the pose as the last logged one
+	void UpdatePrevious(const FSLPoseArrays& Poses, int32 Idx, float Time, FSLPreviousPoses& Prev) const;
+
+	// Check every bone against its own previous pose, a skeletal entity is changed if its root or any of its bones moved
+	void DetectSkeletals(const FSLWorldStateSnapshot& Snapshot, FSLWorldStateChanges& OutChanges);
+
+	// Move the previous bone poses to the new bone layout of the snapshot (skeletal entities with a changed number of bones are reset)
+	void RemapBones(const TArray<int32>& BoneOffsets);
+
+private:
+	// Location step size (log items that moved at least this distance since the last log)
+	float LinDistSqMin;
+
+	// Rotation step size (log items that rotated at least this value since the last log)
+	float AngDistMin;
+
+	// Squared quaternion dot product equivalent of the rotation step size (avoids the acos in the vectorized check)
+	float QuatDotSqMin;
+
+	// Last logged poses
+	FSLPreviousPoses PrevActors;
+	FSLPreviousPoses PrevComponents;
+	FSLPreviousPoses PrevSkeletals;
+	FSLPreviousPoses PrevBones;
+
+	// Bone layout of the snapshot the previous bone poses were remapped to (emptied when a skeletal entity is removed)
+	TArray<int32> PrevBoneOffsets;
+
+	// First bone and number of bones of every skeletal entity in the previous bone poses
+	TArray<TPair<int32, int32>> PrevBoneRanges;
+
+	// Moved skeletal roots and bones of the current snapshot
+	TArray<int32> MovedRoots;
+	TArray<int32> MovedBones;
+
+	// Attachment group roots of the actors and components
+	TArray<FSLGroupRoot> ActorRoots;
+	TArray<FSLGroupRoot> ComponentRoots;
+
+	// True if the group roots match the current entity arrays and at least one entity has a root
+	bool bHasGroupRoots;
+
+	// Reconstructed poses of the rigid children of the current snapshot
+	TArray<FTransform> RigidActorPoses;
+	TArray<FTransform> RigidComponentPoses;
+};
@@ -0,0 +1,93 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+* Compact encoding of the poses written between two keyframes:
+*
+* [Delta]  Slot(varint) DX(zigzag varint) DY(zigzag varint) DZ(zigzag varint) Rot(6 bytes)
+*
+* Slots are assigned in the order the entities (and bones) appear in the keyframe, the locations are quantized
+* with the keyframe precision and stored as the difference to the previous value of the slot (the keyframe value
+* is the first base), the rotations use the smallest three encoding: index of the largest component (2 bits)
+* followed by the other three components (15 bits each)
+*/
+struct FSLWorldPoseCodec
+{
+	// Size of an encoded rotation
+	static constexpr int32 QuatSize = 6;
+
+	// Quantize a location component
+	static FORCEINLINE int64 QuantizeLoc(double Value, double Precision)
+	{
+		return static_cast<int64>(FMath::FloorToDouble(Value / Precision + 0.5));
+	}
+
+	// Append unsigned variable length integer
+	static void AppendVarint(TArray<uint8>& Out, uint64 Value);
+
+	// Read unsigned variable length integer, false if the data ends
+	static bool ReadVarint(const uint8*& Ptr, const uint8* End, uint64& OutValue);
+
+	// Map signed to unsigned values so that small magnitudes have short varints
+	static FORCEINLINE uint64 ZigZag(int64 Value) { return (static_cast<uint64>(Value) << 1) ^ static_cast<uint64>(Value >> 63); }
+	static FORCEINLINE int64 UnZigZag(uint64 Value) { return static_cast<int64>(Value >> 1) ^ -static_cast<int64>(Value & 1); }
+
+	// Append rotation using the smallest three encoding
+	static void AppendQuat(TArray<uint8>& Out, const FQuat& InQuat);
+
+	// Read smallest three encoded rotation, false if the data ends
+	static bool ReadQuat(const uint8*& Ptr, const uint8* End, FQuat& OutQuat);
+};
+
+/**
+* Writes the deltas of the poses relative to the last keyframe
+*/
+class FSLWorldPoseEncoder
+{
+public:
+	// Start a new keyframe, removes all slots
+	void Reset(double InLocPrecision);
+
+	// Add the slot of an entity written in the keyframe, returns the slot index
+	int32 AddSlot(const FVector& InLoc);
+
+	// Append the delta of the slot pose
+	void AppendDelta(int32 Slot, const FVector& InLoc, const FQuat& InQuat, TArray<uint8>& Out);
+
+private:
+	// Location quantization step
+	double LocPrecision = 1.0;
+
+	// Last quantized location of every slot
+	TArray<int64> SlotLocs;
+};
+
+/**
+* Reconstructs the poses from the deltas relative to the last keyframe
+*/
+class FSLWorldPoseDecoder
+{
+public:
+	// Start a new keyframe, removes all slots
+	void Reset(double InLocPrecision);
+
+	// Add the slot of an entity read from the keyframe, returns the slot index
+	int32 AddSlot(const FVector& InLoc);
+
+	// Number of slots
+	int32 Num() const { return SlotLocs.Num() / 3; };
+
+	// Decode the deltas, the callback is called with the slot index and its reconstructed pose, false on corrupt data
+	bool Decode(const uint8* Data, int32 Size, TFunctionRef<void(int32 Slot, const FVector& Loc, const FQuat& Quat)> Callback);
+
+private:
+	// Location quantization step
+	double LocPrecision = 1.0;
+
+	// Last quantized location of every slot
+	TArray<int64> SlotLocs;
+};
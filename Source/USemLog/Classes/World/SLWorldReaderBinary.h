@@ -0,0 +1,151 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SLWorldWriterBinary.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+* Dictionary entry of the binary world state format
+*/
+struct FSLWorldBinaryEntity
+{
+	// Semantic id (can be empty for bones)
+	FString Id;
+
+	// Semantic class
+	FString Class;
+
+	// Bone name (empty for non bones)
+	FString Name;
+
+	// Handle of the parent entity (InvalidHandle for non bones)
+	uint32 ParentHandle = FSLWorldBinaryFormat::InvalidHandle;
+};
+
+/**
+* View of a frame record, the columns point directly into the (memory mapped) file
+*/
+struct FSLWorldBinaryFrame
+{
+	// Frame timestamp
+	float Timestamp = 0.f;
+
+	// Number of rows
+	int32 Num = 0;
+
+	// Entity handles column
+	const uint32* Handles = nullptr;
+
+	// Locations column (x,y,z per row)
+	const float* Locs = nullptr;
+
+	// Rotations column (x,y,z,w per row)
+	const float* Quats = nullptr;
+
+	// Number of rigid children
+	int32 NumRigid = 0;
+
+	// Rigid children and group root handle pairs
+	const uint32* RigidHandles = nullptr;
+
+	// Get the location of the given row
+	FORCEINLINE FVector GetLoc(int32 Row) const { return FVector(Locs[3 * Row], Locs[3 * Row + 1], Locs[3 * Row + 2]); }
+
+	// Get the rotation of the given row
+	FORCEINLINE FQuat GetQuat(int32 Row) const { return FQuat(Quats[4 * Row], Quats[4 * Row + 1], Quats[4 * Row + 2], Quats[4 * Row + 3]); }
+};
+
+/**
+ * Reader of the binary world state format, the file is memory mapped when the platform supports it
+ */
+class FSLWorldReaderBinary
+{
+public:
+	// Default ctor
+	FSLWorldReaderBinary();
+
+	// Dtor
+	~FSLWorldReaderBinary();
+
+	// Open the file and load the dictionary and seek table
+	bool Open(const FString& FilePath);
+
+	// Release the file
+	void Close();
+
+	// True if a file is open
+	bool IsOpen() const { return Data != nullptr; };
+
+	// Get the dictionary (indexed by handle)
+	const TArray<FSLWorldBinaryEntity>& GetEntities() const { return Entities; };
+
+	// Number of frames
+	int32 GetNumFrames() const { return FrameOffsets.Num(); };
+
+	// Get the timestamp of the given frame
+	float GetFrameTimestamp(int32 FrameIdx) const { return FrameTimestamps[FrameIdx]; };
+
+	// Index of the last frame with the timestamp smaller or equal to the given one (INDEX_NONE if none)
+	int32 FindFrame(float Timestamp) const;
+
+	// Get the given frame
+	bool GetFrame(int32 FrameIdx, FSLWorldBinaryFrame& OutFrame) const;
+
+	// Apply the frame to the poses of the entities (indexed by handle, as logged), the rigid children are reconstructed from their group roots
+	static void ApplyFrame(const FSLWorldBinaryFrame& Frame, TArray<FTransform>& InOutPoses);
+
+private:
+	// Read the seek table from the footer, false if the file has no (valid) footer
+	bool ReadSeekTable();
+
+	// Parse all the records (dictionary and frame offsets), used if the file has no seek table (e.g. crash), stops at the last complete record
+	bool ReadRecords(bool bOnlyDictionary);
+
+	// Parse a dictionary record, returns the offset after the record
+	int64 ReadDictionary(int64 Offset);
+
+	// Read a value from the given offset
+	template<typename T>
+	FORCEINLINE bool ReadValue(int64 Offset, T& OutValue) const
+	{
+		if (Offset < 0 || Offset + static_cast<int64>(sizeof(T)) > Size)
+		{
+			return false;
+		}
+		FMemory::Memcpy(&OutValue, Data + Offset, sizeof(T));
+		return true;
+	}
+
+	// Read a length prefixed utf8 string, returns the offset after the string (INDEX_NONE on error)
+	int64 ReadString(int64 Offset, FString& OutStr) const;
+
+private:
+	// Mapped file
+	IMappedFileHandle* MappedHandle;
+
+	// Mapped region of the whole file
+	IMappedFileRegion* MappedRegion;
+
+	// File content if memory mapping is not available
+	TArray<uint8> FileContent;
+
+	// Start of the file content
+	const uint8* Data;
+
+	// Size of the file content
+	int64 Size;
+
+	// Dictionary
+	TArray<FSLWorldBinaryEntity> Entities;
+
+	// File offset of every frame
+	TArray<int64> FrameOffsets;
+
+	// Timestamp of every frame
+	TArray<float> FrameTimestamps;
+};
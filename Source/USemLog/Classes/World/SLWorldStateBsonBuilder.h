@@ -0,0 +1,121 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#pragma once
+
+#include "USemLog.h"
+#include "ISLWorldWriter.h"
+#include "SLWorldPoseCodec.h"
+#if SL_WITH_LIBMONGO_C
+THIRD_PARTY_INCLUDES_START
+	#if PLATFORM_WINDOWS
+	#include "Windows/AllowWindowsPlatformTypes.h"
+	#include <mongoc/mongoc.h>
+	#include "Windows/HideWindowsPlatformTypes.h"
+	#else
+	#include <mongoc/mongoc.h>
+	#endif // #if PLATFORM_WINDOWS
+THIRD_PARTY_INCLUDES_END
+#endif //SL_WITH_LIBMONGO_C
+
+/**
+ * Builds the bson world state documents, shared by the mongo and the bson file writers
+ */
+class FSLWorldStateBsonBuilder
+{
+public:
+	// Default ctor
+	FSLWorldStateBsonBuilder();
+
+	// Set the compression parameters
+	void Init(const FSLWorldWriterCompressionParams& InCompression = FSLWorldWriterCompressionParams());
+
+#if SL_WITH_LIBMONGO_C
+	// Add the entities that moved since the last logging to the document, returns the number of added entries
+	uint32 AddWorldState(const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes,
+		const TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
+		const TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
+		const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
+		bson_t* out_doc);
+
+private:
+	// Add non skeletal actors to array
+	void AddActorEntities(const TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
+		const FSLPoseArrays& Poses, const TArray<int32>& Idxs, bool bKeyframe, bson_t* out_doc, uint32_t& idx);
+
+	// Add non skeletal components to array
+	void AddComponentEntities(const TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
+		const FSLPoseArrays& Poses, const TArray<int32>& Idxs, bool bKeyframe, bson_t* out_doc, uint32_t& idx);
+
+	// Add the markers of the rigid children to array (the id of the group root instead of the pose)
+	template<typename T>
+	void AddRigidEntities(const TArray<TSLEntityPreviousPose<T>>& Entities, const TArray<int32>& RigidIdxs,
+		const TArray<FSLGroupRoot>& Roots, const TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
+		const TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities, bson_t* out_doc, uint32_t& idx);
+
+	// Add skeletal actors to array
+	void AddSkeletalEntities(const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
+		const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes, bool bKeyframe, bson_t* out_doc, uint32_t& idx);
+
+	// Add the gaze data if it changed since the last logging
+	void AddGazeIfChanged(const FSLGazeData& GazeData, bson_t* out_doc, uint32& NumEntries);
+
+	// Add gaze data
+	void AddGazeData(const FSLGazeData& GazeData, bson_t* out_doc);
+
+	// Add the given captured bones of a skeletal entity to array
+	void AddSkeletalBones(const FSLWorldStateSnapshot& Snapshot, TArrayView<const int32> BoneIdxs, int32 SkelIdx,
+		const TSLEntityPreviousPose<USLSkeletalDataComponent>& SkelEntity, bool bKeyframe, bson_t* out_doc);
+
+	// Add pose to document
+	void AddPoseChild(const FVector& InLoc, const FQuat& InQuat, bson_t* out_doc);
+
+	// True if the next document has to be a keyframe
+	bool NeedsKeyframe(const FSLWorldStateSnapshot& Snapshot, int32 NumActors, int32 NumComponents, int32 NumSkeletals) const;
+
+	// Reset the slots, they are assigned while the keyframe is written
+	void BeginKeyframe(const FSLWorldStateSnapshot& Snapshot, int32 NumActors, int32 NumComponents, int32 NumSkeletals);
+
+	// Add the deltas of the moved non skeletal entities, returns the number of added entities
+	uint32 AddEntityDeltas(const FSLPoseArrays& Poses, const TArray<int32>& MovedIdxs, const TArray<int32>& Slots);
+
+	// Add the deltas of the changed skeletal entities and their moved bones, returns the number of added skeletal entities
+	uint32 AddSkeletalDeltas(const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes);
+#endif //SL_WITH_LIBMONGO_C
+
+public:
+	// Get the location as it is logged (ROS coordinates if available)
+	static FVector GetLoggedLoc(const FVector& InLoc);
+
+	// Get the rotation as it is logged (ROS coordinates if available)
+	static FQuat GetLoggedQuat(const FQuat& InQuat);
+
+private:
+	// Previous gaze data
+	FSLGazeData PreviousGazeData;
+
+	// Keyframe and delta compression parameters
+	FSLWorldWriterCompressionParams Compression;
+
+	// Writes the deltas relative to the last keyframe
+	FSLWorldPoseEncoder PoseEncoder;
+
+	// Delta slot of every entity and bone (INDEX_NONE if it was not part of the last keyframe)
+	TArray<int32> ActorSlots;
+	TArray<int32> ComponentSlots;
+	TArray<int32> SkeletalSlots;
+	TArray<int32> BoneSlots;
+
+	// Indexes of the valid entities and of the bones written in the current keyframe
+	TArray<int32> KeyframeIdxs;
+	TArray<int32> KeyframeBoneIdxs;
+
+	// Deltas of the current document
+	TArray<uint8> DeltaBuffer;
+
+	// True if a keyframe was written
+	bool bHasKeyframe;
+
+	// Time of the last keyframe
+	float LastKeyframeTime;
+};
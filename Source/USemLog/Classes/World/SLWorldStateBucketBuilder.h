@@ -0,0 +1,115 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#pragma once
+
+#include "USemLog.h"
+#include "ISLWorldWriter.h"
+#if SL_WITH_LIBMONGO_C
+THIRD_PARTY_INCLUDES_START
+	#if PLATFORM_WINDOWS
+	#include "Windows/AllowWindowsPlatformTypes.h"
+	#include <mongoc/mongoc.h>
+	#include "Windows/HideWindowsPlatformTypes.h"
+	#else
+	#include <mongoc/mongoc.h>
+	#endif // #if PLATFORM_WINDOWS
+THIRD_PARTY_INCLUDES_END
+#endif //SL_WITH_LIBMONGO_C
+
+/**
+* Layout of the entity bucket documents:
+* { ts: date (window start), meta: { id, bone, bone_id }, start, end, num,
+*   timestamps: float32[num], locs: float32[3*num], quats: float32[4*num] }
+* the packed arrays are little endian binaries, the timestamps are offsets from start (s, keeps the sub millisecond
+* precision in long episodes), the poses are in the logged coordinates (ROS if available)
+*/
+struct FSLWorldStateBucketFormat
+{
+	// Time field of the time series collection
+	static const char* TimeField() { return "ts"; }
+
+	// Meta field of the time series collection
+	static const char* MetaField() { return "meta"; }
+};
+
+/**
+ * Collects the moved poses of every entity and bone over a time window, the closed windows are written as
+ * one document per entity (or bone) so trajectory queries only read a few documents
+ */
+class FSLWorldStateBucketBuilder
+{
+public:
+	// Default ctor
+	FSLWorldStateBucketBuilder();
+
+	// Set the bucket parameters
+	void Init(const FSLWorldWriterMongoBucketParams& InParams);
+
+#if SL_WITH_LIBMONGO_C
+	// Append the moved poses to their buckets, the documents of the buckets closed by the snapshot are added to the array
+	void AddWorldState(const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes,
+		const TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
+		const TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
+		const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
+		TArray<bson_t*>& OutDocs);
+
+	// Create the documents of the open buckets (end of the episode)
+	void CloseBuckets(TArray<bson_t*>& OutDocs);
+
+private:
+	// Create the documents of the non empty buckets and clear them (the buckets are kept for the next window)
+	void BuildDocuments(TArray<bson_t*>& OutDocs);
+#endif //SL_WITH_LIBMONGO_C
+
+private:
+	// Poses of an entity (or bone) in the current window
+	struct FBucket
+	{
+		// Strings of the entity, also keeps the bucket key alive
+		TSharedPtr<const FSLEntityUtf8> Entity;
+
+		// Bone name and id (bones only)
+		FSLUtf8Str BoneName;
+		FSLUtf8Str BoneId;
+
+		// Time of the first sample
+		double StartTs = 0.0;
+
+		// Packed samples (timestamps as offsets from the first sample)
+		TArray<float> Timestamps;
+		TArray<float> Locs;
+		TArray<float> Quats;
+	};
+
+	// Get (or create) the bucket of the entity, bones use their index in the skeletal entity
+	FBucket& GetBucket(const TSharedPtr<const FSLEntityUtf8>& Entity, int32 LocalBoneIdx = INDEX_NONE);
+
+	// Append the pose to the bucket
+	static void AddSample(FBucket& Bucket, double Timestamp, const FVector& InLoc, const FQuat& InQuat);
+
+	// Add the given entities to their buckets
+	template<typename T>
+	void AddEntities(const TArray<TSLEntityPreviousPose<T>>& Entities, const FSLPoseArrays& Poses,
+		const TArray<int32>& MovedIdxs, float Timestamp);
+
+	// Add the changed skeletal entities and their moved bones to their buckets
+	void AddSkeletalEntities(const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
+		const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes);
+
+private:
+	// Bucket parameters
+	FSLWorldWriterMongoBucketParams Params;
+
+	// Buckets of all the entities and bones seen so far
+	TArray<FBucket> Buckets;
+
+	// Index of the bucket of the entity and bone (INDEX_NONE for the entity itself)
+	TMap<TPair<const FSLEntityUtf8*, int32>, int32> BucketIdxs;
+
+	// Index of the current time window
+	int64 WindowIdx;
+
+	// Number of samples in the current window
+	int32 NumSamples;
+};
@@ -0,0 +1,95 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#pragma once
+
+#include "USemLog.h"
+#include "SLWorldStateBucketBuilder.h"
+#if SL_WITH_LIBMONGO_C
+THIRD_PARTY_INCLUDES_START
+	#if PLATFORM_WINDOWS
+	#include "Windows/AllowWindowsPlatformTypes.h"
+	#include <mongoc/mongoc.h>
+	#include "Windows/HideWindowsPlatformTypes.h"
+	#else
+	#include <mongoc/mongoc.h>
+	#endif // #if PLATFORM_WINDOWS
+THIRD_PARTY_INCLUDES_END
+#endif //SL_WITH_LIBMONGO_C
+
+/**
+ * Reads the trajectories from the world state collections written with the entity bucket layout,
+ * only the buckets of the entity which overlap the queried time interval are read
+ */
+class USEMLOG_API FSLWorldStateBucketReader
+{
+public:
+	// Default ctor
+	FSLWorldStateBucketReader();
+
+	// Dtor
+	~FSLWorldStateBucketReader();
+
+	// Connect to the episode collection
+	bool Connect(const FString& DBName, const FString& CollectionName, const FString& ServerIp, uint16 ServerPort);
+
+	// Disconnect and clean db connection
+	void Disconnect();
+
+	// True if connected
+	bool IsConnected() const { return bIsConnected; };
+
+	// Get the poses of the entity in the interval, with a positive delta time the samples are at least delta time apart,
+	// if the entity did not move at the interval start the trajectory starts with its last logged pose before it
+	bool GetEntityTrajectory(const FString& Id, float StartTs, float EndTs, TArray<FTransform>& OutTraj,
+		float DeltaT = -1.f, TArray<float>* OutTimestamps = nullptr) const;
+
+	// Get the poses of the bone of the skeletal entity in the interval
+	bool GetBoneTrajectory(const FString& Id, const FString& BoneName, float StartTs, float EndTs, TArray<FTransform>& OutTraj,
+		float DeltaT = -1.f, TArray<float>* OutTimestamps = nullptr) const;
+
+private:
+	// Progress of reading the buckets of a trajectory
+	struct FReadState
+	{
+		// Time of the first and last read samples in the interval
+		double FirstTs = BIG_NUMBER;
+		double LastTs = -BIG_NUMBER;
+
+		// Last sample before the interval
+		bool bHasPrev = false;
+		double PrevTs = 0.0;
+		FTransform PrevPose;
+	};
+
+	// Query the buckets of the entity (or bone) overlapping the interval and unpack the samples
+	bool GetTrajectory(const FString& Id, const FString* BoneName, float StartTs, float EndTs, TArray<FTransform>& OutTraj,
+		float DeltaT, TArray<float>* OutTimestamps) const;
+
+#if SL_WITH_LIBMONGO_C
+	// Create the filter of the buckets of the entity (or bone)
+	static bson_t* CreateFilter(const FString& Id, const FString* BoneName);
+
+	// Unpack the samples of the bucket document in the interval, the last sample before the interval is kept separately
+	static void ReadBucket(const bson_t* doc, double StartTs, double EndTs, float DeltaT, FReadState& State,
+		TArray<FTransform>& OutTraj, TArray<float>* OutTimestamps);
+#endif //SL_WITH_LIBMONGO_C
+
+	// Convert the logged pose back to the unreal coordinates
+	static FTransform ToUnrealPose(const float* Loc, const float* Quat);
+
+private:
+	// Set when connected
+	bool bIsConnected;
+
+#if SL_WITH_LIBMONGO_C
+	// Server uri
+	mongoc_uri_t* uri;
+
+	// MongoC connection client
+	mongoc_client_t* client;
+
+	// Episode collection
+	mongoc_collection_t* collection;
+#endif //SL_WITH_LIBMONGO_C
+};
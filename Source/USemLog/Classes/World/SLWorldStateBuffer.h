@@ -0,0 +1,379 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Atomic.h"
+#include "Templates/UniquePtr.h"
+#include "Containers/ArrayView.h"
+#include "SLGazeDataHandler.h"
+
+struct FSLWorldEntityLayout;
+
+/**
+* Poses of a group of entities stored as structure of arrays (one array per component, so the
+* movement checks can process several entities per vector instruction),
+* the indexes match the entity arrays of the world async worker
+*/
+struct FSLPoseArrays
+{
+	// Location components
+	TArray<float> LocX;
+	TArray<float> LocY;
+	TArray<float> LocZ;
+
+	// Rotation components
+	TArray<float> QuatX;
+	TArray<float> QuatY;
+	TArray<float> QuatZ;
+	TArray<float> QuatW;
+
+	// False if the entity was not valid at capture time (e.g. destroyed actor)
+	TArray<bool> Valid;
+
+	// Preallocate the arrays
+	void Reserve(int32 InNum)
+	{
+		LocX.Reserve(InNum);
+		LocY.Reserve(InNum);
+		LocZ.Reserve(InNum);
+		QuatX.Reserve(InNum);
+		QuatY.Reserve(InNum);
+		QuatZ.Reserve(InNum);
+		QuatW.Reserve(InNum);
+		Valid.Reserve(InNum);
+	}
+
+	// Resize the arrays without shrinking the allocated memory (values are left uninitialized)
+	void SetNum(int32 InNum)
+	{
+		LocX.SetNumUninitialized(InNum, false);
+		LocY.SetNumUninitialized(InNum, false);
+		LocZ.SetNumUninitialized(InNum, false);
+		QuatX.SetNumUninitialized(InNum, false);
+		QuatY.SetNumUninitialized(InNum, false);
+		QuatZ.SetNumUninitialized(InNum, false);
+		QuatW.SetNumUninitialized(InNum, false);
+		Valid.SetNumUninitialized(InNum, false);
+	}
+
+	// Append a pose
+	void Add(const FVector& InLoc, const FQuat& InQuat)
+	{
+		SetNum(Num() + 1);
+		Set(Num() - 1, InLoc, InQuat);
+	}
+
+	// Remove the poses of the given range (the following indexes are shifted)
+	void RemoveAt(int32 Idx, int32 Count = 1)
+	{
+		LocX.RemoveAt(Idx, Count, false);
+		LocY.RemoveAt(Idx, Count, false);
+		LocZ.RemoveAt(Idx, Count, false);
+		QuatX.RemoveAt(Idx, Count, false);
+		QuatY.RemoveAt(Idx, Count, false);
+		QuatZ.RemoveAt(Idx, Count, false);
+		QuatW.RemoveAt(Idx, Count, false);
+		Valid.RemoveAt(Idx, Count, false);
+	}
+
+	// Remove the pose of the given index, the last pose takes its place
+	void RemoveAtSwap(int32 Idx)
+	{
+		LocX.RemoveAtSwap(Idx, 1, false);
+		LocY.RemoveAtSwap(Idx, 1, false);
+		LocZ.RemoveAtSwap(Idx, 1, false);
+		QuatX.RemoveAtSwap(Idx, 1, false);
+		QuatY.RemoveAtSwap(Idx, 1, false);
+		QuatZ.RemoveAtSwap(Idx, 1, false);
+		QuatW.RemoveAtSwap(Idx, 1, false);
+		Valid.RemoveAtSwap(Idx, 1, false);
+	}
+
+	// Set the pose of the given index
+	FORCEINLINE void Set(int32 Idx, const FVector& InLoc, const FQuat& InQuat)
+	{
+		LocX[Idx] = InLoc.X;
+		LocY[Idx] = InLoc.Y;
+		LocZ[Idx] = InLoc.Z;
+		QuatX[Idx] = InQuat.X;
+		QuatY[Idx] = InQuat.Y;
+		QuatZ[Idx] = InQuat.Z;
+		QuatW[Idx] = InQuat.W;
+		Valid[Idx] = true;
+	}
+
+	// Mark the given index as invalid
+	FORCEINLINE void SetInvalid(int32 Idx)
+	{
+		Valid[Idx] = false;
+	}
+
+	// Get the location of the given index
+	FORCEINLINE FVector GetLoc(int32 Idx) const { return FVector(LocX[Idx], LocY[Idx], LocZ[Idx]); }
+
+	// Get the rotation of the given index
+	FORCEINLINE FQuat GetQuat(int32 Idx) const { return FQuat(QuatX[Idx], QuatY[Idx], QuatZ[Idx], QuatW[Idx]); }
+
+	// Copy the poses of another group, the allocated memory is reused
+	void CopyFrom(const FSLPoseArrays& Other)
+	{
+		SetNum(Other.Num());
+		FMemory::Memcpy(LocX.GetData(), Other.LocX.GetData(), Other.Num() * sizeof(float));
+		FMemory::Memcpy(LocY.GetData(), Other.LocY.GetData(), Other.Num() * sizeof(float));
+		FMemory::Memcpy(LocZ.GetData(), Other.LocZ.GetData(), Other.Num() * sizeof(float));
+		FMemory::Memcpy(QuatX.GetData(), Other.QuatX.GetData(), Other.Num() * sizeof(float));
+		FMemory::Memcpy(QuatY.GetData(), Other.QuatY.GetData(), Other.Num() * sizeof(float));
+		FMemory::Memcpy(QuatZ.GetData(), Other.QuatZ.GetData(), Other.Num() * sizeof(float));
+		FMemory::Memcpy(QuatW.GetData(), Other.QuatW.GetData(), Other.Num() * sizeof(float));
+		FMemory::Memcpy(Valid.GetData(), Other.Valid.GetData(), Other.Num() * sizeof(bool));
+	}
+
+	// Get the indexes of all the valid poses
+	void GetValidIndexes(TArray<int32>& OutIdxs) const
+	{
+		OutIdxs.Reset();
+		for (int32 Idx = 0; Idx < Valid.Num(); ++Idx)
+		{
+			if (Valid[Idx])
+			{
+				OutIdxs.Add(Idx);
+			}
+		}
+	}
+
+	// Number of stored poses
+	FORCEINLINE int32 Num() const { return LocX.Num(); }
+};
+
+/**
+* Topmost logged ancestor (attachment group root) of an actor or component entity
+*/
+struct FSLGroupRoot
+{
+	// Index of the root in its entity array, INDEX_NONE if the entity has no logged ancestor
+	int32 Idx = INDEX_NONE;
+
+	// True if the root is a component entity, otherwise it is an actor entity
+	bool bIsComponent = false;
+
+	// True if the entity has a group root
+	FORCEINLINE bool IsSet() const { return Idx != INDEX_NONE; }
+};
+
+/**
+* Indexes (ascending) of the valid entities of a snapshot that moved more than the thresholds since their last logging,
+* computed once per snapshot and consumed by the writers
+*/
+struct FSLWorldStateChanges
+{
+	// Moved non skeletal actors
+	TArray<int32> Actors;
+
+	// Moved non skeletal components
+	TArray<int32> Components;
+
+	// Skeletal entities which moved or have moved bones
+	TArray<int32> Skeletals;
+
+	// Moved bones (snapshot bone indexes) grouped by the skeletal entities above
+	TArray<int32> Bones;
+
+	// Index of the first moved bone of every changed skeletal entity, the last value is the total number of moved bones
+	TArray<int32> SkeletalBoneOffsets;
+
+	// Moved actors and components which kept their pose relative to their group root (moved in the same snapshot),
+	// only a marker with the root is logged, their pose is the previous pose relative to the previous root pose applied to the new root pose
+	TArray<int32> RigidActors;
+	TArray<int32> RigidComponents;
+
+	// Group roots of the rigid actors and components above
+	TArray<FSLGroupRoot> RigidActorRoots;
+	TArray<FSLGroupRoot> RigidComponentRoots;
+
+	// Clear the indexes without releasing the memory
+	void Reset()
+	{
+		Actors.Reset();
+		Components.Reset();
+		Skeletals.Reset();
+		Bones.Reset();
+		SkeletalBoneOffsets.Reset();
+		SkeletalBoneOffsets.Add(0);
+		RigidActors.Reset();
+		RigidComponents.Reset();
+		RigidActorRoots.Reset();
+		RigidComponentRoots.Reset();
+	}
+
+	// Get the moved bones of the given changed skeletal entity (index into the Skeletals array)
+	TArrayView<const int32> GetMovedBones(int32 ChangeIdx) const
+	{
+		const int32 First = SkeletalBoneOffsets[ChangeIdx];
+		return TArrayView<const int32>(Bones.GetData() + First, SkeletalBoneOffsets[ChangeIdx + 1] - First);
+	}
+
+	// Number of moved entities
+	int32 Num() const { return Actors.Num() + Components.Num() + Skeletals.Num() + RigidActors.Num() + RigidComponents.Num(); }
+};
+
+/**
+* Copy of the world state captured on the game thread at a given timestamp
+*/
+struct FSLWorldStateSnapshot
+{
+	// Capture time
+	float Timestamp = 0.f;
+
+	// Poses of the non skeletal actors
+	FSLPoseArrays Actors;
+
+	// Poses of the non skeletal components
+	FSLPoseArrays Components;
+
+	// Poses of the skeletal data components
+	FSLPoseArrays Skeletals;
+
+	// Poses of the bones of all skeletal entities (flattened)
+	FSLPoseArrays Bones;
+
+	// Names of the bones (flattened, same indexes as the bone poses)
+	TArray<FName> BoneNames;
+
+	// Index of the first bone of every skeletal entity, the last value is the total number of bones
+	TArray<int32> BoneOffsets;
+
+	// Eye tracking data
+	FSLGazeData GazeData;
+
+	// True if only the entities in the dirty lists changed their transform since the previous snapshot (dirty tracking)
+	bool bHasDirtyIdxs = false;
+
+	// Indexes (ascending) of the actors and components whose transform changed since the previous snapshot
+	TArray<int32> DirtyActors;
+	TArray<int32> DirtyComponents;
+
+	// Moved entities, set by the change detector before the snapshot is passed to the writers
+	FSLWorldStateChanges Changes;
+
+	// Entities at capture time (the indexes of the poses and changes), only set for the writer sinks
+	TSharedPtr<const FSLWorldEntityLayout, ESPMode::ThreadSafe> EntityLayout;
+
+	// Preallocate the arrays
+	void Reserve(int32 NumActors, int32 NumComponents, int32 NumSkeletals, int32 NumBones)
+	{
+		Actors.Reserve(NumActors);
+		Components.Reserve(NumComponents);
+		Skeletals.Reserve(NumSkeletals);
+		Bones.Reserve(NumBones);
+		BoneNames.Reserve(NumBones);
+		BoneOffsets.Reserve(NumSkeletals + 1);
+	}
+
+	// Get the bone index range of the given skeletal entity
+	FORCEINLINE void GetBoneRange(int32 SkelIdx, int32& OutFirst, int32& OutLast) const
+	{
+		OutFirst = BoneOffsets[SkelIdx];
+		OutLast = BoneOffsets[SkelIdx + 1];
+	}
+};
+
+/**
+* Single producer (game thread) buffer of world state snapshots with one or more readers, the first reader (change detector)
+* releases the snapshots to the following readers (writers); only the first reader can fill the buffer, a following reader
+* which falls a buffer depth behind skips its oldest snapshots, so a slow writer does not throttle the capture nor the other writers;
+* the snapshots are preallocated (one extra per following reader for the snapshot it is reading) to avoid allocations while logging
+*/
+class FSLWorldStateBuffer
+{
+public:
+	// Default ctor
+	FSLWorldStateBuffer();
+
+	// Max number of readers
+	enum { MaxReaders = 8 };
+
+	// Allocate the snapshots
+	void Init(int32 InDepth, int32 NumActors, int32 NumComponents, int32 NumSkeletals, int32 NumBones, int32 InNumReaders = 1);
+
+	// Remove all pending snapshots (not thread safe, only call when the readers are idle)
+	void Reset();
+
+	// Producer: get the next free snapshot to fill, nullptr if the first reader is a buffer depth behind
+	FSLWorldStateSnapshot* BeginWrite();
+
+	// Producer: publish the snapshot returned by BeginWrite
+	void EndWrite();
+
+	// Reader: get the oldest snapshot available to the reader, nullptr if there is none
+	FSLWorldStateSnapshot* BeginRead(int32 ReaderIdx = 0);
+
+	// Reader: release the snapshot returned by BeginRead
+	void EndRead(int32 ReaderIdx = 0);
+
+	// Number of snapshots waiting for the first reader
+	int32 Num() const { return static_cast<int32>(WriteIdx.Load() - ReadIdxs[0].Load()); }
+
+	// True if the first reader is done with all the snapshots
+	bool IsEmpty() const { return Num() == 0; }
+
+	// True if no more snapshots can be added
+	bool IsFull() const { return Num() >= Depth; }
+
+	// True if every reader is done with all the snapshots
+	bool IsDrained() const;
+
+	// Number of snapshots not yet released by the slowest reader
+	int32 GetNumUnread() const;
+
+	// Number of snapshots the first reader can fall behind
+	int32 GetDepth() const { return Depth; }
+
+	// Number of readers
+	int32 GetNumReaders() const { return NumReaders; }
+
+	// Number of snapshots skipped by the reader (only call from the reader thread, or once it finished)
+	int32 GetNumSkipped(int32 ReaderIdx) const { return NumSkipped[ReaderIdx]; }
+
+private:
+	// Move the following readers behind the given counter to it, their older snapshots are skipped
+	void SkipLaggingReaders(uint64 MinIdx);
+
+	// Get a snapshot which is not pending for any reader nor being read, INDEX_NONE if there is none
+	int32 FindFreeSlot();
+
+private:
+	// Preallocated snapshots
+	TArray<FSLWorldStateSnapshot> Snapshots;
+
+	// Snapshot indexes of the last written counters (ring of the buffer depth)
+	TUniquePtr<TAtomic<int32>[]> WrittenSlots;
+
+	// Number of snapshots the first reader can fall behind (and the following readers are kept)
+	int32 Depth;
+
+	// Monotonic write counter (only changed by the producer)
+	TAtomic<uint64> WriteIdx;
+
+	// Monotonic read counters (changed by their reader, the following readers are also moved forward by the producer)
+	TAtomic<uint64> ReadIdxs[MaxReaders];
+
+	// Snapshot index being read by the following readers (INDEX_NONE between reads)
+	TAtomic<int32> ReadSlots[MaxReaders];
+
+	// Counter expected by the next read (reader only)
+	uint64 NextReadIdxs[MaxReaders];
+
+	// Number of skipped snapshots (reader only)
+	int32 NumSkipped[MaxReaders];
+
+	// Snapshot index returned by BeginWrite (producer only)
+	int32 WriteSlot;
+
+	// Snapshots in use while searching for a free one (producer only)
+	TArray<bool> UsedSlots;
+
+	// Number of readers
+	int32 NumReaders;
+};
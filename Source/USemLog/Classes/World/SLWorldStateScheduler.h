@@ -0,0 +1,104 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+* Entity groups of the world async worker
+*/
+enum class ESLScheduledGroup : uint8
+{
+	Actors = 0,
+	Components = 1,
+	Skeletals = 2,
+	Num = 3
+};
+
+/**
+* Capture state of a group of entities (same indexes as the entity arrays of the world async worker)
+*/
+struct FSLScheduledGroup
+{
+	// Entities without a rate tier, read at every capture
+	TArray<int32> BaseIdxs;
+
+	// Tier entities which are due at the current capture
+	TArray<int32> DueIdxs;
+
+	// True if the entity is read at the current capture (always true for the base entities)
+	TArray<bool> bIsDue;
+
+	// Tier of every entity (INDEX_NONE for the base entities) and its position in the base list or in the tier entries
+	TArray<int32> TierIdxs;
+	TArray<int32> EntryIdxs;
+};
+
+/**
+ * Spreads the reads of the entities with a slower update rate than the capture rate evenly across the captures,
+ * every tier reads a round-robin slice of its entities so the per frame cost is flat
+ */
+class FSLWorldStateScheduler
+{
+public:
+	// Default ctor
+	FSLWorldStateScheduler();
+
+	// Create the tiers from the update rates (s) of the entities, the entities with a rate of 0 are read at every capture
+	void Init(const TArray<float>& ActorRates, const TArray<float>& ComponentRates, const TArray<float>& SkeletalRates);
+
+	// True if there are any tiers
+	bool IsActive() const { return Tiers.Num() > 0; };
+
+	// Mark the tier entities which are due at the given capture time (the first capture reads every entity)
+	void Advance(float Timestamp);
+
+	// Clear the due flags of the tier entities after the capture
+	void ClearDue();
+
+	// Remove the entity of the group, the last entity of the group takes its index (mirrors the swap removal of the entity arrays)
+	void RemoveAtSwap(ESLScheduledGroup InGroup, int32 Idx);
+
+	// Get the capture state of the group
+	const FSLScheduledGroup& GetGroup(ESLScheduledGroup Group) const { return Groups[static_cast<uint8>(Group)]; };
+
+private:
+	// Entities sharing the same update rate
+	struct FTier
+	{
+		// Update rate (s)
+		float UpdateRate = 0.f;
+
+		// Group and index of the entities
+		TArray<TPair<ESLScheduledGroup, int32>> Entries;
+
+		// Next entry to read
+		int32 Cursor = 0;
+
+		// Fractional number of entries owed to the next captures
+		float Budget = 0.f;
+	};
+
+	// Add the entities of the group to the base list or to their tiers
+	void AddGroup(ESLScheduledGroup Group, const TArray<float>& Rates);
+
+	// Mark the tier entry as due
+	void SetDue(const TPair<ESLScheduledGroup, int32>& Entry);
+
+	// Remove the entity from its base list or tier entries, the entry taking its position is updated
+	void RemoveEntry(ESLScheduledGroup InGroup, int32 Idx);
+
+private:
+	// Capture state of the entity groups
+	FSLScheduledGroup Groups[static_cast<uint8>(ESLScheduledGroup::Num)];
+
+	// Rate tiers
+	TArray<FTier> Tiers;
+
+	// Time of the previous capture (negative before the first capture)
+	float LastTimestamp;
+
+	// Set by the removals, the base lists are sorted again before the next capture
+	bool bSortBaseIdxs;
+};
@@ -0,0 +1,182 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+// World state logger stats (stat SLWorld)
+DECLARE_STATS_GROUP(TEXT("SLWorld"), STATGROUP_SLWorld, STATCAT_Advanced);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Capture"), STAT_SLWorldCapture, STATGROUP_SLWorld, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Detect changes"), STAT_SLWorldDetect, STATGROUP_SLWorld, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Serialize"), STAT_SLWorldSerialize, STATGROUP_SLWorld, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Queue depth"), STAT_SLWorldQueueDepth, STATGROUP_SLWorld, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Changed entities"), STAT_SLWorldChangedEntities, STATGROUP_SLWorld, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Bytes per frame"), STAT_SLWorldBytesPerFrame, STATGROUP_SLWorld, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Dropped frames"), STAT_SLWorldDroppedFrames, STATGROUP_SLWorld, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Late frames"), STAT_SLWorldLateFrames, STATGROUP_SLWorld, );
+
+/**
+* Latency histogram with power of two buckets, bucket i counts the latencies in [2^i, 2^(i+1)) us
+*/
+struct FSLLatencyHistogram
+{
+	// Number of buckets, the last one is open (~8 s and above)
+	static constexpr int32 NumBuckets = 24;
+
+	// Counts per bucket
+	uint32 Buckets[NumBuckets] = {};
+
+	// Number of samples
+	int64 Count = 0;
+
+	// Sum and max of the samples (s)
+	double Sum = 0.0;
+	double Max = 0.0;
+
+	// Add a sample (s)
+	void Add(double Seconds);
+
+	// Add the samples of another histogram
+	void Merge(const FSLLatencyHistogram& Other);
+
+	// Upper bound (s) of the bucket containing the given percentile (0-1)
+	double GetPercentile(float Percentile) const;
+
+	// Mean of the samples (s)
+	double GetMean() const { return Count > 0 ? Sum / Count : 0.0; };
+
+	// Json object with the summary and the non-empty buckets
+	FString ToJson() const;
+};
+
+/**
+* Statistics of a captured frame (game thread)
+*/
+struct FSLWorldCaptureRecord
+{
+	// Capture time
+	float Timestamp = 0.f;
+
+	// Time spent copying the poses (s)
+	float CaptureTime = 0.f;
+
+	// Snapshots waiting to be written after the capture
+	int32 QueueDepth = 0;
+
+	// The buffer was full and the frame was dropped
+	bool bDropped = false;
+
+	// The capture came later than the expected update rate
+	bool bLate = false;
+};
+
+/**
+* Statistics of a written frame (change detection on the async task, or serialization by a writer)
+*/
+struct FSLWorldWriteRecord
+{
+	// Time spent (s)
+	float Duration = 0.f;
+
+	// Number of changed entities (detection) or serialized bytes (writer)
+	int32 Num = 0;
+
+	// The writer skipped the frame since it fell a buffer depth behind
+	bool bSkipped = false;
+};
+
+/**
+* Statistics of one writer, only accessed from the thread writing with it (read after the thread finished)
+*/
+struct FSLWorldWriterTelemetry
+{
+	// Writer name (csv column prefix)
+	FString Name;
+
+	// Per frame serialization time and bytes
+	TArray<FSLWorldWriteRecord> Frames;
+
+	// Total serialized bytes
+	int64 NumBytes = 0;
+
+	// Serialization latencies
+	FSLLatencyHistogram SerializeLatencies;
+
+	// Database round-trip latencies (copied from the writer when it finished)
+	FSLLatencyHistogram RoundTripLatencies;
+
+	// Database queue high-water mark and the overflow spilled to the journal (copied from the writer when it finished)
+	int64 MaxQueuedBytes = 0;
+	int64 NumSpilledBytes = 0;
+
+	// Frames skipped by the writer since it fell a buffer depth behind
+	int32 NumSkipped = 0;
+
+	// Add the statistics of a written frame
+	void AddFrame(double Duration, int64 FrameBytes, bool bKeepFrames);
+
+	// Add frames skipped by the writer
+	void AddSkipped(int32 Num, bool bKeepFrames);
+};
+
+/**
+ * Performance telemetry of the world state logger, every series is filled from a single thread,
+ * the per frame records are dumped as csv and the summary with the histograms as json at the end of the episode
+ */
+class FSLWorldTelemetry
+{
+public:
+	// Default ctor
+	FSLWorldTelemetry();
+
+	// Create the writer slots, with bInKeepFrames the per frame records are stored for the dump
+	void Init(const TArray<FString>& WriterNames, bool bInKeepFrames);
+
+	// Expected time (s) between two captures, used to count the late frames (0 disables the check)
+	void SetExpectedInterval(float InInterval) { ExpectedInterval = InInterval; };
+
+	// Add a capture (game thread)
+	void AddCapture(float Timestamp, double Duration, int32 QueueDepth, bool bDropped);
+
+	// Add a change detection (async task)
+	void AddDetection(double Duration, int32 NumChanged);
+
+	// Get the slot of the given writer (nullptr if out of range)
+	FSLWorldWriterTelemetry* GetWriter(int32 Idx) { return Writers.IsValidIndex(Idx) ? &Writers[Idx] : nullptr; };
+
+	// Write the csv and json files, call after all the writers finished
+	void Dump(const FString& TaskId, const FString& EpisodeId) const;
+
+private:
+	// Per frame csv rows (the detections and writes follow the captures which were not dropped)
+	FString ToCsv() const;
+
+	// Summary with the histograms
+	FString ToJson() const;
+
+private:
+	// Store the per frame records
+	bool bKeepFrames;
+
+	// Expected time between two captures
+	float ExpectedInterval;
+
+	// Time of the previous capture (negative before the first capture)
+	float LastTimestamp;
+
+	// Captures (game thread)
+	TArray<FSLWorldCaptureRecord> Captures;
+	FSLLatencyHistogram CaptureLatencies;
+	int32 NumDropped;
+	int32 NumLate;
+	int32 MaxQueueDepth;
+
+	// Change detections (async task)
+	TArray<FSLWorldWriteRecord> Detections;
+	FSLLatencyHistogram DetectLatencies;
+
+	// Writers (each from its own thread)
+	TArray<FSLWorldWriterTelemetry> Writers;
+};
@@ -0,0 +1,160 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ISLWorldWriter.h"
+
+/**
+* Layout constants of the binary world state format (little endian):
+*
+* [Header]      Magic(uint32) Version(uint16) Reserved(uint16)
+* [Dictionary]  RecordType(uint32='D') Num(uint32) { Handle(uint32) ParentHandle(uint32)
+*               IdLen(uint16) Id(utf8) ClassLen(uint16) Class(utf8) NameLen(uint16) Name(utf8) } x Num
+*               Padding(0-3 bytes, records start 4 byte aligned)
+* [Frame]       RecordType(uint32='F') Timestamp(float) Num(uint32)
+*               Handles(uint32 x Num) Locs(float x 3 x Num) Quats(float x 4 x Num)
+* [Rigid]       RecordType(uint32='R') Num(uint32) { Handle(uint32) RootHandle(uint32) } x Num
+* ...
+* [SeekTable]   RecordType(uint32='S') Num(uint32) { Timestamp(float) Offset(uint64) } x Num
+* [Footer]      SeekTableOffset(uint64) FooterMagic(uint32)
+*
+* Frame columns are 4 byte aligned so they can be read in place from a memory mapped file,
+* entities are added to the dictionary the first time they are written, a dictionary record always precedes
+* the first frame referencing its handles; handles are dense and never reused,
+* bones reference their skeletal entity through the parent handle and store the bone name,
+* if the bone count of a skeletal entity changes its bones are added again with new handles;
+* the optional rigid record follows its frame and lists the entities which moved rigidly with their group root (logged in the frame),
+* their pose is the previous pose relative to the previous root pose applied to the root pose of the frame (version 2+)
+*/
+struct FSLWorldBinaryFormat
+{
+	static constexpr uint32 Magic = 0x53574C53;			// "SLWS"
+	static constexpr uint32 FooterMagic = 0x45574C53;	// "SLWE"
+	static constexpr uint16 Version = 2;
+	static constexpr uint32 DictionaryRecord = 'D';
+	static constexpr uint32 FrameRecord = 'F';
+	static constexpr uint32 RigidRecord = 'R';
+	static constexpr uint32 SeekTableRecord = 'S';
+	static constexpr uint32 InvalidHandle = MAX_uint32;
+	static constexpr int32 HeaderSize = sizeof(uint32) + 2 * sizeof(uint16);
+	static constexpr int32 FooterSize = sizeof(uint64) + sizeof(uint32);
+};
+
+/**
+ * Raw data logger to a compact binary columnar format
+ */
+class FSLWorldWriterBinary : public ISLWorldWriter
+{
+public:
+	// Default constr
+	FSLWorldWriterBinary();
+
+	// Init constructor
+	FSLWorldWriterBinary(const FSLWorldWriterParams& InParams);
+
+	// Destr
+	virtual ~FSLWorldWriterBinary();
+
+	// Init
+	virtual void Init(const FSLWorldWriterParams& InParams) override;
+
+	// Finish (writes the seek table and closes the file)
+	virtual void Finish() override;
+
+	// Called to write the data
+	virtual void Write(const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes,
+		const TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
+		const TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
+		const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities) override;
+
+private:
+	// Set the file handle for the logger (and the compression of the file if enabled)
+	bool SetFileHandle(const FString& LogDirectory, const FString& InEpisodeId, ESLFileCompression InCompression);
+
+	// Get the handle of the entity, it is added to the dictionary if seen for the first time
+	uint32 GetHandle(const FSLEntity& Entity);
+
+	// Get the handle of the first bone of the skeletal entity, the bones are added to the dictionary if seen for the first time or if their count changed
+	uint32 GetFirstBoneHandle(const TSLEntityPreviousPose<USLSkeletalDataComponent>& SkelEntity, uint32 SkelHandle,
+		const FSLWorldStateSnapshot& Snapshot, int32 SkelIdx);
+
+	// Add a dictionary entry and return its handle
+	uint32 AddDictionaryEntry(const FString& Id, const FString& Class, const FString& Name, uint32 ParentHandle);
+
+	// Add the moved non skeletal entities to the frame columns
+	template<typename T>
+	void AddEntities(const TArray<TSLEntityPreviousPose<T>>& Entities, const FSLPoseArrays& Poses, const TArray<int32>& MovedIdxs);
+
+	// Add the rigid children and their group roots to the rigid record of the frame
+	template<typename T>
+	void AddRigidEntities(const TArray<TSLEntityPreviousPose<T>>& Entities, const TArray<int32>& RigidIdxs,
+		const TArray<FSLGroupRoot>& Roots, const TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
+		const TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities);
+
+	// Add the changed skeletal entities and their moved bones to the frame columns
+	void AddSkeletalEntities(const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
+		const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes);
+
+	// Add row to the frame columns
+	void AddRow(uint32 Handle, const FVector& InLoc, const FQuat& InQuat);
+
+	// Append the frame columns to the output buffer
+	void WriteFrame(float Timestamp);
+
+	// Append the seek table and footer to the output buffer
+	void WriteSeekTable();
+
+	// Append raw bytes to the output buffer
+	FORCEINLINE void Append(const void* Data, int32 Num);
+
+	// Append a length prefixed utf8 string to the given buffer
+	static void AppendString(TArray<uint8>& Buffer, const FString& Str);
+
+	// Write the output buffer to file
+	void Flush();
+
+private:
+	// File handle to write the raw data to file
+	IFileHandle* FileHandle;
+
+	// Streaming compression of the output (optional)
+	TUniquePtr<FSLCompressedFileWriter> CompressedWriter;
+
+	// Bytes written to file so far (offset of the output buffer start)
+	uint64 FileOffset;
+
+	// Output buffer, flushed to file in large chunks
+	TArray<uint8> OutBuffer;
+
+	// Dictionary entries waiting to be written
+	TArray<uint8> DictBuffer;
+
+	// Number of entries in the dictionary buffer
+	uint32 NumPendingDictEntries;
+
+	// Next free handle
+	uint32 NextHandle;
+
+	// Entity id to handle mapping
+	TMap<FString, uint32> EntityHandles;
+
+	// Skeletal entity id to the handle of its first bone and the number of bones (bones get consecutive handles)
+	TMap<FString, TPair<uint32, int32>> FirstBoneHandles;
+
+	// Frame columns
+	TArray<uint32> FrameHandles;
+	TArray<float> FrameLocs;
+	TArray<float> FrameQuats;
+
+	// Rigid children and group root handle pairs of the frame
+	TArray<uint32> FrameRigidHandles;
+
+	// Timestamp and file offset of every frame
+	TArray<TPair<float, uint64>> SeekTable;
+
+	/* Constants */
+	// Flush the output buffer to file after it reaches this size
+	constexpr static int32 FlushSize = 4 * 1024 * 1024;
+};
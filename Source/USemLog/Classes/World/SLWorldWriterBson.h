@@ -5,17 +5,10 @@
 
 #include "CoreMinimal.h"
 #include "ISLWorldWriter.h"
-#if SL_WITH_LIBMONGO_CXX
-THIRD_PARTY_INCLUDES_START
-#include <bsoncxx/builder/stream/array.hpp>
-#include <bsoncxx/builder/stream/document.hpp>
-#include <bsoncxx/builder/stream/helpers.hpp>
-#include <bsoncxx/types.hpp>
-THIRD_PARTY_INCLUDES_END
-#endif //SL_WITH_LIBMONGO_CXX
+#include "SLWorldStateBsonBuilder.h"
 
 /**
- * Raw data logger to bson format
+ * Raw data logger to a bson file (concatenated documents, same layout as the mongo collection, can be imported with mongorestore)
  */
 class FSLWorldWriterBson : public ISLWorldWriter
 {
@@ -32,38 +25,41 @@ public:
 	// Init
 	virtual void Init(const FSLWorldWriterParams& InParams) override;
 
-	// Finish
+	// Finish (writes the remaining data and closes the file)
 	virtual void Finish() override;
 
 	// Called to write the data
-	virtual void Write(float Timestamp,
-		TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
-		TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
-		TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
-		FSLGazeData& GazeData,
-		bool bCheckAndRemoveInvalidEntities = true) override;
+	virtual void Write(const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes,
+		const TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
+		const TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
+		const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities) override;
 
 private:
-	// Set the file handle for the logger
-	bool SetFileHandle(const FString& LogDirectory, const FString& InEpisodeId);
+	// Set the file handle for the logger (and the compression of the file if enabled)
+	bool SetFileHandle(const FString& LogDirectory, const FString& InEpisodeId, ESLFileCompression InCompression);
 
-#if SL_WITH_LIBMONGO_CXX
-	//// Add actors
-	//void AddActors(bson_t& OutBsonEntitiesArr);
+	// Write the output buffer to file
+	void Flush();
 
-	//// Add components
-	//void AddComponents(bson_t& OutBsonEntitiesArr);
+private:
+	// File handle to write the raw data to file
+	IFileHandle* FileHandle;
 
-	//// Get entry as Bson object
-	//bson_t GetAsBsonEntry(const FString& InId,
-	//	const FString& InClass,
-	//	const FVector& InLoc,
-	//	const FQuat& InQuat);
+	// Streaming compression of the output (optional)
+	TUniquePtr<FSLCompressedFileWriter> CompressedWriter;
 
-	//// Write entry to file
-	//void WriteData(uint8* memorybuffer, int64 bufferlen);
-#endif //SL_WITH_LIBMONGO_CXX
+	// Builds the world state documents
+	FSLWorldStateBsonBuilder DocBuilder;
 
-	// File handle to write the raw data to file
-	IFileHandle* FileHandle;
+#if SL_WITH_LIBMONGO_C
+	// Reused document, avoids an allocation for every write
+	bson_t ws_doc;
+#endif //SL_WITH_LIBMONGO_C
+
+	// Output buffer, flushed to file in large chunks
+	TArray<uint8> OutBuffer;
+
+	/* Constants */
+	// Flush the output buffer to file after it reaches this size
+	constexpr static int32 FlushSize = 4 * 1024 * 1024;
 };
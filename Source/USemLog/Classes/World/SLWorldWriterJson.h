@@ -7,7 +7,8 @@
 #include "ISLWorldWriter.h"
 
 /**
- * Raw data logger to json format
+ * Raw data logger to json format, the documents are emitted directly into a byte buffer
+ * (tab indented, same layout as the pretty printed documents of the json serializer)
  */
 class FSLWorldWriterJson : public ISLWorldWriter
 {
@@ -24,42 +25,77 @@ public:
 	// Init
 	virtual void Init(const FSLWorldWriterParams& InParams) override;
 
-	// Finish
+	// Finish (writes the remaining data to file)
 	virtual void Finish() override;
 
-	// Write the data (it also removes invalid items from the array -- e.g. deleted ones)
-	void Write(float Timestamp,
-		TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
-		TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
-		TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
-		FSLGazeData& GazeData,
-		bool bCheckAndRemoveInvalidEntities = true) override;
+	// Write the data
+	void Write(const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes,
+		const TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
+		const TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
+		const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities) override;
 
 private:
-	// Set the file handle for the logger
-	bool SetFileHandle(const FString& LogDirectory, const FString& InEpisodeId);
-	
-#if SL_WITH_JSON
-	// Add non skeletal actors to json array
-	void AddActorEntities(TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
-		TArray<TSharedPtr<FJsonValue>>& OutJsonEntitiesArr);
-
-	// Add non skeletal components to json array
-	void AddComponentEntities(TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
-		TArray<TSharedPtr<FJsonValue>>& OutJsonEntitiesArr);
-
-	// Add skeletal actors to json array
-	void AddSkeletalEntities(TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
-		TArray<TSharedPtr<FJsonValue>>& OutJsonEntitiesArr);
-
-	// Get key value pairs as json entry
-	TSharedPtr<FJsonObject> GetAsJsonEntry(const TMap<FString, FString>& InKeyValMap,
-		const FVector& InLoc, const FQuat& InQuat);
-
-	// Write entry to file
-	void WriteToFile(const TSharedPtr<FJsonObject>& InRootObj);
-#endif SL_WITH_JSON
+	// Set the file handle for the logger (and the compression of the file if enabled)
+	bool SetFileHandle(const FString& LogDirectory, const FString& InEpisodeId, ESLFileCompression InCompression);
+
+	// Add the moved non skeletal entities to the json array
+	template<typename T>
+	void AddEntities(const TArray<TSLEntityPreviousPose<T>>& Entities, const FSLPoseArrays& Poses,
+		const TArray<int32>& MovedIdxs, int32& NumAdded);
+
+	// Add the changed skeletal entities and their moved bones to the json array
+	void AddSkeletalEntities(const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
+		const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes, int32& NumAdded);
+
+	// Get the pre-escaped "id" and "class" fields of the entity
+	const TArray<uint8>& GetEntityFields(const FSLEntity& Entity);
+
+	// Get the pre-escaped fields of the bones of the skeletal entity (in capture order)
+	const TArray<TArray<uint8>>& GetBoneFields(const TSLEntityPreviousPose<USLSkeletalDataComponent>& SkelEntity,
+		const FSLWorldStateSnapshot& Snapshot, int32 SkelIdx);
+
+	// Append the "loc" and "rot" fields (at the given depth)
+	void AppendPose(const FVector& InLoc, const FQuat& InQuat, int32 Depth);
+
+	// Append a "key": number field on a new line
+	FORCEINLINE void AppendNumberField(const ANSICHAR* Key, double Value, int32 Depth, bool bComma = true);
+
+	// Append a number (nan and inf are written as null)
+	FORCEINLINE void AppendNumber(double Value);
+
+	// Append a line terminator and the indentation of the given depth to the buffer
+	static FORCEINLINE void AppendLineBreak(TArray<uint8>& Buffer, int32 Depth);
+
+	// Append a string literal
+	template<int32 N>
+	FORCEINLINE void AppendLiteral(const ANSICHAR(&Str)[N]) { OutBuffer.Append(reinterpret_cast<const uint8*>(Str), N - 1); }
+
+	// Append a "key":"value" field with the value escaped to the given buffer
+	static void AppendStringField(TArray<uint8>& Buffer, const ANSICHAR* Key, const FString& Value);
+
+	// Write the output buffer to file
+	void Flush();
 	
+private:
 	// File handle to write the raw data to file
 	IFileHandle* FileHandle;
+
+	// Streaming compression of the output (optional)
+	TUniquePtr<FSLCompressedFileWriter> CompressedWriter;
+
+	// Output buffer, flushed to file in large chunks
+	TArray<uint8> OutBuffer;
+
+	// Pre-escaped and indented utf8 "id" and "class" fields of the entities (by entity id)
+	TMap<FString, TArray<uint8>> EntityFieldsCache;
+
+	// Pre-escaped and indented utf8 "bone", "class" and "mask_hex" fields of the bones of the skeletal entities (by entity id)
+	TMap<FString, TArray<TArray<uint8>>> BoneFieldsCache;
+
+	/* Constants */
+	// Flush the output buffer to file after it reaches this size
+	constexpr static int32 FlushSize = 4 * 1024 * 1024;
+
+	// Indentation of the entities (document root and entities array)
+	constexpr static int32 EntityDepth = 2;
 };
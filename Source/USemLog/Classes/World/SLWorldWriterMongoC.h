@@ -5,6 +5,10 @@
 
 #include "USemLog.h"
 #include "ISLWorldWriter.h"
+#include "SLWorldStateBsonBuilder.h"
+#include "SLWorldStateBucketBuilder.h"
+#include "SLWorldWriterMongoCFlusher.h"
+#include "Utils/SLMongoIndexes.h"
 #if SL_WITH_LIBMONGO_C
 THIRD_PARTY_INCLUDES_START
 	#if PLATFORM_WINDOWS
@@ -40,50 +44,57 @@ public:
 	virtual void Finish() override;
 
 	// Write the data
-	virtual void Write(float Timestamp,
-		TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
-		TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
-		TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
-		FSLGazeData& GazeData,
-		bool bCheckAndRemoveInvalidEntities = true) override;
+	virtual void Write(const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes,
+		const TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
+		const TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
+		const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities) override;
 
 private:
 	// Connect to the database
 	bool Connect(const FString& DBName, const FString& CollectionName, const FString& ServerIp,
-		uint16 ServerPort, bool bOverwrite = false);
+		uint16 ServerPort, bool bOverwrite = false, bool bTimeSeries = false);
 
 	// Disconnect and clean db connection
 	void Disconnect();
 	
-	// Create indexes on the logged data, usually called after logging
-	bool CreateIndexes() const;
+	// Create indexes on the logged data if the given mode is the configured one
+	bool CreateIndexes(ESLMongoIndexMode InMode);
 
 	// Get the actors that moved since the previous log time
 	//void GetMovedEntities(TArray<TSLEntityPreviousPose<AActor>>& ActorEntities, TArray<FSLEntity>& OutMovedEntities)
 	
-#if SL_WITH_LIBMONGO_C
-	// Add non skeletal actors to array
-	void AddActorEntities(TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
-		bson_t* out_doc, uint32_t& idx) const;
+	// Builds the world state documents
+	FSLWorldStateBsonBuilder DocBuilder;
+
+	// Inserts the documents in batches from a separate thread (only set if batching is enabled)
+	TUniquePtr<FSLWorldWriterMongoCFlusher> Flusher;
 
-	// Add non skeletal components to array
-	void AddComponentEntities(TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
-		bson_t* out_doc, uint32_t& idx) const;
+	// Builds the entity bucket documents (only used with the bucket layout)
+	FSLWorldStateBucketBuilder BucketBuilder;
 
-	// Add skeletal actors to array
-	void AddSkeletalEntities(TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
-		bson_t* out_doc, uint32_t& idx) const;
+	// Write one document per entity and time window instead of one document per frame
+	bool bEntityBuckets;
 
-	// Add gaze data
-	void AddGazeData(const FSLGazeData& GazeData, bson_t* out_doc) const;
+	// When to create the indexes
+	ESLMongoIndexMode IndexMode;
 
-	// Add skeletal bones to array
-	void AddSkeletalBones(USkeletalMeshComponent* SkelComp, const TMap<FName, FSLBoneData>& BoneClassMap, bson_t* out_doc) const;
+	// Connection of the background index creation
+	FString ServerIp;
+	uint16 ServerPort;
+	FString DBName;
+	FString CollName;
 
-	// Add pose to document
-	void AddPoseChild(const FVector& InLoc, const FQuat& InQuat, bson_t* out_doc) const;
+	// Result of the background index creation, waited for before the mongo cleanup
+	TFuture<bool> BackgroundIndexes;
 
+#if SL_WITH_LIBMONGO_C
 private:
+	// Insert (or pass to the flusher) the closed bucket documents
+	void InsertBucketDocs();
+
+	// Closed bucket documents waiting to be inserted
+	TArray<bson_t*> BucketDocs;
+
 	// Server uri
 	mongoc_uri_t* uri;
 
@@ -0,0 +1,171 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "ISLWorldWriter.h"
+#if SL_WITH_LIBMONGO_C
+THIRD_PARTY_INCLUDES_START
+	#if PLATFORM_WINDOWS
+	#include "Windows/AllowWindowsPlatformTypes.h"
+	#include <mongoc/mongoc.h>
+	#include "Windows/HideWindowsPlatformTypes.h"
+	#else
+	#include <mongoc/mongoc.h>
+	#endif // #if PLATFORM_WINDOWS
+THIRD_PARTY_INCLUDES_END
+#endif //SL_WITH_LIBMONGO_C
+
+class FRunnableThread;
+class FEvent;
+class IFileHandle;
+
+/**
+* Statistics of the document queue of the mongo flusher
+*/
+struct FSLWorldWriterMongoQueueStats
+{
+	// Max number of documents waiting in memory
+	int32 MaxQueuedDocs = 0;
+
+	// Max size of the documents waiting in memory
+	int64 MaxQueuedBytes = 0;
+
+	// Number of times the queue overflowed and started spilling to the journal
+	int32 NumSpills = 0;
+
+	// Documents written to the journal
+	int64 NumSpilledDocs = 0;
+	int64 NumSpilledBytes = 0;
+
+	// Documents inserted from the journal
+	int64 NumReplayedDocs = 0;
+
+	// Size of the journal documents not yet inserted
+	int64 JournalBacklogBytes = 0;
+};
+
+/**
+ * Accumulates world state documents and inserts them with unordered bulk operations from a dedicated thread,
+ * a batch is flushed when it reaches the max number of documents, the max size or the max waiting time;
+ * if the server stalls and the queue exceeds its max size the documents are appended to a local journal,
+ * which is replayed in order once the server catches up
+ */
+class FSLWorldWriterMongoCFlusher : public FRunnable
+{
+public:
+#if SL_WITH_LIBMONGO_C
+	// Ctor, the collection is only accessed from the flush thread until the flusher is stopped
+	FSLWorldWriterMongoCFlusher(mongoc_collection_t* InCollection, const FSLWorldWriterMongoBatchParams& InParams,
+		const FString& InJournalPath = TEXT(""));
+#endif //SL_WITH_LIBMONGO_C
+
+	// Dtor
+	virtual ~FSLWorldWriterMongoCFlusher();
+
+	// Create the flush thread
+	bool Start();
+
+	// Stop the flush thread and insert the remaining documents
+	void Finish();
+
+#if SL_WITH_LIBMONGO_C
+	// Add document to the pending batch, or to the journal if the queue is full (takes ownership)
+	void Add(bson_t* Doc);
+#endif //SL_WITH_LIBMONGO_C
+
+	// Get a copy of the queue statistics (thread safe)
+	FSLWorldWriterMongoQueueStats GetQueueStats() const;
+
+	// Latencies of the bulk inserts (only valid after finish)
+	const FSLLatencyHistogram& GetFlushLatencies() const { return FlushLatencies; };
+
+	/* Begin FRunnable interface */
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	/* End FRunnable interface */
+
+private:
+	// Insert the pending documents with a bulk operation
+	void Flush();
+
+	// Insert the journal documents written so far, leaves the spilling mode if all of them were inserted
+	void ReplayJournal();
+
+	// Open the journal for appending (called with the pending lock held)
+	bool OpenJournal();
+
+	// Close the journal, it is removed if all its documents were inserted
+	void CloseJournal();
+
+#if SL_WITH_LIBMONGO_C
+	// Insert the documents with a bulk operation and destroy them, if nothing was inserted the batch is spilled to the journal and false returned
+	bool InsertDocs(TArray<bson_t*>& Docs, int64 NumBytes);
+
+	// Append the documents of a failed batch to the journal and destroy them, false if there is no journal (not destroyed)
+	bool SpillDocs(TArray<bson_t*>& Docs);
+#endif //SL_WITH_LIBMONGO_C
+
+private:
+#if SL_WITH_LIBMONGO_C
+	// Database collection
+	mongoc_collection_t* collection;
+
+	// Bulk operation options (unordered, write concern)
+	bson_t bulk_opts;
+
+	// Documents waiting to be inserted
+	TArray<bson_t*> PendingDocs;
+
+	// Documents being inserted (swapped with the pending ones)
+	TArray<bson_t*> FlushDocs;
+#endif //SL_WITH_LIBMONGO_C
+
+	// Batching parameters
+	FSLWorldWriterMongoBatchParams Params;
+
+	// Size of the pending documents
+	int64 PendingBytes;
+
+	// Guards the pending documents, the journal writer and the queue statistics
+	mutable FCriticalSection PendingCS;
+
+	// Local journal of the overflowing documents (empty path disables spilling)
+	FString JournalPath;
+
+	// Appends the overflowing documents (guarded)
+	IFileHandle* JournalWriter;
+
+	// Reads the documents to replay (flush thread only)
+	IFileHandle* JournalReader;
+
+	// End of the written journal (guarded)
+	int64 JournalWriteOffset;
+
+	// End of the replayed journal (flush thread only)
+	int64 JournalReadOffset;
+
+	// Documents are appended to the journal until it is fully replayed, this keeps the insertion order (guarded)
+	bool bIsSpilling;
+
+	// Queue statistics (guarded)
+	FSLWorldWriterMongoQueueStats QueueStats;
+
+	// Wakes up the flush thread before the interval passes
+	FEvent* WakeUpEvent;
+
+	// Flush thread
+	FRunnableThread* Thread;
+
+	// Set when the flush thread should exit
+	TAtomic<bool> bStopRequested;
+
+	// Flush statistics (only accessed by the flush thread until it is stopped)
+	double MaxFlushDuration;
+	double TotalFlushDuration;
+	int32 NumFlushes;
+	int64 NumFlushedDocs;
+	FSLLatencyHistogram FlushLatencies;
+};
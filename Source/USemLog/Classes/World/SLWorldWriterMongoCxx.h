@@ -38,12 +38,10 @@ public:
 		TArray<TSLEntityPreviousPose<USceneComponent>>& NonSkeletalComponentPool,
 		float Timestamp) override;*/
 
-	virtual void Write(float Timestamp,
-		TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
-		TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
-		TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
-		FSLGazeData& GazeData,
-		bool bCheckAndRemoveInvalidEntities = true) override;
+	virtual void Write(const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes,
+		const TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
+		const TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
+		const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities) override;
 private:
 	// Connect to the database
 	bool Connect(const FString& DBName, const FString& EpisodeId, const FString& ServerIp, uint16 ServerPort);
@@ -0,0 +1,97 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "ISLWorldWriter.h"
+#include "SLWorldStateBuffer.h"
+
+class FRunnableThread;
+class FEvent;
+
+/**
+ * Copy of the entity arrays of the world async worker, shared by the snapshots captured with the same entities,
+ * the worker replaces it when entities are added or removed, so the sinks write the older snapshots with their own entities
+ */
+struct FSLWorldEntityLayout
+{
+	TArray<TSLEntityPreviousPose<AActor>> Actors;
+	TArray<TSLEntityPreviousPose<USceneComponent>> Components;
+	TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>> Skeletals;
+};
+
+/**
+ * Writes the snapshots released by the change detector with one of several world state writers from its own thread,
+ * every sink reads the shared snapshot buffer with its own read counter, so a slow sink does not delay the others,
+ * a sink which falls a buffer depth behind skips its oldest snapshots (counted in its telemetry)
+ */
+class FSLWorldWriterSink : public FRunnable
+{
+public:
+	// Ctor, the snapshots carry the entities they were captured with
+	FSLWorldWriterSink(TSharedPtr<ISLWorldWriter> InWriter, FSLWorldStateBuffer* InBuffer, int32 InReaderIdx,
+		FSLWorldWriterTelemetry* InTelemetry = nullptr, bool bInKeepFrames = false, FEvent* InIdleEvent = nullptr);
+
+	// Dtor
+	virtual ~FSLWorldWriterSink();
+
+	// Create the writer thread
+	bool Start();
+
+	// Wake up the writer thread, new snapshots are available
+	void Notify();
+
+	// Stop the writer thread, with bWriteRemaining after it wrote the remaining snapshots, otherwise after the current one
+	void Finish(bool bWriteRemaining = true);
+
+	// Get the writer
+	TSharedPtr<ISLWorldWriter> GetWriter() const { return Writer; };
+
+	/* Begin FRunnable interface */
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	/* End FRunnable interface */
+
+private:
+	// Write all the snapshots available to this sink
+	void WriteAvailableSnapshots();
+
+	// Count the snapshots skipped since the last read
+	void AddSkippedSnapshots();
+
+private:
+	// World state writer
+	TSharedPtr<ISLWorldWriter> Writer;
+
+	// Shared snapshot buffer
+	FSLWorldStateBuffer* Buffer;
+
+	// Read counter of the sink in the snapshot buffer
+	int32 ReaderIdx;
+
+	// Serialization statistics of the writer (only accessed from the writer thread)
+	FSLWorldWriterTelemetry* Telemetry;
+
+	// Store the per frame statistics
+	bool bKeepFrames;
+
+	// Wakes up the writer thread
+	FEvent* WakeUpEvent;
+
+	// Signaled when the available snapshots are written (not owned, optional)
+	FEvent* IdleEvent;
+
+	// Writer thread
+	FRunnableThread* Thread;
+
+	// Set when the writer thread should exit
+	TAtomic<bool> bStopRequested;
+
+	// Set when the writer thread should exit without writing the remaining snapshots
+	TAtomic<bool> bSkipRemaining;
+
+	// Skipped snapshots already added to the telemetry
+	int32 LastNumSkipped;
+};
@@ -50,10 +50,11 @@ bool FSLSemanticMapWriter::WriteToFile(UWorld* World,
 	// Add individuals to map
 	AddAllIndividuals(SemMap, World);
 
-	// Write map to file
-	
+	// Write map to file (serialized in one pass as utf8)
 	FPaths::RemoveDuplicateSlashes(FullFilePath);
-	return FFileHelper::SaveStringToFile(SemMap->ToString(), *FullFilePath);
+	FSLOwlWriteBuffer Out;
+	SemMap->WriteTo(Out);
+	return FFileHelper::SaveArrayToFile(Out.Bytes, *FullFilePath);
 }
 
 // Create semantic map template
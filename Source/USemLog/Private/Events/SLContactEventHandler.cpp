@@ -68,82 +68,91 @@ void FSLContactEventHandler::Finish(float EndTime, bool bForced)
 // Start new contact event
 void FSLContactEventHandler::AddNewContactEvent(const FSLContactResult& InResult)
 {
+	const uint64 PairId = FIds::PairEncodeCantor(InResult.Self.Obj->GetUniqueID(), InResult.Other.Obj->GetUniqueID());
+
+	// A pair can only have one started event
+	if (StartedContactEvents.Contains(PairId))
+	{
+		return;
+	}
+
 	// Start a semantic contact event
 	TSharedPtr<FSLContactEvent> ContactEvent = MakeShareable(new FSLContactEvent(
-		FIds::NewGuidInBase64Url(), InResult.Time,
-		FIds::PairEncodeCantor(InResult.Self.Obj->GetUniqueID(), InResult.Other.Obj->GetUniqueID()),
-		InResult.Self, InResult.Other));
-	// Add event to the pending contacts array
-	StartedContactEvents.Emplace(ContactEvent);
+		FIds::NewGuidInBase64Url(), InResult.Time, PairId, InResult.Self, InResult.Other));
+	// Add event to the pending contacts map
+	StartedContactEvents.Emplace(PairId, ContactEvent);
 }
 
 // Publish finished event
-bool FSLContactEventHandler::FinishContactEvent(const FSLEntity& InOther, float EndTime)
+bool FSLContactEventHandler::FinishContactEvent(const FSLEntity& InSelf, const FSLEntity& InOther, float EndTime)
 {
-	// Use iterator to be able to remove the entry from the array
-	for (auto EventItr(StartedContactEvents.CreateIterator()); EventItr; ++EventItr)
+	if (InSelf.Obj == nullptr || InOther.Obj == nullptr)
 	{
-		// It is enough to compare against the other id when searching
-		if ((*EventItr)->Item2.EqualsFast(InOther))
-		{
-			// Set the event end time
-			(*EventItr)->End = EndTime;
-
-			// Avoid publishing short events
-			if (((*EventItr)->End - (*EventItr)->Start) > ContactEventMin)
-			{
-				OnSemanticEvent.ExecuteIfBound(*EventItr);
-			}
-			
-			// Remove event from the pending list
-			EventItr.RemoveCurrent();
-
-			return true;
-		}
+		return false;
 	}
-	return false;
+
+	// Remove event from the pending map
+	TSharedPtr<FSLContactEvent> Event;
+	if (!StartedContactEvents.RemoveAndCopyValue(
+		FIds::PairEncodeCantor(InSelf.Obj->GetUniqueID(), InOther.Obj->GetUniqueID()), Event))
+	{
+		return false;
+	}
+
+	// Set the event end time
+	Event->End = EndTime;
+
+	// Avoid publishing short events
+	if ((Event->End - Event->Start) > ContactEventMin)
+	{
+		OnSemanticEvent.ExecuteIfBound(Event);
+	}
+	return true;
 }
 
 // Start new supported by event
 void FSLContactEventHandler::AddNewSupportedByEvent(const FSLEntity& Supported, const FSLEntity& Supporting, float StartTime, const uint64 EventPairId)
 {
+	// A pair can only have one started event
+	if (StartedSupportedByEvents.Contains(EventPairId))
+	{
+		return;
+	}
+
 	// Start a supported by event
 	TSharedPtr<FSLSupportedByEvent> Event = MakeShareable(new FSLSupportedByEvent(
 		FIds::NewGuidInBase64Url(), StartTime, EventPairId, Supported, Supporting));
-	// Add event to the pending array
-	StartedSupportedByEvents.Emplace(Event);
+	// Add event to the pending map
+	StartedSupportedByEvents.Emplace(EventPairId, Event);
 }
 
 // Finish then publish the event
 bool FSLContactEventHandler::FinishSupportedByEvent(const uint64 InPairId, float EndTime)
 {
-	// Use iterator to be able to remove the entry from the array
-	for (auto EventItr(StartedSupportedByEvents.CreateIterator()); EventItr; ++EventItr)
+	// Remove event from the pending map
+	TSharedPtr<FSLSupportedByEvent> Event;
+	if (!StartedSupportedByEvents.RemoveAndCopyValue(InPairId, Event))
 	{
-		// It is enough to compare against the other id when searching
-		if ((*EventItr)->PairId == InPairId)
-		{
-			// Ignore short events
-			if ((EndTime - (*EventItr)->Start) > SupportedByEventMin)
-			{
-				// Set end time and publish event
-				(*EventItr)->End = EndTime;
-				OnSemanticEvent.ExecuteIfBound(*EventItr);
-			}
-			// Remove event from the pending list
-			EventItr.RemoveCurrent();
-			return true;
-		}
+		return false;
+	}
+
+	// Ignore short events
+	if ((EndTime - Event->Start) > SupportedByEventMin)
+	{
+		// Set end time and publish event
+		Event->End = EndTime;
+		OnSemanticEvent.ExecuteIfBound(Event);
 	}
-	return false;
+	return true;
 }
 
 // Terminate and publish pending contact events (this usually is called at end play)
 void FSLContactEventHandler::FinishAllEvents(float EndTime)
 {
 	// Finish contact events
-	for (auto& Ev : StartedContactEvents)
+	for (auto& EvPair : StartedContactEvents)
 	{
+		auto& Ev = EvPair.Value;
 		// Ignore short events
 		if ((EndTime - Ev->Start) > ContactEventMin)
 		{
@@ -155,8 +164,9 @@ void FSLContactEventHandler::FinishAllEvents(float EndTime)
 	StartedContactEvents.Empty();
 
 	// Finish supported by events
-	for (auto& Ev : StartedSupportedByEvents)
+	for (auto& EvPair : StartedSupportedByEvents)
 	{
+		auto& Ev = EvPair.Value;
 		// Ignore short events
 		if ((EndTime - Ev->Start) > SupportedByEventMin)
 		{
@@ -177,7 +187,7 @@ void FSLContactEventHandler::OnSLOverlapBegin(const FSLContactResult& InResult)
 // Event called when a semantic overlap event ends
 void FSLContactEventHandler::OnSLOverlapEnd(const FSLEntity& Self, const FSLEntity& Other, float Time)
 {
-	FinishContactEvent(Other, Time);
+	FinishContactEvent(Self, Other, Time);
 }
 
 // Event called when a supported by event begins
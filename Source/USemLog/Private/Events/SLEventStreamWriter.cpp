@@ -0,0 +1,164 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "Events/SLEventStreamWriter.h"
+#include "Events/ISLEvent.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/Paths.h"
+
+// Bytes after which the written events are flushed (avoids syncing the file or compressing small blocks per event)
+static const int64 SLEventStreamFlushBytes = 64 * 1024;
+
+// Default ctor
+FSLEventStreamWriter::FSLEventStreamWriter() :
+	bIsStarted(false),
+	FileHandle(nullptr),
+	NumUnflushedBytes(0)
+{
+}
+
+// Dtor
+FSLEventStreamWriter::~FSLEventStreamWriter()
+{
+	Finish();
+}
+
+// Open the file and write the header of the document template
+bool FSLEventStreamWriter::Start(TSharedPtr<FSLOwlExperiment> InDoc, const FString& FilePath, ESLFileCompression InCompression)
+{
+	if (bIsStarted || !InDoc.IsValid())
+	{
+		return bIsStarted;
+	}
+
+	FString OutPath = FilePath;
+	if (InCompression != ESLFileCompression::None)
+	{
+		OutPath += FSLCompressedFileFormat::GetExtension(InCompression);
+	}
+	FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*FPaths::GetPath(OutPath));
+	FileHandle = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*OutPath);
+	if (!FileHandle)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s::%d Could not open %s.."), *FString(__func__), __LINE__, *OutPath);
+		return false;
+	}
+
+	// The blocks are compressed on a separate thread
+	if (InCompression != ESLFileCompression::None)
+	{
+		CompressedWriter = MakeUnique<FSLCompressedFileWriter>(FileHandle, InCompression);
+		if (!CompressedWriter->Start())
+		{
+			CompressedWriter.Reset();
+			delete FileHandle;
+			FileHandle = nullptr;
+			return false;
+		}
+	}
+
+	Doc = InDoc;
+	bIsStarted = true;
+	NumUnflushedBytes = 0;
+	Buffer.Reset();
+	Doc->WriteHeaderTo(Buffer);
+	WriteBuffer();
+	return true;
+}
+
+// Write the event with the timepoints and objects it introduces
+void FSLEventStreamWriter::Write(const TSharedPtr<ISLEvent>& Event)
+{
+	if (!bIsStarted || !Event.IsValid())
+	{
+		return;
+	}
+
+	Event->AddToOwlDoc(Doc.Get());
+	WriteNewIndividuals();
+
+	// The owner flushes the remaining events periodically
+	if (NumUnflushedBytes >= SLEventStreamFlushBytes)
+	{
+		Flush();
+	}
+}
+
+// Flush the events written since the last flush to disk
+void FSLEventStreamWriter::Flush()
+{
+	if (!bIsStarted || NumUnflushedBytes == 0)
+	{
+		return;
+	}
+
+	// Keep the written events on disk in case of a crash, the compressed writer flushes from its own thread
+	if (CompressedWriter.IsValid())
+	{
+		CompressedWriter->Flush();
+	}
+	else
+	{
+		FileHandle->Flush();
+	}
+	NumUnflushedBytes = 0;
+}
+
+// Write the experiment individual and the footer and close the file
+void FSLEventStreamWriter::Finish()
+{
+	if (!bIsStarted)
+	{
+		return;
+	}
+
+	Doc->AddExperimentIndividual();
+	WriteNewIndividuals();
+	Buffer.Reset();
+	FSLOwlDoc::WriteFooterTo(Buffer);
+	WriteBuffer();
+
+	if (CompressedWriter.IsValid())
+	{
+		CompressedWriter->Finish();
+		CompressedWriter.Reset();
+	}
+	FileHandle->Flush();
+	delete FileHandle;
+	FileHandle = nullptr;
+	Doc.Reset();
+	bIsStarted = false;
+}
+
+// Serialize the individuals moved out of the document
+void FSLEventStreamWriter::WriteNewIndividuals()
+{
+	NewIndividuals.Reset();
+	Doc->MoveNewIndividuals(NewIndividuals);
+	if (NewIndividuals.Num() == 0)
+	{
+		return;
+	}
+
+	// The individuals are children of the root node
+	Buffer.Reset();
+	for (const auto& Individual : NewIndividuals)
+	{
+		Individual.WriteTo(Buffer, 1);
+	}
+	WriteBuffer();
+}
+
+// Write the serialized bytes to the file
+void FSLEventStreamWriter::WriteBuffer()
+{
+	const bool bWritten = CompressedWriter.IsValid()
+		? CompressedWriter->Write(Buffer.Bytes.GetData(), Buffer.Num())
+		: FileHandle->Write(Buffer.Bytes.GetData(), Buffer.Num());
+	if (!bWritten)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s::%d Could not write %d bytes to file.."),
+			*FString(__func__), __LINE__, Buffer.Num());
+	}
+	NumUnflushedBytes += Buffer.Num();
+}
@@ -72,44 +72,46 @@ void FSLFixationGraspEventHandler::Finish(float EndTime, bool bForced)
 // Start new grasp event
 void FSLFixationGraspEventHandler::AddNewEvent(const FSLEntity& Self, const FSLEntity& Other, float StartTime)
 {
+	// An object can only have one started event
+	if (StartedEvents.Contains(Other.Obj->GetUniqueID()))
+	{
+		return;
+	}
+
 	// Start a semantic grasp event
 	TSharedPtr<FSLGraspEvent> Event = MakeShareable(new FSLGraspEvent(
 		FIds::NewGuidInBase64Url(), StartTime, 
 		FIds::PairEncodeCantor(Self.Obj->GetUniqueID(), Other.Obj->GetUniqueID()),
 		Self, Other));
-	// Add event to the pending array
-	StartedEvents.Emplace(Event);
+	// Add event to the pending map
+	StartedEvents.Emplace(Other.Obj->GetUniqueID(), Event);
 }
 
 // Publish finished event
 bool FSLFixationGraspEventHandler::FinishEvent(UObject* Other, float EndTime)
 {
-	// Use iterator to be able to remove the entry from the array
-	for (auto EventItr(StartedEvents.CreateIterator()); EventItr; ++EventItr)
+	// Remove event from the pending map
+	TSharedPtr<FSLGraspEvent> Event;
+	if (Other == nullptr || !StartedEvents.RemoveAndCopyValue(Other->GetUniqueID(), Event))
 	{
-		// It is enough to compare against the other id when searching
-		if ((*EventItr)->Item.Obj == Other)
-		{
-			// Set end time and publish event
-			(*EventItr)->End = EndTime;
-			OnSemanticEvent.ExecuteIfBound(*EventItr);
-			// Remove event from the pending list
-			EventItr.RemoveCurrent();
-			return true;
-		}
+		return false;
 	}
-	return false;
+
+	// Set end time and publish event
+	Event->End = EndTime;
+	OnSemanticEvent.ExecuteIfBound(Event);
+	return true;
 }
 
 // Terminate and publish pending events (this usually is called at end play)
 void FSLFixationGraspEventHandler::FinishAllEvents(float EndTime)
 {
 	// Finish events
-	for (auto& Ev : StartedEvents)
+	for (auto& EvPair : StartedEvents)
 	{
 		// Set end time and publish event
-		Ev->End = EndTime;
-		OnSemanticEvent.ExecuteIfBound(Ev);
+		EvPair.Value->End = EndTime;
+		OnSemanticEvent.ExecuteIfBound(EvPair.Value);
 	}
 	StartedEvents.Empty();
 }
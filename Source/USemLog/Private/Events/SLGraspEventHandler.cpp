@@ -71,45 +71,48 @@ void FSLGraspEventHandler::Finish(float EndTime, bool bForced)
 // Start new grasp event
 void FSLGraspEventHandler::AddNewEvent(const FSLEntity& Self, const FSLEntity& Other, float StartTime, const FString& InType)
 {
+	// An object can only have one started event
+	if (StartedEvents.Contains(Other.Obj->GetUniqueID()))
+	{
+		return;
+	}
+
 	// Start a semantic grasp event
 	TSharedPtr<FSLGraspEvent> Event = MakeShareable(new FSLGraspEvent(
 		FIds::NewGuidInBase64Url(), StartTime,
 		FIds::PairEncodeCantor(Self.Obj->GetUniqueID(), Other.Obj->GetUniqueID()),
 		Self, Other, InType));
-	// Add event to the pending array
-	StartedEvents.Emplace(Event);
+	// Add event to the pending map
+	StartedEvents.Emplace(Other.Obj->GetUniqueID(), Event);
 }
 
 // Publish finished event
 bool FSLGraspEventHandler::FinishEvent(AActor* Other, float EndTime)
 {
-	// Use iterator to be able to remove the entry from the array
-	for (auto EventItr(StartedEvents.CreateIterator()); EventItr; ++EventItr)
+	// Remove event from the pending map
+	TSharedPtr<FSLGraspEvent> Event;
+	if (Other == nullptr || !StartedEvents.RemoveAndCopyValue(Other->GetUniqueID(), Event))
 	{
-		// It is enough to compare against the other id when searching
-		if ((*EventItr)->Item.Obj == Other)
-		{
-			// Ignore short events
-			if ((EndTime - (*EventItr)->Start) > GraspEventMin)
-			{
-				// Set end time and publish event
-				(*EventItr)->End = EndTime;
-				OnSemanticEvent.ExecuteIfBound(*EventItr);
-			}
-			// Remove event from the pending list
-			EventItr.RemoveCurrent();
-			return true;
-		}
+		return false;
+	}
+
+	// Ignore short events
+	if ((EndTime - Event->Start) > GraspEventMin)
+	{
+		// Set end time and publish event
+		Event->End = EndTime;
+		OnSemanticEvent.ExecuteIfBound(Event);
 	}
-	return false;
+	return true;
 }
 
 // Terminate and publish pending events (this usually is called at end play)
 void FSLGraspEventHandler::FinishAllEvents(float EndTime)
 {
 	// Finish events
-	for (auto& Ev : StartedEvents)
+	for (auto& EvPair : StartedEvents)
 	{
+		auto& Ev = EvPair.Value;
 		// Ignore short events
 		if ((EndTime - Ev->Start) > GraspEventMin)
 		{
@@ -63,46 +63,52 @@ void FSLManipulatorContactEventHandler::Finish(float EndTime, bool bForced)
 // Start new contact event
 void FSLManipulatorContactEventHandler::AddNewEvent(const FSLContactResult& InResult)
 {
+	const uint64 PairId = FIds::PairEncodeCantor(InResult.Self.Obj->GetUniqueID(), InResult.Other.Obj->GetUniqueID());
+
+	// A pair can only have one started event
+	if (StartedEvents.Contains(PairId))
+	{
+		return;
+	}
+
 	// Start a semantic contact event
 	TSharedPtr<FSLContactEvent> ContactEvent = MakeShareable(new FSLContactEvent(
-		FIds::NewGuidInBase64Url(), InResult.Time,
-		FIds::PairEncodeCantor(InResult.Self.Obj->GetUniqueID(), InResult.Other.Obj->GetUniqueID()),
-		InResult.Self, InResult.Other));
-	// Add event to the pending contacts array
-	StartedEvents.Emplace(ContactEvent);
+		FIds::NewGuidInBase64Url(), InResult.Time, PairId, InResult.Self, InResult.Other));
+	// Add event to the pending contacts map
+	StartedEvents.Emplace(PairId, ContactEvent);
 }
 
 // Publish finished event
-bool FSLManipulatorContactEventHandler::FinishEvent(const FSLEntity& InOther, float EndTime)
+bool FSLManipulatorContactEventHandler::FinishEvent(const FSLEntity& InSelf, const FSLEntity& InOther, float EndTime)
 {
-	// Use iterator to be able to remove the entry from the array
-	for (auto EventItr(StartedEvents.CreateIterator()); EventItr; ++EventItr)
+	if (InSelf.Obj == nullptr || InOther.Obj == nullptr)
 	{
-		// It is enough to compare against the other id when searching
-		if ((*EventItr)->Item2.EqualsFast(InOther))
-		{
-			// Set the event end time
-			(*EventItr)->End = EndTime;
-
-			OnSemanticEvent.ExecuteIfBound(*EventItr);
+		return false;
+	}
 
-			// Remove event from the pending list
-			EventItr.RemoveCurrent();
-			return true;
-		}
+	// Remove event from the pending map
+	TSharedPtr<FSLContactEvent> Event;
+	if (!StartedEvents.RemoveAndCopyValue(
+		FIds::PairEncodeCantor(InSelf.Obj->GetUniqueID(), InOther.Obj->GetUniqueID()), Event))
+	{
+		return false;
 	}
-	return false;
+
+	// Set the event end time and publish
+	Event->End = EndTime;
+	OnSemanticEvent.ExecuteIfBound(Event);
+	return true;
 }
 
 // Terminate and publish pending contact events (this usually is called at end play)
 void FSLManipulatorContactEventHandler::FinishAllEvents(float EndTime)
 {
 	// Finish contact events
-	for (auto& Ev : StartedEvents)
+	for (auto& EvPair : StartedEvents)
 	{
 		// Set end time and publish event
-		Ev->End = EndTime;
-		OnSemanticEvent.ExecuteIfBound(Ev);
+		EvPair.Value->End = EndTime;
+		OnSemanticEvent.ExecuteIfBound(EvPair.Value);
 	}
 	StartedEvents.Empty();
 }
@@ -117,5 +123,5 @@ void FSLManipulatorContactEventHandler::OnSLOverlapBegin(const FSLContactResult&
 // Event called when a semantic overlap event ends
 void FSLManipulatorContactEventHandler::OnSLOverlapEnd(const FSLEntity& Self, const FSLEntity& Other, float Time)
 {
-	FinishEvent(Other, Time);
+	FinishEvent(Self, Other, Time);
 }
@@ -76,46 +76,48 @@ void FSLSlicingEventHandler::Finish(float EndTime, bool bForced)
 // Start new Slicing event
 void FSLSlicingEventHandler::AddNewEvent(const FSLEntity& PerformedBy, const FSLEntity& DeviceUsed, const FSLEntity& ObjectActedOn, float StartTime)
 {
+	// An object can only have one started event
+	if (StartedEvents.Contains(ObjectActedOn.Obj->GetUniqueID()))
+	{
+		return;
+	}
+
 	// Start a semantic Slicing event
 	TSharedPtr<FSLSlicingEvent> Event = MakeShareable(new FSLSlicingEvent(
 		FIds::NewGuidInBase64Url(), StartTime, 
 		FIds::PairEncodeCantor(PerformedBy.Obj->GetUniqueID(), ObjectActedOn.Obj->GetUniqueID()),
 		PerformedBy, DeviceUsed, ObjectActedOn));
-	// Add event to the pending array
-	StartedEvents.Emplace(Event);
+	// Add event to the pending map
+	StartedEvents.Emplace(ObjectActedOn.Obj->GetUniqueID(), Event);
 }
 
 // Publish finished event
 bool FSLSlicingEventHandler::FinishEvent(UObject* ObjectActedOn, bool bInTaskSuccessful, float EndTime, const FSLEntity& OutputsCreated = FSLEntity())
 {
-	// Use iterator to be able to remove the entry from the array
-	for (auto EventItr(StartedEvents.CreateIterator()); EventItr; ++EventItr)
+	// Remove event from the pending map
+	TSharedPtr<FSLSlicingEvent> Event;
+	if (ObjectActedOn == nullptr || !StartedEvents.RemoveAndCopyValue(ObjectActedOn->GetUniqueID(), Event))
 	{
-		// It is enough to compare against the other id when searching
-		if ((*EventItr)->ObjectActedOn.Obj == ObjectActedOn)
-		{
-			// Set end time and publish event
-			(*EventItr)->End = EndTime;
-			(*EventItr)->bTaskSuccessful = bInTaskSuccessful;
-			(*EventItr)->OutputsCreated = OutputsCreated;
-			OnSemanticEvent.ExecuteIfBound(*EventItr);
-			// Remove event from the pending list
-			EventItr.RemoveCurrent();
-			return true;
-		}
+		return false;
 	}
-	return false;
+
+	// Set end time and publish event
+	Event->End = EndTime;
+	Event->bTaskSuccessful = bInTaskSuccessful;
+	Event->OutputsCreated = OutputsCreated;
+	OnSemanticEvent.ExecuteIfBound(Event);
+	return true;
 }
 
 // Terminate and publish pending events (this usually is called at end play)
 void FSLSlicingEventHandler::FinishAllEvents(float EndTime)
 {
 	// Finish events
-	for (auto& Ev : StartedEvents)
+	for (auto& EvPair : StartedEvents)
 	{
 		// Set end time and publish event
-		Ev->End = EndTime;
-		OnSemanticEvent.ExecuteIfBound(Ev);
+		EvPair.Value->End = EndTime;
+		OnSemanticEvent.ExecuteIfBound(EvPair.Value);
 	}
 	StartedEvents.Empty();
 }
@@ -14,12 +14,13 @@ void ISLContactShapeInterface::Finish(bool bForced)
 {
 	if (!bIsFinished && (bIsInit || bIsStarted))
 	{
-		// Publish any pending delayed events	
-		for(const auto& Ev : RecentlyEndedOverlapEvents)
+		// Publish any pending delayed events
+		if(OverlapEndScheduler)
 		{
-			PublishDelayedOverlapEndEvent(Ev);
+			OverlapEndScheduler->RemovePublisher(OverlapEndPublisherId);
+			OverlapEndScheduler = nullptr;
+			OverlapEndPublisherId = INDEX_NONE;
 		}
-		RecentlyEndedOverlapEvents.Empty();
 		
 		// Disable overlap events
 		ShapeComponent->SetGenerateOverlapEvents(false);
@@ -31,6 +32,18 @@ void ISLContactShapeInterface::Finish(bool bForced)
 	}
 }
 
+// Delay the overlap ends with the shared scheduler
+void ISLContactShapeInterface::SetOverlapEndScheduler(FSLOverlapEndScheduler* InScheduler)
+{
+	if(OverlapEndScheduler || !InScheduler)
+	{
+		return;
+	}
+	OverlapEndScheduler = InScheduler;
+	OverlapEndPublisherId = OverlapEndScheduler->AddPublisher(MaxOverlapEventTimeGap,
+		FSLOverlapEndPublishSignature::CreateRaw(this, &ISLContactShapeInterface::PublishOverlapEndEvent));
+}
+
 // Init the interface
 bool ISLContactShapeInterface::InitInterface(UShapeComponent* InShapeComponent, UWorld* InWorld)
 {
@@ -38,7 +51,6 @@ bool ISLContactShapeInterface::InitInterface(UShapeComponent* InShapeComponent,
 	{
 		World = InWorld;
 		ShapeComponent = InShapeComponent;
-		DelayTimerDelegate.BindRaw(this, &ISLContactShapeInterface::DelayedOverlapEndEventCallback);
 		return true;
 	}
 	return false;
@@ -251,111 +263,64 @@ void ISLContactShapeInterface::OnOverlapEnd(UPrimitiveComponent* OverlappedComp,
 		}
 	}
 
-	// Delay publishing the overlap event in case of possible concatenations
-	RecentlyEndedOverlapEvents.Emplace(FSLOverlapEndEvent(OtherComp, OtherItem, World->GetTimeSeconds()));
-
 	// Delay publishing for a while, in case the new event is of the same type and should be concatenated
-	if(!World->GetTimerManager().IsTimerActive(DelayTimerHandle))
-	{
-		World->GetTimerManager().SetTimer(DelayTimerHandle, DelayTimerDelegate,MaxOverlapEventTimeGap*1.12f, false);
-	}
-}
-
-// Delayed call of sending the finished event to check for possible concatenation of jittering events of the same type
-void ISLContactShapeInterface::DelayedOverlapEndEventCallback()
-{
-	// Curr time (keep very recently added events for another delay)
-	const float CurrTime = World->GetTimeSeconds();
-	
-	for (auto OverlapEndEvItr(RecentlyEndedOverlapEvents.CreateIterator()); OverlapEndEvItr; ++OverlapEndEvItr)
+	const FSLOverlapEndEvent Ev(OtherComp, OtherItem, World->GetTimeSeconds());
+	if(OverlapEndScheduler)
 	{
-		if(PublishDelayedOverlapEndEvent(*OverlapEndEvItr, CurrTime))
-		{
-			// Remove event from the pending list
-			OverlapEndEvItr.RemoveCurrent();
-		}
+		OverlapEndScheduler->Schedule(OverlapEndPublisherId, OtherItem.Obj->GetUniqueID(), Ev);
 	}
-
-	// There are very recent events still available, spin another delay callback to give them a chance to concatenate
-	if(RecentlyEndedOverlapEvents.Num() > 0)
+	else
 	{
-		World->GetTimerManager().SetTimer(DelayTimerHandle, DelayTimerDelegate,MaxOverlapEventTimeGap * 1.12f, false);
+		PublishOverlapEndEvent(Ev);
 	}
 }
 
-// Broadcast delayed overlaps, if curr time < 0, it guarantees a publish
-bool ISLContactShapeInterface::PublishDelayedOverlapEndEvent(const FSLOverlapEndEvent& Ev, float CurrTime)
+// Broadcast the (delayed) overlap end
+void ISLContactShapeInterface::PublishOverlapEndEvent(const FSLOverlapEndEvent& Ev)
 {
-	// Check if the event is old enough that it had it chance to be concatenated
-	// if CurrTime < 0, it forces publishing
-	if(CurrTime < 0 ||
-		CurrTime - Ev.Time > MaxOverlapEventTimeGap)
+	// Check the type of the other component
+	if (UMeshComponent* OtherAsMeshComp = Cast<UMeshComponent>(Ev.Other))
+	{
+		// Broadcast end of semantic overlap event
+		OnEndSLContact.Broadcast(SemanticOwner, Ev.OtherItem, Ev.Time);
+	}
+	else if (ISLContactShapeInterface* OtherContactTrigger = Cast<ISLContactShapeInterface>(Ev.Other))
 	{
-		// Check the type of the other component
-		if (UMeshComponent* OtherAsMeshComp = Cast<UMeshComponent>(Ev.OtherComp))
+		// If both areas are trigger areas, they will both concurrently trigger overlap events.
+		// To avoid this we consistently ignore one trigger event. This is chosen using
+		// the unique ids of the overlapping actors (GetUniqueID), we compare the two values 
+		// and consistently pick the event with a given (larger or smaller) value.
+		// This allows us to be in sync with the overlap end event 
+		// since the unique ids and the rule of ignoring the one event will not change
+		// Filter out one of the trigger areas (compare unique ids)
+		if (Ev.OtherItem.Obj->GetUniqueID() > SemanticOwner.Obj->GetUniqueID())
 		{
 			// Broadcast end of semantic overlap event
 			OnEndSLContact.Broadcast(SemanticOwner, Ev.OtherItem, Ev.Time);
 		}
-		else if (ISLContactShapeInterface* OtherContactTrigger = Cast<ISLContactShapeInterface>(Ev.OtherComp))
-		{
-			// If both areas are trigger areas, they will both concurrently trigger overlap events.
-			// To avoid this we consistently ignore one trigger event. This is chosen using
-			// the unique ids of the overlapping actors (GetUniqueID), we compare the two values 
-			// and consistently pick the event with a given (larger or smaller) value.
-			// This allows us to be in sync with the overlap end event 
-			// since the unique ids and the rule of ignoring the one event will not change
-			// Filter out one of the trigger areas (compare unique ids)
-			if (Ev.OtherItem.Obj->GetUniqueID() > SemanticOwner.Obj->GetUniqueID())
-			{
-				// Broadcast end of semantic overlap event
-				OnEndSLContact.Broadcast(SemanticOwner, Ev.OtherItem, Ev.Time);
-			}
-		}
+	}
 
-		if(bLogSupportedByEvents)
+	if(bLogSupportedByEvents)
+	{
+		// Ignore and remove if it is a candidate only
+		// (it cannot be a candidate and an event, e.g. contact ended with a candidate only)
+		if(!CheckAndRemoveIfJustCandidate(Ev.OtherItem.Obj))
 		{
-			// Ignore and remove if it is a candidate only
-			// (it cannot be a candidate and an event, e.g. contact ended with a candidate only)
-			if(!CheckAndRemoveIfJustCandidate(Ev.OtherItem.Obj))
+			const uint64 PairId1 = FIds::PairEncodeCantor(SemanticOwner.Obj->GetUniqueID(),Ev.OtherItem.Obj->GetUniqueID());
+			const uint64 PairId2 = FIds::PairEncodeCantor(Ev.OtherItem.Obj->GetUniqueID(), SemanticOwner.Obj->GetUniqueID());
+			OnEndSLSupportedBy.Broadcast(PairId1, PairId2, Ev.Time);
+			PrevSupportedByEndTime =  Ev.Time;
+			if(IsSupportedByPariIds.Remove(PairId1) == 0)
 			{
-				const uint64 PairId1 = FIds::PairEncodeCantor(SemanticOwner.Obj->GetUniqueID(),Ev.OtherItem.Obj->GetUniqueID());
-				const uint64 PairId2 = FIds::PairEncodeCantor(Ev.OtherItem.Obj->GetUniqueID(), SemanticOwner.Obj->GetUniqueID());
-				OnEndSLSupportedBy.Broadcast(PairId1, PairId2, Ev.Time);
-				PrevSupportedByEndTime =  Ev.Time;
-				if(IsSupportedByPariIds.Remove(PairId1) == 0)
-				{
-					IsSupportedByPariIds.Remove(PairId2);
-				}
+				IsSupportedByPariIds.Remove(PairId2);
 			}
 		}
-		return true;
 	}
-	return false;
 }
 
 // Skip publishing overlap event if it can be concatenated with the current event start
 bool ISLContactShapeInterface::SkipOverlapEndEventBroadcast(const FSLEntity& InItem, float StartTime)
 {
-	for (auto OverlapEndEvItr(RecentlyEndedOverlapEvents.CreateIterator()); OverlapEndEvItr; ++OverlapEndEvItr)
-	{
-		// Check if it is an event between the same entities
-		if(OverlapEndEvItr->OtherItem.EqualsFast(InItem))
-		{
-			// Check time difference
-			if(StartTime - OverlapEndEvItr->Time < MaxOverlapEventTimeGap)
-			{
-				OverlapEndEvItr.RemoveCurrent();
-
-				// Check if it was the last event, if so, pause the delay publisher
-				if(RecentlyEndedOverlapEvents.Num() == 0)
-				{
-					World->GetTimerManager().ClearTimer(DelayTimerHandle);
-				}
-				
-				return true;
-			}
-		}
-	}
-	return false;
+	// A pending end too old to be concatenated is published before the new begin
+	return OverlapEndScheduler && OverlapEndScheduler->ConcatenateOrPublish(OverlapEndPublisherId, InItem.Obj->GetUniqueID(), StartTime);
 }
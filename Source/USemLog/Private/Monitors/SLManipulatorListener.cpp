@@ -28,6 +28,7 @@ USLManipulatorListener::USLManipulatorListener()
 	InputAxisName = "LeftGrasp";
 	bIsNotSkeletal = false;
 	UnPauseTriggerVal = 0.5;
+	OverlapEndScheduler = nullptr;
 	
 #if WITH_EDITOR
 	// Default values
@@ -128,6 +129,7 @@ void USLManipulatorListener::Start()
 		// Start listening on the bone overlaps
 		for (auto BoneOverlap : GroupA)
 		{
+			BoneOverlap->SetOverlapEndScheduler(OverlapEndScheduler);
 			BoneOverlap->Start();
 			if (bDetectContacts)
 			{
@@ -142,6 +144,7 @@ void USLManipulatorListener::Start()
 		}
 		for (auto BoneOverlap : GroupB)
 		{
+			BoneOverlap->SetOverlapEndScheduler(OverlapEndScheduler);
 			BoneOverlap->Start();
 			if (bDetectContacts)
 			{
@@ -470,17 +473,20 @@ bool USLManipulatorListener::SkipRecentGraspEndEventBroadcast(AActor* OtherActor
 		if(EvItr->OtherActor == OtherActor)
 		{
 			// Check time difference
-			if(StartTime - EvItr->Time < MaxGraspEventTimeGap)
+			const bool bConcatenate = StartTime - EvItr->Time < MaxGraspEventTimeGap;
+			if(!bConcatenate)
 			{
-				EvItr.RemoveCurrent();
+				// Too old to be concatenated, publish it before the new begin (the delay callback did not run yet)
+				OnEndManipulatorGrasp.Broadcast(SemanticOwner, EvItr->OtherActor, EvItr->Time);
+			}
+			EvItr.RemoveCurrent();
 
-				// Check if it was the last event, if so, pause the delay publisher
-				if(RecentlyEndedGraspEvents.Num() == 0)
-				{
-					GetWorld()->GetTimerManager().ClearTimer(GraspDelayTimerHandle);
-				}
-				return true;
+			// Check if it was the last event, if so, pause the delay publisher
+			if(RecentlyEndedGraspEvents.Num() == 0)
+			{
+				GetWorld()->GetTimerManager().ClearTimer(GraspDelayTimerHandle);
 			}
+			return bConcatenate;
 		}
 	}
 	return false;
@@ -583,19 +589,20 @@ bool USLManipulatorListener::SkipRecentContactEndEventBroadcast(const FSLEntity&
 		if(EvItr->OtherItem.EqualsFast(OtherItem))
 		{
 			// Check time difference between the previous and current event
-			const float TimeGap = StartTime - EvItr->Time;
-			if(TimeGap < MaxContactEventTimeGap)
+			const bool bConcatenate = StartTime - EvItr->Time < MaxContactEventTimeGap;
+			if(!bConcatenate)
 			{
-				// Event will be concatenated
-				EvItr.RemoveCurrent();
+				// Too old to be concatenated, publish it before the new begin (the delay callback did not run yet)
+				OnEndManipulatorContact.Broadcast(SemanticOwner, EvItr->OtherItem, EvItr->Time);
+			}
+			EvItr.RemoveCurrent();
 
-				// Check if it was the last event, if so, pause the delay publisher
-				if(RecentlyEndedContactEvents.Num() == 0)
-				{
-					GetWorld()->GetTimerManager().ClearTimer(ContactDelayTimerHandle);
-				}
-				return true;
+			// Check if it was the last event, if so, pause the delay publisher
+			if(RecentlyEndedContactEvents.Num() == 0)
+			{
+				GetWorld()->GetTimerManager().ClearTimer(ContactDelayTimerHandle);
 			}
+			return bConcatenate;
 		}
 	}
 	return false;
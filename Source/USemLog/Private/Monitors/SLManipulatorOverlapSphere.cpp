@@ -2,7 +2,6 @@
 // Author: Andrei Haidu (http://haidu.eu)
 
 #include "SLManipulatorOverlapSphere.h"
-#include "TimerManager.h"
 
 // Ctor
 USLManipulatorOverlapSphere::USLManipulatorOverlapSphere()
@@ -19,6 +18,9 @@ USLManipulatorOverlapSphere::USLManipulatorOverlapSphere()
 	bGraspPaused = false;
 	bDetectGrasps = false;
 	bDetectContacts = false;
+	OverlapEndScheduler = nullptr;
+	GraspPublisherId = INDEX_NONE;
+	ContactPublisherId = INDEX_NONE;
 
 #if WITH_EDITOR
 	// Mimic a button to attach to the bone	
@@ -143,18 +145,14 @@ void USLManipulatorOverlapSphere::Finish(bool bForced)
 	if (!bIsFinished && (bIsInit || bIsStarted))
 	{
 		// Publish dangling recently finished events
-		for (const auto& EvItr : RecentlyEndedGraspOverlapEvents)
+		if (OverlapEndScheduler)
 		{
-			OnEndManipulatorGraspOverlap.Broadcast(EvItr.OtherActor);
+			OverlapEndScheduler->RemovePublisher(GraspPublisherId);
+			OverlapEndScheduler->RemovePublisher(ContactPublisherId);
+			OverlapEndScheduler = nullptr;
+			GraspPublisherId = INDEX_NONE;
+			ContactPublisherId = INDEX_NONE;
 		}
-		RecentlyEndedGraspOverlapEvents.Empty();
-
-		// Publish dangling recently finished events
-		for (const auto& EvItr : RecentlyEndedContactOverlapEvents)
-		{
-			OnEndManipulatorContactOverlap.Broadcast(EvItr.OtherActor);
-		}
-		RecentlyEndedContactOverlapEvents.Empty();
 
 		SetGenerateOverlapEvents(false);
 		
@@ -165,6 +163,20 @@ void USLManipulatorOverlapSphere::Finish(bool bForced)
 	}
 }
 
+// Delay the overlap ends with the shared scheduler
+void USLManipulatorOverlapSphere::SetOverlapEndScheduler(FSLOverlapEndScheduler* InScheduler)
+{
+	if (OverlapEndScheduler || !InScheduler)
+	{
+		return;
+	}
+	OverlapEndScheduler = InScheduler;
+	GraspPublisherId = OverlapEndScheduler->AddPublisher(MaxOverlapEventTimeGap,
+		FSLOverlapEndPublishSignature::CreateUObject(this, &USLManipulatorOverlapSphere::PublishGraspOverlapEndEvent));
+	ContactPublisherId = OverlapEndScheduler->AddPublisher(MaxOverlapEventTimeGap,
+		FSLOverlapEndPublishSignature::CreateUObject(this, &USLManipulatorOverlapSphere::PublishContactOverlapEndEvent));
+}
+
 #if WITH_EDITOR
 // Called when a property is changed in the editor
 void USLManipulatorOverlapSphere::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
@@ -377,15 +389,15 @@ void USLManipulatorOverlapSphere::OnGraspOverlapEnd(UPrimitiveComponent* Overlap
 	{
 		if (ActiveContacts.Remove(OtherActor) > 0)
 		{
-			// Grasp overlap ended ended
-			RecentlyEndedGraspOverlapEvents.Emplace(FSLManipulatorOverlapEndEvent(
-				OtherActor, GetWorld()->GetTimeSeconds()));
-			
-			// Delay publishing for a while, in case the new event is of the same type and should be concatenated
-			if(!GetWorld()->GetTimerManager().IsTimerActive(GraspDelayTimerHandle))
+			// Grasp overlap ended, delay publishing for a while, in case the new event is of the same type and should be concatenated
+			const FSLOverlapEndEvent Ev(OtherActor, GetWorld()->GetTimeSeconds());
+			if (OverlapEndScheduler)
 			{
-				GetWorld()->GetTimerManager().SetTimer(GraspDelayTimerHandle, this, 
-					&USLManipulatorOverlapSphere::DelayedGraspOverlapEndEventCallback, MaxOverlapEventTimeGap*1.1f, false);
+				OverlapEndScheduler->Schedule(GraspPublisherId, OtherActor->GetUniqueID(), Ev);
+			}
+			else
+			{
+				PublishGraspOverlapEndEvent(Ev);
 			}
 		}
 
@@ -399,59 +411,19 @@ void USLManipulatorOverlapSphere::OnGraspOverlapEnd(UPrimitiveComponent* Overlap
 	}
 }
 
-// Delayed call of sending the finished event to check for possible concatenation of jittering events of the same type
-void USLManipulatorOverlapSphere::DelayedGraspOverlapEndEventCallback()
+// Broadcast the (delayed) grasp overlap end
+void USLManipulatorOverlapSphere::PublishGraspOverlapEndEvent(const FSLOverlapEndEvent& Ev)
 {
-	// Curr time (keep very recently added events for another delay)
-	const float CurrTime = GetWorld()->GetTimeSeconds();
-	
-	for (auto EvItr(RecentlyEndedGraspOverlapEvents.CreateIterator()); EvItr; ++EvItr)
-	{
-		// If enough time has passed, publish the event
-		if(CurrTime - EvItr->Time > MaxOverlapEventTimeGap)
-		{
-			// Broadcast delayed event
-			OnEndManipulatorGraspOverlap.Broadcast(EvItr->OtherActor);
-			
-			// Remove event from the pending list
-			EvItr.RemoveCurrent();
-		}
-	}
-
-	// There are very recent events still available, spin another delay callback to give them a chance to concatenate
-	if(RecentlyEndedGraspOverlapEvents.Num() > 0)
-	{
-		GetWorld()->GetTimerManager().SetTimer(GraspDelayTimerHandle, this, &USLManipulatorOverlapSphere::DelayedGraspOverlapEndEventCallback,
-			MaxOverlapEventTimeGap*1.1f, false);
-	}
+	OnEndManipulatorGraspOverlap.Broadcast(Cast<AActor>(Ev.Other));
 }
 
-// Check if this begin event happened right after the previous one ended, if so remove it from the array, and cancel publishing the begin event
+// Check if this begin event happened right after the previous one ended, if so cancel publishing the begin event
+// (a pending end too old to be concatenated is published first)
 bool USLManipulatorOverlapSphere::SkipRecentGraspOverlapEndEventBroadcast(AActor* OtherActor, float StartTime)
 {
-	for (auto EvItr(RecentlyEndedGraspOverlapEvents.CreateIterator()); EvItr; ++EvItr)
-	{
-		// Check if it is an event between the same entities
-		if(EvItr->OtherActor == OtherActor)
-		{
-			// Check time difference
-			if(StartTime - EvItr->Time < MaxOverlapEventTimeGap)
-			{
-				EvItr.RemoveCurrent();
-
-				// Check if it was the last event, if so, pause the delay publisher
-				if(RecentlyEndedGraspOverlapEvents.Num() == 0)
-				{
-					GetWorld()->GetTimerManager().ClearTimer(GraspDelayTimerHandle);
-				}
-				return true;
-			}
-		}
-	}
-	return false;
+	return OverlapEndScheduler && OverlapEndScheduler->ConcatenateOrPublish(GraspPublisherId, OtherActor->GetUniqueID(), StartTime);
 }
 
-
 /* Contact related*/
 // Publish currently contact related overlapping components
 void USLManipulatorOverlapSphere::TriggerInitialContactOverlaps()
@@ -506,68 +478,28 @@ void USLManipulatorOverlapSphere::OnContactOverlapEnd(UPrimitiveComponent* Overl
 	if (OtherActor->IsA(AStaticMeshActor::StaticClass())
 		&& !IgnoreList.Contains(OtherActor))
 	{
-		// Contact overlap ended ended
-		RecentlyEndedContactOverlapEvents.Emplace(FSLManipulatorOverlapEndEvent(
-			OtherActor, GetWorld()->GetTimeSeconds()));
-		
-		// Delay publishing for a while, in case the new event is of the same type and should be concatenated
-		if(!GetWorld()->GetTimerManager().IsTimerActive(ContactDelayTimerHandle))
+		// Contact overlap ended, delay publishing for a while, in case the new event is of the same type and should be concatenated
+		const FSLOverlapEndEvent Ev(OtherActor, GetWorld()->GetTimeSeconds());
+		if (OverlapEndScheduler)
 		{
-			GetWorld()->GetTimerManager().SetTimer(ContactDelayTimerHandle, this, 
-				&USLManipulatorOverlapSphere::DelayedContactOverlapEndEventCallback, MaxOverlapEventTimeGap*1.1f, false);
+			OverlapEndScheduler->Schedule(ContactPublisherId, OtherActor->GetUniqueID(), Ev);
 		}
-	}
-}
-
-// Delayed call of sending the finished event to check for possible concatenation of jittering events of the same type
-void USLManipulatorOverlapSphere::DelayedContactOverlapEndEventCallback()
-{
-	// Curr time (keep very recently added events for another delay)
-	const float CurrTime = GetWorld()->GetTimeSeconds();
-	
-	for (auto EvItr(RecentlyEndedContactOverlapEvents.CreateIterator()); EvItr; ++EvItr)
-	{
-		// If enough time has passed, publish the event
-		if(CurrTime - EvItr->Time > MaxOverlapEventTimeGap)
+		else
 		{
-			// Broadcast delayed event
-			OnEndManipulatorContactOverlap.Broadcast(EvItr->OtherActor);
-			
-			// Remove event from the pending list
-			EvItr.RemoveCurrent();
+			PublishContactOverlapEndEvent(Ev);
 		}
 	}
+}
 
-	// There are very recent events still available, spin another delay callback to give them a chance to concatenate
-	if(RecentlyEndedContactOverlapEvents.Num() > 0)
-	{
-		GetWorld()->GetTimerManager().SetTimer(ContactDelayTimerHandle, this, &USLManipulatorOverlapSphere::DelayedContactOverlapEndEventCallback,
-			MaxOverlapEventTimeGap*1.1f, false);
-	}
+// Broadcast the (delayed) contact overlap end
+void USLManipulatorOverlapSphere::PublishContactOverlapEndEvent(const FSLOverlapEndEvent& Ev)
+{
+	OnEndManipulatorContactOverlap.Broadcast(Cast<AActor>(Ev.Other));
 }
 
-// Check if this begin event happened right after the previous one ended
-// if so remove it from the array, and cancel publishing the begin event
+// Check if this begin event happened right after the previous one ended, if so cancel publishing the begin event
+// (a pending end too old to be concatenated is published first)
 bool USLManipulatorOverlapSphere::SkipRecentContactOverlapEndEventBroadcast(AActor* OtherActor, float StartTime)
 {
-	for (auto EvItr(RecentlyEndedContactOverlapEvents.CreateIterator()); EvItr; ++EvItr)
-	{
-		// Check if it is an event between the same entities
-		if(EvItr->OtherActor == OtherActor)
-		{
-			// Check time difference
-			if(StartTime - EvItr->Time < MaxOverlapEventTimeGap)
-			{
-				EvItr.RemoveCurrent();
-
-				// Check if it was the last event, if so, pause the delay publisher
-				if(RecentlyEndedContactOverlapEvents.Num() == 0)
-				{
-					GetWorld()->GetTimerManager().ClearTimer(ContactDelayTimerHandle);
-				}
-				return true;
-			}
-		}
-	}
-	return false;
+	return OverlapEndScheduler && OverlapEndScheduler->ConcatenateOrPublish(ContactPublisherId, OtherActor->GetUniqueID(), StartTime);
 }
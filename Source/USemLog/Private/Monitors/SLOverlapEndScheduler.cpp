@@ -0,0 +1,250 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "Monitors/SLOverlapEndScheduler.h"
+#include "Engine/World.h"
+
+// UUtils
+#include "Ids.h"
+
+// Default ctor
+FSLOverlapEndScheduler::FSLOverlapEndScheduler() :
+	World(nullptr),
+	NextSweepTick(0)
+{
+	SlotHeads.Init(INDEX_NONE, NumSlots);
+	SlotTails.Init(INDEX_NONE, NumSlots);
+}
+
+// Set the world (time source) and start ticking
+void FSLOverlapEndScheduler::Init(UWorld* InWorld)
+{
+	World = InWorld;
+	if (World)
+	{
+		NextSweepTick = GetTick(World->GetTimeSeconds());
+	}
+}
+
+// Publish all the pending ends and stop
+void FSLOverlapEndScheduler::Finish()
+{
+	for (auto EntryItr(Entries.CreateIterator()); EntryItr; ++EntryItr)
+	{
+		RemoveToBatch(EntryItr.GetIndex());
+	}
+	PublishBatch();
+	Publishers.Empty();
+	World = nullptr;
+}
+
+// Register a publisher
+int32 FSLOverlapEndScheduler::AddPublisher(float InMaxTimeGap, const FSLOverlapEndPublishSignature& InPublishDelegate)
+{
+	FPublisher Publisher;
+	Publisher.MaxTimeGap = InMaxTimeGap;
+	Publisher.PublishDelegate = InPublishDelegate;
+	return Publishers.Add(Publisher);
+}
+
+// Publish the pending ends of the publisher and unregister it
+void FSLOverlapEndScheduler::RemovePublisher(int32 PublisherId)
+{
+	if (!Publishers.IsValidIndex(PublisherId))
+	{
+		return;
+	}
+
+	for (auto EntryItr(Entries.CreateIterator()); EntryItr; ++EntryItr)
+	{
+		if (EntryItr->PublisherId == PublisherId)
+		{
+			RemoveToBatch(EntryItr.GetIndex());
+		}
+	}
+	PublishBatch();
+	Publishers.RemoveAt(PublisherId);
+}
+
+// Delay publishing the end of the overlap with the other object
+void FSLOverlapEndScheduler::Schedule(int32 PublisherId, uint32 OtherId, const FSLOverlapEndEvent& Event)
+{
+	if (!Publishers.IsValidIndex(PublisherId))
+	{
+		return;
+	}
+
+	// A pair has at most one pending end, an older one is published first
+	const uint64 Key = FIds::PairEncodeCantor(PublisherId, OtherId);
+	if (const int32* EntryIdx = KeyToEntryIdx.Find(Key))
+	{
+		RemoveToBatch(*EntryIdx);
+		PublishBatch();
+	}
+
+	FPendingEnd Entry;
+	Entry.Key = Key;
+	Entry.PublisherId = PublisherId;
+	Entry.ExpireTime = Event.Time + Publishers[PublisherId].MaxTimeGap;
+	// Entries behind the sweep go in the next swept slot
+	Entry.Slot = static_cast<int32>(FMath::Max(GetTick(Entry.ExpireTime), NextSweepTick) & (NumSlots - 1));
+	Entry.Prev = INDEX_NONE;
+	Entry.Next = INDEX_NONE;
+	Entry.Event = Event;
+
+	const int32 NewIdx = Entries.Add(Entry);
+	Link(NewIdx);
+	KeyToEntryIdx.Add(Key, NewIdx);
+}
+
+// Check for concatenation with the pending end of the pair
+bool FSLOverlapEndScheduler::ConcatenateOrPublish(int32 PublisherId, uint32 OtherId, float StartTime)
+{
+	if (!Publishers.IsValidIndex(PublisherId))
+	{
+		return false;
+	}
+
+	const int32* EntryIdxPtr = KeyToEntryIdx.Find(FIds::PairEncodeCantor(PublisherId, OtherId));
+	if (!EntryIdxPtr)
+	{
+		return false;
+	}
+
+	const int32 EntryIdx = *EntryIdxPtr;
+	if (StartTime - Entries[EntryIdx].Event.Time < Publishers[PublisherId].MaxTimeGap)
+	{
+		// Concatenate, the end is dropped
+		Unlink(EntryIdx);
+		KeyToEntryIdx.Remove(Entries[EntryIdx].Key);
+		Entries.RemoveAt(EntryIdx);
+		return true;
+	}
+
+	// Gap passed but not swept yet, the end is published before the new begin
+	RemoveToBatch(EntryIdx);
+	PublishBatch();
+	return false;
+}
+
+/** Begin FTickableGameObject interface */
+// Publish the expired ends
+void FSLOverlapEndScheduler::Tick(float DeltaTime)
+{
+	Sweep(World->GetTimeSeconds());
+}
+
+// Only tick while there are pending ends
+bool FSLOverlapEndScheduler::IsTickable() const
+{
+	return World != nullptr && KeyToEntryIdx.Num() > 0;
+}
+
+// Return the stat id to use for this tickable
+TStatId FSLOverlapEndScheduler::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(FSLOverlapEndScheduler, STATGROUP_Tickables);
+}
+/** End FTickableGameObject interface */
+
+// Visit the slots up to the current time and publish the expired ends
+void FSLOverlapEndScheduler::Sweep(float CurrTime)
+{
+	const int64 CurrTick = GetTick(CurrTime);
+
+	// Every slot is visited at most once per sweep
+	for (int64 SweepTick = FMath::Max(NextSweepTick, CurrTick - NumSlots + 1); SweepTick <= CurrTick; ++SweepTick)
+	{
+		int32 EntryIdx = SlotHeads[SweepTick & (NumSlots - 1)];
+		while (EntryIdx != INDEX_NONE)
+		{
+			const int32 NextIdx = Entries[EntryIdx].Next;
+			// Later entries of the slot wait for the next sweep or round
+			if (CurrTime > Entries[EntryIdx].ExpireTime)
+			{
+				RemoveToBatch(EntryIdx);
+			}
+			EntryIdx = NextIdx;
+		}
+	}
+
+	// The current slot can still hold ends expiring later in this tick
+	NextSweepTick = CurrTick;
+	PublishBatch();
+}
+
+// Remove the entry and add it to the batch to be published
+void FSLOverlapEndScheduler::RemoveToBatch(int32 EntryIdx)
+{
+	Unlink(EntryIdx);
+	FPendingEnd& Entry = Entries[EntryIdx];
+	KeyToEntryIdx.Remove(Entry.Key);
+	Batch.Emplace(Entry.PublisherId, MoveTemp(Entry.Event));
+	Entries.RemoveAt(EntryIdx);
+}
+
+// Publish the batched ends in the order they ended
+void FSLOverlapEndScheduler::PublishBatch()
+{
+	if (Batch.Num() == 0)
+	{
+		return;
+	}
+
+	Batch.StableSort([](const TPair<int32, FSLOverlapEndEvent>& A, const TPair<int32, FSLOverlapEndEvent>& B)
+	{
+		return A.Value.Time < B.Value.Time;
+	});
+
+	// Move out the batch, publishing can schedule new ends
+	TArray<TPair<int32, FSLOverlapEndEvent>> CurrBatch = MoveTemp(Batch);
+	Batch.Reset();
+	for (const auto& Pair : CurrBatch)
+	{
+		if (Publishers.IsValidIndex(Pair.Key))
+		{
+			Publishers[Pair.Key].PublishDelegate.ExecuteIfBound(Pair.Value);
+		}
+	}
+}
+
+// Insert the entry at the end of its slot list
+void FSLOverlapEndScheduler::Link(int32 EntryIdx)
+{
+	FPendingEnd& Entry = Entries[EntryIdx];
+	Entry.Prev = SlotTails[Entry.Slot];
+	Entry.Next = INDEX_NONE;
+	if (Entry.Prev != INDEX_NONE)
+	{
+		Entries[Entry.Prev].Next = EntryIdx;
+	}
+	else
+	{
+		SlotHeads[Entry.Slot] = EntryIdx;
+	}
+	SlotTails[Entry.Slot] = EntryIdx;
+}
+
+// Remove the entry from its slot list
+void FSLOverlapEndScheduler::Unlink(int32 EntryIdx)
+{
+	FPendingEnd& Entry = Entries[EntryIdx];
+	if (Entry.Prev != INDEX_NONE)
+	{
+		Entries[Entry.Prev].Next = Entry.Next;
+	}
+	else
+	{
+		SlotHeads[Entry.Slot] = Entry.Next;
+	}
+	if (Entry.Next != INDEX_NONE)
+	{
+		Entries[Entry.Next].Prev = Entry.Prev;
+	}
+	else
+	{
+		SlotTails[Entry.Slot] = Entry.Prev;
+	}
+	Entry.Prev = INDEX_NONE;
+	Entry.Next = INDEX_NONE;
+}
@@ -35,80 +35,198 @@ void FSLEntitiesManager::Init(UWorld* World)
 		// Iterate all actors
 		for (TActorIterator<AActor> ActorItr(World); ActorItr; ++ActorItr)
 		{
-			// Add to map if key is found in the actor
-			FString ActId = FTags::GetValue(*ActorItr, "SemLog", "Id");
-			FString ActClass = FTags::GetValue(*ActorItr, "SemLog", "Class");
-			if (!ActId.IsEmpty() && !ActClass.IsEmpty())
-			{
-				FSLEntity SemEntity(*ActorItr, ActId, ActClass);
-				SemEntity.VisualMask = FTags::GetValue(*ActorItr, "SemLog", "VisMask");
-				SemEntity.RenderedVisualMask = FTags::GetValue(*ActorItr, "SemLog", "RenderedVisMask");
-				ObjectsSemanticData.Emplace(*ActorItr, SemEntity);
-				//ActorSemanticData.Emplace(*ActorItr, FSLEntity(*ActorItr, ActId, ActClass,
-				//	FTags::GetValue(*ActorItr, "SemLog", "VisMask")));
-
-				IdToActor.Emplace(ActId, *ActorItr);
-				
-				// Create a separate list with the camera views
-				if (ASLVisionCamera* VCA = Cast<ASLVisionCamera>(*ActorItr))
-				{
-					CameraViewSemanticData.Emplace(VCA, FSLEntity(*ActorItr, ActId, ActClass));
-					IdToVisionCamera.Emplace(ActId, VCA);
-				}
-
-				// Store quick map of id to actor pointer
-				if(AStaticMeshActor* AsSMA = Cast<AStaticMeshActor>(*ActorItr))
-				{
-					IdToStaticMeshActor.Emplace(ActId, AsSMA);
-				}
-				else if(ASkeletalMeshActor* AsSkMA = Cast<ASkeletalMeshActor>(*ActorItr))
-				{
-					// Check if skeletal data component is available
-					if(AsSkMA->GetComponentByClass(USLSkeletalDataComponent::StaticClass()))
-					{
-						IdToSkeletalMeshActor.Emplace(ActId, AsSkMA);
-					}
-					else
-					{
-						UE_LOG(LogTemp, Error, TEXT("%s::%d %s has no USLSKeletalDataComponent, entity will not be logged.."), 
-							*FString(__func__), __LINE__, *AsSkMA->GetName());
-					}
-				}
-			}
-			else
+			if (!AddActorData(*ActorItr))
 			{
 				UntaggedActors.Add(*ActorItr);
 				//UE_LOG(LogTemp, Warning, TEXT("%s::%d Add %s as un-tagged actor.."),
 				//	*FString(__func__), __LINE__, *ActorItr->GetName());
 			}
-			
+		}
+
+		// The writers append the pre-encoded strings
+		BuildUtf8Data();
+
+		// Mark as initialized
+		bIsInit = true;
+	}
+}
+
+// Add the semantic data of the actor and of its components, returns false if the actor itself is not annotated
+bool FSLEntitiesManager::AddActorData(AActor* Actor)
+{
+	bool bIsTagged = false;
+
+	// Add to map if key is found in the actor
+	FString ActId = FTags::GetValue(Actor, "SemLog", "Id");
+	FString ActClass = FTags::GetValue(Actor, "SemLog", "Class");
+	if (!ActId.IsEmpty() && !ActClass.IsEmpty())
+	{
+		bIsTagged = true;
+		FSLEntity SemEntity(Actor, ActId, ActClass);
+		SemEntity.VisualMask = FTags::GetValue(Actor, "SemLog", "VisMask");
+		SemEntity.RenderedVisualMask = FTags::GetValue(Actor, "SemLog", "RenderedVisMask");
+		ObjectsSemanticData.Emplace(Actor, SemEntity);
+		//ActorSemanticData.Emplace(Actor, FSLEntity(Actor, ActId, ActClass,
+		//	FTags::GetValue(Actor, "SemLog", "VisMask")));
+
+		IdToActor.Emplace(ActId, Actor);
+		
+		// Create a separate list with the camera views
+		if (ASLVisionCamera* VCA = Cast<ASLVisionCamera>(Actor))
+		{
+			CameraViewSemanticData.Emplace(VCA, FSLEntity(Actor, ActId, ActClass));
+			IdToVisionCamera.Emplace(ActId, VCA);
+		}
+
+		// Store quick map of id to actor pointer
+		if(AStaticMeshActor* AsSMA = Cast<AStaticMeshActor>(Actor))
+		{
+			IdToStaticMeshActor.Emplace(ActId, AsSMA);
+		}
+		else if(ASkeletalMeshActor* AsSkMA = Cast<ASkeletalMeshActor>(Actor))
+		{
+			// Check if skeletal data component is available
+			if(AsSkMA->GetComponentByClass(USLSkeletalDataComponent::StaticClass()))
+			{
+				IdToSkeletalMeshActor.Emplace(ActId, AsSkMA);
+			}
+			else
+			{
+				UE_LOG(LogTemp, Error, TEXT("%s::%d %s has no USLSKeletalDataComponent, entity will not be logged.."), 
+					*FString(__func__), __LINE__, *AsSkMA->GetName());
+			}
+		}
+	}
 
-			// Iterate components of the actor
-			for (const auto& CompItr : ActorItr->GetComponents())
+	// Iterate components of the actor
+	for (const auto& CompItr : Actor->GetComponents())
+	{
+		// Add to map if key is found in the actor
+		FString CompId = FTags::GetValue(CompItr, "SemLog", "Id");
+		FString CompClass = FTags::GetValue(CompItr, "SemLog", "Class");
+		if (!CompId.IsEmpty() && !CompClass.IsEmpty())
+		{
+			ObjectsSemanticData.Emplace(CompItr, FSLEntity(CompItr, CompId, CompClass,
+				FTags::GetValue(CompItr, "SemLog", "VisMask")));
+		}
+
+		// Check if the component is a skeletal data container
+		if (USLSkeletalDataComponent* AsSkelData = Cast<USLSkeletalDataComponent>(CompItr))
+		{
+			if (AsSkelData->Init())
 			{
-				// Add to map if key is found in the actor
-				FString CompId = FTags::GetValue(CompItr, "SemLog", "Id");
-				FString CompClass = FTags::GetValue(CompItr, "SemLog", "Class");
-				if (!CompId.IsEmpty() && !CompClass.IsEmpty())
-				{
-					ObjectsSemanticData.Emplace(CompItr, FSLEntity(CompItr, CompId, CompClass,
-						FTags::GetValue(CompItr, "SemLog", "VisMask")));
-				}
-
-				// Check if the component is a skeletal data container
-				if (USLSkeletalDataComponent* AsSkelData = Cast<USLSkeletalDataComponent>(CompItr))
-				{
-					if (AsSkelData->Init())
-					{
-						ObjectsSemanticSkelData.Add(AsSkelData->OwnerSemanticData.Obj, AsSkelData);
-					}
-				}
+				ObjectsSemanticSkelData.Add(AsSkelData->OwnerSemanticData.Obj, AsSkelData);
 			}
 		}
+	}
 
-		// Mark as initialized
-		bIsInit = true;
+	return bIsTagged;
+}
+
+// Register an actor spawned after init (with its components and pre-encoded strings)
+bool FSLEntitiesManager::AddActor(AActor* Actor)
+{
+	// The actor can already be (partially) known, e.g. slices added as objects, the entries are overwritten
+	if (!bIsInit || !Actor)
+	{
+		return false;
+	}
+
+	// Untagged runtime actors (e.g. effects, projectiles) are not tracked
+	bool bIsAdded = AddActorData(Actor);
+
+	// Only the strings of the new entities are converted
+	if (const FSLEntity* Entity = ObjectsSemanticData.Find(Actor))
+	{
+		ObjectsUtf8Data.Emplace(Actor, MakeShared<FSLEntityUtf8>(*Entity));
+	}
+	for (const auto& CompItr : Actor->GetComponents())
+	{
+		if (const FSLEntity* Entity = ObjectsSemanticData.Find(CompItr))
+		{
+			ObjectsUtf8Data.Emplace(CompItr, MakeShared<FSLEntityUtf8>(*Entity));
+			bIsAdded = true;
+		}
+		if (USLSkeletalDataComponent* AsSkelData = Cast<USLSkeletalDataComponent>(CompItr))
+		{
+			if (ObjectsSemanticSkelData.FindRef(AsSkelData->OwnerSemanticData.Obj) == AsSkelData)
+			{
+				SkeletalUtf8Data.Emplace(AsSkelData, CreateSkeletalUtf8(AsSkelData));
+				bIsAdded = true;
+			}
+		}
+	}
+	return bIsAdded;
+}
+
+// Unregister an actor and its components (e.g. on destruction)
+bool FSLEntitiesManager::RemoveActor(AActor* Actor)
+{
+	if (!Actor)
+	{
+		return false;
+	}
+
+	bool bRemoved = false;
+	if (const FSLEntity* Entity = ObjectsSemanticData.Find(Actor))
+	{
+		const FString ActId = Entity->Id;
+		IdToActor.Remove(ActId);
+		IdToStaticMeshActor.Remove(ActId);
+		IdToSkeletalMeshActor.Remove(ActId);
+		if (ASLVisionCamera* VCA = Cast<ASLVisionCamera>(Actor))
+		{
+			CameraViewSemanticData.Remove(VCA);
+			IdToVisionCamera.Remove(ActId);
+		}
+		bRemoved = true;
+	}
+	ObjectsSemanticData.Remove(Actor);
+	ObjectsUtf8Data.Remove(Actor);
+
+	for (const auto& CompItr : Actor->GetComponents())
+	{
+		bRemoved |= ObjectsSemanticData.Remove(CompItr) > 0;
+		ObjectsUtf8Data.Remove(CompItr);
+		if (USLSkeletalDataComponent* AsSkelData = Cast<USLSkeletalDataComponent>(CompItr))
+		{
+			bRemoved |= ObjectsSemanticSkelData.Remove(AsSkelData->OwnerSemanticData.Obj) > 0;
+			SkeletalUtf8Data.Remove(AsSkelData);
+		}
+	}
+	return bRemoved;
+}
+
+// Convert the ids, classes and bone names of the entities to utf8
+void FSLEntitiesManager::BuildUtf8Data()
+{
+	ObjectsUtf8Data.Empty(ObjectsSemanticData.Num());
+	for (const auto& Pair : ObjectsSemanticData)
+	{
+		ObjectsUtf8Data.Emplace(Pair.Key, MakeShared<FSLEntityUtf8>(Pair.Value));
+	}
+
+	SkeletalUtf8Data.Empty(ObjectsSemanticSkelData.Num());
+	for (const auto& Pair : ObjectsSemanticSkelData)
+	{
+		SkeletalUtf8Data.Emplace(Pair.Value, CreateSkeletalUtf8(Pair.Value));
+	}
+}
+
+// Create the pre-encoded strings of a skeletal entity
+TSharedPtr<const FSLEntityUtf8> FSLEntitiesManager::CreateSkeletalUtf8(USLSkeletalDataComponent* SkelData)
+{
+	TSharedPtr<FSLEntityUtf8> Utf8 = MakeShared<FSLEntityUtf8>(SkelData->OwnerSemanticData);
+	const TArray<FName>& BoneNames = SkelData->GetCachedBoneNames();
+	Utf8->BoneNames.Reserve(BoneNames.Num());
+	Utf8->BoneIds.Reserve(BoneNames.Num());
+	for (const FName& BoneName : BoneNames)
+	{
+		Utf8->BoneNames.Emplace(BoneName.ToString());
+		const FSLBoneData* BoneData = SkelData->SemanticBonesData.Find(BoneName);
+		Utf8->BoneIds.Emplace(BoneData ? FSLUtf8Str(BoneData->Id) : FSLUtf8Str());
 	}
+	return Utf8;
 }
 
 
@@ -117,6 +235,8 @@ void FSLEntitiesManager::Clear()
 {
 	// Clear any previous data
 	ObjectsSemanticData.Empty();
+	ObjectsUtf8Data.Empty();
+	SkeletalUtf8Data.Empty();
 
 	// Mark as uninitialized
 	bIsInit = false;
@@ -172,6 +292,7 @@ void FSLEntitiesManager::SetReplicates(bool bReplicate, float Priority, float Mi
 bool FSLEntitiesManager::RemoveEntity(UObject* Object)
 {
 	//return FSLMappings::RemoveItem(Object->GetUniqueID());
+	ObjectsUtf8Data.Remove(Object);
 	int32 NrOfRemovedItems = ObjectsSemanticData.Remove(Object);
 	if (NrOfRemovedItems > 0)
 	{
@@ -191,7 +312,8 @@ bool FSLEntitiesManager::AddObject(UObject* Object)
 	FString Class = FTags::GetValue(Object, "SemLog", "Class");
 	if (!Id.IsEmpty() && !Class.IsEmpty())
 	{
-		ObjectsSemanticData.Emplace(Object, FSLEntity(Object, Id, Class));
+		const FSLEntity& Entity = ObjectsSemanticData.Emplace(Object, FSLEntity(Object, Id, Class));
+		ObjectsUtf8Data.Emplace(Object, MakeShared<FSLEntityUtf8>(Entity));
 		return true;
 	}
 	else
@@ -10,6 +10,8 @@
 #include "Events/SLPickAndPlaceEventsHandler.h"
 #include "Events/SLContainerEventHandler.h"
 #include "Monitors/SLContactShapeInterface.h"
+#include "Monitors/SLOverlapEndScheduler.h"
+#include "TimerManager.h"
 #include "Monitors/SLManipulatorListener.h"
 #include "Monitors/SLReachListener.h"
 #include "Monitors/SLPickAndPlaceListener.h"
@@ -44,6 +46,7 @@ USLEventLogger::USLEventLogger()
 	bIsStarted = false;
 	bIsFinished = false;
 	bWriteTimelines = false;
+	FileCompression = ESLFileCompression::None;
 }
 
 // Destructor
@@ -71,6 +74,7 @@ void USLEventLogger::Init(ESLOwlExperimentTemplate TemplateType,
 		EpisodeId = WriterParams.EpisodeId;
 		OwlDocTemplate = TemplateType;
 		bWriteTimelines = bInWriteTimelines;
+		FileCompression = WriterParams.FileCompression;
 
 		// Init the semantic mappings (if not already init)
 		FSLEntitiesManager::GetInstance()->Init(GetWorld());
@@ -84,6 +88,10 @@ void USLEventLogger::Init(ESLOwlExperimentTemplate TemplateType,
 		// Parent -> TArray Parents
 		// rename FSLContactEventHandler,FSLSupportedByEventHandler,FSLFixationGraspEventHandler -> Events
 
+		// Shared delay of the overlap ends
+		OverlapEndScheduler = MakeShareable(new FSLOverlapEndScheduler());
+		OverlapEndScheduler->Init(GetWorld());
+
 		// Init all contact trigger handlers
 		for (TObjectIterator<UShapeComponent> Itr; Itr; ++Itr)
 		{
@@ -92,6 +100,7 @@ void USLEventLogger::Init(ESLOwlExperimentTemplate TemplateType,
 			{
 				if (IsValidAndAnnotated(*Itr))
 				{
+					ContactShape->SetOverlapEndScheduler(OverlapEndScheduler.Get());
 					ContactShape->Init(bInLogSupportedByEvents);
 
 					ContactShapes.Emplace(ContactShape);
@@ -123,6 +132,7 @@ void USLEventLogger::Init(ESLOwlExperimentTemplate TemplateType,
 			{
 				if (IsValidAndAnnotated(*Itr))
 				{
+					Itr->SetOverlapEndScheduler(OverlapEndScheduler.Get());
 					if (Itr->Init(bInLogGraspEvents, bInLogContactEvents))
 					{
 						GraspListeners.Emplace(*Itr);
@@ -313,6 +323,13 @@ void USLEventLogger::Start()
 {
 	if (!bIsStarted && bIsInit)
 	{
+		// The events are written to file as they finish and flushed periodically
+		if (StartEventStream())
+		{
+			GetWorld()->GetTimerManager().SetTimer(EventStreamFlushTimerHandle, this, &USLEventLogger::FlushEventStream,
+				FSLEventStreamWriter::FlushInterval, true);
+		}
+
 		// Start handlers
 		for (auto& EvHandler : EventHandlers)
 		{
@@ -364,6 +381,12 @@ void USLEventLogger::Finish(const float Time, bool bForced)
 {
 	if (!bIsFinished && (bIsInit || bIsStarted))
 	{
+		// Publish the delayed overlap ends before the handlers finish their started events
+		if (OverlapEndScheduler.IsValid())
+		{
+			OverlapEndScheduler->Finish();
+		}
+
 		// Finish handlers pending events
 		for (auto& EvHandler : EventHandlers)
 		{
@@ -397,27 +420,16 @@ void USLEventLogger::Finish(const float Time, bool bForced)
 		bIsInit = false;
 		bIsFinished = true;
 
-		// Create the experiment owl doc
-		if (!ExperimentDoc.IsValid())
-			return;
-
-		// Add finished events to doc
-		for (const auto& Ev : FinishedEvents)
+		// Add the experiment individual and close the owl document (the document is written even if never started)
+		if (GetWorld())
 		{
-			Ev->AddToOwlDoc(ExperimentDoc.Get());
+			GetWorld()->GetTimerManager().ClearTimer(EventStreamFlushTimerHandle);
 		}
+		StartEventStream();
+		EventStream.Finish();
 
-		// Add stored unique timepoints to doc
-		ExperimentDoc->AddTimepointIndividuals();
-
-		// Add stored unique objects to doc
-		ExperimentDoc->AddObjectIndividuals();
-
-		// Add experiment individual to doc
-		ExperimentDoc->AddExperimentIndividual();
-
-		// Write events to file
-		WriteToFile();
+		// Write events timelines to file
+		WriteTimelines();
 
 		bIsStarted = false;
 		bIsInit = false;
@@ -430,28 +442,44 @@ void USLEventLogger::OnSemanticEvent(TSharedPtr<ISLEvent> Event)
 {
 	//GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Yellow, FString::Printf(TEXT("%s::%d %s"), *FString(__func__), __LINE__, *Event->ToString()));
 	//UE_LOG(LogTemp, Error, TEXT(">> %s::%d %s"), *FString(__func__), __LINE__, *Event->ToString());
-	FinishedEvents.Add(Event);
-}
-
-// Write to file
-bool USLEventLogger::WriteToFile()
-{
-	// Write events timelines to file
+	EventStream.Write(Event);
 	if (bWriteTimelines)
 	{
-		FSLGoogleChartsParameters Params;
-		Params.bTooltips = true;
-		FSLGoogleCharts::WriteTimelines(FinishedEvents, LogDirectory, EpisodeId, Params);
+		FinishedEvents.Add(Event);
 	}
+}
 
+// Open the owl file and write the document header
+bool USLEventLogger::StartEventStream()
+{
 	if (!ExperimentDoc.IsValid())
+	{
 		return false;
+	}
 
-	// Write experiment to file
 	FString FullFilePath = FPaths::ProjectDir() + "/SemLog/" +
 		LogDirectory /*+ TEXT("/Episodes/")*/+ "/" + EpisodeId + TEXT("_ED.owl");
 	FPaths::RemoveDuplicateSlashes(FullFilePath);
-	return FFileHelper::SaveStringToFile(ExperimentDoc->ToString(), *FullFilePath);
+	return EventStream.Start(ExperimentDoc, FullFilePath, FileCompression);
+}
+
+// Flush the events written since the last flush
+void USLEventLogger::FlushEventStream()
+{
+	EventStream.Flush();
+}
+
+// Write the events timelines to file
+bool USLEventLogger::WriteTimelines()
+{
+	if (!bWriteTimelines)
+	{
+		return false;
+	}
+
+	FSLGoogleChartsParameters Params;
+	Params.bTooltips = true;
+	return FSLGoogleCharts::WriteTimelines(FinishedEvents, LogDirectory, EpisodeId, Params);
 }
 
 // Create events doc (experiment) template
@@ -50,7 +50,24 @@ ASLManager::ASLManager()
 	WorldStateUpdateRate = 0.0f;
 	LinearDistance = 0.5f; // cm
 	AngularDistance = 0.1f; // rad
+	bWorldStateDirtyTracking = false;
+	bWorldStateRigidGroups = false;
+	bWorldStateTelemetry = false;
 	WriterType = ESLWorldWriterType::MongoC;
+	WorldStateBufferDepth = 256;
+	bWorldStateMongoBatch = false;
+	WorldStateMongoBatchNumDocs = 64;
+	WorldStateMongoBatchSizeKB = 8 * 1024;
+	WorldStateMongoBatchInterval = 1.f;
+	WorldStateMongoWriteConcern = 1;
+	WorldStateMongoQueueSizeMB = 256;
+	WorldStateMongoIndexMode = ESLMongoIndexMode::Background;
+	bWorldStateMongoEntityBuckets = false;
+	WorldStateMongoBucketDuration = 1.f;
+	bWorldStateCompression = false;
+	WorldStateKeyframeInterval = 10.f;
+	WorldStateLocPrecision = 0.0001f;
+	WorldStateFileCompression = ESLFileCompression::None;
 
 	
 	// Events logger default values
@@ -61,6 +78,7 @@ ASLManager::ASLManager()
 	bLogPickAndPlaceEvents = true;
 	bLogSlicingEvents = true;
 	bWriteTimelines = true;
+	EventFileCompression = ESLFileCompression::None;
 	bWriteEpisodeMetadata = false;
 	ExperimentTemplateType = ESLOwlExperimentTemplate::Default;
 
@@ -208,15 +226,46 @@ void ASLManager::Init()
 
 			if (bLogWorldState)
 			{
+				FSLWorldWriterParams WriterParams(LinearDistance, AngularDistance, TaskId, EpisodeId,
+					ServerIp, ServerPort, bOverwriteWorldState, WorldStateBufferDepth);
+				WriterParams.bDirtyTracking = bWorldStateDirtyTracking;
+				WriterParams.bRigidGroups = bWorldStateRigidGroups;
+				WriterParams.bTelemetry = bWorldStateTelemetry;
+				WriterParams.FileCompression = WorldStateFileCompression;
+				WriterParams.MongoIndexMode = WorldStateMongoIndexMode;
+				WriterParams.ClassUpdateRates = WorldStateClassUpdateRates;
+				if (bWorldStateMongoBatch)
+				{
+					WriterParams.MongoBatch.MaxNumDocs = WorldStateMongoBatchNumDocs;
+					WriterParams.MongoBatch.MaxNumBytes = WorldStateMongoBatchSizeKB * 1024;
+					WriterParams.MongoBatch.MaxInterval = WorldStateMongoBatchInterval;
+					WriterParams.MongoBatch.WriteConcern = WorldStateMongoWriteConcern;
+					WriterParams.MongoBatch.MaxQueueBytes = static_cast<int64>(WorldStateMongoQueueSizeMB) * 1024 * 1024;
+				}
+				if (bWorldStateMongoEntityBuckets)
+				{
+					WriterParams.MongoBuckets.bEnabled = true;
+					WriterParams.MongoBuckets.BucketDuration = WorldStateMongoBucketDuration;
+				}
+				if (bWorldStateCompression)
+				{
+					WriterParams.Compression.bEnabled = true;
+					WriterParams.Compression.KeyframeInterval = WorldStateKeyframeInterval;
+					WriterParams.Compression.LocPrecision = WorldStateLocPrecision;
+				}
 				WorldStateLogger = NewObject<USLWorldLogger>(this);
-				WorldStateLogger->Init(WriterType, FSLWorldWriterParams(
-					LinearDistance, AngularDistance, TaskId, EpisodeId, ServerIp, ServerPort, bOverwriteWorldState));
+				TArray<ESLWorldWriterType> WriterTypes;
+				WriterTypes.Add(WriterType);
+				WriterTypes.Append(AdditionalWriterTypes);
+				WorldStateLogger->Init(WriterTypes, WriterParams);
 			}
 
 			if (bLogEventData)
 			{
 				EventDataLogger = NewObject<USLEventLogger>(this);
-				EventDataLogger->Init(ExperimentTemplateType, FSLEventWriterParams(TaskId, EpisodeId),
+				FSLEventWriterParams EventWriterParams(TaskId, EpisodeId);
+				EventWriterParams.FileCompression = EventFileCompression;
+				EventDataLogger->Init(ExperimentTemplateType, EventWriterParams,
 					bLogContactEvents, bLogSupportedByEvents, bLogGraspEvents, bLogPickAndPlaceEvents, bLogSlicingEvents, bWriteTimelines);
 			}
 		}
@@ -466,18 +515,44 @@ bool ASLManager::CanEditChange(const UProperty* InProperty) const
 	// Get the property name
 	const FName PropertyName = InProperty->GetFName();
 
+	// Check the main and the additional world state writers
+	const auto UsesWriter = [this](ESLWorldWriterType Type)
+	{
+		return WriterType == Type || AdditionalWriterTypes.Contains(Type);
+	};
+
 	// HostIP and HostPort can only be edited if the world state writer is of type Mongo
 	if (PropertyName == GET_MEMBER_NAME_CHECKED(ASLManager, ServerIp))
 	{
-		return (WriterType == ESLWorldWriterType::MongoCxx) || (WriterType == ESLWorldWriterType::MongoC);
+		return UsesWriter(ESLWorldWriterType::MongoCxx) || UsesWriter(ESLWorldWriterType::MongoC);
 	}
 	else if (PropertyName == GET_MEMBER_NAME_CHECKED(ASLManager, ServerPort))
 	{
-		return (WriterType == ESLWorldWriterType::MongoCxx) || (WriterType == ESLWorldWriterType::MongoC);
+		return UsesWriter(ESLWorldWriterType::MongoCxx) || UsesWriter(ESLWorldWriterType::MongoC);
+	}
+	else if (PropertyName == GET_MEMBER_NAME_CHECKED(ASLManager, bWorldStateMongoBatch))
+	{
+		return UsesWriter(ESLWorldWriterType::MongoC);
+	}
+	else if (PropertyName == GET_MEMBER_NAME_CHECKED(ASLManager, WorldStateMongoIndexMode))
+	{
+		return UsesWriter(ESLWorldWriterType::MongoC);
+	}
+	else if (PropertyName == GET_MEMBER_NAME_CHECKED(ASLManager, bWorldStateMongoEntityBuckets))
+	{
+		return UsesWriter(ESLWorldWriterType::MongoC);
+	}
+	else if (PropertyName == GET_MEMBER_NAME_CHECKED(ASLManager, bWorldStateCompression))
+	{
+		return UsesWriter(ESLWorldWriterType::MongoC) || UsesWriter(ESLWorldWriterType::Bson);
+	}
+	else if (PropertyName == GET_MEMBER_NAME_CHECKED(ASLManager, WorldStateFileCompression))
+	{
+		return UsesWriter(ESLWorldWriterType::Json) || UsesWriter(ESLWorldWriterType::Bson) || UsesWriter(ESLWorldWriterType::Binary);
 	}
 	else if (PropertyName == GET_MEMBER_NAME_CHECKED(ASLManager, bLogMetadata))
 	{
-		return (WriterType == ESLWorldWriterType::MongoCxx) || (WriterType == ESLWorldWriterType::MongoC);
+		return UsesWriter(ESLWorldWriterType::MongoCxx) || UsesWriter(ESLWorldWriterType::MongoC);
 	}
 
 	return ParentVal;
@@ -177,9 +177,6 @@ void USLVisionLogger::Finish(bool bForced)
 {
 	if (!bIsFinished && (bIsInit || bIsStarted))
 	{
-		// Index the entries in the db
-		DBHandler.CreateIndexes();
-
 		// Mark logger as finished
 		bIsStarted = false;
 		bIsInit = false;
@@ -27,7 +27,7 @@ USLWorldLogger::~USLWorldLogger()
 }
 
 // Init Logger
-void USLWorldLogger::Init(ESLWorldWriterType WriterType, const FSLWorldWriterParams& InWriterParams)
+void USLWorldLogger::Init(const TArray<ESLWorldWriterType>& WriterTypes, const FSLWorldWriterParams& InWriterParams)
 {
 	if (!bIsInit)
 	{
@@ -45,9 +45,11 @@ void USLWorldLogger::Init(ESLWorldWriterType WriterType, const FSLWorldWriterPar
 		// Init async worker (create the writer and set logging parameters)
 		if (AsyncWorker)
 		{
-			AsyncWorker->GetTask().Init(GetWorld(), WriterType, InWriterParams);
+			AsyncWorker->GetTask().Init(GetWorld(), WriterTypes, InWriterParams);
 			if(AsyncWorker->GetTask().IsInit())
 			{
+				// Spawned and destroyed actors are added and removed without rescanning the world
+				BindEntityEvents();
 				bIsInit = true;
 			}
 		}
@@ -59,7 +61,8 @@ void USLWorldLogger::Start(const float UpdateRate)
 {
 	if (!bIsStarted && bIsInit)
 	{
-		// Prepare worker for starting
+		// Prepare worker for starting (the captures delayed by more than half an update are reported as late)
+		AsyncWorker->GetTask().SetCaptureInterval(UpdateRate);
 		AsyncWorker->GetTask().Start();
 		
 		// Call before binding the recurrent Update function
@@ -95,6 +98,8 @@ void USLWorldLogger::Finish(bool bForced)
 {
 	if (!bIsFinished && (bIsInit || bIsStarted))
 	{
+		UnbindEntityEvents();
+
 		if (AsyncWorker)
 		{
 			// Wait for worker to complete 
@@ -151,6 +156,9 @@ TStatId USLWorldLogger::GetStatId() const
 // Log initial state of the world (static and dynamic entities)
 void USLWorldLogger::InitialUpdate()
 {
+	// Copy the initial poses on the game thread
+	AsyncWorker->GetTask().Capture(GetWorld()->GetTimeSeconds());
+
 	// Start async worker
 	AsyncWorker->StartBackgroundTask();
 	
@@ -164,18 +172,23 @@ void USLWorldLogger::InitialUpdate()
 // Log current state of the world (dynamic objects that moved more than the distance threshold)
 void USLWorldLogger::Update()
 {
-	// TODO get gaze data here
-	// Create a Thread-safe Shared Pointer to the gaze data
-	//TSharedPtr<FMyObjectType, ESPMode::ThreadSafe> NewThreadsafePointer = MakeShared<FMyObjectType, ESPMode::ThreadSafe>(MyArgs);
+	// Entities can only be added or removed while the change detection is idle, the writer sinks keep the entities of their snapshots
+	if (AsyncWorker->GetTask().HasPendingEntityChanges() && AsyncWorker->IsDone() && !AsyncWorker->GetTask().HasPendingSnapshots())
+	{
+		AsyncWorker->GetTask().UpdateEntities();
+	}
 
-	// Start task if worker is done with its previous work
-	if (AsyncWorker->IsDone())
+	// Copy the current poses on the game thread, the writer will serialize them asynchronously
+	if (!AsyncWorker->GetTask().Capture(GetWorld()->GetTimeSeconds()))
 	{
-		AsyncWorker->StartBackgroundTask();
+		UE_LOG(LogSL, Error, TEXT("%s::%d [%f] Snapshot buffer full (%d pending), DROPPING frame.."),
+			*FString(__func__), __LINE__, GetWorld()->GetTimeSeconds(), AsyncWorker->GetTask().GetNumPendingSnapshots());
 	}
-	else
+
+	// Start task if worker is done with its previous work, otherwise the running task will also write the new snapshot
+	if (AsyncWorker->IsDone())
 	{
-		UE_LOG(LogSL, Error, TEXT("%s::%d [%f] Previous task not finished, SKIPPING new task.."), *FString(__func__), __LINE__, GetWorld()->GetTimeSeconds());
+		AsyncWorker->StartBackgroundTask();
 	}
 }
 
@@ -184,3 +197,61 @@ void USLWorldLogger::DelaySetTickTrue()
 {
 	bIsTickable = true;
 }
+
+// Subscribe to the actor spawn and destroy events
+void USLWorldLogger::BindEntityEvents()
+{
+	ActorSpawnedHandle = GetWorld()->AddOnActorSpawnedHandler(
+		FOnActorSpawned::FDelegate::CreateUObject(this, &USLWorldLogger::OnActorSpawned));
+
+	TArray<AActor*> Actors;
+	FSLEntitiesManager::GetInstance()->GetActors(Actors);
+	for (AActor* Actor : Actors)
+	{
+		Actor->OnDestroyed.AddUniqueDynamic(this, &USLWorldLogger::OnActorDestroyed);
+		DestroyBoundActors.Add(Actor);
+	}
+}
+
+// Unsubscribe from the actor spawn and destroy events
+void USLWorldLogger::UnbindEntityEvents()
+{
+	if (ActorSpawnedHandle.IsValid())
+	{
+		if (UWorld* World = GetWorld())
+		{
+			World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+		}
+		ActorSpawnedHandle.Reset();
+	}
+
+	for (const auto& WeakActor : DestroyBoundActors)
+	{
+		if (AActor* Actor = WeakActor.Get())
+		{
+			Actor->OnDestroyed.RemoveDynamic(this, &USLWorldLogger::OnActorDestroyed);
+		}
+	}
+	DestroyBoundActors.Empty();
+}
+
+// Called when an actor is spawned in the world
+void USLWorldLogger::OnActorSpawned(AActor* Actor)
+{
+	if (AsyncWorker)
+	{
+		AsyncWorker->GetTask().AddNewActorEntity(Actor);
+		Actor->OnDestroyed.AddUniqueDynamic(this, &USLWorldLogger::OnActorDestroyed);
+		DestroyBoundActors.Add(Actor);
+	}
+}
+
+// Called when an actor is destroyed
+void USLWorldLogger::OnActorDestroyed(AActor* DestroyedActor)
+{
+	DestroyBoundActors.Remove(DestroyedActor);
+	if (AsyncWorker)
+	{
+		AsyncWorker->GetTask().RemoveEntity(DestroyedActor);
+	}
+}
@@ -58,6 +58,7 @@ bool USLSkeletalDataComponent::Init()
 		if (SetSemanticOwnerData() && SetSkeletalParent())
 		{
 			CreateBoneClassToMaterialIndexMapping();
+			CacheBoneNames();
 			bInit = true;
 		}
 		else 
@@ -68,6 +69,21 @@ bool USLSkeletalDataComponent::Init()
 	return bInit;
 }
 
+// Resolve the bone names of the skeletal parent once, in bone index order
+void USLSkeletalDataComponent::CacheBoneNames()
+{
+	CachedBoneNames.Reset();
+	if (SkeletalMeshParent)
+	{
+		const int32 NumBones = SkeletalMeshParent->GetNumBones();
+		CachedBoneNames.Reserve(NumBones);
+		for (int32 BoneIdx = 0; BoneIdx < NumBones; ++BoneIdx)
+		{
+			CachedBoneNames.Add(SkeletalMeshParent->GetBoneName(BoneIdx));
+		}
+	}
+}
+
 // Clear and re-load data from data asset
 void USLSkeletalDataComponent::LoadFromDataAsset()
 {
@@ -177,6 +193,7 @@ void USLSkeletalDataComponent::ClearData()
 	OwnerSemanticData.Clear();
 	SkeletalMeshParent = nullptr;
 	SemanticOwner = nullptr;
+	CachedBoneNames.Empty();
 	bInit = false;
 }
 
@@ -0,0 +1,79 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Math/RandomStream.h"
+#include "Utils/SLCompressedFile.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SLCompressedFileTest
+{
+	// Text like (compressible) data followed by random (incompressible) data, spans several blocks
+	TArray<uint8> CreateData(int32 Seed)
+	{
+		FRandomStream Rand(Seed);
+		TArray<uint8> Data;
+		while (Data.Num() < 2 * 1024 * 1024)
+		{
+			const FTCHARToUTF8 Line(*FString::Printf(TEXT("{\"id\":\"Id%d\",\"loc\":[%f,%f,%f]}\n"), Rand.RandHelper(1000), Rand.FRand(), Rand.FRand(), Rand.FRand()));
+			Data.Append(reinterpret_cast<const uint8*>(Line.Get()), Line.Length());
+		}
+		const int32 NumText = Data.Num();
+		Data.SetNumUninitialized(NumText + 1024 * 1024 + 123);
+		for (int32 Idx = NumText; Idx < Data.Num(); ++Idx)
+		{
+			Data[Idx] = static_cast<uint8>(Rand.RandHelper(256));
+		}
+		return Data;
+	}
+}
+
+// Writes gzip and LZ4 files and reads them back, including concatenated files
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSLCompressedFileRoundTripTest, "USemLog.Utils.CompressedFile.RoundTrip",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSLCompressedFileRoundTripTest::RunTest(const FString& Parameters)
+{
+	using namespace SLCompressedFileTest;
+	const TArray<uint8> First = CreateData(1);
+	const TArray<uint8> Second = CreateData(2);
+	TArray<uint8> Both = First;
+	Both.Append(Second);
+
+	for (const ESLFileCompression Compression : { ESLFileCompression::LZ4, ESLFileCompression::Zlib })
+	{
+		const FString What = FSLCompressedFileFormat::GetExtension(Compression);
+		const FString FilePath = FPaths::AutomationTransientDir() + TEXT("SLCompressedFileTest") + What;
+		if (!TestTrue(What + TEXT(" saved"), FSLCompressedFileWriter::SaveToFile(First, FilePath, Compression)))
+		{
+			continue;
+		}
+
+		TArray<uint8> Compressed;
+		FFileHelper::LoadFileToArray(Compressed, *FilePath);
+		TestTrue(What + TEXT(" compressed"), Compressed.Num() < First.Num());
+		TestTrue(What + TEXT(" detected"), FSLCompressedFileReader::IsCompressed(Compressed.GetData(), Compressed.Num()));
+		TestFalse(What + TEXT(" plain data not detected"), FSLCompressedFileReader::IsCompressed(First.GetData(), First.Num()));
+
+		TArray<uint8> Loaded;
+		TestTrue(What + TEXT(" loaded"), FSLCompressedFileReader::LoadFileToArray(Loaded, FilePath) && Loaded == First);
+
+		// Appended episodes are concatenated files
+		TArray<uint8> Appended;
+		FSLCompressedFileWriter::SaveToFile(Second, FilePath, Compression);
+		FFileHelper::LoadFileToArray(Appended, *FilePath);
+		Compressed.Append(Appended);
+		TArray<uint8> Decompressed;
+		TestTrue(What + TEXT(" concatenated"), FSLCompressedFileReader::Decompress(Compressed.GetData(), Compressed.Num(), Decompressed) && Decompressed == Both);
+
+		// A truncated file is rejected
+		TestFalse(What + TEXT(" truncated"), FSLCompressedFileReader::Decompress(Compressed.GetData(), Compressed.Num() - 3, Decompressed));
+		IFileManager::Get().Delete(*FilePath);
+	}
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
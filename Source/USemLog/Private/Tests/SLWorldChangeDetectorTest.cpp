@@ -0,0 +1,76 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "Misc/AutomationTest.h"
+#include "World/SLWorldChangeDetector.h"
+#include "SLWorldTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SLWorldChangeDetectorTest
+{
+	// Movement thresholds of the benchmark (1cm, 0.1rad)
+	static constexpr float LinDistSqMin = 1.f;
+	static constexpr float AngDistMin = 0.1f;
+
+	// Per entity check as done by the writers before the detector
+	void FindMovedScalar(const TArray<FTransform>& Poses, const TArray<FTransform>& PrevPoses, TArray<int32>& OutIdxs)
+	{
+		for (int32 Idx = 0; Idx < Poses.Num(); ++Idx)
+		{
+			if (FVector::DistSquared(Poses[Idx].GetLocation(), PrevPoses[Idx].GetLocation()) > LinDistSqMin ||
+				Poses[Idx].GetRotation().AngularDistance(PrevPoses[Idx].GetRotation()) > AngDistMin)
+			{
+				OutIdxs.Add(Idx);
+			}
+		}
+	}
+}
+
+// Compares the scalar per entity check with the vectorized check of the change detector at 1k, 10k and 100k entities
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSLWorldChangeDetectorBenchmark, "USemLog.World.ChangeDetector.Benchmark",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter | EAutomationTestFlags::PerfFilter)
+
+bool FSLWorldChangeDetectorBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace SLWorldTestHelpers;
+	using namespace SLWorldChangeDetectorTest;
+	const float QuatDotSqMin = 0.5f * (1.f + FMath::Cos(AngDistMin));
+	const int32 NumRuns = 50;
+
+	for (const int32 Num : { 1000, 10000, 100000 })
+	{
+		TArray<FTransform> Prev, Curr;
+		CreatePoses(Num, Prev, Curr);
+		FSLPoseArrays PrevPoses, CurrPoses;
+		ToPoseArrays(Prev, PrevPoses);
+		ToPoseArrays(Curr, CurrPoses);
+
+		TArray<int32> ScalarIdxs, VectorIdxs;
+		ScalarIdxs.Reserve(Num);
+		VectorIdxs.Reserve(Num);
+
+		double ScalarTime = 0.0;
+		double VectorTime = 0.0;
+		for (int32 Run = 0; Run < NumRuns; ++Run)
+		{
+			ScalarIdxs.Reset();
+			double StartTime = FPlatformTime::Seconds();
+			FindMovedScalar(Curr, Prev, ScalarIdxs);
+			ScalarTime += FPlatformTime::Seconds() - StartTime;
+
+			VectorIdxs.Reset();
+			StartTime = FPlatformTime::Seconds();
+			FSLWorldChangeDetector::FindMoved(CurrPoses, PrevPoses, LinDistSqMin, QuatDotSqMin, VectorIdxs);
+			VectorTime += FPlatformTime::Seconds() - StartTime;
+		}
+
+		TestTrue(FString::Printf(TEXT("Same moved entities at %d entities"), Num), ScalarIdxs == VectorIdxs);
+		AddInfo(FString::Printf(TEXT("%d entities (%d moved): scalar %.3f ms, vector %.3f ms, speedup %.2fx"),
+			Num, VectorIdxs.Num(), ScalarTime * 1000.0 / NumRuns, VectorTime * 1000.0 / NumRuns,
+			VectorTime > 0.0 ? ScalarTime / VectorTime : 0.0));
+	}
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,190 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "Misc/AutomationTest.h"
+#include "World/SLWorldPoseCodec.h"
+#include "SLWorldTestHelpers.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SLWorldPoseCodecTest
+{
+	// Max angle between an encoded and a decoded rotation (15 bits per component)
+	static constexpr float QuatTolerance = 1e-3f;
+}
+
+// Checks the zigzag varints and the smallest three rotations, including the limits and the truncated data
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSLWorldPoseCodecPrimitivesTest, "USemLog.World.PoseCodec.Primitives",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSLWorldPoseCodecPrimitivesTest::RunTest(const FString& Parameters)
+{
+	using namespace SLWorldTestHelpers;
+	using namespace SLWorldPoseCodecTest;
+
+	// Small magnitudes map to small unsigned values
+	TestEqual(TEXT("ZigZag 0"), FSLWorldPoseCodec::ZigZag(0), static_cast<uint64>(0));
+	TestEqual(TEXT("ZigZag -1"), FSLWorldPoseCodec::ZigZag(-1), static_cast<uint64>(1));
+	TestEqual(TEXT("ZigZag 1"), FSLWorldPoseCodec::ZigZag(1), static_cast<uint64>(2));
+	TestEqual(TEXT("ZigZag -2"), FSLWorldPoseCodec::ZigZag(-2), static_cast<uint64>(3));
+	for (const int64 Value : { static_cast<int64>(0), static_cast<int64>(-1), static_cast<int64>(63), static_cast<int64>(-64),
+		static_cast<int64>(123456789), MIN_int64, MAX_int64 })
+	{
+		TestEqual(FString::Printf(TEXT("ZigZag round trip %lld"), Value),
+			FSLWorldPoseCodec::UnZigZag(FSLWorldPoseCodec::ZigZag(Value)), Value);
+	}
+
+	// Seven bits per byte
+	TArray<uint8> Bytes;
+	struct FVarintSize { uint64 Value; int32 Size; };
+	const FVarintSize VarintSizes[] = { {0, 1}, {127, 1}, {128, 2}, {16383, 2}, {16384, 3}, {MAX_uint64, 10} };
+	for (const FVarintSize& Entry : VarintSizes)
+	{
+		Bytes.Reset();
+		FSLWorldPoseCodec::AppendVarint(Bytes, Entry.Value);
+		TestEqual(FString::Printf(TEXT("Varint size %llu"), Entry.Value), Bytes.Num(), Entry.Size);
+
+		uint64 Value = 0;
+		const uint8* Ptr = Bytes.GetData();
+		TestTrue(FString::Printf(TEXT("Varint round trip %llu"), Entry.Value),
+			FSLWorldPoseCodec::ReadVarint(Ptr, Bytes.GetData() + Bytes.Num(), Value) && Value == Entry.Value);
+		TestTrue(TEXT("Varint fully consumed"), Ptr == Bytes.GetData() + Bytes.Num());
+
+		Ptr = Bytes.GetData();
+		TestFalse(FString::Printf(TEXT("Truncated varint %llu"), Entry.Value),
+			FSLWorldPoseCodec::ReadVarint(Ptr, Bytes.GetData() + Bytes.Num() - 1, Value));
+	}
+
+	// Axis aligned, negated (q and -q are the same rotation), equal largest components and random rotations
+	TArray<FQuat> Quats = { FQuat::Identity, FQuat(0.f, 0.f, 0.f, -1.f), FQuat(1.f, 0.f, 0.f, 0.f), FQuat(0.f, -1.f, 0.f, 0.f),
+		FQuat(0.5f, 0.5f, 0.5f, 0.5f), FQuat(0.5f, -0.5f, 0.5f, -0.5f), FQuat(0.70710678f, 0.f, 0.70710678f, 0.f),
+		FQuat(FVector::UpVector, 0.001f) };
+	FRandomStream Rand(42);
+	for (int32 Idx = 0; Idx < 1000; ++Idx)
+	{
+		Quats.Add(RandomQuat(Rand));
+	}
+
+	float MaxAngle = 0.f;
+	bool bAllRead = true;
+	bool bAllUnit = true;
+	Bytes.Reset();
+	for (const FQuat& Quat : Quats)
+	{
+		FSLWorldPoseCodec::AppendQuat(Bytes, Quat);
+	}
+	TestEqual(TEXT("Fixed rotation size"), Bytes.Num(), Quats.Num() * FSLWorldPoseCodec::QuatSize);
+	const uint8* Ptr = Bytes.GetData();
+	const uint8* End = Bytes.GetData() + Bytes.Num();
+	for (const FQuat& Quat : Quats)
+	{
+		FQuat Decoded;
+		bAllRead &= FSLWorldPoseCodec::ReadQuat(Ptr, End, Decoded);
+		bAllUnit &= Decoded.IsNormalized();
+		MaxAngle = FMath::Max(MaxAngle, Decoded.AngularDistance(Quat));
+	}
+	TestTrue(TEXT("All rotations read"), bAllRead && Ptr == End);
+	TestTrue(TEXT("Decoded rotations are normalized"), bAllUnit);
+	TestTrue(FString::Printf(TEXT("Max rotation error %f rad"), MaxAngle), MaxAngle < QuatTolerance);
+
+	FQuat Decoded;
+	Ptr = Bytes.GetData();
+	TestFalse(TEXT("Truncated rotation"), FSLWorldPoseCodec::ReadQuat(Ptr, Bytes.GetData() + FSLWorldPoseCodec::QuatSize - 1, Decoded));
+	return true;
+}
+
+// Encodes random walks of keyframe slots over many frames and checks the decoded poses and the corrupt data handling
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSLWorldPoseCodecRoundTripTest, "USemLog.World.PoseCodec.RoundTrip",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSLWorldPoseCodecRoundTripTest::RunTest(const FString& Parameters)
+{
+	using namespace SLWorldTestHelpers;
+	using namespace SLWorldPoseCodecTest;
+	const double Precision = 0.01;
+	const int32 NumSlots = 200;
+	const int32 NumFrames = 100;
+
+	FSLWorldPoseEncoder Encoder;
+	FSLWorldPoseDecoder Decoder;
+	Encoder.Reset(Precision);
+	Decoder.Reset(Precision);
+
+	// Keyframe, both sides add the same slots
+	FRandomStream Rand(NumSlots);
+	TArray<FVector> Locs;
+	TArray<FQuat> Quats;
+	for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+	{
+		Locs.Add(Rand.GetUnitVector() * Rand.FRandRange(0.f, 5000.f));
+		Quats.Add(RandomQuat(Rand));
+		TestEqual(TEXT("Encoder slot"), Encoder.AddSlot(Locs[Slot]), Slot);
+		TestEqual(TEXT("Decoder slot"), Decoder.AddSlot(Locs[Slot]), Slot);
+	}
+
+	// Small and large, positive and negative steps of a random subset of the slots per frame
+	float MaxLocError = 0.f;
+	float MaxAngle = 0.f;
+	bool bAllDecoded = true;
+	bool bSameSlots = true;
+	int64 NumBytes = 0;
+	int32 NumDeltas = 0;
+	TArray<uint8> Bytes;
+	TArray<int32> FrameSlots;
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		Bytes.Reset();
+		FrameSlots.Reset();
+		for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+		{
+			if (Rand.FRand() < 0.3f)
+			{
+				const float Step = Rand.FRand() < 0.9f ? 0.5f : 500.f;
+				Locs[Slot] += Rand.GetUnitVector() * Rand.FRandRange(0.f, Step);
+				Quats[Slot] = FQuat(Rand.GetUnitVector(), Rand.FRandRange(0.f, 0.2f)) * Quats[Slot];
+				Encoder.AppendDelta(Slot, Locs[Slot], Quats[Slot], Bytes);
+				FrameSlots.Add(Slot);
+			}
+		}
+		NumBytes += Bytes.Num();
+		NumDeltas += FrameSlots.Num();
+
+		int32 DecodedIdx = 0;
+		bAllDecoded &= Decoder.Decode(Bytes.GetData(), Bytes.Num(), [&](int32 Slot, const FVector& Loc, const FQuat& Quat)
+		{
+			bSameSlots &= FrameSlots.IsValidIndex(DecodedIdx) && FrameSlots[DecodedIdx] == Slot;
+			if (Locs.IsValidIndex(Slot))
+			{
+				MaxLocError = FMath::Max(MaxLocError, (Loc - Locs[Slot]).GetAbsMax());
+				MaxAngle = FMath::Max(MaxAngle, Quat.AngularDistance(Quats[Slot]));
+			}
+			++DecodedIdx;
+		});
+		bSameSlots &= DecodedIdx == FrameSlots.Num();
+	}
+	TestTrue(TEXT("All frames decoded"), bAllDecoded);
+	TestTrue(TEXT("Same slots in the same order"), bSameSlots);
+
+	// The deltas are between quantized values, the error does not grow over the frames (float precision at 5000cm added)
+	TestTrue(FString::Printf(TEXT("Max location error %f after %d frames"), MaxLocError, NumFrames),
+		MaxLocError <= 0.5f * Precision + 1e-3f);
+	TestTrue(FString::Printf(TEXT("Max rotation error %f rad"), MaxAngle), MaxAngle < QuatTolerance);
+	AddInfo(FString::Printf(TEXT("%d deltas in %lld bytes (%.2f bytes per pose)"),
+		NumDeltas, NumBytes, NumDeltas > 0 ? static_cast<double>(NumBytes) / NumDeltas : 0.0));
+
+	// Corrupt data is reported instead of read out of bounds
+	auto IgnorePose = [](int32, const FVector&, const FQuat&) {};
+	Bytes.Reset();
+	Encoder.AppendDelta(0, Locs[0], Quats[0], Bytes);
+	TestFalse(TEXT("Truncated delta"), Decoder.Decode(Bytes.GetData(), Bytes.Num() - 1, IgnorePose));
+	Bytes.Reset();
+	FSLWorldPoseCodec::AppendVarint(Bytes, NumSlots);
+	FSLWorldPoseCodec::AppendVarint(Bytes, 0);
+	FSLWorldPoseCodec::AppendVarint(Bytes, 0);
+	FSLWorldPoseCodec::AppendVarint(Bytes, 0);
+	FSLWorldPoseCodec::AppendQuat(Bytes, FQuat::Identity);
+	TestFalse(TEXT("Unknown slot"), Decoder.Decode(Bytes.GetData(), Bytes.Num(), IgnorePose));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
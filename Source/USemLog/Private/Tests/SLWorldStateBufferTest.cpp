@@ -0,0 +1,168 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "Misc/AutomationTest.h"
+#include "World/SLWorldStateBuffer.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SLWorldStateBufferTest
+{
+	// Write a snapshot tagged with the given timestamp, false if the buffer is full
+	bool WriteSnapshot(FSLWorldStateBuffer& Buffer, float Timestamp)
+	{
+		FSLWorldStateSnapshot* Snapshot = Buffer.BeginWrite();
+		if (!Snapshot)
+		{
+			return false;
+		}
+		Snapshot->Timestamp = Timestamp;
+		Buffer.EndWrite();
+		return true;
+	}
+}
+
+// Checks the release order of the readers, the skipping of a lagging reader and the snapshots held by the readers
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSLWorldStateBufferReadersTest, "USemLog.World.StateBuffer.Readers",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSLWorldStateBufferReadersTest::RunTest(const FString& Parameters)
+{
+	using namespace SLWorldStateBufferTest;
+	const int32 Depth = 4;
+	const int32 NumReaders = 3;
+
+	FSLWorldStateBuffer Buffer;
+	Buffer.Init(Depth, 0, 0, 0, 0, NumReaders);
+	TestEqual(TEXT("Reader count"), Buffer.GetNumReaders(), NumReaders);
+	TestTrue(TEXT("Empty after init"), Buffer.IsEmpty() && Buffer.IsDrained() && Buffer.BeginRead(0) == nullptr);
+
+	// Only the first reader fills the buffer
+	for (int32 Idx = 0; Idx < Depth; ++Idx)
+	{
+		TestTrue(FString::Printf(TEXT("Write %d"), Idx), WriteSnapshot(Buffer, Idx));
+	}
+	TestTrue(TEXT("Full after depth writes"), Buffer.IsFull() && Buffer.BeginWrite() == nullptr);
+
+	// The following readers only see the snapshots released by the first reader
+	TestTrue(TEXT("Second reader waits for the first"), Buffer.BeginRead(1) == nullptr && Buffer.BeginRead(2) == nullptr);
+	for (int32 Idx = 0; Idx < Depth; ++Idx)
+	{
+		FSLWorldStateSnapshot* Snapshot = Buffer.BeginRead(0);
+		TestTrue(FString::Printf(TEXT("First reader order %d"), Idx), Snapshot && Snapshot->Timestamp == Idx);
+		Buffer.EndRead(0);
+	}
+	TestTrue(TEXT("First reader done"), Buffer.IsEmpty() && !Buffer.IsDrained());
+
+	// The second reader holds the first snapshot, the third one is idle, neither throttles the producer
+	const FSLWorldStateSnapshot* HeldSnapshot = Buffer.BeginRead(1);
+	TestTrue(TEXT("Second reader order 0"), HeldSnapshot && HeldSnapshot->Timestamp == 0.f);
+	for (int32 Idx = Depth; Idx < 2 * Depth; ++Idx)
+	{
+		TestTrue(FString::Printf(TEXT("Write %d past the lagging readers"), Idx), WriteSnapshot(Buffer, Idx));
+	}
+	TestTrue(TEXT("Full again at the first reader depth"), Buffer.IsFull() && Buffer.BeginWrite() == nullptr);
+	TestTrue(TEXT("Held snapshot not reused"), HeldSnapshot->Timestamp == 0.f);
+	Buffer.EndRead(1);
+
+	// The lagging readers were moved to the snapshots the first reader has not released yet
+	TestTrue(TEXT("Second reader skipped"), Buffer.BeginRead(1) == nullptr);
+	TestEqual(TEXT("Second reader skipped count"), Buffer.GetNumSkipped(1), Depth - 1);
+	TestTrue(TEXT("Third reader skipped"), Buffer.BeginRead(2) == nullptr);
+	TestEqual(TEXT("Third reader skipped count"), Buffer.GetNumSkipped(2), Depth);
+	for (int32 ReaderIdx = 0; ReaderIdx < NumReaders; ++ReaderIdx)
+	{
+		for (int32 Idx = Depth; Idx < 2 * Depth; ++Idx)
+		{
+			FSLWorldStateSnapshot* Snapshot = Buffer.BeginRead(ReaderIdx);
+			TestTrue(FString::Printf(TEXT("Reader %d order %d"), ReaderIdx, Idx), Snapshot && Snapshot->Timestamp == Idx);
+			Buffer.EndRead(ReaderIdx);
+		}
+	}
+	TestTrue(TEXT("Drained"), Buffer.IsDrained());
+	TestEqual(TEXT("First reader never skipped"), Buffer.GetNumSkipped(0), 0);
+
+	// Random interleaving over many wraps, the readers see the snapshots in order, the skipped ones are counted
+	// and the snapshots held by the readers are not overwritten
+	Buffer.Reset();
+	TestTrue(TEXT("Empty after reset"), Buffer.IsEmpty() && Buffer.IsDrained());
+	FRandomStream Rand(Depth);
+	int32 NumWritten = 0;
+	int32 NumRead[NumReaders] = { 0 };
+	int32 LastRead[NumReaders] = { -1, -1, -1 };
+	const FSLWorldStateSnapshot* Held[NumReaders] = { nullptr };
+	bool bInOrder = true;
+	bool bHeldIntact = true;
+	bool bBoundsHeld = true;
+	while (NumRead[0] < 100 * Depth)
+	{
+		const int32 Action = Rand.RandRange(0, NumReaders);
+		if (Action == NumReaders)
+		{
+			if (WriteSnapshot(Buffer, NumWritten))
+			{
+				++NumWritten;
+			}
+			bBoundsHeld &= Buffer.Num() <= Depth && Buffer.Num() == NumWritten - NumRead[0];
+			continue;
+		}
+
+		// Begin or end a read, the third reader is slow and skips snapshots
+		if (Held[Action])
+		{
+			if (Action != 2 || Rand.FRand() < 0.2f)
+			{
+				bHeldIntact &= Held[Action]->Timestamp == LastRead[Action];
+				Buffer.EndRead(Action);
+				Held[Action] = nullptr;
+			}
+		}
+		else if (const FSLWorldStateSnapshot* Snapshot = Buffer.BeginRead(Action))
+		{
+			// The first reader reads every snapshot, the following ones can only skip forward
+			const int32 Timestamp = static_cast<int32>(Snapshot->Timestamp);
+			bInOrder &= Action == 0 ? Timestamp == LastRead[0] + 1 : Timestamp > LastRead[Action];
+			bInOrder &= Action == 0 || Timestamp < NumRead[0];
+			LastRead[Action] = Timestamp;
+			Held[Action] = Snapshot;
+			++NumRead[Action];
+		}
+	}
+
+	// Release the held snapshots and drain the following readers
+	for (int32 ReaderIdx = 0; ReaderIdx < NumReaders; ++ReaderIdx)
+	{
+		if (Held[ReaderIdx])
+		{
+			bHeldIntact &= Held[ReaderIdx]->Timestamp == LastRead[ReaderIdx];
+			Buffer.EndRead(ReaderIdx);
+		}
+	}
+	while (const FSLWorldStateSnapshot* Snapshot = Buffer.BeginRead(0))
+	{
+		bInOrder &= static_cast<int32>(Snapshot->Timestamp) == LastRead[0] + 1;
+		LastRead[0] = static_cast<int32>(Snapshot->Timestamp);
+		++NumRead[0];
+		Buffer.EndRead(0);
+	}
+	for (int32 ReaderIdx = 1; ReaderIdx < NumReaders; ++ReaderIdx)
+	{
+		while (const FSLWorldStateSnapshot* Snapshot = Buffer.BeginRead(ReaderIdx))
+		{
+			bInOrder &= static_cast<int32>(Snapshot->Timestamp) > LastRead[ReaderIdx];
+			LastRead[ReaderIdx] = static_cast<int32>(Snapshot->Timestamp);
+			++NumRead[ReaderIdx];
+			Buffer.EndRead(ReaderIdx);
+		}
+		bBoundsHeld &= NumRead[ReaderIdx] + Buffer.GetNumSkipped(ReaderIdx) == NumWritten;
+	}
+	TestTrue(TEXT("Every reader reads the snapshots in order"), bInOrder);
+	TestTrue(TEXT("Held snapshots are not overwritten"), bHeldIntact);
+	TestTrue(TEXT("Read and skipped snapshots add up"), bBoundsHeld && NumRead[0] == NumWritten && Buffer.IsDrained());
+	TestTrue(TEXT("The slow reader skipped snapshots"), Buffer.GetNumSkipped(2) > 0);
+	AddInfo(FString::Printf(TEXT("%d snapshots written with depth %d, skipped %d and %d"),
+		NumWritten, Depth, Buffer.GetNumSkipped(1), Buffer.GetNumSkipped(2)));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,84 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+#include "World/ISLWorldWriter.h"
+
+/**
+* Fixtures shared by the world state automation tests
+*/
+namespace SLWorldTestHelpers
+{
+	// Task directory of the files written by the tests
+	static const FString TaskId = TEXT("SLAutomationTests");
+
+	// Path of the world state file of the given episode as written by the file based writers (e.g. "_WS.json")
+	inline FString GetEpisodeFilePath(const FString& EpisodeId, const FString& Suffix)
+	{
+		FString FilePath = FPaths::ProjectDir() + "/SemLog/" + TaskId + TEXT("/Episodes/") + EpisodeId + Suffix;
+		FPaths::RemoveDuplicateSlashes(FilePath);
+		return FilePath;
+	}
+
+	// Random unit rotation
+	inline FQuat RandomQuat(FRandomStream& Rand)
+	{
+		return FQuat(Rand.GetUnitVector(), Rand.FRandRange(-PI, PI));
+	}
+
+	// Snapshot where all the given actor entities moved (the poses are seeded by the number of entities)
+	inline void CreateMovedActors(int32 Num, TArray<TSLEntityPreviousPose<AActor>>& OutEntities, FSLWorldStateSnapshot& OutSnapshot)
+	{
+		FRandomStream Rand(Num);
+		OutEntities.Reset(Num);
+		OutSnapshot.Actors.SetNum(Num);
+		OutSnapshot.Changes.Reset();
+		for (int32 Idx = 0; Idx < Num; ++Idx)
+		{
+			OutEntities.Emplace(nullptr, FSLEntity(nullptr, FString::Printf(TEXT("Id%d"), Idx), TEXT("Cup")));
+			OutSnapshot.Actors.Set(Idx, Rand.GetUnitVector() * 100.f, RandomQuat(Rand));
+			OutSnapshot.Changes.Actors.Add(Idx);
+		}
+		OutSnapshot.BoneOffsets.Reset();
+		OutSnapshot.BoneOffsets.Add(0);
+	}
+
+	// Every fourth pose moves by 5cm or rotates by 0.5rad, the others are left in place
+	inline void CreatePoses(int32 Num, TArray<FTransform>& OutPrev, TArray<FTransform>& OutCurr)
+	{
+		FRandomStream Rand(Num);
+		OutPrev.SetNumUninitialized(Num);
+		OutCurr.SetNumUninitialized(Num);
+		for (int32 Idx = 0; Idx < Num; ++Idx)
+		{
+			const FQuat Quat = RandomQuat(Rand);
+			const FVector Loc = Rand.GetUnitVector() * Rand.FRandRange(0.f, 1000.f);
+			OutPrev[Idx] = FTransform(Quat, Loc);
+			OutCurr[Idx] = OutPrev[Idx];
+			if (Idx % 4 == 0)
+			{
+				if (Rand.FRand() < 0.5f)
+				{
+					OutCurr[Idx].AddToTranslation(Rand.GetUnitVector() * 5.f);
+				}
+				else
+				{
+					OutCurr[Idx].SetRotation(FQuat(Rand.GetUnitVector(), 0.5f) * Quat);
+				}
+			}
+		}
+	}
+
+	// Copy the poses to the structure of arrays layout of the snapshot
+	inline void ToPoseArrays(const TArray<FTransform>& Poses, FSLPoseArrays& OutPoses)
+	{
+		OutPoses.SetNum(Poses.Num());
+		for (int32 Idx = 0; Idx < Poses.Num(); ++Idx)
+		{
+			OutPoses.Set(Idx, Poses[Idx].GetLocation(), Poses[Idx].GetRotation());
+		}
+	}
+}
@@ -0,0 +1,195 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "World/SLWorldWriterBinary.h"
+#include "World/SLWorldReaderBinary.h"
+#include "SLWorldTestHelpers.h"
+
+#if SL_WITH_ROS_CONVERSIONS
+#include "Conversions.h"
+#endif // SL_WITH_ROS_CONVERSIONS
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SLWorldWriterBinaryTest
+{
+	// Logged pose of an entity in a frame
+	struct FExpectedRow
+	{
+		FString Id;
+		FVector Loc;
+		FQuat Quat;
+	};
+
+	// Path of the world state file written by the binary writer
+	FString GetFilePath(const FString& EpisodeId)
+	{
+		return SLWorldTestHelpers::GetEpisodeFilePath(EpisodeId, TEXT("_WS.bin"));
+	}
+
+	// Size of the dictionary record of the given entities (records are 4 byte aligned)
+	int64 GetDictionarySize(const TArray<TSLEntityPreviousPose<AActor>>& Entities, int32 First, int32 Last)
+	{
+		int64 NumBytes = 2 * sizeof(uint32);
+		for (int32 Idx = First; Idx < Last; ++Idx)
+		{
+			NumBytes += 2 * sizeof(uint32) + 3 * sizeof(uint16) +
+				FTCHARToUTF8(*Entities[Idx].Entity.Id).Length() + FTCHARToUTF8(*Entities[Idx].Entity.Class).Length();
+		}
+		return Align(NumBytes, 4);
+	}
+
+	// Size of a frame record with the given number of rows
+	int64 GetFrameSize(int32 NumRows)
+	{
+		return 3 * sizeof(uint32) + static_cast<int64>(NumRows) * 8 * sizeof(uint32);
+	}
+
+	// Poses of the moved actors as they are logged
+	TArray<FExpectedRow> GetExpectedRows(const FSLWorldStateSnapshot& Snapshot, const TArray<TSLEntityPreviousPose<AActor>>& Entities)
+	{
+		TArray<FExpectedRow> Rows;
+		for (const int32 Idx : Snapshot.Changes.Actors)
+		{
+#if SL_WITH_ROS_CONVERSIONS
+			Rows.Add({ Entities[Idx].Entity.Id, FConversions::UToROS(Snapshot.Actors.GetLoc(Idx)), FConversions::UToROS(Snapshot.Actors.GetQuat(Idx)) });
+#else
+			Rows.Add({ Entities[Idx].Entity.Id, Snapshot.Actors.GetLoc(Idx), Snapshot.Actors.GetQuat(Idx) });
+#endif // SL_WITH_ROS_CONVERSIONS
+		}
+		return Rows;
+	}
+}
+
+// Writes a few frames with the binary writer and reads them back, including from files truncated in a dictionary and in a frame
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSLWorldWriterBinaryRoundTripTest, "USemLog.World.WriterBinary.RoundTrip",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSLWorldWriterBinaryRoundTripTest::RunTest(const FString& Parameters)
+{
+	using namespace SLWorldTestHelpers;
+	using namespace SLWorldWriterBinaryTest;
+	const int32 NumEntities = 20;
+	const int32 NumNewEntities = 5;
+
+	TArray<TSLEntityPreviousPose<AActor>> ActorEntities;
+	const TArray<TSLEntityPreviousPose<USceneComponent>> ComponentEntities;
+	const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>> SkeletalEntities;
+	FSLWorldStateSnapshot Snapshot;
+	CreateMovedActors(NumEntities, ActorEntities, Snapshot);
+	ActorEntities[1].Entity.Class = TEXT("M\u00FCslischale");
+
+	// All entities moved, then every other one, then new entities appear (second dictionary record) together with a few old ones
+	TArray<FSLWorldStateSnapshot> Frames;
+	Snapshot.Timestamp = 0.f;
+	Frames.Add(Snapshot);
+
+	FRandomStream Rand(3);
+	Snapshot.Timestamp = 0.1f;
+	Snapshot.Changes.Reset();
+	for (int32 Idx = 0; Idx < NumEntities; Idx += 2)
+	{
+		Snapshot.Actors.Set(Idx, Snapshot.Actors.GetLoc(Idx) + Rand.GetUnitVector() * 10.f, RandomQuat(Rand));
+		Snapshot.Changes.Actors.Add(Idx);
+	}
+	Frames.Add(Snapshot);
+
+	Snapshot.Timestamp = 0.2f;
+	Snapshot.Changes.Reset();
+	Snapshot.Actors.SetNum(NumEntities + NumNewEntities);
+	for (int32 Idx = NumEntities; Idx < NumEntities + NumNewEntities; ++Idx)
+	{
+		ActorEntities.Emplace(nullptr, FSLEntity(nullptr, FString::Printf(TEXT("Id%d"), Idx), TEXT("Plate")));
+		Snapshot.Actors.Set(Idx, Rand.GetUnitVector() * 100.f, RandomQuat(Rand));
+		Snapshot.Changes.Actors.Add(Idx);
+	}
+	Snapshot.Actors.Set(3, Snapshot.Actors.GetLoc(3) + FVector(5.f, 0.f, 0.f), Snapshot.Actors.GetQuat(3));
+	Snapshot.Changes.Actors.Add(3);
+	Frames.Add(Snapshot);
+
+	const FString EpisodeId = TEXT("BinaryWriterRoundTrip");
+	{
+		FSLWorldWriterBinary Writer(FSLWorldWriterParams(0.f, 0.f, TaskId, EpisodeId));
+		for (const FSLWorldStateSnapshot& Frame : Frames)
+		{
+			Writer.Write(Frame, Frame.Changes, ActorEntities, ComponentEntities, SkeletalEntities);
+		}
+	}
+
+	// Check the frames read from the given file against the first frames written
+	const auto CheckFile = [&](const FString& FilePath, int32 NumExpectedFrames, int32 NumExpectedEntities, const FString& What)
+	{
+		FSLWorldReaderBinary Reader;
+		if (!TestTrue(What + TEXT(" opened"), Reader.Open(FilePath)))
+		{
+			return;
+		}
+
+		const TArray<FSLWorldBinaryEntity>& Entities = Reader.GetEntities();
+		TestEqual(What + TEXT(" dictionary size"), Entities.Num(), NumExpectedEntities);
+		for (int32 Handle = 0; Handle < Entities.Num() && Handle < ActorEntities.Num(); ++Handle)
+		{
+			TestTrue(What + FString::Printf(TEXT(" entity %d"), Handle),
+				Entities[Handle].Id == ActorEntities[Handle].Entity.Id && Entities[Handle].Class == ActorEntities[Handle].Entity.Class &&
+				Entities[Handle].ParentHandle == FSLWorldBinaryFormat::InvalidHandle);
+		}
+
+		if (!TestEqual(What + TEXT(" number of frames"), Reader.GetNumFrames(), NumExpectedFrames))
+		{
+			return;
+		}
+		for (int32 FrameIdx = 0; FrameIdx < NumExpectedFrames; ++FrameIdx)
+		{
+			const TArray<FExpectedRow> Expected = GetExpectedRows(Frames[FrameIdx], ActorEntities);
+			FSLWorldBinaryFrame Frame;
+			if (!TestTrue(What + FString::Printf(TEXT(" frame %d read"), FrameIdx), Reader.GetFrame(FrameIdx, Frame)) ||
+				!TestEqual(What + FString::Printf(TEXT(" frame %d rows"), FrameIdx), Frame.Num, Expected.Num()))
+			{
+				continue;
+			}
+			TestEqual(What + FString::Printf(TEXT(" frame %d timestamp"), FrameIdx), Frame.Timestamp, Frames[FrameIdx].Timestamp);
+			TestEqual(What + FString::Printf(TEXT(" frame %d found by timestamp"), FrameIdx), Reader.FindFrame(Frames[FrameIdx].Timestamp), FrameIdx);
+			TestEqual(What + FString::Printf(TEXT(" frame %d no rigid children"), FrameIdx), Frame.NumRigid, 0);
+			for (int32 Row = 0; Row < Frame.Num; ++Row)
+			{
+				const uint32 Handle = Frame.Handles[Row];
+				TestTrue(What + FString::Printf(TEXT(" frame %d row %d"), FrameIdx, Row),
+					Entities.IsValidIndex(Handle) && Entities[Handle].Id == Expected[Row].Id &&
+					Frame.GetLoc(Row).Equals(Expected[Row].Loc, 0.f) && Frame.GetQuat(Row).Equals(Expected[Row].Quat, 0.f));
+			}
+		}
+	};
+
+	const FString FilePath = GetFilePath(EpisodeId);
+	CheckFile(FilePath, Frames.Num(), ActorEntities.Num(), TEXT("Complete file"));
+
+	// The files of an interrupted episode have no seek table, the reader stops at the last complete record
+	TArray<uint8> Content;
+	if (TestTrue(TEXT("File written"), FFileHelper::LoadFileToArray(Content, *FilePath)))
+	{
+		const int64 SecondDictOffset = FSLWorldBinaryFormat::HeaderSize + GetDictionarySize(ActorEntities, 0, NumEntities) +
+			GetFrameSize(Frames[0].Changes.Actors.Num()) + GetFrameSize(Frames[1].Changes.Actors.Num());
+		const int64 LastFrameOffset = SecondDictOffset + GetDictionarySize(ActorEntities, NumEntities, NumEntities + NumNewEntities);
+		const uint32 DictType = FSLWorldBinaryFormat::DictionaryRecord;
+		const uint32 FrameType = FSLWorldBinaryFormat::FrameRecord;
+		TestTrue(TEXT("Second dictionary record located"), Content.Num() > LastFrameOffset &&
+			FMemory::Memcmp(Content.GetData() + SecondDictOffset, &DictType, sizeof(uint32)) == 0 &&
+			FMemory::Memcmp(Content.GetData() + LastFrameOffset, &FrameType, sizeof(uint32)) == 0);
+
+		const FString TruncatedPath = GetFilePath(EpisodeId + TEXT("_Truncated"));
+		const TArray<uint8> InDictionary(Content.GetData(), static_cast<int32>(SecondDictOffset + 2 * sizeof(uint32) + 5));
+		FFileHelper::SaveArrayToFile(InDictionary, *TruncatedPath);
+		CheckFile(TruncatedPath, Frames.Num() - 1, NumEntities, TEXT("Truncated in dictionary"));
+
+		const TArray<uint8> InFrame(Content.GetData(), static_cast<int32>(LastFrameOffset + GetFrameSize(Frames[2].Changes.Actors.Num()) - 1));
+		FFileHelper::SaveArrayToFile(InFrame, *TruncatedPath);
+		CheckFile(TruncatedPath, Frames.Num() - 1, ActorEntities.Num(), TEXT("Truncated in frame"));
+		IFileManager::Get().Delete(*TruncatedPath);
+	}
+	IFileManager::Get().Delete(*FilePath);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,344 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "HAL/PlatformFilemanager.h"
+#include "World/SLWorldWriterJson.h"
+#include "SLWorldTestHelpers.h"
+#include <limits>
+
+#if WITH_EDITOR
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#endif // WITH_EDITOR
+
+#if SL_WITH_ROS_CONVERSIONS
+#include "Conversions.h"
+#endif // SL_WITH_ROS_CONVERSIONS
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SLWorldWriterJsonTest
+{
+	// Relative tolerance of the number comparison (the json serializer does not print all the float digits in every engine version)
+	static constexpr double NumberTolerance = 1e-5;
+
+	// Path of the world state file written by the json writer
+	FString GetFilePath(const FString& EpisodeId)
+	{
+		return SLWorldTestHelpers::GetEpisodeFilePath(EpisodeId, TEXT("_WS.json"));
+	}
+
+	// Split the concatenated documents of the json writer (top level objects)
+	TArray<FString> SplitDocuments(const FString& Str)
+	{
+		TArray<FString> Docs;
+		int32 Depth = 0;
+		int32 Start = 0;
+		bool bInString = false;
+		for (int32 Idx = 0; Idx < Str.Len(); ++Idx)
+		{
+			const TCHAR Char = Str[Idx];
+			if (bInString)
+			{
+				if (Char == TEXT('\\'))
+				{
+					++Idx;
+				}
+				else if (Char == TEXT('"'))
+				{
+					bInString = false;
+				}
+			}
+			else if (Char == TEXT('"'))
+			{
+				bInString = true;
+			}
+			else if (Char == TEXT('{') && Depth++ == 0)
+			{
+				Start = Idx;
+			}
+			else if (Char == TEXT('}') && --Depth == 0)
+			{
+				Docs.Add(Str.Mid(Start, Idx - Start + 1));
+			}
+		}
+		return Docs;
+	}
+
+#if WITH_EDITOR
+	// Previous writer, one json object per moved entity
+	TSharedPtr<FJsonObject> CreateLegacyDocument(const FSLWorldStateSnapshot& Snapshot, const TArray<TSLEntityPreviousPose<AActor>>& Entities)
+	{
+		TArray<TSharedPtr<FJsonValue>> JsonEntitiesArr;
+		for (const int32 Idx : Snapshot.Changes.Actors)
+		{
+			TSharedPtr<FJsonObject> JsonEntry = MakeShareable(new FJsonObject);
+			for (const auto& Pair : TMap<FString, FString>{ {"id", Entities[Idx].Entity.Id}, {"class", Entities[Idx].Entity.Class} })
+			{
+				JsonEntry->SetStringField(Pair.Key, Pair.Value);
+			}
+#if SL_WITH_ROS_CONVERSIONS
+			const FVector Loc = FConversions::UToROS(Snapshot.Actors.GetLoc(Idx));
+			const FQuat Quat = FConversions::UToROS(Snapshot.Actors.GetQuat(Idx));
+#else
+			const FVector Loc = Snapshot.Actors.GetLoc(Idx);
+			const FQuat Quat = Snapshot.Actors.GetQuat(Idx);
+#endif // SL_WITH_ROS_CONVERSIONS
+			TSharedPtr<FJsonObject> LocObj = MakeShareable(new FJsonObject);
+			LocObj->SetNumberField("x", Loc.X);
+			LocObj->SetNumberField("y", Loc.Y);
+			LocObj->SetNumberField("z", Loc.Z);
+			JsonEntry->SetObjectField("loc", LocObj);
+			TSharedPtr<FJsonObject> QuatObj = MakeShareable(new FJsonObject);
+			QuatObj->SetNumberField("x", Quat.X);
+			QuatObj->SetNumberField("y", Quat.Y);
+			QuatObj->SetNumberField("z", Quat.Z);
+			QuatObj->SetNumberField("w", Quat.W);
+			JsonEntry->SetObjectField("rot", QuatObj);
+			JsonEntitiesArr.Add(MakeShareable(new FJsonValueObject(JsonEntry)));
+		}
+		TSharedPtr<FJsonObject> JsonRootObj = MakeShareable(new FJsonObject);
+		JsonRootObj->SetNumberField("timestamp", Snapshot.Timestamp);
+		JsonRootObj->SetArrayField("entities", JsonEntitiesArr);
+		return JsonRootObj;
+	}
+
+	// Serialize the document as the previous writer did
+	FString LegacySerialize(const TSharedPtr<FJsonObject>& JsonRootObj)
+	{
+		FString JsonString;
+		FJsonSerializer::Serialize(JsonRootObj.ToSharedRef(), TJsonWriterFactory<>::Create(&JsonString));
+		return JsonString;
+	}
+
+	// Parse a single document (invalid pointer on error)
+	TSharedPtr<FJsonValue> Parse(const FString& JsonStr)
+	{
+		TSharedPtr<FJsonObject> JsonObj;
+		if (FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(JsonStr), JsonObj) && JsonObj.IsValid())
+		{
+			return MakeShareable(new FJsonValueObject(JsonObj));
+		}
+		return nullptr;
+	}
+
+	// Compare the parsed trees regardless of the key order, the path of the first difference is returned on mismatch
+	bool JsonValuesEqual(const TSharedPtr<FJsonValue>& A, const TSharedPtr<FJsonValue>& B, const FString& Path, FString& OutMismatch)
+	{
+		if (!A.IsValid() || !B.IsValid() || A->Type != B->Type)
+		{
+			OutMismatch = Path;
+			return false;
+		}
+
+		bool bEqual = true;
+		switch (A->Type)
+		{
+		case EJson::Number:
+			bEqual = FMath::IsNearlyEqual(A->AsNumber(), B->AsNumber(), NumberTolerance * FMath::Max(1.0, FMath::Abs(A->AsNumber())));
+			break;
+		case EJson::String:
+			bEqual = A->AsString().Equals(B->AsString(), ESearchCase::CaseSensitive);
+			break;
+		case EJson::Boolean:
+			bEqual = A->AsBool() == B->AsBool();
+			break;
+		case EJson::Array:
+		{
+			const TArray<TSharedPtr<FJsonValue>>& ArrA = A->AsArray();
+			const TArray<TSharedPtr<FJsonValue>>& ArrB = B->AsArray();
+			if (ArrA.Num() != ArrB.Num())
+			{
+				bEqual = false;
+				break;
+			}
+			for (int32 Idx = 0; Idx < ArrA.Num(); ++Idx)
+			{
+				if (!JsonValuesEqual(ArrA[Idx], ArrB[Idx], FString::Printf(TEXT("%s[%d]"), *Path, Idx), OutMismatch))
+				{
+					return false;
+				}
+			}
+			break;
+		}
+		case EJson::Object:
+		{
+			const TSharedPtr<FJsonObject> ObjA = A->AsObject();
+			const TSharedPtr<FJsonObject> ObjB = B->AsObject();
+			if (ObjA->Values.Num() != ObjB->Values.Num())
+			{
+				bEqual = false;
+				break;
+			}
+			for (const auto& Pair : ObjA->Values)
+			{
+				const TSharedPtr<FJsonValue>* ValB = ObjB->Values.Find(Pair.Key);
+				if (!JsonValuesEqual(Pair.Value, ValB ? *ValB : nullptr, Path + TEXT(".") + Pair.Key, OutMismatch))
+				{
+					return false;
+				}
+			}
+			break;
+		}
+		default:
+			break;
+		}
+
+		if (!bEqual)
+		{
+			OutMismatch = Path;
+		}
+		return bEqual;
+	}
+#endif // WITH_EDITOR
+}
+
+// Checks that the documents of the json writer parse to the same trees as the ones of the previous json object serializer
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSLWorldWriterJsonOutputTest, "USemLog.World.WriterJson.Output",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FSLWorldWriterJsonOutputTest::RunTest(const FString& Parameters)
+{
+	using namespace SLWorldTestHelpers;
+	using namespace SLWorldWriterJsonTest;
+
+	TArray<TSLEntityPreviousPose<AActor>> ActorEntities;
+	const TArray<TSLEntityPreviousPose<USceneComponent>> ComponentEntities;
+	const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>> SkeletalEntities;
+	FSLWorldStateSnapshot Snapshot;
+	CreateMovedActors(100, ActorEntities, Snapshot);
+
+	// Escaped and non ascii strings
+	ActorEntities[1].Entity.Id = TEXT("Id\"1\\\t");
+	ActorEntities[2].Entity.Class = TEXT("M\u00FCslischale");
+
+	// Two frames, in the second one only every third entity moved
+	TArray<FSLWorldStateSnapshot> Frames;
+	Snapshot.Timestamp = 0.1f;
+	Frames.Add(Snapshot);
+	FRandomStream Rand(7);
+	Snapshot.Timestamp = 0.25f;
+	Snapshot.Changes.Reset();
+	for (int32 Idx = 0; Idx < ActorEntities.Num(); Idx += 3)
+	{
+		Snapshot.Actors.Set(Idx, Snapshot.Actors.GetLoc(Idx) + Rand.GetUnitVector() * 10.f, RandomQuat(Rand));
+		Snapshot.Changes.Actors.Add(Idx);
+	}
+	Frames.Add(Snapshot);
+
+	const FString EpisodeId = TEXT("JsonWriterOutput");
+	{
+		FSLWorldWriterJson Writer(FSLWorldWriterParams(0.f, 0.f, TaskId, EpisodeId));
+		for (const FSLWorldStateSnapshot& Frame : Frames)
+		{
+			Writer.Write(Frame, Frame.Changes, ActorEntities, ComponentEntities, SkeletalEntities);
+		}
+	}
+
+	FString JsonStr;
+	TestTrue(TEXT("Json file written"), FFileHelper::LoadFileToString(JsonStr, *GetFilePath(EpisodeId)));
+	IFileManager::Get().Delete(*GetFilePath(EpisodeId));
+	const TArray<FString> Docs = SplitDocuments(JsonStr);
+	TestEqual(TEXT("One document per frame"), Docs.Num(), Frames.Num());
+
+#if WITH_EDITOR
+	for (int32 Idx = 0; Idx < Docs.Num() && Idx < Frames.Num(); ++Idx)
+	{
+		const TSharedPtr<FJsonValue> Streamed = Parse(Docs[Idx]);
+		const TSharedPtr<FJsonValue> Legacy = Parse(LegacySerialize(CreateLegacyDocument(Frames[Idx], ActorEntities)));
+		TestTrue(FString::Printf(TEXT("Frame %d is valid json"), Idx), Streamed.IsValid());
+		FString Mismatch;
+		const bool bEqual = JsonValuesEqual(Streamed, Legacy, TEXT("$"), Mismatch);
+		TestTrue(FString::Printf(TEXT("Frame %d equals the previous serializer (first difference at %s)"), Idx, *Mismatch), bEqual);
+	}
+#endif // WITH_EDITOR
+
+	// Single document with an invalid pose, nan has to be written as null to keep the json valid
+	{
+		const FString NanEpisodeId = TEXT("JsonWriterNan");
+		FSLWorldStateSnapshot NanSnapshot = Frames[0];
+		NanSnapshot.Actors.Set(0, FVector(std::numeric_limits<float>::quiet_NaN(), 0.f, 0.f), FQuat::Identity);
+		{
+			FSLWorldWriterJson Writer(FSLWorldWriterParams(0.f, 0.f, TaskId, NanEpisodeId));
+			Writer.Write(NanSnapshot, NanSnapshot.Changes, ActorEntities, ComponentEntities, SkeletalEntities);
+		}
+
+		FString NanJsonStr;
+		TestTrue(TEXT("Json file written"), FFileHelper::LoadFileToString(NanJsonStr, *GetFilePath(NanEpisodeId)));
+		TestTrue(TEXT("Nan written as null"), NanJsonStr.Contains(TEXT("\"x\": null")));
+#if WITH_EDITOR
+		TestTrue(TEXT("Valid json"), Parse(NanJsonStr).IsValid());
+#endif // WITH_EDITOR
+		IFileManager::Get().Delete(*GetFilePath(NanEpisodeId));
+	}
+	return true;
+}
+
+// Times the json writer with 10k moved entities per frame against the previous json object serializer, the outputs have to be equal
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSLWorldWriterJsonBenchmark, "USemLog.World.WriterJson.Benchmark",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter | EAutomationTestFlags::PerfFilter)
+
+bool FSLWorldWriterJsonBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace SLWorldTestHelpers;
+	using namespace SLWorldWriterJsonTest;
+	const int32 NumEntities = 10000;
+	const int32 NumFrames = 20;
+
+	TArray<TSLEntityPreviousPose<AActor>> ActorEntities;
+	const TArray<TSLEntityPreviousPose<USceneComponent>> ComponentEntities;
+	const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>> SkeletalEntities;
+	FSLWorldStateSnapshot Snapshot;
+	CreateMovedActors(NumEntities, ActorEntities, Snapshot);
+
+	const FString EpisodeId = TEXT("JsonWriterBenchmark");
+	double WriteTime = 0.0;
+	{
+		FSLWorldWriterJson Writer(FSLWorldWriterParams(0.f, 0.f, TaskId, EpisodeId));
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			Snapshot.Timestamp = Frame * 0.1f;
+			const double StartTime = FPlatformTime::Seconds();
+			Writer.Write(Snapshot, Snapshot.Changes, ActorEntities, ComponentEntities, SkeletalEntities);
+			WriteTime += FPlatformTime::Seconds() - StartTime;
+		}
+	}
+	const int64 NumBytes = IFileManager::Get().FileSize(*GetFilePath(EpisodeId));
+	FString JsonStr;
+	TestTrue(TEXT("Json file written"), FFileHelper::LoadFileToString(JsonStr, *GetFilePath(EpisodeId)));
+	IFileManager::Get().Delete(*GetFilePath(EpisodeId));
+	const TArray<FString> Docs = SplitDocuments(JsonStr);
+	TestEqual(TEXT("One document per frame"), Docs.Num(), NumFrames);
+	AddInfo(FString::Printf(TEXT("%d entities per frame: %.2f ms per frame (%lld bytes for %d frames)"),
+		NumEntities, WriteTime * 1000.0 / NumFrames, NumBytes, NumFrames));
+
+#if WITH_EDITOR
+	// Previous writer, one json object per entity serialized to a string and converted to ansi
+	double JsonObjectTime = 0.0;
+	FString LegacyStr;
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		Snapshot.Timestamp = Frame * 0.1f;
+		const double StartTime = FPlatformTime::Seconds();
+		LegacyStr = LegacySerialize(CreateLegacyDocument(Snapshot, ActorEntities));
+		FTCHARToUTF8 Utf8(*LegacyStr);
+		JsonObjectTime += FPlatformTime::Seconds() - StartTime;
+	}
+	AddInfo(FString::Printf(TEXT("%d entities per frame: previous json object writer %.2f ms per frame (without file writes)"),
+		NumEntities, JsonObjectTime * 1000.0 / NumFrames));
+
+	// Same last frame
+	if (Docs.Num() == NumFrames)
+	{
+		FString Mismatch;
+		const bool bEqual = JsonValuesEqual(Parse(Docs.Last()), Parse(LegacyStr), TEXT("$"), Mismatch);
+		TestTrue(FString::Printf(TEXT("Equals the previous serializer (first difference at %s)"), *Mismatch), bEqual);
+	}
+#endif // WITH_EDITOR
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
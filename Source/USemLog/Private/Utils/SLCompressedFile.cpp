@@ -0,0 +1,550 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "Utils/SLCompressedFile.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformFilemanager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+
+// Max number of full blocks waiting for the compression thread
+static const int32 SLMaxQueuedBlocks = 8;
+
+// Engine compression format of the codec
+FName FSLCompressedFileFormat::GetFormatName(ESLFileCompression Compression)
+{
+	switch (Compression)
+	{
+	case ESLFileCompression::LZ4:
+		return NAME_LZ4;
+	case ESLFileCompression::Zlib:
+		return NAME_Gzip;
+	default:
+		return NAME_None;
+	}
+}
+
+// Header checksum of the LZ4 frame descriptor (second byte of the xxh32 hash with seed 0)
+uint8 FSLCompressedFileFormat::GetLz4HeaderChecksum(const uint8* Descriptor, int32 Num)
+{
+	static const uint32 Prime1 = 2654435761U;
+	static const uint32 Prime2 = 2246822519U;
+	static const uint32 Prime3 = 3266489917U;
+	static const uint32 Prime4 = 668265263U;
+	static const uint32 Prime5 = 374761393U;
+	const auto RotL = [](uint32 Value, int32 Bits) { return (Value << Bits) | (Value >> (32 - Bits)); };
+	const auto Read32 = [](const uint8* Ptr) { uint32 Value; FMemory::Memcpy(&Value, Ptr, sizeof(uint32)); return Value; };
+
+	const uint8* Ptr = Descriptor;
+	const uint8* End = Descriptor + Num;
+	uint32 Hash;
+	if (Num >= 16)
+	{
+		uint32 V1 = Prime1 + Prime2;
+		uint32 V2 = Prime2;
+		uint32 V3 = 0;
+		uint32 V4 = 0 - Prime1;
+		for (; Ptr + 16 <= End; Ptr += 16)
+		{
+			V1 = RotL(V1 + Read32(Ptr) * Prime2, 13) * Prime1;
+			V2 = RotL(V2 + Read32(Ptr + 4) * Prime2, 13) * Prime1;
+			V3 = RotL(V3 + Read32(Ptr + 8) * Prime2, 13) * Prime1;
+			V4 = RotL(V4 + Read32(Ptr + 12) * Prime2, 13) * Prime1;
+		}
+		Hash = RotL(V1, 1) + RotL(V2, 7) + RotL(V3, 12) + RotL(V4, 18);
+	}
+	else
+	{
+		Hash = Prime5;
+	}
+	Hash += static_cast<uint32>(Num);
+	for (; Ptr + 4 <= End; Ptr += 4)
+	{
+		Hash = RotL(Hash + Read32(Ptr) * Prime3, 17) * Prime4;
+	}
+	for (; Ptr < End; ++Ptr)
+	{
+		Hash = RotL(Hash + *Ptr * Prime5, 11) * Prime1;
+	}
+	Hash ^= Hash >> 15;
+	Hash *= Prime2;
+	Hash ^= Hash >> 13;
+	Hash *= Prime3;
+	Hash ^= Hash >> 16;
+	return static_cast<uint8>(Hash >> 8);
+}
+
+// Ctor
+FSLCompressedFileWriter::FSLCompressedFileWriter(IFileHandle* InFileHandle, ESLFileCompression InCompression, int32 InBlockSize) :
+	FileHandle(InFileHandle),
+	Compression(InCompression),
+	FormatName(FSLCompressedFileFormat::GetFormatName(InCompression)),
+	BlockSize(FMath::Clamp(InBlockSize, 1024, FSLCompressedFileFormat::MaxBlockSize)),
+	NumQueuedBlocks(0),
+	WakeUpEvent(nullptr),
+	Thread(nullptr),
+	bStopRequested(false),
+	bFlushRequested(false),
+	bWriteFailed(false),
+	bIsStarted(false)
+{
+	CurrBlock.Reserve(BlockSize);
+}
+
+// Dtor
+FSLCompressedFileWriter::~FSLCompressedFileWriter()
+{
+	Finish();
+}
+
+// Create the compression thread
+bool FSLCompressedFileWriter::Start()
+{
+	if (bIsStarted)
+	{
+		return true;
+	}
+
+	// Every block is a self contained gzip member or LZ4 frame, so there is no file header
+	if (!FileHandle || FormatName.IsNone())
+	{
+		return false;
+	}
+	bIsStarted = true;
+
+	bStopRequested = false;
+	WakeUpEvent = FPlatformProcess::GetSynchEventFromPool();
+	Thread = FRunnableThread::Create(this, TEXT("SLCompressedFileWriter"), 0, TPri_BelowNormal);
+	if (!Thread)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s::%d Could not create the compression thread, compressing on write.."),
+			*FString(__func__), __LINE__);
+		FPlatformProcess::ReturnSynchEventToPool(WakeUpEvent);
+		WakeUpEvent = nullptr;
+	}
+	return true;
+}
+
+// Append the data, full blocks are passed to the compression thread
+bool FSLCompressedFileWriter::Write(const uint8* Data, int64 NumBytes)
+{
+	if (!bIsStarted)
+	{
+		return false;
+	}
+
+	while (NumBytes > 0)
+	{
+		const int32 NumCopied = static_cast<int32>(FMath::Min<int64>(NumBytes, BlockSize - CurrBlock.Num()));
+		CurrBlock.Append(Data, NumCopied);
+		Data += NumCopied;
+		NumBytes -= NumCopied;
+		if (CurrBlock.Num() >= BlockSize)
+		{
+			SubmitBlock();
+		}
+	}
+	return !bWriteFailed;
+}
+
+// Pass the partial block to the compression thread and flush the file once it is written
+void FSLCompressedFileWriter::Flush()
+{
+	if (!bIsStarted || CurrBlock.Num() == 0)
+	{
+		return;
+	}
+
+	SubmitBlock();
+	if (!Thread)
+	{
+		FileHandle->Flush();
+		return;
+	}
+
+	// The file handle is only used by the compression thread while it runs
+	bFlushRequested = true;
+	WakeUpEvent->Trigger();
+}
+
+// Compress and write the remaining data, stop the compression thread
+void FSLCompressedFileWriter::Finish()
+{
+	if (!bIsStarted)
+	{
+		return;
+	}
+
+	SubmitBlock();
+	if (Thread)
+	{
+		// The thread writes the queued blocks before exiting
+		Stop();
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+		FPlatformProcess::ReturnSynchEventToPool(WakeUpEvent);
+		WakeUpEvent = nullptr;
+	}
+	WriteQueuedBlocks();
+	FileHandle->Flush();
+
+	if (bWriteFailed)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s::%d Not all the compressed blocks could be written.."), *FString(__func__), __LINE__);
+	}
+	bIsStarted = false;
+}
+
+// Compress the data and save it to the given file
+bool FSLCompressedFileWriter::SaveToFile(const TArray<uint8>& Data, const FString& FilePath, ESLFileCompression InCompression)
+{
+	if (InCompression == ESLFileCompression::None)
+	{
+		return FFileHelper::SaveArrayToFile(Data, *FilePath);
+	}
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(FilePath));
+	IFileHandle* Handle = PlatformFile.OpenWrite(*FilePath);
+	if (!Handle)
+	{
+		return false;
+	}
+
+	bool bSuccess = false;
+	{
+		FSLCompressedFileWriter Writer(Handle, InCompression);
+		bSuccess = Writer.Start() && Writer.Write(Data.GetData(), Data.Num());
+		Writer.Finish();
+		bSuccess &= !Writer.bWriteFailed;
+	}
+	delete Handle;
+	return bSuccess;
+}
+
+// Compression loop
+uint32 FSLCompressedFileWriter::Run()
+{
+	while (!bStopRequested)
+	{
+		WakeUpEvent->Wait(100);
+
+		// Read the request before writing, the flushed block is queued before the request is set
+		const bool bFlush = bFlushRequested.Exchange(false);
+		WriteQueuedBlocks();
+		if (bFlush)
+		{
+			FileHandle->Flush();
+		}
+	}
+	return 0;
+}
+
+// Request the compression thread to exit
+void FSLCompressedFileWriter::Stop()
+{
+	bStopRequested = true;
+	if (WakeUpEvent)
+	{
+		WakeUpEvent->Trigger();
+	}
+}
+
+// Pass the current block to the compression thread
+void FSLCompressedFileWriter::SubmitBlock()
+{
+	if (CurrBlock.Num() == 0)
+	{
+		return;
+	}
+
+	if (!Thread)
+	{
+		bWriteFailed = !WriteBlock(CurrBlock) || bWriteFailed;
+		CurrBlock.Reset();
+		return;
+	}
+
+	// The disk is slower than the serialization, wait instead of growing the memory (this only blocks the writer thread)
+	while (NumQueuedBlocks.Load() >= SLMaxQueuedBlocks)
+	{
+		WakeUpEvent->Trigger();
+		FPlatformProcess::Sleep(0.001f);
+	}
+
+	TArray<uint8> Block;
+	Block.Reserve(BlockSize);
+	Swap(Block, CurrBlock);
+	QueuedBlocks.Enqueue(MoveTemp(Block));
+	++NumQueuedBlocks;
+	WakeUpEvent->Trigger();
+}
+
+// Compress and write the queued blocks
+void FSLCompressedFileWriter::WriteQueuedBlocks()
+{
+	TArray<uint8> Block;
+	while (QueuedBlocks.Dequeue(Block))
+	{
+		bWriteFailed = !WriteBlock(Block) || bWriteFailed;
+		--NumQueuedBlocks;
+	}
+}
+
+// Compress and write a block
+bool FSLCompressedFileWriter::WriteBlock(const TArray<uint8>& Block)
+{
+	const int32 UncompressedSize = Block.Num();
+	int32 CompressedSize = FCompression::CompressMemoryBound(FormatName, UncompressedSize);
+
+	if (Compression == ESLFileCompression::LZ4)
+	{
+		// Frame header, block size, block, end mark
+		const int32 BlockOffset = FSLCompressedFileFormat::Lz4FrameHeaderSize + sizeof(uint32);
+		CompressedBlock.SetNumUninitialized(BlockOffset + FMath::Max(CompressedSize, UncompressedSize) + sizeof(uint32), false);
+		uint8* Out = CompressedBlock.GetData();
+
+		const uint32 Magic = FSLCompressedFileFormat::Lz4FrameMagic;
+		const uint64 ContentSize = UncompressedSize;
+		FMemory::Memcpy(Out, &Magic, sizeof(uint32));
+		Out[4] = 0x68;	// Version 1, independent blocks, content size
+		Out[5] = 0x70;	// Max block size 4 MB
+		FMemory::Memcpy(Out + 6, &ContentSize, sizeof(uint64));
+		Out[14] = FSLCompressedFileFormat::GetLz4HeaderChecksum(Out + 4, 10);
+
+		// Store the block as is if it does not compress (flagged by the highest bit of the block size)
+		uint32 BlockWord;
+		if (FCompression::CompressMemory(FormatName, Out + BlockOffset, CompressedSize, Block.GetData(), UncompressedSize) &&
+			CompressedSize < UncompressedSize)
+		{
+			BlockWord = static_cast<uint32>(CompressedSize);
+		}
+		else
+		{
+			CompressedSize = UncompressedSize;
+			FMemory::Memcpy(Out + BlockOffset, Block.GetData(), UncompressedSize);
+			BlockWord = static_cast<uint32>(UncompressedSize) | 0x80000000U;
+		}
+		const uint32 EndMark = 0;
+		FMemory::Memcpy(Out + BlockOffset - sizeof(uint32), &BlockWord, sizeof(uint32));
+		FMemory::Memcpy(Out + BlockOffset + CompressedSize, &EndMark, sizeof(uint32));
+		return FileHandle->Write(Out, BlockOffset + CompressedSize + sizeof(uint32));
+	}
+
+	// The engine writes a plain 10 byte gzip header, it is replaced by the one with the member size subfield
+	const int32 EngineHeaderSize = 10;
+	const int32 ExtraSize = FSLCompressedFileFormat::GzipHeaderSize - EngineHeaderSize;
+	CompressedSize += FSLCompressedFileFormat::GzipHeaderSize;	// The bound of some engine versions does not include the gzip wrapper
+	CompressedBlock.SetNumUninitialized(ExtraSize + CompressedSize, false);
+	uint8* Out = CompressedBlock.GetData();
+	if (!FCompression::CompressMemory(FormatName, Out + ExtraSize, CompressedSize, Block.GetData(), UncompressedSize) ||
+		CompressedSize < EngineHeaderSize + FSLCompressedFileFormat::GzipTrailerSize ||
+		Out[ExtraSize] != FSLCompressedFileFormat::GzipId1 || Out[ExtraSize + 1] != FSLCompressedFileFormat::GzipId2 ||
+		Out[ExtraSize + 3] != 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s::%d Could not compress the block.."), *FString(__func__), __LINE__);
+		return false;
+	}
+
+	const uint32 MemberSize = static_cast<uint32>(ExtraSize + CompressedSize);
+	const uint16 ExtraLen = 8;
+	const uint16 SubfieldLen = sizeof(uint32);
+	Out[0] = FSLCompressedFileFormat::GzipId1;
+	Out[1] = FSLCompressedFileFormat::GzipId2;
+	Out[2] = 8;		// Deflate
+	Out[3] = 0x04;	// Extra field
+	FMemory::Memzero(Out + 4, 4);	// No modification time
+	Out[8] = 0;
+	Out[9] = 0xFF;	// Unknown OS
+	FMemory::Memcpy(Out + 10, &ExtraLen, sizeof(uint16));
+	Out[12] = 'S';
+	Out[13] = 'L';
+	FMemory::Memcpy(Out + 14, &SubfieldLen, sizeof(uint16));
+	FMemory::Memcpy(Out + 16, &MemberSize, sizeof(uint32));
+	return FileHandle->Write(Out, MemberSize);
+}
+
+
+// True if the data starts with a gzip member or a LZ4 frame
+bool FSLCompressedFileReader::IsCompressed(const uint8* Data, int64 Size)
+{
+	if (Size >= 2 && Data[0] == FSLCompressedFileFormat::GzipId1 && Data[1] == FSLCompressedFileFormat::GzipId2)
+	{
+		return true;
+	}
+	uint32 Magic = 0;
+	if (Size >= static_cast<int64>(sizeof(uint32)))
+	{
+		FMemory::Memcpy(&Magic, Data, sizeof(uint32));
+	}
+	return Magic == FSLCompressedFileFormat::Lz4FrameMagic;
+}
+
+// Decompress all the gzip members or LZ4 frames
+bool FSLCompressedFileReader::Decompress(const uint8* Data, int64 Size, TArray<uint8>& OutData)
+{
+	OutData.Reset();
+	int64 Offset = 0;
+	while (Offset < Size)
+	{
+		int64 NumRead = INDEX_NONE;
+		if (Data[Offset] == FSLCompressedFileFormat::GzipId1)
+		{
+			NumRead = DecompressGzipMember(Data + Offset, Size - Offset, OutData);
+		}
+		else if (IsCompressed(Data + Offset, Size - Offset))
+		{
+			NumRead = DecompressLz4Frame(Data + Offset, Size - Offset, OutData);
+		}
+
+		if (NumRead <= 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("%s::%d Corrupted, truncated or unsupported data at offset %lld.."),
+				*FString(__func__), __LINE__, Offset);
+			return false;
+		}
+		Offset += NumRead;
+	}
+	return true;
+}
+
+// Decompress the gzip member at the start of the data, returns its size
+int64 FSLCompressedFileReader::DecompressGzipMember(const uint8* Data, int64 Size, TArray<uint8>& OutData)
+{
+	if (Size < 10 + FSLCompressedFileFormat::GzipTrailerSize || Data[1] != FSLCompressedFileFormat::GzipId2 || Data[2] != 8)
+	{
+		return INDEX_NONE;
+	}
+
+	// Without the member size subfield the member has to span the rest of the data
+	int64 MemberSize = Size;
+	if (Data[3] & 0x04)
+	{
+		uint16 ExtraLen = 0;
+		FMemory::Memcpy(&ExtraLen, Data + 10, sizeof(uint16));
+		int64 Offset = 12;
+		while (Offset + 4 <= FMath::Min<int64>(12 + ExtraLen, Size))
+		{
+			uint16 SubfieldLen = 0;
+			FMemory::Memcpy(&SubfieldLen, Data + Offset + 2, sizeof(uint16));
+			if (Data[Offset] == 'S' && Data[Offset + 1] == 'L' && SubfieldLen == sizeof(uint32) && Offset + 8 <= Size)
+			{
+				uint32 Value = 0;
+				FMemory::Memcpy(&Value, Data + Offset + 4, sizeof(uint32));
+				MemberSize = Value;
+				break;
+			}
+			Offset += 4 + SubfieldLen;
+		}
+	}
+	if (MemberSize < 10 + FSLCompressedFileFormat::GzipTrailerSize || MemberSize > Size || MemberSize > MAX_int32)
+	{
+		return INDEX_NONE;
+	}
+
+	// The trailer ends with the uncompressed size
+	uint32 UncompressedSize = 0;
+	FMemory::Memcpy(&UncompressedSize, Data + MemberSize - sizeof(uint32), sizeof(uint32));
+	if (UncompressedSize > static_cast<uint32>(MAX_int32 - OutData.Num()))
+	{
+		return INDEX_NONE;
+	}
+	const int32 OutOffset = OutData.AddUninitialized(UncompressedSize);
+	if (!FCompression::UncompressMemory(NAME_Gzip, OutData.GetData() + OutOffset, UncompressedSize, Data, static_cast<int32>(MemberSize)))
+	{
+		return INDEX_NONE;
+	}
+	return MemberSize;
+}
+
+// Decompress the LZ4 frame at the start of the data, returns its size
+int64 FSLCompressedFileReader::DecompressLz4Frame(const uint8* Data, int64 Size, TArray<uint8>& OutData)
+{
+	const auto Read32 = [Data](int64 Offset) { uint32 Value; FMemory::Memcpy(&Value, Data + Offset, sizeof(uint32)); return Value; };
+
+	// Version 1 with the content size, the other flags only add fields to skip
+	const uint8 Flags = Size > 6 ? Data[4] : 0;
+	if ((Flags >> 6) != 1 || !(Flags & 0x08))
+	{
+		return INDEX_NONE;
+	}
+	const bool bBlockChecksum = (Flags & 0x10) != 0;
+	const bool bContentChecksum = (Flags & 0x04) != 0;
+	const int64 DescriptorEnd = (Flags & 0x01) ? 18 : 14;
+	if (Size < DescriptorEnd + 1 + static_cast<int64>(sizeof(uint32)) ||
+		Data[DescriptorEnd] != FSLCompressedFileFormat::GetLz4HeaderChecksum(Data + 4, DescriptorEnd - 4))
+	{
+		return INDEX_NONE;
+	}
+	uint64 ContentSize = 0;
+	FMemory::Memcpy(&ContentSize, Data + 6, sizeof(uint64));
+	if (ContentSize > static_cast<uint64>(MAX_int32 - OutData.Num()))
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 OutOffset = OutData.AddUninitialized(static_cast<int32>(ContentSize));
+	int64 NumOut = 0;
+	int64 Offset = DescriptorEnd + 1;
+	while (true)
+	{
+		if (Offset + static_cast<int64>(sizeof(uint32)) > Size)
+		{
+			return INDEX_NONE;
+		}
+		const uint32 BlockWord = Read32(Offset);
+		Offset += sizeof(uint32);
+		if (BlockWord == 0)
+		{
+			break;
+		}
+
+		const int64 BlockSize = BlockWord & 0x7FFFFFFFU;
+		if (Offset + BlockSize > Size)
+		{
+			return INDEX_NONE;
+		}
+		if (BlockWord & 0x80000000U)
+		{
+			if (NumOut + BlockSize > static_cast<int64>(ContentSize))
+			{
+				return INDEX_NONE;
+			}
+			FMemory::Memcpy(OutData.GetData() + OutOffset + NumOut, Data + Offset, BlockSize);
+			NumOut += BlockSize;
+		}
+		else
+		{
+			// The decompressed size of a block is only known if it is the last one of the frame
+			if (!FCompression::UncompressMemory(NAME_LZ4, OutData.GetData() + OutOffset + NumOut, static_cast<int32>(ContentSize - NumOut),
+				Data + Offset, static_cast<int32>(BlockSize)))
+			{
+				return INDEX_NONE;
+			}
+			NumOut = ContentSize;
+		}
+		Offset += BlockSize + (bBlockChecksum ? sizeof(uint32) : 0);
+	}
+	Offset += bContentChecksum ? sizeof(uint32) : 0;
+	return NumOut == static_cast<int64>(ContentSize) && Offset <= Size ? Offset : INDEX_NONE;
+}
+
+// Load the file, it is decompressed if it is a gzip or LZ4 file
+bool FSLCompressedFileReader::LoadFileToArray(TArray<uint8>& OutData, const FString& FilePath)
+{
+	TArray<uint8> FileData;
+	if (!FFileHelper::LoadFileToArray(FileData, *FilePath))
+	{
+		return false;
+	}
+	if (!IsCompressed(FileData.GetData(), FileData.Num()))
+	{
+		OutData = MoveTemp(FileData);
+		return true;
+	}
+	return Decompress(FileData.GetData(), FileData.Num(), OutData);
+}
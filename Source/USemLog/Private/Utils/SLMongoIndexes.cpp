@@ -0,0 +1,112 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "Utils/SLMongoIndexes.h"
+#include "Async/Async.h"
+
+#if SL_WITH_LIBMONGO_C
+// Create the indexes on the collection
+bool FSLMongoIndexes::Create(mongoc_collection_t* collection, const TArray<FSLMongoIndex>& Indexes)
+{
+	if (!collection || Indexes.Num() == 0)
+	{
+		return false;
+	}
+
+	bson_t index_command;
+	bson_t indexes_arr;
+	bson_error_t error;
+	char idx_str[16];
+	const char* idx_key;
+
+	bson_init(&index_command);
+	BSON_APPEND_UTF8(&index_command, "createIndexes", mongoc_collection_get_name(collection));
+	BSON_APPEND_ARRAY_BEGIN(&index_command, "indexes", &indexes_arr);
+	for (int32 Idx = 0; Idx < Indexes.Num(); ++Idx)
+	{
+		bson_t index_obj;
+		bson_t keys_obj;
+
+		bson_init(&keys_obj);
+		for (const FString& Key : Indexes[Idx].Keys)
+		{
+			BSON_APPEND_INT32(&keys_obj, TCHAR_TO_UTF8(*Key), 1);
+		}
+		char* index_name = mongoc_collection_keys_to_index_string(&keys_obj);
+
+		bson_uint32_to_string(Idx, &idx_key, idx_str, sizeof idx_str);
+		BSON_APPEND_DOCUMENT_BEGIN(&indexes_arr, idx_key, &index_obj);
+		BSON_APPEND_DOCUMENT(&index_obj, "key", &keys_obj);
+		BSON_APPEND_UTF8(&index_obj, "name", index_name);
+		if (Indexes[Idx].bUnique)
+		{
+			BSON_APPEND_BOOL(&index_obj, "unique", true);
+		}
+		bson_append_document_end(&indexes_arr, &index_obj);
+
+		bson_free(index_name);
+		bson_destroy(&keys_obj);
+	}
+	bson_append_array_end(&index_command, &indexes_arr);
+
+	const bool bSuccess = mongoc_collection_write_command_with_opts(collection, &index_command, NULL/*opts*/, NULL/*reply*/, &error);
+	if (!bSuccess)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s::%d Create indexes err.: %s"),
+			*FString(__func__), __LINE__, *FString(error.message));
+	}
+
+	bson_destroy(&index_command);
+	return bSuccess;
+}
+#endif //SL_WITH_LIBMONGO_C
+
+// Create the indexes from a background thread
+TFuture<bool> FSLMongoIndexes::CreateInBackground(const FString& ServerIp, uint16 ServerPort, const FString& DBName, const FString& CollName,
+	const TArray<FSLMongoIndex>& Indexes)
+{
+#if SL_WITH_LIBMONGO_C
+	// The mongo handles are not thread safe, the task uses its own connection
+	const FString Uri = TEXT("mongodb://") + ServerIp + TEXT(":") + FString::FromInt(ServerPort);
+	return Async(EAsyncExecution::Thread, [Uri, DBName, CollName, Indexes]()
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		bool bSuccess = false;
+
+		mongoc_init();
+		if (mongoc_client_t* client = mongoc_client_new(TCHAR_TO_UTF8(*Uri)))
+		{
+			mongoc_client_set_appname(client, TCHAR_TO_UTF8(*("SLIndexes_" + CollName)));
+			mongoc_collection_t* collection = mongoc_client_get_collection(client, TCHAR_TO_UTF8(*DBName), TCHAR_TO_UTF8(*CollName));
+			bSuccess = Create(collection, Indexes);
+			mongoc_collection_destroy(collection);
+			mongoc_client_destroy(client);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Error, TEXT("%s::%d Could not connect to %s.."), *FString(__func__), __LINE__, *Uri);
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("%s::%d Indexes of %s.%s created in background (success=%d) in [%f] seconds.."),
+			*FString(__func__), __LINE__, *DBName, *CollName, bSuccess, FPlatformTime::Seconds() - StartTime);
+
+		AsyncTask(ENamedThreads::GameThread, [DBName, CollName, bSuccess]()
+		{
+			OnIndexesCreated().Broadcast(DBName, CollName, bSuccess);
+		});
+		return bSuccess;
+	});
+#else
+	OnIndexesCreated().Broadcast(DBName, CollName, false);
+	TPromise<bool> Promise;
+	Promise.SetValue(false);
+	return Promise.GetFuture();
+#endif //SL_WITH_LIBMONGO_C
+}
+
+// Broadcast when the indexes of a collection are created
+FSLMongoIndexesCreatedSignature& FSLMongoIndexes::OnIndexesCreated()
+{
+	static FSLMongoIndexesCreatedSignature Delegate;
+	return Delegate;
+}
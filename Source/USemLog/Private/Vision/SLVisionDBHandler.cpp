@@ -3,6 +3,7 @@
 
 #include "Vision/SLVisionDBHandler.h"
 #include "SLEntitiesManager.h"
+#include "Utils/SLMongoIndexes.h"
 
 // UUtils
 #if SL_WITH_ROS_CONVERSIONS
@@ -119,6 +120,9 @@ bool FSLVisionDBHandler::Connect(const FString& DBName, const FString& CollName,
 		DropPreviousEntries(DBName, CollName);
 	}
 
+	// Index the vision collection before writing to it
+	CreateIndexes();
+
 	return true;
 #else
 	return false;
@@ -154,143 +158,20 @@ void FSLVisionDBHandler::Disconnect() const
 #endif //SL_WITH_LIBMONGO_C
 }
 
-// Create indexes on the inserted data
+// Create indexes on the vision collection, called on the empty collection so the server maintains them while logging
 void FSLVisionDBHandler::CreateIndexes() const
 {
 #if SL_WITH_LIBMONGO_C
-	bson_t* index_command;
-	bson_error_t error;
-
-	//bson_t index;
-	//bson_init(&index);
-	//BSON_APPEND_INT32(&index, "vision", 1);
-	//char* index_str = mongoc_collection_keys_to_index_string(&index);
-	bson_t idx_ts;
-	bson_init(&idx_ts);
-	BSON_APPEND_INT32(&idx_ts, "timestamp", 1);
-	char* idx_ts_str = mongoc_collection_keys_to_index_string(&idx_ts);
-
-	bson_t idx_id;
-	bson_init(&idx_id);
-	BSON_APPEND_INT32(&idx_id, "views.id", 1);
-	char* idx_id_str = mongoc_collection_keys_to_index_string(&idx_id);
-
-	bson_t idx_cls;
-	bson_init(&idx_cls);
-	BSON_APPEND_INT32(&idx_cls, "views.class", 1);
-	char* idx_cls_str = mongoc_collection_keys_to_index_string(&idx_cls);
-
-	bson_t idx_eid;
-	bson_init(&idx_eid);
-	BSON_APPEND_INT32(&idx_eid, "views.entities.id", 1);
-	char* idx_eid_str = mongoc_collection_keys_to_index_string(&idx_eid);
-
-	bson_t idx_ecls;
-	bson_init(&idx_ecls);
-	BSON_APPEND_INT32(&idx_ecls, "views.entities.class", 1);
-	char* idx_ecls_str = mongoc_collection_keys_to_index_string(&idx_ecls);
-
-	bson_t idx_skeid;
-	bson_init(&idx_skeid);
-	BSON_APPEND_INT32(&idx_skeid, "views.skel_entities.id", 1);
-	char* idx_skeid_str = mongoc_collection_keys_to_index_string(&idx_skeid);
-
-	bson_t idx_skecls;
-	bson_init(&idx_skecls);
-	BSON_APPEND_INT32(&idx_skecls, "views.skel_entities.class", 1);
-	char* idx_skecls_str = mongoc_collection_keys_to_index_string(&idx_skecls);
-
-	bson_t idx_skebcls;
-	bson_init(&idx_skebcls);
-	BSON_APPEND_INT32(&idx_skebcls, "views.skel_entities.bones.class", 1);
-	char* idx_skebcls_str = mongoc_collection_keys_to_index_string(&idx_skebcls);
-
-	index_command = BCON_NEW("createIndexes",
-		BCON_UTF8(mongoc_collection_get_name(vis_collection)),
-		"indexes",
-		"[",
-			"{",
-				"key",
-				BCON_DOCUMENT(&idx_ts),
-				"name",
-				BCON_UTF8(idx_ts_str),
-				//"unique",
-				//BCON_BOOL(true),
-			"}",
-			"{",
-				"key",
-				BCON_DOCUMENT(&idx_id),
-				"name",
-				BCON_UTF8(idx_id_str),
-				//"unique",
-				//BCON_BOOL(true),
-			"}",
-			"{",
-				"key",
-				BCON_DOCUMENT(&idx_cls),
-				"name",
-				BCON_UTF8(idx_cls_str),
-				//"unique",
-				//BCON_BOOL(true),
-			"}",
-			"{",
-				"key",
-				BCON_DOCUMENT(&idx_eid),
-				"name",
-				BCON_UTF8(idx_eid_str),
-				//"unique",
-				//BCON_BOOL(true),
-			"}",
-			"{",
-				"key",
-				BCON_DOCUMENT(&idx_ecls),
-				"name",
-				BCON_UTF8(idx_ecls_str),
-				//"unique",
-				//BCON_BOOL(true),
-			"}",
-			"{",
-				"key",
-				BCON_DOCUMENT(&idx_skeid),
-				"name",
-				BCON_UTF8(idx_skeid_str),
-				//"unique",
-				//BCON_BOOL(true),
-			"}",
-			"{",
-				"key",
-				BCON_DOCUMENT(&idx_skecls),
-				"name",
-				BCON_UTF8(idx_skecls_str),
-				//"unique",
-				//BCON_BOOL(true),
-			"}",
-			"{",
-				"key",
-				BCON_DOCUMENT(&idx_skebcls),
-				"name",
-				BCON_UTF8(idx_skebcls_str),
-				//"unique",
-				//BCON_BOOL(true),
-			"}",
-		"]");
-
-	if (!mongoc_collection_write_command_with_opts(vis_collection, index_command, NULL/*opts*/, NULL/*reply*/, &error))
-	{
-		UE_LOG(LogTemp, Error, TEXT("%s::%d Create indexes err.: %s"),
-			*FString(__func__), __LINE__, *FString(error.message));
-	}
-
-	// Clean up
-	bson_destroy(index_command);
-	bson_free(idx_ts_str);
-	bson_free(idx_id_str);
-	bson_free(idx_cls_str);
-	bson_free(idx_eid_str);
-	bson_free(idx_ecls_str);
-	bson_free(idx_skeid_str);
-	bson_free(idx_skecls_str);
-	bson_free(idx_skebcls_str);
+	TArray<FSLMongoIndex> Indexes;
+	Indexes.Emplace(FSLMongoIndex({ TEXT("timestamp") }));
+	Indexes.Emplace(FSLMongoIndex({ TEXT("views.id") }));
+	Indexes.Emplace(FSLMongoIndex({ TEXT("views.class") }));
+	Indexes.Emplace(FSLMongoIndex({ TEXT("views.entities.id") }));
+	Indexes.Emplace(FSLMongoIndex({ TEXT("views.entities.class") }));
+	Indexes.Emplace(FSLMongoIndex({ TEXT("views.skel_entities.id") }));
+	Indexes.Emplace(FSLMongoIndex({ TEXT("views.skel_entities.class") }));
+	Indexes.Emplace(FSLMongoIndex({ TEXT("views.skel_entities.bones.class") }));
+	FSLMongoIndexes::Create(vis_collection, Indexes);
 #endif //SL_WITH_LIBMONGO_C
 }
 
@@ -301,6 +182,7 @@ bool FSLVisionDBHandler::GetEpisodeData(float UpdateRate, const TMap<ASkeletalMe
 {
 	float CurrTs = 0.f;
 	float PrevTs = -BIG_NUMBER; // this to make sure the first entry is loaded every time
+	LastEntityPoses.Reset();
 
 #if SL_WITH_LIBMONGO_C
 	bson_error_t error;
@@ -332,6 +214,8 @@ bool FSLVisionDBHandler::GetEpisodeData(float UpdateRate, const TMap<ASkeletalMe
 				"timestamp", BCON_INT32(1),
 				"entities", BCON_UTF8("$entities"),
 				"skel_entities", BCON_UTF8("$skel_entities"),
+				"keyframe", BCON_INT32(1),
+				"deltas", BCON_INT32(1),
 			"}",
 		"}",
 	"]");
@@ -356,6 +240,20 @@ bool FSLVisionDBHandler::GetEpisodeData(float UpdateRate, const TMap<ASkeletalMe
 				CurrTs = bson_iter_double(&doc_iter);
 			}
 
+			// Compressed episodes store keyframes (full poses) and the quantized deltas in between
+			bson_iter_t keyframe_iter;
+			bson_iter_t keyframe_child_iter;
+			if (bson_iter_init_find(&keyframe_iter, doc, "keyframe") &&
+				bson_iter_recurse(&keyframe_iter, &keyframe_child_iter) &&
+				bson_iter_find(&keyframe_child_iter, "loc_precision"))
+			{
+				ReadKeyframeSlots(doc, bson_iter_double(&keyframe_child_iter), InSkelToPoseableMap);
+			}
+			else
+			{
+				GetDeltasData(doc, Frame);
+			}
+
 			// Accumulate entity changes in the frame until the desired update rate is reached
 			GetEntitiesData(&doc_iter, Frame.ActorPoses, Frame.VisionCameraPoses);
 
@@ -628,74 +526,136 @@ void FSLVisionDBHandler::DropPreviousEntries(const FString& DBName, const FStrin
 // Get the entities data out of the bson iterator
 bool FSLVisionDBHandler::GetEntitiesData(bson_iter_t* doc,
 	TMap<AStaticMeshActor*, FTransform>& OutEntityPoses,
-	TMap<ASLVisionCamera*, FTransform>& OutVirtualCameraPoses) const
+	TMap<ASLVisionCamera*, FTransform>& OutVirtualCameraPoses)
 {
 	// Iterate entities
 	if (bson_iter_find(doc, "entities"))
 	{
 		bson_iter_t child_iter;				// entities,
-		bson_iter_t sub_child_iter;			// id, loc, rot
+		bson_iter_t sub_child_iter;			// id, loc, rot / id, rigid_root
 		bson_iter_t sub_sub_child_iter;		// x,y,z,w (entity)
 
+		// Entities logged with their pose, and rigid children logged with the id of their group root
+		TArray<TPair<FString, FTransform>> Posed;
+		TArray<TPair<FString, FString>> Rigid;
+
 		// Check if there are any entities
 		if (bson_iter_recurse(doc, &child_iter))
 		{
-			FString Id;
-			FVector Loc;
-			FQuat Quat;
-
 			while (bson_iter_next(&child_iter))
 			{
+				// Every entity is read from scratch, missing fields are not taken from the previous entry
+				FString Id;
+				FVector Loc;
+				FQuat Quat;
+				bool bHasLoc = true;
+				bool bHasRot = true;
+
 				if (bson_iter_recurse(&child_iter, &sub_child_iter) && bson_iter_find(&sub_child_iter, "id"))
 				{
 					Id = FString(bson_iter_utf8(&sub_child_iter, NULL));
 				}
+				if (Id.IsEmpty())
+				{
+					continue;
+				}
+				if (bson_iter_recurse(&child_iter, &sub_child_iter) && bson_iter_find(&sub_child_iter, "rigid_root"))
+				{
+					Rigid.Emplace(Id, FString(bson_iter_utf8(&sub_child_iter, NULL)));
+					continue;
+				}
+
 				if (bson_iter_recurse(&child_iter, &sub_child_iter) && bson_iter_find_descendant(&sub_child_iter, "loc.x", &sub_sub_child_iter))
 				{
 					Loc.X = bson_iter_double(&sub_sub_child_iter);
 				}
+				else { bHasLoc = false; }
 				if (bson_iter_recurse(&child_iter, &sub_child_iter) && bson_iter_find_descendant(&sub_child_iter, "loc.y", &sub_sub_child_iter))
 				{
 					Loc.Y = bson_iter_double(&sub_sub_child_iter);
 				}
+				else { bHasLoc = false; }
 				if (bson_iter_recurse(&child_iter, &sub_child_iter) && bson_iter_find_descendant(&sub_child_iter, "loc.z", &sub_sub_child_iter))
 				{
 					Loc.Z = bson_iter_double(&sub_sub_child_iter);
 				}
+				else { bHasLoc = false; }
 				if (bson_iter_recurse(&child_iter, &sub_child_iter) && bson_iter_find_descendant(&sub_child_iter, "rot.x", &sub_sub_child_iter))
 				{
 					Quat.X = bson_iter_double(&sub_sub_child_iter);
 				}
+				else { bHasRot = false; }
 				if (bson_iter_recurse(&child_iter, &sub_child_iter) && bson_iter_find_descendant(&sub_child_iter, "rot.y", &sub_sub_child_iter))
 				{
 					Quat.Y = bson_iter_double(&sub_sub_child_iter);
 				}
+				else { bHasRot = false; }
 				if (bson_iter_recurse(&child_iter, &sub_child_iter) && bson_iter_find_descendant(&sub_child_iter, "rot.z", &sub_sub_child_iter))
 				{
 					Quat.Z = bson_iter_double(&sub_sub_child_iter);
 				}
+				else { bHasRot = false; }
 				if (bson_iter_recurse(&child_iter, &sub_child_iter) && bson_iter_find_descendant(&sub_child_iter, "rot.w", &sub_sub_child_iter))
 				{
 					Quat.W = bson_iter_double(&sub_sub_child_iter);
 				}
+				else { bHasRot = false; }
 
-				// Add entity
-				if (AStaticMeshActor* SMA = FSLEntitiesManager::GetInstance()->GetStaticMeshActor(Id))
+				// Skip incomplete entries instead of replaying them with a made up pose
+				if (!bHasLoc || !bHasRot)
 				{
-#if SL_WITH_ROS_CONVERSIONS
-					OutEntityPoses.Emplace(SMA, FConversions::ROSToU(FTransform(Quat, Loc)));
-#else
-					OutEntityPoses.Emplace(SMA, FTransform(Quat, Loc));
-#endif // SL_WITH_ROS_CONVERSIONS
+					UE_LOG(LogTemp, Warning, TEXT("%s::%d Entity %s has no complete pose, skipped.."),
+						*FString(__func__), __LINE__, *Id);
+					continue;
 				}
-				else if (ASLVisionCamera* VCA = FSLEntitiesManager::GetInstance()->GetVisionCameraActor(Id))
-				{					
+
 #if SL_WITH_ROS_CONVERSIONS
-					OutVirtualCameraPoses.Emplace(VCA, FConversions::ROSToU(FTransform(Quat, Loc)));
+				Posed.Emplace(Id, FConversions::ROSToU(FTransform(Quat, Loc)));
 #else
-					OutVirtualCameraPoses.Emplace(VCA, FTransform(Quat, Loc));
+				Posed.Emplace(Id, FTransform(Quat, Loc));
 #endif // SL_WITH_ROS_CONVERSIONS
-				}
+			}
+		}
+
+		// The rigid children keep their last pose relative to the last pose of their root (taken before the roots are updated)
+		TArray<TPair<FString, FTransform>> RigidRelative;
+		TArray<FString> RigidRoots;
+		for (const auto& Pair : Rigid)
+		{
+			const FTransform* ChildPose = LastEntityPoses.Find(Pair.Key);
+			const FTransform* RootPose = LastEntityPoses.Find(Pair.Value);
+			if (ChildPose && RootPose)
+			{
+				RigidRelative.Emplace(Pair.Key, ChildPose->GetRelativeTransform(*RootPose));
+				RigidRoots.Add(Pair.Value);
+			}
+			else
+			{
+				UE_LOG(LogTemp, Warning, TEXT("%s::%d Rigid entity %s or its root %s has no previous pose, skipped.."),
+					*FString(__func__), __LINE__, *Pair.Key, *Pair.Value);
+			}
+		}
+		for (const auto& Pair : Posed)
+		{
+			LastEntityPoses.Add(Pair.Key, Pair.Value);
+		}
+		for (int32 Idx = 0; Idx < RigidRelative.Num(); ++Idx)
+		{
+			const FTransform RigidPose = RigidRelative[Idx].Value * LastEntityPoses[RigidRoots[Idx]];
+			LastEntityPoses.Add(RigidRelative[Idx].Key, RigidPose);
+			Posed.Emplace(RigidRelative[Idx].Key, RigidPose);
+		}
+
+		// Add entities
+		for (const auto& Pair : Posed)
+		{
+			if (AStaticMeshActor* SMA = FSLEntitiesManager::GetInstance()->GetStaticMeshActor(Pair.Key))
+			{
+				OutEntityPoses.Emplace(SMA, Pair.Value);
+			}
+			else if (ASLVisionCamera* VCA = FSLEntitiesManager::GetInstance()->GetVisionCameraActor(Pair.Key))
+			{
+				OutVirtualCameraPoses.Emplace(VCA, Pair.Value);
 			}
 		}
 		return OutEntityPoses.Num() > 0;
@@ -805,6 +765,135 @@ bool FSLVisionDBHandler::GetSkeletalEntitiesData(bson_iter_t* doc,
 	return false;
 }
 
+// Rebuild the delta slots from a keyframe document (entities, then skeletal entities followed by their bones)
+void FSLVisionDBHandler::ReadKeyframeSlots(const bson_t* doc, double LocPrecision,
+	const TMap<ASkeletalMeshActor*, ASLVisionPoseableMeshActor*>& InSkelToPoseableMap)
+{
+	PoseDecoder.Reset(LocPrecision);
+	DeltaSlots.Reset();
+
+	// The slot base is the location as stored in the keyframe
+	auto AddSlot = [this](bson_iter_t* obj_iter) -> FSLVisionDeltaSlot&
+	{
+		bson_iter_t child_iter;
+		bson_iter_t loc_iter;
+		FVector Loc = FVector::ZeroVector;
+		if (bson_iter_recurse(obj_iter, &child_iter) && bson_iter_find_descendant(&child_iter, "loc.x", &loc_iter))
+		{
+			Loc.X = bson_iter_double(&loc_iter);
+		}
+		if (bson_iter_recurse(obj_iter, &child_iter) && bson_iter_find_descendant(&child_iter, "loc.y", &loc_iter))
+		{
+			Loc.Y = bson_iter_double(&loc_iter);
+		}
+		if (bson_iter_recurse(obj_iter, &child_iter) && bson_iter_find_descendant(&child_iter, "loc.z", &loc_iter))
+		{
+			Loc.Z = bson_iter_double(&loc_iter);
+		}
+		PoseDecoder.AddSlot(Loc);
+		return DeltaSlots.AddDefaulted_GetRef();
+	};
+
+	bson_iter_t doc_iter;
+	bson_iter_t child_iter;
+	bson_iter_t sub_child_iter;
+	if (bson_iter_init_find(&doc_iter, doc, "entities") && bson_iter_recurse(&doc_iter, &child_iter))
+	{
+		while (bson_iter_next(&child_iter))
+		{
+			FSLVisionDeltaSlot& Slot = AddSlot(&child_iter);
+			if (bson_iter_recurse(&child_iter, &sub_child_iter) && bson_iter_find(&sub_child_iter, "id"))
+			{
+				const FString Id = FString(bson_iter_utf8(&sub_child_iter, NULL));
+				Slot.Actor = FSLEntitiesManager::GetInstance()->GetStaticMeshActor(Id);
+				Slot.Camera = Slot.Actor ? nullptr : FSLEntitiesManager::GetInstance()->GetVisionCameraActor(Id);
+			}
+		}
+	}
+
+	if (bson_iter_init_find(&doc_iter, doc, "skel_entities") && bson_iter_recurse(&doc_iter, &child_iter))
+	{
+		while (bson_iter_next(&child_iter))
+		{
+			// The pose of the skeletal itself is not used, only its bones
+			AddSlot(&child_iter);
+
+			ASLVisionPoseableMeshActor* Poseable = nullptr;
+			if (bson_iter_recurse(&child_iter, &sub_child_iter) && bson_iter_find(&sub_child_iter, "id"))
+			{
+				if (ASkeletalMeshActor* SkMA = FSLEntitiesManager::GetInstance()->GetSkeletalMeshActor(FString(bson_iter_utf8(&sub_child_iter, NULL))))
+				{
+					if (ASLVisionPoseableMeshActor* const* PMA = InSkelToPoseableMap.Find(SkMA))
+					{
+						Poseable = *PMA;
+					}
+				}
+			}
+
+			bson_iter_t bones_iter;
+			bson_iter_t bones_child;
+			bson_iter_t bones_sub_child;
+			if (bson_iter_recurse(&child_iter, &bones_iter) && bson_iter_find(&bones_iter, "bones") &&
+				bson_iter_recurse(&bones_iter, &bones_child))
+			{
+				while (bson_iter_next(&bones_child))
+				{
+					FSLVisionDeltaSlot& Slot = AddSlot(&bones_child);
+					Slot.Poseable = Poseable;
+					if (bson_iter_recurse(&bones_child, &bones_sub_child) && bson_iter_find(&bones_sub_child, "name"))
+					{
+						Slot.BoneName = FName(bson_iter_utf8(&bones_sub_child, NULL));
+					}
+				}
+			}
+		}
+	}
+}
+
+// Apply the pose deltas of the document to the frame, returns false if there are no deltas
+bool FSLVisionDBHandler::GetDeltasData(const bson_t* doc, FSLVisionFrame& OutFrame)
+{
+	bson_iter_t deltas_iter;
+	if (!bson_iter_init_find(&deltas_iter, doc, "deltas") || !BSON_ITER_HOLDS_BINARY(&deltas_iter))
+	{
+		return false;
+	}
+
+	bson_subtype_t subtype;
+	uint32_t len = 0;
+	const uint8_t* data = nullptr;
+	bson_iter_binary(&deltas_iter, &subtype, &len, &data);
+
+	const bool bDecoded = PoseDecoder.Decode(data, len, [&](int32 SlotIdx, const FVector& Loc, const FQuat& Quat)
+	{
+		const FSLVisionDeltaSlot& Slot = DeltaSlots[SlotIdx];
+#if SL_WITH_ROS_CONVERSIONS
+		const FTransform Pose = FConversions::ROSToU(FTransform(Quat, Loc));
+#else
+		const FTransform Pose = FTransform(Quat, Loc);
+#endif // SL_WITH_ROS_CONVERSIONS
+		if (Slot.Actor)
+		{
+			OutFrame.ActorPoses.Emplace(Slot.Actor, Pose);
+		}
+		else if (Slot.Camera)
+		{
+			OutFrame.VisionCameraPoses.Emplace(Slot.Camera, Pose);
+		}
+		else if (Slot.Poseable)
+		{
+			OutFrame.SkeletalPoses.FindOrAdd(Slot.Poseable).Add(Slot.BoneName, Pose);
+		}
+	});
+
+	if (!bDecoded)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s::%d Could not decode the pose deltas (missing keyframe?).."),
+			*FString(__func__), __LINE__);
+	}
+	return bDecoded;
+}
+
 // Save image to gridfs, get the file oid and return true if succeeded
 bool FSLVisionDBHandler::AddToGridFs(const TArray<uint8>& InData, bson_oid_t* out_oid) const
 {
@@ -12,7 +12,7 @@
 #endif // SL_WITH_EYE_TRACKING
 
 // Default ctor
-FSLGazeDataHandler::FSLGazeDataHandler()
+FSLGazeDataHandler::FSLGazeDataHandler() : TraceState(MakeShared<FTraceState>())
 {
 	bIsInit = false;
 	bIsStarted = false;
@@ -65,6 +65,7 @@ void FSLGazeDataHandler::Start()
 				CameraManager = UGameplayStatics::GetPlayerController(World, 0)->PlayerCameraManager;
 				if(CameraManager)
 				{
+					BuildActorEntities();
 					bIsStarted = true;
 				}
 			}
@@ -84,14 +85,16 @@ void FSLGazeDataHandler::Finish()
 	{
 #if SL_WITH_EYE_TRACKING
 		GazeProxy->Stop();		
+		TraceState->bPending = false;
+		TraceState->bHit = false;
 		bIsStarted = false;
 		bIsInit = false;
 		bIsFinished = true;
-	#endif // SL_WITH_EYE_TRACKING
+#endif // SL_WITH_EYE_TRACKING
 	}
 }
 
-// Get the current gaze data, true if a raytrace hit occurs
+// Get the gaze data of the last completed trace and issue the next one, true if the trace hit an entity
 bool FSLGazeDataHandler::GetData(FSLGazeData& OutData)
 {
 	if(!bIsStarted)
@@ -99,68 +102,121 @@ bool FSLGazeDataHandler::GetData(FSLGazeData& OutData)
 		return false;
 	}
 
+#if SL_WITH_EYE_TRACKING
+	// The traces complete in the frame after they were issued, the capture uses the latest result
+	const bool bHit = TraceState->bHit;
+	if (bHit)
+	{
+		OutData = TraceState->Data;
+	}
+
+	// Avoid queuing traces if the capture runs faster than the traces complete
+	if (!TraceState->bPending)
+	{
+		IssueTrace();
+	}
+
+	// Without a trace in flight (e.g. no valid gaze direction) the result would be reported again at the next capture
+	if (!TraceState->bPending)
+	{
+		TraceState->bHit = false;
+	}
+	return bHit;
+#else
+	return false;
+#endif // SL_WITH_EYE_TRACKING
+}
+
+// Cache the entities of the annotated actors
+void FSLGazeDataHandler::BuildActorEntities()
+{
+	TraceState->ActorEntities.Empty();
+	for (const auto& Pair : FSLEntitiesManager::GetInstance()->GetObjectsSemanticData())
+	{
+		if (const AActor* Actor = Cast<AActor>(Pair.Key))
+		{
+			TraceState->ActorEntities.Add(Actor, Pair.Value);
+		}
+	}
+}
+
+// Issue the async trace
+void FSLGazeDataHandler::IssueTrace()
+{
 #if SL_WITH_EYE_TRACKING
 	FVector RelativeGazeDirection;
-	if (GazeProxy->GetRelativeGazeDirection(RelativeGazeDirection))
+	if (!GazeProxy->GetRelativeGazeDirection(RelativeGazeDirection))
 	{
-		const FVector RaycastOrigin = CameraManager->GetCameraLocation();
-		const FVector RaycastTarget =  CameraManager->GetCameraRotation().RotateVector(RaycastOrigin + RelativeGazeDirection * RayLength);
+		return;
+	}
 
-		FCollisionQueryParams TraceParam = FCollisionQueryParams(FName("EyeTraceParam"), true, CameraManager);
-		FHitResult HitResult;
+	const FVector RaycastOrigin = CameraManager->GetCameraLocation();
+	const FVector RaycastTarget = RaycastOrigin + CameraManager->GetCameraRotation().RotateVector(RelativeGazeDirection) * RayLength;
+	FCollisionQueryParams TraceParam = FCollisionQueryParams(FName("EyeTraceParam"), true, CameraManager);
 
-		// Line trace
-		if(RayRadius == 0.f)
+	// The delegate is copied into the trace data, the weak reference guards against the handler being destroyed
+	TWeakPtr<FTraceState> WeakState = TraceState;
+	FTraceDelegate TraceDelegate = FTraceDelegate::CreateLambda([WeakState](const FTraceHandle&, FTraceDatum& TraceDatum)
+	{
+		if (TSharedPtr<FTraceState> State = WeakState.Pin())
 		{
-			// TODO async might be needed since this is run in a separate thread
-			//World->AsyncLineTraceByChannel
-			if(World->LineTraceSingleByChannel(HitResult, RaycastOrigin, RaycastTarget, ECC_Pawn, TraceParam))
-			{
-				FSLEntity Entity;
-				if(FSLEntitiesManager::GetInstance()->GetEntity(HitResult.Actor.Get(), Entity))
-				{
-					OutData.SetData(RaycastOrigin, HitResult.ImpactPoint, Entity);
-					// TODO debug lines should not run on the separate thread
-					DrawDebugLine(World, RaycastOrigin, RaycastTarget, FColor::Green);
-					DrawDebugSphere(World, HitResult.ImpactPoint, 2.f, 32, FColor::Red);
-					return true;
-				}
-				else
-				{
-					// TODO debug lines should not run on the separate thread
-					DrawDebugLine(World, RaycastOrigin, RaycastTarget, FColor::Emerald);
-					return false;
-				}
-			}
+			OnTraceCompleted(TraceDatum, State.ToSharedRef());
 		}
-		else
+	});
+
+	if (RayRadius == 0.f)
+	{
+		World->AsyncLineTraceByChannel(EAsyncTraceType::Single, RaycastOrigin, RaycastTarget, ECC_Pawn,
+			TraceParam, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate);
+	}
+	else
+	{
+		World->AsyncSweepByChannel(EAsyncTraceType::Single, RaycastOrigin, RaycastTarget, FQuat::Identity, ECC_Pawn,
+			FCollisionShape::MakeSphere(RayRadius), TraceParam, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate);
+	}
+	TraceState->bPending = true;
+#endif // SL_WITH_EYE_TRACKING
+}
+
+// Trace callback, looks up the hit entity and draws the debug lines
+void FSLGazeDataHandler::OnTraceCompleted(const FTraceDatum& TraceDatum, const TSharedRef<FTraceState>& State)
+{
+	State->bPending = false;
+	State->bHit = false;
+
+	UWorld* TraceWorld = TraceDatum.PhysWorld.Get();
+	const FHitResult* HitResult = TraceDatum.OutHits.Num() > 0 ? &TraceDatum.OutHits[0] : nullptr;
+	if (!HitResult || !HitResult->bBlockingHit)
+	{
+		return;
+	}
+
+	// The weak keys do not match a new actor reusing the address of a destroyed one
+	const FSLEntity* Entity = State->ActorEntities.Find(HitResult->Actor);
+	if (!Entity)
+	{
+		FSLEntity NewEntity;
+		if (AActor* HitActor = HitResult->Actor.Get())
 		{
-			// TODO async might be needed since this is run in a separate thread
-			//World->AsyncLineTraceByChannel
-			FCollisionShape Sphere;
-			Sphere.SetSphere(RayRadius);
-			if(World->SweepSingleByChannel(HitResult,RaycastOrigin, RaycastTarget, FQuat::Identity, 
-				ECC_Pawn, Sphere, TraceParam))
+			if (FSLEntitiesManager::GetInstance()->GetEntity(HitActor, NewEntity))
 			{
-				FSLEntity Entity;
-				if(FSLEntitiesManager::GetInstance()->GetEntity(HitResult.Actor.Get(),Entity))
-				{
-					OutData.SetData(RaycastOrigin, HitResult.ImpactPoint, Entity);
-					// TODO debug lines should not run on the separate thread
-					DrawDebugLine(World, RaycastOrigin, RaycastTarget, FColor::Green);
-					DrawDebugSphere(World, HitResult.ImpactPoint, RayRadius, 32, FColor::Red);
-					return true;
-				}
-				else
-				{
-					// TODO debug lines should not run on the separate thread
-					DrawDebugLine(World, RaycastOrigin, RaycastTarget, FColor::Emerald);
-					return false;
-				}
+				Entity = &State->ActorEntities.Add(HitActor, NewEntity);
 			}
 		}
 	}
-#endif // SL_WITH_EYE_TRACKING	
-return false;
-}
 
+	if (Entity)
+	{
+		State->Data.SetData(TraceDatum.Start, HitResult->ImpactPoint, *Entity);
+		State->bHit = true;
+		if (TraceWorld)
+		{
+			DrawDebugLine(TraceWorld, TraceDatum.Start, TraceDatum.End, FColor::Green);
+			DrawDebugSphere(TraceWorld, HitResult->ImpactPoint, FMath::Max(RayRadius, 2.f), 32, FColor::Red);
+		}
+	}
+	else if (TraceWorld)
+	{
+		DrawDebugLine(TraceWorld, TraceDatum.Start, TraceDatum.End, FColor::Emerald);
+	}
+}
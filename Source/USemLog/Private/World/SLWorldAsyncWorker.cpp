@@ -7,8 +7,41 @@
 #include "World/SLWorldWriterBson.h"
 #include "World/SLWorldWriterMongoC.h"
 #include "World/SLWorldWriterMongoCxx.h"
+#include "World/SLWorldWriterBinary.h"
 #include "Tags.h"
 #include "Animation/SkeletalMeshActor.h"
+#include "Components/SkeletalMeshComponent.h"
+
+// Read the world pose of an actor
+static FORCEINLINE void GetWorldPose(const AActor* Actor, FVector& OutLoc, FQuat& OutQuat)
+{
+	OutLoc = Actor->GetActorLocation();
+	OutQuat = Actor->GetActorQuat();
+}
+
+// Read the world pose of a scene component
+static FORCEINLINE void GetWorldPose(const USceneComponent* Comp, FVector& OutLoc, FQuat& OutQuat)
+{
+	OutLoc = Comp->GetComponentLocation();
+	OutQuat = Comp->GetComponentQuat();
+}
+
+// Max time (s) to wait for the writer sinks to write their pending snapshots
+static const float SLSinkWaitTimeout = 30.f;
+
+// Name of the writer type in the telemetry
+static const TCHAR* GetWriterName(ESLWorldWriterType WriterType)
+{
+	switch (WriterType)
+	{
+	case ESLWorldWriterType::Json: return TEXT("json");
+	case ESLWorldWriterType::Bson: return TEXT("bson");
+	case ESLWorldWriterType::MongoC: return TEXT("mongoc");
+	case ESLWorldWriterType::MongoCxx: return TEXT("mongocxx");
+	case ESLWorldWriterType::Binary: return TEXT("binary");
+	default: return TEXT("writer");
+	}
+}
 
 // Constructor
 FSLWorldAsyncWorker::FSLWorldAsyncWorker()
@@ -17,17 +50,29 @@ FSLWorldAsyncWorker::FSLWorldAsyncWorker()
 	bIsInit = false;
 	bIsStarted = false;
 	bIsFinished = false;
+	bHasInvalidEntities = false;
+	bDirtyTracking = false;
+	bRigidGroups = false;
+	bIsTransformUpdateBound = false;
+	bTelemetry = false;
+	SinksIdleEvent = nullptr;
 }
 
 // Destructor
 FSLWorldAsyncWorker::~FSLWorldAsyncWorker()
 {
+	UnbindTransformUpdates();
 	Finish(true);
+	if (SinksIdleEvent)
+	{
+		FPlatformProcess::ReturnSynchEventToPool(SinksIdleEvent);
+		SinksIdleEvent = nullptr;
+	}
 }
 
 // Init writer, load items from sl mapping singleton
 void FSLWorldAsyncWorker::Init(UWorld* InWorld,
-	ESLWorldWriterType InWriterType,
+	const TArray<ESLWorldWriterType>& InWriterTypes,
 	const FSLWorldWriterParams& InParams)
 {
 	if(!bIsInit)
@@ -38,39 +83,49 @@ void FSLWorldAsyncWorker::Init(UWorld* InWorld,
 		{
 			return;
 		}
-		
-		// Cache the writer type
-		WriterType = InWriterType;
-
-		// Create the writer object
-		switch(WriterType)
-		{
-		case ESLWorldWriterType::Json:
-			Writer = MakeShareable(new FSLWorldWriterJson(InParams));
-			break;
-		case ESLWorldWriterType::Bson:
-			Writer = MakeShareable(new FSLWorldWriterBson(InParams));
-			break;
-		case ESLWorldWriterType::MongoC:
-			Writer = MakeShareable(new FSLWorldWriterMongoC(InParams));
-			break;
-		case ESLWorldWriterType::MongoCxx:
-			Writer = MakeShareable(new FSLWorldWriterMongoCxx(InParams));
-			break;
-		default:
-			Writer = MakeShareable(new FSLWorldWriterJson(InParams));
-			break;
-		}
-
-		// Writer could not be created
-		if (!Writer.IsValid() || !Writer->IsInit())
+
+		// Create the writer objects (every type once)
+		TArray<TSharedPtr<ISLWorldWriter>> Writers;
+		TArray<FString> WriterNames;
+		TArray<ESLWorldWriterType> UniqueWriterTypes;
+		for (const auto WriterType : InWriterTypes)
+		{
+			if (UniqueWriterTypes.Contains(WriterType))
+			{
+				continue;
+			}
+			UniqueWriterTypes.Add(WriterType);
+
+			// Every writer reads the snapshot buffer after the change detector
+			if (Writers.Num() >= FSLWorldStateBuffer::MaxReaders - 1)
+			{
+				UE_LOG(LogTemp, Error, TEXT("%s::%d At most %d world state writers are supported, the writer of type %d is not created.."),
+					*FString(__func__), __LINE__, FSLWorldStateBuffer::MaxReaders - 1, static_cast<int32>(WriterType));
+				continue;
+			}
+			TSharedPtr<ISLWorldWriter> NewWriter = CreateWriter(WriterType, InParams);
+			if (NewWriter.IsValid())
+			{
+				Writers.Add(NewWriter);
+				WriterNames.Add(GetWriterName(WriterType));
+			}
+			else
+			{
+				UE_LOG(LogTemp, Error, TEXT("%s::%d Could not init the world state writer of type %d, skipping.."),
+					*FString(__func__), __LINE__, static_cast<int32>(WriterType));
+			}
+		}
+
+		// No writer could be created
+		if (Writers.Num() == 0)
 		{
 			return;
 		}
 
 		// Iterate all annotated entities, ignore skeletal ones
+		FSLEntitiesManager* EntitiesManager = FSLEntitiesManager::GetInstance();
 		TArray<FSLEntity> SemanticEntities;
-		FSLEntitiesManager::GetInstance()->GetSemanticDataArray(SemanticEntities);
+		EntitiesManager->GetSemanticDataArray(SemanticEntities);
 		for (const auto& SemEntity : SemanticEntities)
 		{
 			// Take into account only objects with transform data (AActor, USceneComponents)
@@ -79,7 +134,7 @@ void FSLWorldAsyncWorker::Init(UWorld* InWorld,
 				// Continue if it is not a skeletal mesh actor
 				if (!Cast<ASkeletalMeshActor>(ObjAsActor))
 				{
-					ActorEntitites.Emplace(TSLEntityPreviousPose<AActor>(ObjAsActor, SemEntity));
+					AddEntity(ActorEntitites, ActorIdxs, ObjAsActor, SemEntity, EntitiesManager->GetEntityUtf8(ObjAsActor));
 				}
 			}
 			else if (USceneComponent* ObjAsSceneComp = Cast<USceneComponent>(SemEntity.Obj))
@@ -87,19 +142,90 @@ void FSLWorldAsyncWorker::Init(UWorld* InWorld,
 				// Continue if it is not a skeletal mesh component 
 				if (!Cast<USkeletalMeshComponent>(ObjAsSceneComp))
 				{
-					ComponentEntities.Emplace(TSLEntityPreviousPose<USceneComponent>(ObjAsSceneComp, SemEntity));
+					AddEntity(ComponentEntities, ComponentIdxs, ObjAsSceneComp, SemEntity, EntitiesManager->GetEntityUtf8(ObjAsSceneComp));
 				}
 			}
 		}
 
 		// Get the skeletal data info
 		TArray<USLSkeletalDataComponent*> SemanticSkeletalData;
-		FSLEntitiesManager::GetInstance()->GetSemanticSkeletalDataArray(SemanticSkeletalData);
+		EntitiesManager->GetSemanticSkeletalDataArray(SemanticSkeletalData);
 		for (const auto& SemSkelData : SemanticSkeletalData)
 		{
-			SkeletalEntities.Emplace(TSLEntityPreviousPose<USLSkeletalDataComponent>(
-				SemSkelData, SemSkelData->OwnerSemanticData));
+			AddEntity(SkeletalEntities, SkeletalIdxs, SemSkelData, SemSkelData->OwnerSemanticData,
+				EntitiesManager->GetSkeletalUtf8(SemSkelData));
+		}
+
+		// Entities without pre-encoded strings are converted here once
+		const auto EnsureUtf8 = [](auto& Entities)
+		{
+			for (auto& Entity : Entities)
+			{
+				if (!Entity.Utf8.IsValid())
+				{
+					Entity.Utf8 = MakeShared<FSLEntityUtf8>(Entity.Entity);
+				}
+			}
+		};
+		EnsureUtf8(ActorEntitites);
+		EnsureUtf8(ComponentEntities);
+		EnsureUtf8(SkeletalEntities);
+
+		// Preallocate the snapshot buffer
+		int32 NumBones = 0;
+		for (const auto& SkelEntity : SkeletalEntities)
+		{
+			if (SkelEntity.Obj.IsValid() && SkelEntity.Obj->SkeletalMeshParent)
+			{
+				NumBones += SkelEntity.Obj->SkeletalMeshParent->GetNumBones();
+			}
+		}
+		// Performance statistics, every writer has its own slot
+		bTelemetry = InParams.bTelemetry;
+		TelemetryTaskId = InParams.TaskId;
+		TelemetryEpisodeId = InParams.EpisodeId;
+		Telemetry.Init(WriterNames, bTelemetry);
+
+		if (Writers.Num() == 1)
+		{
+			// Detect and write from the async task
+			Writer = Writers[0];
+			SnapshotBuffer.Init(InParams.SnapshotBufferDepth,
+				ActorEntitites.Num(), ComponentEntities.Num(), SkeletalEntities.Num(), NumBones);
 		}
+		else
+		{
+			// The async task detects the changes (first reader), the sinks write them from their own threads
+			if (!SinksIdleEvent)
+			{
+				SinksIdleEvent = FPlatformProcess::GetSynchEventFromPool();
+			}
+			SnapshotBuffer.Init(InParams.SnapshotBufferDepth,
+				ActorEntitites.Num(), ComponentEntities.Num(), SkeletalEntities.Num(), NumBones, Writers.Num() + 1);
+			for (int32 Idx = 0; Idx < Writers.Num(); ++Idx)
+			{
+				Sinks.Emplace(MakeUnique<FSLWorldWriterSink>(Writers[Idx], &SnapshotBuffer, Idx + 1,
+					Telemetry.GetWriter(Idx), bTelemetry, SinksIdleEvent));
+			}
+			UpdateEntityLayout();
+		}
+
+		// Movement thresholds, checked once per snapshot for all the writers
+		ChangeDetector.Init(InParams.LinearDistanceSquared, InParams.AngularDistance);
+
+		// Attached entities moving rigidly with their group root are only marked
+		bRigidGroups = InParams.bRigidGroups;
+		if (bRigidGroups)
+		{
+			SetGroupRoots();
+		}
+
+		// Only the entities with updated transforms are read and checked
+		bDirtyTracking = InParams.bDirtyTracking;
+
+		// Entities with slower update rates are only read when due
+		ClassUpdateRates = InParams.ClassUpdateRates;
+		InitScheduler();
 
 		// Init the gaze handler
 		GazeDataHandler.Init(World);
@@ -117,6 +243,17 @@ void FSLWorldAsyncWorker::Start()
 		// Start the gaze handler
 		GazeDataHandler.Start();
 
+		if (bDirtyTracking)
+		{
+			BindTransformUpdates();
+		}
+
+		// Start the writer threads
+		for (const auto& Sink : Sinks)
+		{
+			Sink->Start();
+		}
+
 		bIsStarted = true;
 	}
 }
@@ -126,29 +263,57 @@ void FSLWorldAsyncWorker::Finish(bool bForced)
 {
 	if (!bIsFinished && (bIsStarted || bIsInit))
 	{
+		UnbindTransformUpdates();
+
 		if (!bForced)
 		{
-			// Check if mongo writer
+			// Write the snapshots captured after the last task finished
+			WritePendingSnapshots();
+
+			// Finish writer (create database indexes or flush file buffers for example)
 			if (Writer.IsValid())
 			{
-				if (WriterType == ESLWorldWriterType::MongoCxx)
+				Writer->Finish();
+			}
+
+			// The sink threads write the remaining snapshots before exiting, a stalled sink is stopped after the timeout
+			const bool bSinksDrained = WaitForSinks(SLSinkWaitTimeout);
+			for (const auto& Sink : Sinks)
+			{
+				Sink->Finish(bSinksDrained);
+				Sink->GetWriter()->Finish();
+			}
+
+			GazeDataHandler.Finish();
+
+			// The writer threads are done, the database latencies and queue statistics are complete
+			if (bTelemetry)
+			{
+				const auto CopyDatabaseStats = [](const ISLWorldWriter& InWriter, FSLWorldWriterTelemetry& OutTelemetry)
+				{
+					OutTelemetry.RoundTripLatencies = InWriter.GetRoundTripLatencies();
+					OutTelemetry.MaxQueuedBytes = InWriter.GetMaxQueuedBytes();
+					OutTelemetry.NumSpilledBytes = InWriter.GetNumSpilledBytes();
+				};
+				if (Writer.IsValid())
 				{
-					// We cannot cast dynamically if it is not an UObject
-					TSharedPtr<FSLWorldWriterMongoCxx> AsMongoCxxWriter = StaticCastSharedPtr<FSLWorldWriterMongoCxx>(Writer);
-					// Finish writer (create database indexes for example)
-					AsMongoCxxWriter->Finish();
+					CopyDatabaseStats(*Writer, *Telemetry.GetWriter(0));
 				}
-				else if (WriterType == ESLWorldWriterType::MongoC)
+				for (int32 Idx = 0; Idx < Sinks.Num(); ++Idx)
 				{
-					// We cannot cast dynamically if it is not an UObject
-					TSharedPtr<FSLWorldWriterMongoC> AsMongoCWriter = StaticCastSharedPtr<FSLWorldWriterMongoC>(Writer);
-					// Finish writer (create database indexes for example)
-					AsMongoCWriter->Finish();
+					CopyDatabaseStats(*Sinks[Idx]->GetWriter(), *Telemetry.GetWriter(Idx));
 				}
+				Telemetry.Dump(TelemetryTaskId, TelemetryEpisodeId);
 			}
+		}
 
-			GazeDataHandler.Finish();
+		// Joins the writer threads (when forced without writing the remaining snapshots)
+		for (const auto& Sink : Sinks)
+		{
+			Sink->Finish(false);
 		}
+		Sinks.Empty();
+		EntityLayout.Reset();
 		
 		bIsInit = false;
 		bIsStarted = false;
@@ -159,37 +324,879 @@ void FSLWorldAsyncWorker::Finish(bool bForced)
 // Remove all items that are semantically marked as static
 void FSLWorldAsyncWorker::RemoveStaticItems()
 {
-	// Non-skeletal actors
-	for (auto Itr(ActorEntitites.CreateIterator()); Itr; ++Itr)
+	// The writer sinks keep writing the initial snapshot with the entities it was captured with
+	// Non-skeletal actors (iterated backwards, the swapped in entities were already checked)
+	for (int32 Idx = ActorEntitites.Num() - 1; Idx >= 0; --Idx)
 	{
-		if (FTags::HasKeyValuePair(Itr->Obj.Get(), "SemLog", "Mobility", "Static"))
+		if (FTags::HasKeyValuePair(ActorEntitites[Idx].Obj.Get(), "SemLog", "Mobility", "Static"))
 		{
-			Itr.RemoveCurrent();
+			RemoveActorAt(Idx);
 		}
 	}
 	ActorEntitites.Shrink();
 
 	// Non-skeletal scene components
-	for (auto Itr(ComponentEntities.CreateIterator()); Itr; ++Itr)
+	for (int32 Idx = ComponentEntities.Num() - 1; Idx >= 0; --Idx)
 	{
-		if (FTags::HasKeyValuePair(Itr->Obj.Get(), "SemLog", "Mobility", "Static"))
+		if (FTags::HasKeyValuePair(ComponentEntities[Idx].Obj.Get(), "SemLog", "Mobility", "Static"))
 		{
-			Itr.RemoveCurrent();
+			RemoveComponentAt(Idx);
 		}
 	}
 	ComponentEntities.Shrink();
 
 	// Skeletal components are probably always movable, so we just skip that step
+
+	// The group roots refer to the entity indexes
+	if (bRigidGroups)
+	{
+		SetGroupRoots();
+	}
+	UpdateEntityLayout();
+}
+
+// Copy the current poses of the entities into the snapshot buffer (game thread), false if the buffer is full
+bool FSLWorldAsyncWorker::Capture(float Timestamp)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SLWorldCapture);
+	const double StartTime = FPlatformTime::Seconds();
+	FSLWorldStateSnapshot* Snapshot = SnapshotBuffer.BeginWrite();
+	if (!Snapshot)
+	{
+		Telemetry.AddCapture(Timestamp, FPlatformTime::Seconds() - StartTime, SnapshotBuffer.Num(), true);
+		return false;
+	}
+
+	Snapshot->Timestamp = Timestamp;
+	Snapshot->EntityLayout = EntityLayout;
+	bool bAllValid = true;
+	const bool bScheduled = Scheduler.IsActive();
+	if (bScheduled)
+	{
+		Scheduler.Advance(Timestamp);
+	}
+
+	// With rate tiers only the read entities are checked for movement
+	Snapshot->bHasDirtyIdxs = bIsTransformUpdateBound || bScheduled;
+	if (bIsTransformUpdateBound)
+	{
+		bAllValid &= CaptureDirtyPoses(ActorEntitites, DirtyActorIdxs, bIsActorDirty, CachedActorPoses, Snapshot->Actors,
+			Snapshot->DirtyActors, bScheduled ? &Scheduler.GetGroup(ESLScheduledGroup::Actors) : nullptr);
+		bAllValid &= CaptureDirtyPoses(ComponentEntities, DirtyComponentIdxs, bIsComponentDirty, CachedComponentPoses, Snapshot->Components,
+			Snapshot->DirtyComponents, bScheduled ? &Scheduler.GetGroup(ESLScheduledGroup::Components) : nullptr);
+	}
+	else if (bScheduled)
+	{
+		bAllValid &= CaptureScheduledPoses(ActorEntitites, Scheduler.GetGroup(ESLScheduledGroup::Actors),
+			CachedActorPoses, Snapshot->Actors, Snapshot->DirtyActors);
+		bAllValid &= CaptureScheduledPoses(ComponentEntities, Scheduler.GetGroup(ESLScheduledGroup::Components),
+			CachedComponentPoses, Snapshot->Components, Snapshot->DirtyComponents);
+	}
+	else
+	{
+		bAllValid &= CapturePoses(ActorEntitites, Snapshot->Actors);
+		bAllValid &= CapturePoses(ComponentEntities, Snapshot->Components);
+	}
+	if (bScheduled)
+	{
+		bAllValid &= CaptureScheduledPoses(SkeletalEntities, Scheduler.GetGroup(ESLScheduledGroup::Skeletals),
+			CachedSkeletalPoses, Snapshot->Skeletals, ReadSkeletalIdxs);
+	}
+	else
+	{
+		bAllValid &= CapturePoses(SkeletalEntities, Snapshot->Skeletals);
+	}
+	CaptureBones(*Snapshot);
+	if (!bAllValid)
+	{
+		bHasInvalidEntities = true;
+	}
+	if (bScheduled)
+	{
+		Scheduler.ClearDue();
+	}
+
+	// Gaze data is only set if the last completed trace (issued in a previous capture) hit an entity
+	Snapshot->GazeData = FSLGazeData();
+	GazeDataHandler.GetData(Snapshot->GazeData);
+
+	// Make the snapshot available to the writer
+	SnapshotBuffer.EndWrite();
+	Telemetry.AddCapture(Timestamp, FPlatformTime::Seconds() - StartTime, SnapshotBuffer.Num(), false);
+	return true;
+}
+
+// Queue a spawned actor to be logged
+void FSLWorldAsyncWorker::AddNewActorEntity(AActor* Actor)
+{
+	if (Actor)
+	{
+		PendingNewActors.Emplace(Actor);
+	}
+}
+
+// Queue the object (and the components of an actor) to be removed from logging
+void FSLWorldAsyncWorker::RemoveEntity(UObject* Obj)
+{
+	if (!Obj)
+	{
+		return;
+	}
+
+	// The object is still alive, the entities manager drops it (and the components of an actor) here
+	PendingRemovals.Add(Obj);
+	if (AActor* ObjAsActor = Cast<AActor>(Obj))
+	{
+		FSLEntitiesManager::GetInstance()->RemoveActor(ObjAsActor);
+		for (const auto& CompItr : ObjAsActor->GetComponents())
+		{
+			PendingRemovals.Add(CompItr);
+		}
+	}
+	else
+	{
+		FSLEntitiesManager::GetInstance()->RemoveEntity(Obj);
+	}
+}
+
+// Add the queued actors and remove the queued and invalid entities
+void FSLWorldAsyncWorker::UpdateEntities()
+{
+	if (!HasPendingEntityChanges())
+	{
+		return;
+	}
+
+	// The queued objects are looked up by their index, every removal is a swap-removal
+	for (const UObject* Obj : PendingRemovals)
+	{
+		if (const int32* Idx = ActorIdxs.Find(Obj))
+		{
+			RemoveActorAt(*Idx);
+		}
+		if (const int32* Idx = ComponentIdxs.Find(Obj))
+		{
+			RemoveComponentAt(*Idx);
+		}
+		if (const int32* Idx = SkeletalIdxs.Find(Obj))
+		{
+			RemoveSkeletalAt(*Idx);
+		}
+	}
+	PendingRemovals.Reset();
+
+	// Entities collected without a destroy notification are found by a scan, the manager is not aware of their removal
+	if (bHasInvalidEntities)
+	{
+		const auto RemoveInvalid = [](auto& Entities, auto RemoveAt)
+		{
+			for (int32 Idx = Entities.Num() - 1; Idx >= 0; --Idx)
+			{
+				if (!Entities[Idx].Obj.IsValid())
+				{
+					FSLEntitiesManager::GetInstance()->RemoveEntity(Entities[Idx].Entity.Obj);
+					RemoveAt(Idx);
+				}
+			}
+		};
+		RemoveInvalid(ActorEntitites, [this](int32 Idx) { RemoveActorAt(Idx); });
+		RemoveInvalid(ComponentEntities, [this](int32 Idx) { RemoveComponentAt(Idx); });
+		RemoveInvalid(SkeletalEntities, [this](int32 Idx) { RemoveSkeletalAt(Idx); });
+		bHasInvalidEntities = false;
+	}
+
+	// The new entities are appended, their first pose is always logged
+	const bool bHasNewActors = PendingNewActors.Num() > 0;
+	for (const auto& WeakActor : PendingNewActors)
+	{
+		if (AActor* Actor = WeakActor.Get())
+		{
+			AppendEntities(Actor);
+		}
+	}
+	PendingNewActors.Reset();
+
+	// The new entities are bound and assigned to their tiers
+	if (bHasNewActors)
+	{
+		if (bIsTransformUpdateBound)
+		{
+			BindTransformUpdates();
+		}
+		InitScheduler();
+	}
+	if (bRigidGroups)
+	{
+		SetGroupRoots();
+	}
+	UpdateEntityLayout();
+}
+
+// Share a copy of the entity arrays with the snapshots captured from now on
+void FSLWorldAsyncWorker::UpdateEntityLayout()
+{
+	// The snapshots pending for the sinks keep the previous layout until they are reused
+	if (Sinks.Num() > 0)
+	{
+		TSharedRef<FSLWorldEntityLayout, ESPMode::ThreadSafe> Layout = MakeShared<FSLWorldEntityLayout, ESPMode::ThreadSafe>();
+		Layout->Actors = ActorEntitites;
+		Layout->Components = ComponentEntities;
+		Layout->Skeletals = SkeletalEntities;
+		EntityLayout = Layout;
+	}
+}
+
+// Append an entity and register its index
+template<typename T>
+void FSLWorldAsyncWorker::AddEntity(TArray<TSLEntityPreviousPose<T>>& Entities, TMap<const UObject*, int32>& EntityIdxs, T* Obj,
+	const FSLEntity& Entity, TSharedPtr<const FSLEntityUtf8> Utf8)
+{
+	EntityIdxs.Add(Entity.Obj, Entities.Num());
+	Entities.Emplace(TSLEntityPreviousPose<T>(Obj, Entity));
+	Entities.Last().Utf8 = Utf8;
+}
+
+// Remove the entity at the index, the last entity takes its place and its index is updated
+template<typename T>
+void FSLWorldAsyncWorker::RemoveEntityAtSwap(TArray<TSLEntityPreviousPose<T>>& Entities, TMap<const UObject*, int32>& EntityIdxs, int32 Idx)
+{
+	EntityIdxs.Remove(Entities[Idx].Entity.Obj);
+	Entities.RemoveAtSwap(Idx, 1, false);
+	if (Entities.IsValidIndex(Idx))
+	{
+		EntityIdxs.Add(Entities[Idx].Entity.Obj, Idx);
+	}
+}
+
+// Swap-remove the actor and mirror it in the detector, the caches, the dirty flags, the delegates and the scheduler
+void FSLWorldAsyncWorker::RemoveActorAt(int32 Idx)
+{
+	const int32 LastIdx = ActorEntitites.Num() - 1;
+	RemoveEntityAtSwap(ActorEntitites, ActorIdxs, Idx);
+	ChangeDetector.RemoveActorAtSwap(Idx);
+	if (CachedActorPoses.Num() == LastIdx + 1)
+	{
+		CachedActorPoses.RemoveAtSwap(Idx);
+	}
+	if (bIsTransformUpdateBound)
+	{
+		RemoveDirtyAtSwap(bIsActorDirty, DirtyActorIdxs, Idx);
+		UnbindTransformUpdate(ActorTransformHandles[Idx]);
+		if (Idx != LastIdx)
+		{
+			UnbindTransformUpdate(ActorTransformHandles[LastIdx]);
+		}
+		ActorTransformHandles.RemoveAtSwap(Idx, 1, false);
+		if (Idx != LastIdx)
+		{
+			BindActorTransformUpdate(Idx);
+		}
+	}
+	if (Scheduler.IsActive())
+	{
+		Scheduler.RemoveAtSwap(ESLScheduledGroup::Actors, Idx);
+	}
+}
+
+// Swap-remove the component and mirror it in the detector, the caches, the dirty flags, the delegates and the scheduler
+void FSLWorldAsyncWorker::RemoveComponentAt(int32 Idx)
+{
+	const int32 LastIdx = ComponentEntities.Num() - 1;
+	RemoveEntityAtSwap(ComponentEntities, ComponentIdxs, Idx);
+	ChangeDetector.RemoveComponentAtSwap(Idx);
+	if (CachedComponentPoses.Num() == LastIdx + 1)
+	{
+		CachedComponentPoses.RemoveAtSwap(Idx);
+	}
+	if (bIsTransformUpdateBound)
+	{
+		RemoveDirtyAtSwap(bIsComponentDirty, DirtyComponentIdxs, Idx);
+		UnbindTransformUpdate(ComponentTransformHandles[Idx]);
+		if (Idx != LastIdx)
+		{
+			UnbindTransformUpdate(ComponentTransformHandles[LastIdx]);
+		}
+		ComponentTransformHandles.RemoveAtSwap(Idx, 1, false);
+		if (Idx != LastIdx)
+		{
+			BindComponentTransformUpdate(Idx);
+		}
+	}
+	if (Scheduler.IsActive())
+	{
+		Scheduler.RemoveAtSwap(ESLScheduledGroup::Components, Idx);
+	}
+}
+
+// Swap-remove the skeletal and mirror it in the detector, the caches and the scheduler
+void FSLWorldAsyncWorker::RemoveSkeletalAt(int32 Idx)
+{
+	const int32 LastIdx = SkeletalEntities.Num() - 1;
+	RemoveEntityAtSwap(SkeletalEntities, SkeletalIdxs, Idx);
+	ChangeDetector.RemoveSkeletalAtSwap(Idx);
+	if (CachedSkeletalPoses.Num() == LastIdx + 1)
+	{
+		CachedSkeletalPoses.RemoveAtSwap(Idx);
+	}
+	// The cached bones are laid out by skeletal index, they are read again at the next capture
+	CachedBoneOffsets.Reset();
+	if (Scheduler.IsActive())
+	{
+		Scheduler.RemoveAtSwap(ESLScheduledGroup::Skeletals, Idx);
+	}
+}
+
+// Swap-remove the dirty flag of the index
+void FSLWorldAsyncWorker::RemoveDirtyAtSwap(TArray<bool>& DirtyFlags, TArray<int32>& DirtyIdxs, int32 Idx)
+{
+	// The dirty list only holds the entities updated since the last capture
+	const int32 LastIdx = DirtyFlags.Num() - 1;
+	if (DirtyFlags[Idx])
+	{
+		DirtyIdxs.RemoveSingleSwap(Idx, false);
+	}
+	if (Idx != LastIdx && DirtyFlags[LastIdx])
+	{
+		const int32 DirtyPos = DirtyIdxs.Find(LastIdx);
+		if (DirtyPos != INDEX_NONE)
+		{
+			DirtyIdxs[DirtyPos] = Idx;
+		}
+	}
+	DirtyFlags.RemoveAtSwap(Idx, 1, false);
 }
 
 // Async work done here
 void FSLWorldAsyncWorker::DoWork()
 {
-	FSLGazeData GazeData;
-	GazeDataHandler.GetData(GazeData);
-	UE_LOG(LogTemp, Log, TEXT("\t\t\t%s::%d Writing at = %f;"),
-		*FString(__FUNCTION__), __LINE__, World->GetTimeSeconds());
-	Writer->Write(World->GetTimeSeconds(), ActorEntitites, ComponentEntities, SkeletalEntities, GazeData);
+	WritePendingSnapshots();
+}
+
+// Write all the pending snapshots (with several writers the changes are detected and the sinks notified)
+void FSLWorldAsyncWorker::WritePendingSnapshots()
+{
+	// New snapshots can be captured while writing, these are drained as well
+	while (FSLWorldStateSnapshot* Snapshot = SnapshotBuffer.BeginRead())
+	{
+		{
+			SCOPE_CYCLE_COUNTER(STAT_SLWorldDetect);
+			const double StartTime = FPlatformTime::Seconds();
+			ChangeDetector.Detect(*Snapshot, Snapshot->Changes);
+			Telemetry.AddDetection(FPlatformTime::Seconds() - StartTime, Snapshot->Changes.Num());
+		}
+		if (Writer.IsValid())
+		{
+			SCOPE_CYCLE_COUNTER(STAT_SLWorldSerialize);
+			const double StartTime = FPlatformTime::Seconds();
+			const int64 StartBytes = Writer->GetNumBytesWritten();
+			Writer->Write(*Snapshot, Snapshot->Changes, ActorEntitites, ComponentEntities, SkeletalEntities);
+			Telemetry.GetWriter(0)->AddFrame(FPlatformTime::Seconds() - StartTime, Writer->GetNumBytesWritten() - StartBytes, bTelemetry);
+		}
+		SnapshotBuffer.EndRead();
+
+		// The changes are computed once for all the sinks
+		for (const auto& Sink : Sinks)
+		{
+			Sink->Notify();
+		}
+	}
+}
+
+// Block until every writer sink is done with the pending snapshots, false on timeout
+bool FSLWorldAsyncWorker::WaitForSinks(float Timeout) const
+{
+	if (Sinks.Num() == 0)
+	{
+		return true;
+	}
+
+	// The sinks signal the event every time they wrote all their available snapshots
+	const double EndTime = FPlatformTime::Seconds() + Timeout;
+	while (!SnapshotBuffer.IsDrained())
+	{
+		const double RemainingTime = EndTime - FPlatformTime::Seconds();
+		if (RemainingTime <= 0.0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("%s::%d The writers did not catch up in %.1fs, %d snapshot(s) not written by the slowest writer.."),
+				*FString(__func__), __LINE__, Timeout, SnapshotBuffer.GetNumUnread());
+			return false;
+		}
+		SinksIdleEvent->Wait(FMath::Max(1, FMath::CeilToInt(RemainingTime * 1000.0)));
+	}
+	return true;
+}
+
+// Create a writer of the given type, invalid if it could not be initialized
+TSharedPtr<ISLWorldWriter> FSLWorldAsyncWorker::CreateWriter(ESLWorldWriterType InWriterType, const FSLWorldWriterParams& InParams)
+{
+	TSharedPtr<ISLWorldWriter> NewWriter;
+	switch(InWriterType)
+	{
+	case ESLWorldWriterType::Json:
+		NewWriter = MakeShareable(new FSLWorldWriterJson(InParams));
+		break;
+	case ESLWorldWriterType::Bson:
+		NewWriter = MakeShareable(new FSLWorldWriterBson(InParams));
+		break;
+	case ESLWorldWriterType::MongoC:
+		NewWriter = MakeShareable(new FSLWorldWriterMongoC(InParams));
+		break;
+	case ESLWorldWriterType::MongoCxx:
+		NewWriter = MakeShareable(new FSLWorldWriterMongoCxx(InParams));
+		break;
+	case ESLWorldWriterType::Binary:
+		NewWriter = MakeShareable(new FSLWorldWriterBinary(InParams));
+		break;
+	default:
+		NewWriter = MakeShareable(new FSLWorldWriterJson(InParams));
+		break;
+	}
+
+	if (!NewWriter.IsValid() || !NewWriter->IsInit())
+	{
+		return nullptr;
+	}
+	return NewWriter;
+}
+
+// Copy the poses of the given entities into the snapshot, returns false if any of them is invalid and not queued for removal
+template<typename T>
+bool FSLWorldAsyncWorker::CapturePoses(const TArray<TSLEntityPreviousPose<T>>& Entities, FSLPoseArrays& OutPoses) const
+{
+	bool bAllValid = true;
+	OutPoses.SetNum(Entities.Num());
+	for (int32 Idx = 0; Idx < Entities.Num(); ++Idx)
+	{
+		if (const T* Obj = Entities[Idx].Obj.Get())
+		{
+			FVector Loc;
+			FQuat Quat;
+			GetWorldPose(Obj, Loc, Quat);
+			OutPoses.Set(Idx, Loc, Quat);
+		}
+		else
+		{
+			OutPoses.SetInvalid(Idx);
+			bAllValid &= PendingRemovals.Contains(Entities[Idx].Entity.Obj);
+		}
+	}
+	return bAllValid;
+}
+
+// Read the poses of the dirty entities into the cache and copy it into the snapshot, returns false if any of them is invalid and not queued for removal
+template<typename T>
+bool FSLWorldAsyncWorker::CaptureDirtyPoses(const TArray<TSLEntityPreviousPose<T>>& Entities, TArray<int32>& DirtyIdxs,
+	TArray<bool>& DirtyFlags, FSLPoseArrays& CachedPoses, FSLPoseArrays& OutPoses, TArray<int32>& OutDirtyIdxs,
+	const FSLScheduledGroup* Group)
+{
+	// Destroyed entities which did not move are not re-read, their last pose stays in the cache
+	bool bAllValid = true;
+	DirtyIdxs.Sort();
+	OutDirtyIdxs.Reset();
+	for (const int32 Idx : DirtyIdxs)
+	{
+		// Dirty tier entities wait until they are due
+		if (Group && !Group->bIsDue[Idx])
+		{
+			continue;
+		}
+
+		DirtyFlags[Idx] = false;
+		OutDirtyIdxs.Add(Idx);
+		if (const T* Obj = Entities[Idx].Obj.Get())
+		{
+			FVector Loc;
+			FQuat Quat;
+			GetWorldPose(Obj, Loc, Quat);
+			CachedPoses.Set(Idx, Loc, Quat);
+		}
+		else
+		{
+			CachedPoses.SetInvalid(Idx);
+			bAllValid &= PendingRemovals.Contains(Entities[Idx].Entity.Obj);
+		}
+	}
+
+	OutPoses.CopyFrom(CachedPoses);
+	if (Group)
+	{
+		DirtyIdxs.RemoveAll([&DirtyFlags](int32 Idx) { return !DirtyFlags[Idx]; });
+	}
+	else
+	{
+		DirtyIdxs.Reset();
+	}
+	return bAllValid;
+}
+
+// Read the poses of the base and due tier entities into the cache and copy it into the snapshot, returns false if any of them is invalid and not queued for removal
+template<typename T>
+bool FSLWorldAsyncWorker::CaptureScheduledPoses(const TArray<TSLEntityPreviousPose<T>>& Entities, const FSLScheduledGroup& Group,
+	FSLPoseArrays& CachedPoses, FSLPoseArrays& OutPoses, TArray<int32>& OutReadIdxs)
+{
+	// Merge the two ascending index lists
+	OutReadIdxs.Reset(Group.BaseIdxs.Num() + Group.DueIdxs.Num());
+	int32 BaseItr = 0;
+	int32 DueItr = 0;
+	while (BaseItr < Group.BaseIdxs.Num() || DueItr < Group.DueIdxs.Num())
+	{
+		if (DueItr == Group.DueIdxs.Num() || (BaseItr < Group.BaseIdxs.Num() && Group.BaseIdxs[BaseItr] < Group.DueIdxs[DueItr]))
+		{
+			OutReadIdxs.Add(Group.BaseIdxs[BaseItr++]);
+		}
+		else
+		{
+			OutReadIdxs.Add(Group.DueIdxs[DueItr++]);
+		}
+	}
+
+	bool bAllValid = true;
+	for (const int32 Idx : OutReadIdxs)
+	{
+		if (const T* Obj = Entities[Idx].Obj.Get())
+		{
+			FVector Loc;
+			FQuat Quat;
+			GetWorldPose(Obj, Loc, Quat);
+			CachedPoses.Set(Idx, Loc, Quat);
+		}
+		else
+		{
+			CachedPoses.SetInvalid(Idx);
+			bAllValid &= PendingRemovals.Contains(Entities[Idx].Entity.Obj);
+		}
+	}
+
+	OutPoses.CopyFrom(CachedPoses);
+	return bAllValid;
+}
+
+// Append the annotated actor, components and skeletals of the actor to the entity arrays
+void FSLWorldAsyncWorker::AppendEntities(AActor* Actor)
+{
+	// Register the actor with its current tags
+	FSLEntitiesManager* EntitiesManager = FSLEntitiesManager::GetInstance();
+	if (!EntitiesManager->AddActor(Actor))
+	{
+		return;
+	}
+
+	// Same selection as at init, skeletal meshes are logged through their skeletal data components
+	if (const FSLEntity* Entity = EntitiesManager->GetEntityPtr(Actor))
+	{
+		if (!Cast<ASkeletalMeshActor>(Actor))
+		{
+			AddEntity(ActorEntitites, ActorIdxs, Actor, *Entity, EntitiesManager->GetEntityUtf8(Actor));
+		}
+	}
+	for (const auto& CompItr : Actor->GetComponents())
+	{
+		if (USLSkeletalDataComponent* AsSkelData = Cast<USLSkeletalDataComponent>(CompItr))
+		{
+			if (TSharedPtr<const FSLEntityUtf8> SkelUtf8 = EntitiesManager->GetSkeletalUtf8(AsSkelData))
+			{
+				AddEntity(SkeletalEntities, SkeletalIdxs, AsSkelData, AsSkelData->OwnerSemanticData, SkelUtf8);
+			}
+		}
+		else if (USceneComponent* AsSceneComp = Cast<USceneComponent>(CompItr))
+		{
+			const FSLEntity* Entity = EntitiesManager->GetEntityPtr(AsSceneComp);
+			if (Entity && !Cast<USkeletalMeshComponent>(AsSceneComp))
+			{
+				AddEntity(ComponentEntities, ComponentIdxs, AsSceneComp, *Entity, EntitiesManager->GetEntityUtf8(AsSceneComp));
+			}
+		}
+	}
+}
+
+// Get the update rate tier of the entity from its tags (SemLog;UpdateRate,<s>;) or its class
+float FSLWorldAsyncWorker::GetEntityUpdateRate(const FSLEntity& Entity) const
+{
+	const FString TagRate = FTags::GetValue(Entity.Obj, "SemLog", "UpdateRate");
+	if (!TagRate.IsEmpty())
+	{
+		return FCString::Atof(*TagRate);
+	}
+	if (const float* ClassRate = ClassUpdateRates.Find(Entity.Class))
+	{
+		return *ClassRate;
+	}
+	return 0.f;
+}
+
+// Assign the entities to their update rate tiers, the next capture reads every entity
+void FSLWorldAsyncWorker::InitScheduler()
+{
+	const auto GetRates = [this](const auto& Entities, TArray<float>& OutRates)
+	{
+		OutRates.Reset(Entities.Num());
+		for (const auto& Entity : Entities)
+		{
+			OutRates.Add(GetEntityUpdateRate(Entity.Entity));
+		}
+	};
+	TArray<float> ActorRates;
+	TArray<float> ComponentRates;
+	TArray<float> SkeletalRates;
+	GetRates(ActorEntitites, ActorRates);
+	GetRates(ComponentEntities, ComponentRates);
+	GetRates(SkeletalEntities, SkeletalRates);
+	Scheduler.Init(ActorRates, ComponentRates, SkeletalRates);
+
+	if (Scheduler.IsActive())
+	{
+		CachedActorPoses.SetNum(ActorEntitites.Num());
+		CachedComponentPoses.SetNum(ComponentEntities.Num());
+		CachedSkeletalPoses.SetNum(SkeletalEntities.Num());
+		CachedBones.SetNum(0);
+		CachedBoneOffsets.Reset();
+	}
+}
+
+// Pass the topmost logged attachment ancestors of the actors and components to the change detector
+void FSLWorldAsyncWorker::SetGroupRoots()
+{
+	const auto MakeRoot = [](int32 Idx, bool bIsComponent)
+	{
+		FSLGroupRoot Root;
+		Root.Idx = Idx;
+		Root.bIsComponent = bIsComponent;
+		return Root;
+	};
+
+	// The actors are represented by their root components in the attachment hierarchy
+	TMap<const USceneComponent*, FSLGroupRoot> LoggedComponents;
+	for (int32 Idx = 0; Idx < ActorEntitites.Num(); ++Idx)
+	{
+		if (const AActor* Actor = ActorEntitites[Idx].Obj.Get())
+		{
+			if (const USceneComponent* RootComp = Actor->GetRootComponent())
+			{
+				LoggedComponents.Add(RootComp, MakeRoot(Idx, false));
+			}
+		}
+	}
+	for (int32 Idx = 0; Idx < ComponentEntities.Num(); ++Idx)
+	{
+		if (const USceneComponent* Comp = ComponentEntities[Idx].Obj.Get())
+		{
+			LoggedComponents.Add(Comp, MakeRoot(Idx, true));
+		}
+	}
+
+	// The topmost logged ancestor is the root of the group
+	const auto FindGroupRoot = [&LoggedComponents](const USceneComponent* Comp)
+	{
+		FSLGroupRoot GroupRoot;
+		for (const USceneComponent* Parent = Comp ? Comp->GetAttachParent() : nullptr; Parent; Parent = Parent->GetAttachParent())
+		{
+			if (const FSLGroupRoot* LoggedRoot = LoggedComponents.Find(Parent))
+			{
+				GroupRoot = *LoggedRoot;
+			}
+		}
+		return GroupRoot;
+	};
+
+	TArray<FSLGroupRoot> ActorRoots;
+	ActorRoots.Reserve(ActorEntitites.Num());
+	for (const auto& ActorEntity : ActorEntitites)
+	{
+		const AActor* Actor = ActorEntity.Obj.Get();
+		ActorRoots.Add(FindGroupRoot(Actor ? Actor->GetRootComponent() : nullptr));
+	}
+
+	TArray<FSLGroupRoot> ComponentRoots;
+	ComponentRoots.Reserve(ComponentEntities.Num());
+	for (const auto& ComponentEntity : ComponentEntities)
+	{
+		ComponentRoots.Add(FindGroupRoot(ComponentEntity.Obj.Get()));
+	}
+
+	ChangeDetector.SetGroupRoots(ActorRoots, ComponentRoots);
+}
+
+// Subscribe to the transform updates of the actors and components, every entity is marked as dirty
+void FSLWorldAsyncWorker::BindTransformUpdates()
+{
+	UnbindTransformUpdates();
+
+	// The cache is re-read completely
+	CachedActorPoses.SetNum(ActorEntitites.Num());
+	bIsActorDirty.Init(true, ActorEntitites.Num());
+	DirtyActorIdxs.Reset(ActorEntitites.Num());
+	ActorTransformHandles.SetNum(ActorEntitites.Num());
+	for (int32 Idx = 0; Idx < ActorEntitites.Num(); ++Idx)
+	{
+		DirtyActorIdxs.Add(Idx);
+		BindActorTransformUpdate(Idx);
+	}
+
+	CachedComponentPoses.SetNum(ComponentEntities.Num());
+	bIsComponentDirty.Init(true, ComponentEntities.Num());
+	DirtyComponentIdxs.Reset(ComponentEntities.Num());
+	ComponentTransformHandles.SetNum(ComponentEntities.Num());
+	for (int32 Idx = 0; Idx < ComponentEntities.Num(); ++Idx)
+	{
+		DirtyComponentIdxs.Add(Idx);
+		BindComponentTransformUpdate(Idx);
+	}
+	bIsTransformUpdateBound = true;
+}
+
+// Unsubscribe from the transform updates
+void FSLWorldAsyncWorker::UnbindTransformUpdates()
+{
+	for (const auto& Handle : ActorTransformHandles)
+	{
+		UnbindTransformUpdate(Handle);
+	}
+	for (const auto& Handle : ComponentTransformHandles)
+	{
+		UnbindTransformUpdate(Handle);
+	}
+	ActorTransformHandles.Empty();
+	ComponentTransformHandles.Empty();
+	bIsTransformUpdateBound = false;
+}
+
+// Subscribe to the transform updates of the root component of the actor at the index
+void FSLWorldAsyncWorker::BindActorTransformUpdate(int32 Idx)
+{
+	ActorTransformHandles[Idx] = TPair<TWeakObjectPtr<USceneComponent>, FDelegateHandle>();
+	if (AActor* Actor = ActorEntitites[Idx].Obj.Get())
+	{
+		if (USceneComponent* Root = Actor->GetRootComponent())
+		{
+			ActorTransformHandles[Idx] = TPair<TWeakObjectPtr<USceneComponent>, FDelegateHandle>(Root,
+				Root->TransformUpdated.AddRaw(this, &FSLWorldAsyncWorker::OnActorTransformUpdated, Idx));
+		}
+	}
+}
+
+// Subscribe to the transform updates of the component at the index
+void FSLWorldAsyncWorker::BindComponentTransformUpdate(int32 Idx)
+{
+	ComponentTransformHandles[Idx] = TPair<TWeakObjectPtr<USceneComponent>, FDelegateHandle>();
+	if (USceneComponent* Comp = ComponentEntities[Idx].Obj.Get())
+	{
+		ComponentTransformHandles[Idx] = TPair<TWeakObjectPtr<USceneComponent>, FDelegateHandle>(Comp,
+			Comp->TransformUpdated.AddRaw(this, &FSLWorldAsyncWorker::OnComponentTransformUpdated, Idx));
+	}
+}
+
+// Remove the transform update delegate
+void FSLWorldAsyncWorker::UnbindTransformUpdate(const TPair<TWeakObjectPtr<USceneComponent>, FDelegateHandle>& Handle)
+{
+	if (USceneComponent* Comp = Handle.Key.Get())
+	{
+		Comp->TransformUpdated.Remove(Handle.Value);
+	}
+}
+
+// Mark the actor as dirty
+void FSLWorldAsyncWorker::OnActorTransformUpdated(USceneComponent* UpdatedComponent,
+	EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport, int32 Idx)
+{
+	if (!bIsActorDirty[Idx])
+	{
+		bIsActorDirty[Idx] = true;
+		DirtyActorIdxs.Add(Idx);
+	}
+}
+
+// Mark the component as dirty
+void FSLWorldAsyncWorker::OnComponentTransformUpdated(USceneComponent* UpdatedComponent,
+	EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport, int32 Idx)
+{
+	if (!bIsComponentDirty[Idx])
+	{
+		bIsComponentDirty[Idx] = true;
+		DirtyComponentIdxs.Add(Idx);
+	}
+}
+
+// Copy the bone poses of the skeletal entities into the snapshot
+void FSLWorldAsyncWorker::CaptureBones(FSLWorldStateSnapshot& OutSnapshot)
+{
+	const bool bScheduled = Scheduler.IsActive();
+	const FSLScheduledGroup& SkelGroup = Scheduler.GetGroup(ESLScheduledGroup::Skeletals);
+
+	OutSnapshot.BoneOffsets.SetNumUninitialized(SkeletalEntities.Num() + 1, false);
+	OutSnapshot.BoneNames.Reset();
+	OutSnapshot.Bones.SetNum(0);
+
+	int32 BoneIdx = 0;
+	for (int32 SkelIdx = 0; SkelIdx < SkeletalEntities.Num(); ++SkelIdx)
+	{
+		OutSnapshot.BoneOffsets[SkelIdx] = BoneIdx;
+		if (!OutSnapshot.Skeletals.Valid[SkelIdx])
+		{
+			continue;
+		}
+
+		USLSkeletalDataComponent* SkelData = SkeletalEntities[SkelIdx].Obj.Get();
+		USkeletalMeshComponent* SkelComp = SkelData ? SkelData->SkeletalMeshParent : nullptr;
+		if (!SkelComp)
+		{
+			continue;
+		}
+
+		// Tier skeletals which are not due keep the bones of their last read
+		if (bScheduled && !SkelGroup.bIsDue[SkelIdx] && CachedBoneOffsets.IsValidIndex(SkelIdx + 1))
+		{
+			const int32 CachedFirst = CachedBoneOffsets[SkelIdx];
+			const int32 NumCached = CachedBoneOffsets[SkelIdx + 1] - CachedFirst;
+			if (NumCached > 0 && NumCached == SkelData->GetCachedBoneNames().Num())
+			{
+				OutSnapshot.BoneNames.Append(SkelData->GetCachedBoneNames());
+				OutSnapshot.Bones.SetNum(BoneIdx + NumCached);
+				for (int32 Idx = 0; Idx < NumCached; ++Idx, ++BoneIdx)
+				{
+					OutSnapshot.Bones.Set(BoneIdx, CachedBones.GetLoc(CachedFirst + Idx), CachedBones.GetQuat(CachedFirst + Idx));
+				}
+				continue;
+			}
+		}
+
+		// The names are resolved once, re-cache if the mesh changed
+		const int32 NumBones = SkelComp->GetNumBones();
+		if (SkelData->GetCachedBoneNames().Num() != NumBones)
+		{
+			SkelData->CacheBoneNames();
+		}
+		OutSnapshot.BoneNames.Append(SkelData->GetCachedBoneNames());
+		OutSnapshot.Bones.SetNum(BoneIdx + NumBones);
+
+		const FTransform& CompToWorld = SkelComp->GetComponentTransform();
+		const TArray<FTransform>& CSTransforms = SkelComp->GetComponentSpaceTransforms();
+		if (CSTransforms.Num() == NumBones && !SkelComp->MasterPoseComponent.IsValid())
+		{
+			// Read all the bones in one pass from the component space transforms
+			for (int32 Idx = 0; Idx < NumBones; ++Idx, ++BoneIdx)
+			{
+				const FTransform BoneToWorld = CSTransforms[Idx] * CompToWorld;
+				OutSnapshot.Bones.Set(BoneIdx, BoneToWorld.GetLocation(), BoneToWorld.GetRotation());
+			}
+		}
+		else
+		{
+			// The bone transforms are owned by the master pose component (or not yet evaluated)
+			for (int32 Idx = 0; Idx < NumBones; ++Idx, ++BoneIdx)
+			{
+				const FTransform BoneToWorld = SkelComp->GetBoneTransform(Idx, CompToWorld);
+				OutSnapshot.Bones.Set(BoneIdx, BoneToWorld.GetLocation(), BoneToWorld.GetRotation());
+			}
+		}
+	}
+	OutSnapshot.BoneOffsets[SkeletalEntities.Num()] = BoneIdx;
+
+	// The bones of the skeletals which are not due at the next capture are copied from here
+	if (bScheduled)
+	{
+		CachedBones.CopyFrom(OutSnapshot.Bones);
+		CachedBoneOffsets = OutSnapshot.BoneOffsets;
+	}
 }
 
 // Needed by the engine API
@@ -0,0 +1,407 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "World/SLWorldChangeDetector.h"
+#include "Algo/BinarySearch.h"
+
+// Add or remove entries to match the given number, new entries are always logged at the next check
+void FSLPreviousPoses::SetNum(int32 InNum)
+{
+	const int32 OldNum = Num();
+	if (InNum < OldNum)
+	{
+		Poses.SetNum(InNum);
+		Times.SetNum(InNum, false);
+		return;
+	}
+
+	Poses.Reserve(InNum);
+	for (int32 Idx = OldNum; Idx < InNum; ++Idx)
+	{
+		// The far away location guarantees the first check reports a movement
+		Poses.Add(FVector(BIG_NUMBER), FQuat::Identity);
+		Times.Add(-1.f);
+	}
+}
+
+// Remove the entry of the given index, the last entry takes its place
+void FSLPreviousPoses::RemoveAtSwap(int32 Idx)
+{
+	if (Times.IsValidIndex(Idx))
+	{
+		Poses.RemoveAtSwap(Idx);
+		Times.RemoveAtSwap(Idx, 1, false);
+	}
+}
+
+// Copy an entry from another group
+void FSLPreviousPoses::CopyEntry(const FSLPreviousPoses& Other, int32 OtherIdx, int32 Idx)
+{
+	Poses.Set(Idx, Other.Poses.GetLoc(OtherIdx), Other.Poses.GetQuat(OtherIdx));
+	Times[Idx] = Other.Times[OtherIdx];
+}
+
+// Default ctor
+FSLWorldChangeDetector::FSLWorldChangeDetector() : LinDistSqMin(0.f), AngDistMin(0.f), QuatDotSqMin(1.f), bHasGroupRoots(false)
+{
+}
+
+// Set the movement thresholds
+void FSLWorldChangeDetector::Init(float InLinDistSqMin, float InAngDistMin)
+{
+	LinDistSqMin = InLinDistSqMin;
+	AngDistMin = InAngDistMin;
+
+	// AngularDistance = acos(2 * dot^2 - 1) > AngDistMin  <=>  dot^2 < (1 + cos(AngDistMin)) / 2
+	QuatDotSqMin = 0.5f * (1.f + FMath::Cos(FMath::Clamp(AngDistMin, 0.f, PI)));
+
+	Reset();
+}
+
+// Forget the previous poses, every valid entity is reported as moved at the next check
+void FSLWorldChangeDetector::Reset()
+{
+	PrevActors.SetNum(0);
+	PrevComponents.SetNum(0);
+	PrevSkeletals.SetNum(0);
+	PrevBones.SetNum(0);
+	PrevBoneOffsets.Reset();
+	PrevBoneRanges.Reset();
+}
+
+// Set the attachment group roots of the actors and components
+void FSLWorldChangeDetector::SetGroupRoots(const TArray<FSLGroupRoot>& InActorRoots, const TArray<FSLGroupRoot>& InComponentRoots)
+{
+	ActorRoots = InActorRoots;
+	ComponentRoots = InComponentRoots;
+	const auto IsSet = [](const FSLGroupRoot& Root) { return Root.IsSet(); };
+	bHasGroupRoots = ActorRoots.ContainsByPredicate(IsSet) || ComponentRoots.ContainsByPredicate(IsSet);
+}
+
+// Keep the previous poses in sync with the entity arrays when a skeletal entity is swap-removed,
+// only the bone ranges are swapped, the bones are moved to the new layout at the next check
+void FSLWorldChangeDetector::RemoveSkeletalAtSwap(int32 Idx)
+{
+	PrevSkeletals.RemoveAtSwap(Idx);
+	if (PrevBoneRanges.IsValidIndex(Idx))
+	{
+		PrevBoneRanges.RemoveAtSwap(Idx, 1, false);
+	}
+	PrevBoneOffsets.Reset();
+}
+
+// Compute the moved entities of the snapshot and store their poses as the last logged ones
+void FSLWorldChangeDetector::Detect(const FSLWorldStateSnapshot& Snapshot, FSLWorldStateChanges& OutChanges)
+{
+	OutChanges.Reset();
+	// The untouched entities did not move
+	const bool bUseDirtyIdxs = Snapshot.bHasDirtyIdxs;
+
+	// The rigid check needs the previous poses of the moved entities, these are updated afterwards
+	const bool bRigidCheck = bHasGroupRoots &&
+		ActorRoots.Num() == Snapshot.Actors.Num() && ComponentRoots.Num() == Snapshot.Components.Num();
+	DetectGroup(Snapshot.Actors, Snapshot.Timestamp, PrevActors, OutChanges.Actors,
+		bUseDirtyIdxs ? &Snapshot.DirtyActors : nullptr, !bRigidCheck);
+	DetectGroup(Snapshot.Components, Snapshot.Timestamp, PrevComponents, OutChanges.Components,
+		bUseDirtyIdxs ? &Snapshot.DirtyComponents : nullptr, !bRigidCheck);
+	if (bRigidCheck)
+	{
+		DetectRigidChildren(Snapshot, OutChanges);
+	}
+	DetectSkeletals(Snapshot, OutChanges);
+}
+
+// Append the indexes of the valid poses that moved more than the thresholds (vectorized, does not update the previous poses)
+void FSLWorldChangeDetector::FindMoved(const FSLPoseArrays& Poses, const FSLPoseArrays& PrevPoses,
+	float LinDistSqMin, float QuatDotSqMin, TArray<int32>& OutIdxs)
+{
+	const int32 Num = Poses.Num();
+	const float* LX = Poses.LocX.GetData();
+	const float* LY = Poses.LocY.GetData();
+	const float* LZ = Poses.LocZ.GetData();
+	const float* QX = Poses.QuatX.GetData();
+	const float* QY = Poses.QuatY.GetData();
+	const float* QZ = Poses.QuatZ.GetData();
+	const float* QW = Poses.QuatW.GetData();
+	const float* PLX = PrevPoses.LocX.GetData();
+	const float* PLY = PrevPoses.LocY.GetData();
+	const float* PLZ = PrevPoses.LocZ.GetData();
+	const float* PQX = PrevPoses.QuatX.GetData();
+	const float* PQY = PrevPoses.QuatY.GetData();
+	const float* PQZ = PrevPoses.QuatZ.GetData();
+	const float* PQW = PrevPoses.QuatW.GetData();
+	const bool* Valid = Poses.Valid.GetData();
+
+	const VectorRegister LinMin = VectorLoadFloat1(&LinDistSqMin);
+	const VectorRegister DotSqMin = VectorLoadFloat1(&QuatDotSqMin);
+
+	// Four entities per iteration
+	int32 Idx = 0;
+	for (; Idx + 4 <= Num; Idx += 4)
+	{
+		const VectorRegister DX = VectorSubtract(VectorLoad(LX + Idx), VectorLoad(PLX + Idx));
+		const VectorRegister DY = VectorSubtract(VectorLoad(LY + Idx), VectorLoad(PLY + Idx));
+		const VectorRegister DZ = VectorSubtract(VectorLoad(LZ + Idx), VectorLoad(PLZ + Idx));
+		VectorRegister DistSq = VectorMultiply(DX, DX);
+		DistSq = VectorMultiplyAdd(DY, DY, DistSq);
+		DistSq = VectorMultiplyAdd(DZ, DZ, DistSq);
+
+		VectorRegister Dot = VectorMultiply(VectorLoad(QX + Idx), VectorLoad(PQX + Idx));
+		Dot = VectorMultiplyAdd(VectorLoad(QY + Idx), VectorLoad(PQY + Idx), Dot);
+		Dot = VectorMultiplyAdd(VectorLoad(QZ + Idx), VectorLoad(PQZ + Idx), Dot);
+		Dot = VectorMultiplyAdd(VectorLoad(QW + Idx), VectorLoad(PQW + Idx), Dot);
+
+		const VectorRegister Moved = VectorBitwiseOr(
+			VectorCompareGT(DistSq, LinMin),
+			VectorCompareGT(DotSqMin, VectorMultiply(Dot, Dot)));
+
+		// One bit per moved lane
+		uint32 Mask = static_cast<uint32>(VectorMaskBits(Moved));
+		while (Mask)
+		{
+			const int32 MovedIdx = Idx + static_cast<int32>(FMath::CountTrailingZeros(Mask));
+			if (Valid[MovedIdx])
+			{
+				OutIdxs.Add(MovedIdx);
+			}
+			Mask &= Mask - 1;
+		}
+	}
+
+	// Remaining entities
+	for (; Idx < Num; ++Idx)
+	{
+		if (Valid[Idx])
+		{
+			const float DX = LX[Idx] - PLX[Idx];
+			const float DY = LY[Idx] - PLY[Idx];
+			const float DZ = LZ[Idx] - PLZ[Idx];
+			const float Dot = QX[Idx] * PQX[Idx] + QY[Idx] * PQY[Idx] + QZ[Idx] * PQZ[Idx] + QW[Idx] * PQW[Idx];
+			if (DX * DX + DY * DY + DZ * DZ > LinDistSqMin || Dot * Dot < QuatDotSqMin)
+			{
+				OutIdxs.Add(Idx);
+			}
+		}
+	}
+}
+
+// Check a group of entities and update the previous poses of the moved ones
+void FSLWorldChangeDetector::DetectGroup(const FSLPoseArrays& Poses, float Time, FSLPreviousPoses& Prev, TArray<int32>& OutIdxs,
+	const TArray<int32>* CandidateIdxs, bool bUpdatePrevious) const
+{
+	// New entities are appended, if entities were removed without notice all are logged again
+	if (Prev.Num() > Poses.Num())
+	{
+		Prev.SetNum(0);
+	}
+	if (Prev.Num() < Poses.Num())
+	{
+		Prev.SetNum(Poses.Num());
+	}
+
+	if (CandidateIdxs)
+	{
+		FindMovedCandidates(Poses, Prev.Poses, *CandidateIdxs, OutIdxs);
+	}
+	else
+	{
+		FindMoved(Poses, Prev.Poses, LinDistSqMin, QuatDotSqMin, OutIdxs);
+	}
+
+	if (bUpdatePrevious)
+	{
+		for (const int32 Idx : OutIdxs)
+		{
+			UpdatePrevious(Poses, Idx, Time, Prev);
+		}
+	}
+}
+
+// Move the children which kept their pose relative to their moved group root from the moved to the rigid lists
+void FSLWorldChangeDetector::DetectRigidChildren(const FSLWorldStateSnapshot& Snapshot, FSLWorldStateChanges& OutChanges)
+{
+	RigidActorPoses.Reset();
+	RigidComponentPoses.Reset();
+	FindRigid(Snapshot.Actors, PrevActors, ActorRoots, OutChanges.Actors, Snapshot, OutChanges,
+		OutChanges.RigidActors, OutChanges.RigidActorRoots, RigidActorPoses);
+	FindRigid(Snapshot.Components, PrevComponents, ComponentRoots, OutChanges.Components, Snapshot, OutChanges,
+		OutChanges.RigidComponents, OutChanges.RigidComponentRoots, RigidComponentPoses);
+
+	// The roots themselves are never rigid, so the moved lists are only compacted after the checks
+	const auto RemoveRigid = [](TArray<int32>& MovedIdxs, const TArray<int32>& RigidIdxs)
+	{
+		int32 RigidItr = 0;
+		int32 NumKept = 0;
+		for (const int32 Idx : MovedIdxs)
+		{
+			if (RigidItr < RigidIdxs.Num() && RigidIdxs[RigidItr] == Idx)
+			{
+				RigidItr++;
+				continue;
+			}
+			MovedIdxs[NumKept++] = Idx;
+		}
+		MovedIdxs.SetNum(NumKept, false);
+	};
+	RemoveRigid(OutChanges.Actors, OutChanges.RigidActors);
+	RemoveRigid(OutChanges.Components, OutChanges.RigidComponents);
+
+	// The rigid children keep the pose the readers reconstruct, so the errors do not accumulate
+	const float Time = Snapshot.Timestamp;
+	for (const int32 Idx : OutChanges.Actors)
+	{
+		UpdatePrevious(Snapshot.Actors, Idx, Time, PrevActors);
+	}
+	for (const int32 Idx : OutChanges.Components)
+	{
+		UpdatePrevious(Snapshot.Components, Idx, Time, PrevComponents);
+	}
+	for (int32 ItrIdx = 0; ItrIdx < OutChanges.RigidActors.Num(); ++ItrIdx)
+	{
+		const int32 Idx = OutChanges.RigidActors[ItrIdx];
+		PrevActors.Poses.Set(Idx, RigidActorPoses[ItrIdx].GetLocation(), RigidActorPoses[ItrIdx].GetRotation());
+		PrevActors.Times[Idx] = Time;
+	}
+	for (int32 ItrIdx = 0; ItrIdx < OutChanges.RigidComponents.Num(); ++ItrIdx)
+	{
+		const int32 Idx = OutChanges.RigidComponents[ItrIdx];
+		PrevComponents.Poses.Set(Idx, RigidComponentPoses[ItrIdx].GetLocation(), RigidComponentPoses[ItrIdx].GetRotation());
+		PrevComponents.Times[Idx] = Time;
+	}
+}
+
+// Find the rigid children of the moved entities of a group
+void FSLWorldChangeDetector::FindRigid(const FSLPoseArrays& Poses, const FSLPreviousPoses& Prev, const TArray<FSLGroupRoot>& Roots,
+	const TArray<int32>& MovedIdxs, const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes,
+	TArray<int32>& OutRigidIdxs, TArray<FSLGroupRoot>& OutRigidRoots, TArray<FTransform>& OutRigidPoses) const
+{
+	for (const int32 Idx : MovedIdxs)
+	{
+		const FSLGroupRoot& Root = Roots[Idx];
+		if (!Root.IsSet() || Prev.Times[Idx] < 0.f)
+		{
+			continue;
+		}
+
+		// The root has to be logged in the same snapshot, and known to the readers from before
+		const FSLPoseArrays& RootPoses = Root.bIsComponent ? Snapshot.Components : Snapshot.Actors;
+		const FSLPreviousPoses& RootPrev = Root.bIsComponent ? PrevComponents : PrevActors;
+		const TArray<int32>& RootMovedIdxs = Root.bIsComponent ? Changes.Components : Changes.Actors;
+		if (RootPrev.Times[Root.Idx] < 0.f || Algo::BinarySearch(RootMovedIdxs, Root.Idx) == INDEX_NONE)
+		{
+			continue;
+		}
+
+		// Previous pose relative to the previous root pose, applied to the new root pose
+		const FTransform PrevPose(Prev.Poses.GetQuat(Idx), Prev.Poses.GetLoc(Idx));
+		const FTransform PrevRootPose(RootPrev.Poses.GetQuat(Root.Idx), RootPrev.Poses.GetLoc(Root.Idx));
+		const FTransform RootPose(RootPoses.GetQuat(Root.Idx), RootPoses.GetLoc(Root.Idx));
+		const FTransform RigidPose = PrevPose.GetRelativeTransform(PrevRootPose) * RootPose;
+
+		if (FVector::DistSquared(RigidPose.GetLocation(), Poses.GetLoc(Idx)) <= LinDistSqMin &&
+			RigidPose.GetRotation().AngularDistance(Poses.GetQuat(Idx)) <= AngDistMin)
+		{
+			OutRigidIdxs.Add(Idx);
+			OutRigidRoots.Add(Root);
+			OutRigidPoses.Add(RigidPose);
+		}
+	}
+}
+
+// Scalar check of the given candidates (ascending) against the last logged poses
+void FSLWorldChangeDetector::FindMovedCandidates(const FSLPoseArrays& Poses, const FSLPoseArrays& PrevPoses,
+	const TArray<int32>& CandidateIdxs, TArray<int32>& OutIdxs) const
+{
+	for (const int32 Idx : CandidateIdxs)
+	{
+		if (Poses.Valid[Idx])
+		{
+			const float DX = Poses.LocX[Idx] - PrevPoses.LocX[Idx];
+			const float DY = Poses.LocY[Idx] - PrevPoses.LocY[Idx];
+			const float DZ = Poses.LocZ[Idx] - PrevPoses.LocZ[Idx];
+			const float Dot = Poses.QuatX[Idx] * PrevPoses.QuatX[Idx] + Poses.QuatY[Idx] * PrevPoses.QuatY[Idx] +
+				Poses.QuatZ[Idx] * PrevPoses.QuatZ[Idx] + Poses.QuatW[Idx] * PrevPoses.QuatW[Idx];
+			if (DX * DX + DY * DY + DZ * DZ > LinDistSqMin || Dot * Dot < QuatDotSqMin)
+			{
+				OutIdxs.Add(Idx);
+			}
+		}
+	}
+}
+
+// Store the pose as the last logged one
+void FSLWorldChangeDetector::UpdatePrevious(const FSLPoseArrays& Poses, int32 Idx, float Time, FSLPreviousPoses& Prev) const
+{
+	Prev.Poses.Set(Idx, Poses.GetLoc(Idx), Poses.GetQuat(Idx));
+	Prev.Times[Idx] = Time;
+}
+
+// Check every bone against its own previous pose, a skeletal entity is changed if its root or any of its bones moved
+void FSLWorldChangeDetector::DetectSkeletals(const FSLWorldStateSnapshot& Snapshot, FSLWorldStateChanges& OutChanges)
+{
+	MovedRoots.Reset();
+	MovedBones.Reset();
+	DetectGroup(Snapshot.Skeletals, Snapshot.Timestamp, PrevSkeletals, MovedRoots);
+
+	if (PrevBoneOffsets != Snapshot.BoneOffsets)
+	{
+		RemapBones(Snapshot.BoneOffsets);
+	}
+	DetectGroup(Snapshot.Bones, Snapshot.Timestamp, PrevBones, MovedBones);
+
+	// Merge the two ascending lists, the bones are grouped by their skeletal entity
+	int32 RootItr = 0;
+	int32 BoneItr = 0;
+	for (int32 SkelIdx = 0; SkelIdx < Snapshot.Skeletals.Num(); ++SkelIdx)
+	{
+		const bool bRootMoved = RootItr < MovedRoots.Num() && MovedRoots[RootItr] == SkelIdx;
+		if (bRootMoved)
+		{
+			RootItr++;
+		}
+
+		const int32 FirstMovedBone = BoneItr;
+		const int32 LastBoneIdx = Snapshot.BoneOffsets[SkelIdx + 1];
+		while (BoneItr < MovedBones.Num() && MovedBones[BoneItr] < LastBoneIdx)
+		{
+			BoneItr++;
+		}
+
+		if (bRootMoved || BoneItr > FirstMovedBone)
+		{
+			OutChanges.Skeletals.Add(SkelIdx);
+			OutChanges.Bones.Append(MovedBones.GetData() + FirstMovedBone, BoneItr - FirstMovedBone);
+			OutChanges.SkeletalBoneOffsets.Add(OutChanges.Bones.Num());
+		}
+	}
+}
+
+// Move the previous bone poses to the new bone layout of the snapshot (skeletal entities with a changed number of bones are reset)
+void FSLWorldChangeDetector::RemapBones(const TArray<int32>& BoneOffsets)
+{
+	FSLPreviousPoses NewBones;
+	NewBones.SetNum(BoneOffsets.Num() > 0 ? BoneOffsets.Last() : 0);
+
+	const int32 NumSkels = FMath::Min(PrevBoneRanges.Num(), BoneOffsets.Num() - 1);
+	for (int32 SkelIdx = 0; SkelIdx < NumSkels; ++SkelIdx)
+	{
+		const int32 PrevFirst = PrevBoneRanges[SkelIdx].Key;
+		const int32 First = BoneOffsets[SkelIdx];
+		const int32 NumBones = BoneOffsets[SkelIdx + 1] - First;
+		if (NumBones == PrevBoneRanges[SkelIdx].Value)
+		{
+			for (int32 Idx = 0; Idx < NumBones; ++Idx)
+			{
+				NewBones.CopyEntry(PrevBones, PrevFirst + Idx, First + Idx);
+			}
+		}
+	}
+
+	PrevBones = MoveTemp(NewBones);
+	PrevBoneOffsets = BoneOffsets;
+	PrevBoneRanges.Reset(BoneOffsets.Num());
+	for (int32 SkelIdx = 0; SkelIdx + 1 < BoneOffsets.Num(); ++SkelIdx)
+	{
+		PrevBoneRanges.Emplace(BoneOffsets[SkelIdx], BoneOffsets[SkelIdx + 1] - BoneOffsets[SkelIdx]);
+	}
+}
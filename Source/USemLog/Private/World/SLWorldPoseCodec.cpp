@@ -0,0 +1,196 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "World/SLWorldPoseCodec.h"
+
+// The three smallest components of a unit quaternion are within [-1/sqrt(2), 1/sqrt(2)]
+static constexpr float SmallestThreeRange = 0.707106781f;
+static constexpr uint32 SmallestThreeMax = (1 << 15) - 1;
+
+// Append unsigned variable length integer
+void FSLWorldPoseCodec::AppendVarint(TArray<uint8>& Out, uint64 Value)
+{
+	while (Value >= 0x80)
+	{
+		Out.Add(static_cast<uint8>(Value | 0x80));
+		Value >>= 7;
+	}
+	Out.Add(static_cast<uint8>(Value));
+}
+
+// Read unsigned variable length integer, false if the data ends
+bool FSLWorldPoseCodec::ReadVarint(const uint8*& Ptr, const uint8* End, uint64& OutValue)
+{
+	OutValue = 0;
+	for (int32 Shift = 0; Shift < 64 && Ptr < End; Shift += 7)
+	{
+		const uint8 Byte = *Ptr++;
+		OutValue |= static_cast<uint64>(Byte & 0x7F) << Shift;
+		if ((Byte & 0x80) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// Append rotation using the smallest three encoding
+void FSLWorldPoseCodec::AppendQuat(TArray<uint8>& Out, const FQuat& InQuat)
+{
+	const FQuat Quat = InQuat.GetNormalized();
+	const float Comps[4] = { Quat.X, Quat.Y, Quat.Z, Quat.W };
+
+	// The largest component is omitted, it is recomputed from the unit length (q and -q are the same rotation)
+	int32 Largest = 0;
+	for (int32 Idx = 1; Idx < 4; ++Idx)
+	{
+		if (FMath::Abs(Comps[Idx]) > FMath::Abs(Comps[Largest]))
+		{
+			Largest = Idx;
+		}
+	}
+	const float Sign = Comps[Largest] < 0.f ? -1.f : 1.f;
+
+	uint64 Packed = static_cast<uint64>(Largest);
+	int32 Shift = 2;
+	for (int32 Idx = 0; Idx < 4; ++Idx)
+	{
+		if (Idx != Largest)
+		{
+			const float Normalized = (Comps[Idx] * Sign / SmallestThreeRange + 1.f) * 0.5f;
+			const uint64 Quantized = static_cast<uint64>(FMath::Clamp(
+				FMath::RoundToInt(Normalized * SmallestThreeMax), 0, static_cast<int32>(SmallestThreeMax)));
+			Packed |= Quantized << Shift;
+			Shift += 15;
+		}
+	}
+
+	for (int32 Byte = 0; Byte < QuatSize; ++Byte)
+	{
+		Out.Add(static_cast<uint8>(Packed >> (8 * Byte)));
+	}
+}
+
+// Read smallest three encoded rotation, false if the data ends
+bool FSLWorldPoseCodec::ReadQuat(const uint8*& Ptr, const uint8* End, FQuat& OutQuat)
+{
+	if (End - Ptr < QuatSize)
+	{
+		return false;
+	}
+
+	uint64 Packed = 0;
+	for (int32 Byte = 0; Byte < QuatSize; ++Byte)
+	{
+		Packed |= static_cast<uint64>(Ptr[Byte]) << (8 * Byte);
+	}
+	Ptr += QuatSize;
+
+	const int32 Largest = static_cast<int32>(Packed & 0x3);
+	float Comps[4];
+	float SumSq = 0.f;
+	int32 Shift = 2;
+	for (int32 Idx = 0; Idx < 4; ++Idx)
+	{
+		if (Idx != Largest)
+		{
+			const uint32 Quantized = static_cast<uint32>((Packed >> Shift) & SmallestThreeMax);
+			Comps[Idx] = (static_cast<float>(Quantized) / SmallestThreeMax * 2.f - 1.f) * SmallestThreeRange;
+			SumSq += Comps[Idx] * Comps[Idx];
+			Shift += 15;
+		}
+	}
+	Comps[Largest] = FMath::Sqrt(FMath::Max(0.f, 1.f - SumSq));
+
+	OutQuat = FQuat(Comps[0], Comps[1], Comps[2], Comps[3]);
+	return true;
+}
+
+// Start a new keyframe, removes all slots
+void FSLWorldPoseEncoder::Reset(double InLocPrecision)
+{
+	LocPrecision = InLocPrecision;
+	SlotLocs.Reset();
+}
+
+// Add the slot of an entity written in the keyframe, returns the slot index
+int32 FSLWorldPoseEncoder::AddSlot(const FVector& InLoc)
+{
+	const int32 Slot = SlotLocs.Num() / 3;
+	SlotLocs.Add(FSLWorldPoseCodec::QuantizeLoc(InLoc.X, LocPrecision));
+	SlotLocs.Add(FSLWorldPoseCodec::QuantizeLoc(InLoc.Y, LocPrecision));
+	SlotLocs.Add(FSLWorldPoseCodec::QuantizeLoc(InLoc.Z, LocPrecision));
+	return Slot;
+}
+
+// Append the delta of the slot pose
+void FSLWorldPoseEncoder::AppendDelta(int32 Slot, const FVector& InLoc, const FQuat& InQuat, TArray<uint8>& Out)
+{
+	FSLWorldPoseCodec::AppendVarint(Out, static_cast<uint64>(Slot));
+
+	// The delta is computed between the quantized values, the reconstruction does not drift
+	int64* PrevLoc = &SlotLocs[3 * Slot];
+	const double Comps[3] = { InLoc.X, InLoc.Y, InLoc.Z };
+	for (int32 Idx = 0; Idx < 3; ++Idx)
+	{
+		const int64 Quantized = FSLWorldPoseCodec::QuantizeLoc(Comps[Idx], LocPrecision);
+		FSLWorldPoseCodec::AppendVarint(Out, FSLWorldPoseCodec::ZigZag(Quantized - PrevLoc[Idx]));
+		PrevLoc[Idx] = Quantized;
+	}
+
+	FSLWorldPoseCodec::AppendQuat(Out, InQuat);
+}
+
+// Start a new keyframe, removes all slots
+void FSLWorldPoseDecoder::Reset(double InLocPrecision)
+{
+	LocPrecision = InLocPrecision;
+	SlotLocs.Reset();
+}
+
+// Add the slot of an entity read from the keyframe, returns the slot index
+int32 FSLWorldPoseDecoder::AddSlot(const FVector& InLoc)
+{
+	const int32 Slot = SlotLocs.Num() / 3;
+	SlotLocs.Add(FSLWorldPoseCodec::QuantizeLoc(InLoc.X, LocPrecision));
+	SlotLocs.Add(FSLWorldPoseCodec::QuantizeLoc(InLoc.Y, LocPrecision));
+	SlotLocs.Add(FSLWorldPoseCodec::QuantizeLoc(InLoc.Z, LocPrecision));
+	return Slot;
+}
+
+// Decode the deltas, the callback is called with the slot index and its reconstructed pose, false on corrupt data
+bool FSLWorldPoseDecoder::Decode(const uint8* Data, int32 Size,
+	TFunctionRef<void(int32 Slot, const FVector& Loc, const FQuat& Quat)> Callback)
+{
+	const uint8* Ptr = Data;
+	const uint8* End = Data + Size;
+	while (Ptr < End)
+	{
+		uint64 Slot = 0;
+		if (!FSLWorldPoseCodec::ReadVarint(Ptr, End, Slot) || Slot >= static_cast<uint64>(Num()))
+		{
+			return false;
+		}
+
+		int64* PrevLoc = &SlotLocs[3 * Slot];
+		for (int32 Idx = 0; Idx < 3; ++Idx)
+		{
+			uint64 Delta = 0;
+			if (!FSLWorldPoseCodec::ReadVarint(Ptr, End, Delta))
+			{
+				return false;
+			}
+			PrevLoc[Idx] += FSLWorldPoseCodec::UnZigZag(Delta);
+		}
+
+		FQuat Quat;
+		if (!FSLWorldPoseCodec::ReadQuat(Ptr, End, Quat))
+		{
+			return false;
+		}
+
+		const FVector Loc(PrevLoc[0] * LocPrecision, PrevLoc[1] * LocPrecision, PrevLoc[2] * LocPrecision);
+		Callback(static_cast<int32>(Slot), Loc, Quat);
+	}
+	return true;
+}
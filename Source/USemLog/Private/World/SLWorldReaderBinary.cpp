@@ -0,0 +1,354 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "World/SLWorldReaderBinary.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/FileHelper.h"
+#include "Utils/SLCompressedFile.h"
+
+// Default ctor
+FSLWorldReaderBinary::FSLWorldReaderBinary()
+{
+	MappedHandle = nullptr;
+	MappedRegion = nullptr;
+	Data = nullptr;
+	Size = 0;
+}
+
+// Dtor
+FSLWorldReaderBinary::~FSLWorldReaderBinary()
+{
+	Close();
+}
+
+// Open the file and load the dictionary and seek table
+bool FSLWorldReaderBinary::Open(const FString& FilePath)
+{
+	Close();
+
+	// Map the file if possible, otherwise load it into memory
+	MappedHandle = FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*FilePath);
+	if (MappedHandle)
+	{
+		MappedRegion = MappedHandle->MapRegion();
+	}
+	if (MappedRegion)
+	{
+		Data = MappedRegion->GetMappedPtr();
+		Size = MappedRegion->GetMappedSize();
+	}
+	else if (FFileHelper::LoadFileToArray(FileContent, *FilePath))
+	{
+		Data = FileContent.GetData();
+		Size = FileContent.Num();
+	}
+	else
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s::%d Could not open %s.."), *FString(__func__), __LINE__, *FilePath);
+		Close();
+		return false;
+	}
+
+	// Compressed files are decompressed into memory, the mapping is released
+	if (FSLCompressedFileReader::IsCompressed(Data, Size))
+	{
+		TArray<uint8> Decompressed;
+		const bool bDecompressed = FSLCompressedFileReader::Decompress(Data, Size, Decompressed);
+		Close();
+		if (!bDecompressed)
+		{
+			UE_LOG(LogTemp, Error, TEXT("%s::%d Could not decompress %s.."), *FString(__func__), __LINE__, *FilePath);
+			return false;
+		}
+		FileContent = MoveTemp(Decompressed);
+		Data = FileContent.GetData();
+		Size = FileContent.Num();
+	}
+
+	// Check header
+	uint32 Magic = 0;
+	uint16 Version = 0;
+	if (!ReadValue(0, Magic) || !ReadValue(sizeof(uint32), Version) ||
+		Magic != FSLWorldBinaryFormat::Magic || Version > FSLWorldBinaryFormat::Version)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s::%d %s is not a supported binary world state file.."),
+			*FString(__func__), __LINE__, *FilePath);
+		Close();
+		return false;
+	}
+
+	// Without a seek table (e.g. logging was interrupted) the frame offsets are recovered by parsing all records
+	if (ReadSeekTable())
+	{
+		return ReadRecords(true);
+	}
+	UE_LOG(LogTemp, Warning, TEXT("%s::%d %s has no seek table, parsing all records.."),
+		*FString(__func__), __LINE__, *FilePath);
+	return ReadRecords(false);
+}
+
+// Release the file
+void FSLWorldReaderBinary::Close()
+{
+	if (MappedRegion)
+	{
+		delete MappedRegion;
+		MappedRegion = nullptr;
+	}
+	if (MappedHandle)
+	{
+		delete MappedHandle;
+		MappedHandle = nullptr;
+	}
+	FileContent.Empty();
+	Data = nullptr;
+	Size = 0;
+	Entities.Empty();
+	FrameOffsets.Empty();
+	FrameTimestamps.Empty();
+}
+
+// Index of the last frame with the timestamp smaller or equal to the given one (INDEX_NONE if none)
+int32 FSLWorldReaderBinary::FindFrame(float Timestamp) const
+{
+	// Upper bound binary search on the sorted timestamps
+	int32 First = 0;
+	int32 Count = FrameTimestamps.Num();
+	while (Count > 0)
+	{
+		const int32 Step = Count / 2;
+		if (FrameTimestamps[First + Step] <= Timestamp)
+		{
+			First += Step + 1;
+			Count -= Step + 1;
+		}
+		else
+		{
+			Count = Step;
+		}
+	}
+	return First - 1;
+}
+
+// Get the given frame
+bool FSLWorldReaderBinary::GetFrame(int32 FrameIdx, FSLWorldBinaryFrame& OutFrame) const
+{
+	if (!FrameOffsets.IsValidIndex(FrameIdx))
+	{
+		return false;
+	}
+
+	const int64 Offset = FrameOffsets[FrameIdx];
+	uint32 NumRows = 0;
+	if (!ReadValue(Offset + sizeof(uint32), OutFrame.Timestamp) || !ReadValue(Offset + 2 * sizeof(uint32), NumRows))
+	{
+		return false;
+	}
+
+	const int64 ColumnsOffset = Offset + 3 * sizeof(uint32);
+	if (ColumnsOffset + static_cast<int64>(NumRows) * 8 * sizeof(uint32) > Size)
+	{
+		return false;
+	}
+
+	OutFrame.Num = NumRows;
+	OutFrame.Handles = reinterpret_cast<const uint32*>(Data + ColumnsOffset);
+	OutFrame.Locs = reinterpret_cast<const float*>(Data + ColumnsOffset + NumRows * sizeof(uint32));
+	OutFrame.Quats = reinterpret_cast<const float*>(Data + ColumnsOffset + NumRows * 4 * sizeof(uint32));
+
+	// Optional rigid record following the frame
+	const int64 RigidOffset = ColumnsOffset + static_cast<int64>(NumRows) * 8 * sizeof(uint32);
+	uint32 RecordType = 0;
+	uint32 NumRigid = 0;
+	OutFrame.NumRigid = 0;
+	OutFrame.RigidHandles = nullptr;
+	if (ReadValue(RigidOffset, RecordType) && RecordType == FSLWorldBinaryFormat::RigidRecord &&
+		ReadValue(RigidOffset + sizeof(uint32), NumRigid) &&
+		RigidOffset + 2 * sizeof(uint32) + static_cast<int64>(NumRigid) * 2 * sizeof(uint32) <= Size)
+	{
+		OutFrame.NumRigid = NumRigid;
+		OutFrame.RigidHandles = reinterpret_cast<const uint32*>(Data + RigidOffset + 2 * sizeof(uint32));
+	}
+	return true;
+}
+
+// Apply the frame to the poses of the entities, the rigid children are reconstructed from their group roots
+void FSLWorldReaderBinary::ApplyFrame(const FSLWorldBinaryFrame& Frame, TArray<FTransform>& InOutPoses)
+{
+	const auto EnsurePose = [&InOutPoses](uint32 Handle) -> FTransform&
+	{
+		if (static_cast<int32>(Handle) >= InOutPoses.Num())
+		{
+			InOutPoses.SetNum(Handle + 1);
+		}
+		return InOutPoses[Handle];
+	};
+
+	// The relative poses are taken before the roots are updated
+	TArray<FTransform, TInlineAllocator<64>> RelativePoses;
+	RelativePoses.Reserve(Frame.NumRigid);
+	for (int32 Idx = 0; Idx < Frame.NumRigid; ++Idx)
+	{
+		const FTransform RootPose = EnsurePose(Frame.RigidHandles[2 * Idx + 1]);
+		RelativePoses.Add(EnsurePose(Frame.RigidHandles[2 * Idx]).GetRelativeTransform(RootPose));
+	}
+
+	for (int32 Row = 0; Row < Frame.Num; ++Row)
+	{
+		EnsurePose(Frame.Handles[Row]) = FTransform(Frame.GetQuat(Row), Frame.GetLoc(Row));
+	}
+
+	for (int32 Idx = 0; Idx < Frame.NumRigid; ++Idx)
+	{
+		InOutPoses[Frame.RigidHandles[2 * Idx]] = RelativePoses[Idx] * InOutPoses[Frame.RigidHandles[2 * Idx + 1]];
+	}
+}
+
+// Read the seek table from the footer, false if the file has no (valid) footer
+bool FSLWorldReaderBinary::ReadSeekTable()
+{
+	uint64 SeekTableOffset = 0;
+	uint32 FooterMagic = 0;
+	const int64 FooterOffset = Size - FSLWorldBinaryFormat::FooterSize;
+	if (!ReadValue(FooterOffset, SeekTableOffset) || !ReadValue(FooterOffset + sizeof(uint64), FooterMagic) ||
+		FooterMagic != FSLWorldBinaryFormat::FooterMagic)
+	{
+		return false;
+	}
+
+	uint32 RecordType = 0;
+	uint32 NumFrames = 0;
+	int64 Offset = static_cast<int64>(SeekTableOffset);
+	if (!ReadValue(Offset, RecordType) || !ReadValue(Offset + sizeof(uint32), NumFrames) ||
+		RecordType != FSLWorldBinaryFormat::SeekTableRecord)
+	{
+		return false;
+	}
+	Offset += 2 * sizeof(uint32);
+
+	FrameOffsets.SetNumUninitialized(NumFrames);
+	FrameTimestamps.SetNumUninitialized(NumFrames);
+	for (uint32 Idx = 0; Idx < NumFrames; ++Idx)
+	{
+		uint64 FrameOffset = 0;
+		if (!ReadValue(Offset, FrameTimestamps[Idx]) || !ReadValue(Offset + sizeof(float), FrameOffset))
+		{
+			FrameOffsets.Empty();
+			FrameTimestamps.Empty();
+			return false;
+		}
+		FrameOffsets[Idx] = static_cast<int64>(FrameOffset);
+		Offset += sizeof(float) + sizeof(uint64);
+	}
+	return true;
+}
+
+// Parse all the records (dictionary and frame offsets)
+bool FSLWorldReaderBinary::ReadRecords(bool bOnlyDictionary)
+{
+	int64 Offset = FSLWorldBinaryFormat::HeaderSize;
+	uint32 RecordType = 0;
+	while (ReadValue(Offset, RecordType))
+	{
+		if (RecordType == FSLWorldBinaryFormat::DictionaryRecord)
+		{
+			const int64 NextOffset = ReadDictionary(Offset);
+			if (NextOffset == INDEX_NONE)
+			{
+				// Truncated dictionary (e.g. crash while flushing), the records before it are kept
+				UE_LOG(LogTemp, Warning, TEXT("%s::%d Truncated dictionary at offset %lld, stopping at the last complete record.."),
+					*FString(__func__), __LINE__, Offset);
+				break;
+			}
+			Offset = NextOffset;
+		}
+		else if (RecordType == FSLWorldBinaryFormat::FrameRecord)
+		{
+			float Timestamp = 0.f;
+			uint32 NumRows = 0;
+			if (!ReadValue(Offset + sizeof(uint32), Timestamp) || !ReadValue(Offset + 2 * sizeof(uint32), NumRows))
+			{
+				break;
+			}
+			const int64 NextOffset = Offset + 3 * sizeof(uint32) + static_cast<int64>(NumRows) * 8 * sizeof(uint32);
+			if (NextOffset > Size)
+			{
+				// Truncated frame
+				break;
+			}
+			if (!bOnlyDictionary)
+			{
+				FrameOffsets.Add(Offset);
+				FrameTimestamps.Add(Timestamp);
+			}
+			Offset = NextOffset;
+		}
+		else if (RecordType == FSLWorldBinaryFormat::RigidRecord)
+		{
+			uint32 NumRigid = 0;
+			if (!ReadValue(Offset + sizeof(uint32), NumRigid))
+			{
+				break;
+			}
+			Offset += 2 * sizeof(uint32) + static_cast<int64>(NumRigid) * 2 * sizeof(uint32);
+		}
+		else
+		{
+			// Seek table or unknown record
+			break;
+		}
+	}
+	return true;
+}
+
+// Parse a dictionary record, returns the offset after the record
+int64 FSLWorldReaderBinary::ReadDictionary(int64 Offset)
+{
+	uint32 NumEntries = 0;
+	if (!ReadValue(Offset + sizeof(uint32), NumEntries))
+	{
+		return INDEX_NONE;
+	}
+	Offset += 2 * sizeof(uint32);
+
+	for (uint32 Idx = 0; Idx < NumEntries; ++Idx)
+	{
+		uint32 Handle = 0;
+		FSLWorldBinaryEntity Entity;
+		if (!ReadValue(Offset, Handle) || !ReadValue(Offset + sizeof(uint32), Entity.ParentHandle))
+		{
+			return INDEX_NONE;
+		}
+		Offset += 2 * sizeof(uint32);
+		Offset = ReadString(Offset, Entity.Id);
+		Offset = ReadString(Offset, Entity.Class);
+		Offset = ReadString(Offset, Entity.Name);
+		if (Offset == INDEX_NONE)
+		{
+			return INDEX_NONE;
+		}
+
+		if (static_cast<int32>(Handle) >= Entities.Num())
+		{
+			Entities.SetNum(Handle + 1);
+		}
+		Entities[Handle] = MoveTemp(Entity);
+	}
+
+	// Records are 4 byte aligned
+	return Align(Offset, 4);
+}
+
+// Read a length prefixed utf8 string, returns the offset after the string (INDEX_NONE on error)
+int64 FSLWorldReaderBinary::ReadString(int64 Offset, FString& OutStr) const
+{
+	uint16 Len = 0;
+	if (Offset == INDEX_NONE || !ReadValue(Offset, Len) || Offset + sizeof(uint16) + Len > Size)
+	{
+		return INDEX_NONE;
+	}
+	const FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Data + Offset + sizeof(uint16)), Len);
+	OutStr = FString(Converted.Length(), Converted.Get());
+	return Offset + sizeof(uint16) + Len;
+}
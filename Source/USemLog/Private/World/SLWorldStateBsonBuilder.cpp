@@ -0,0 +1,499 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "World/SLWorldStateBsonBuilder.h"
+
+// Utils
+#if SL_WITH_ROS_CONVERSIONS
+#include "Conversions.h"
+#endif // SL_WITH_ROS_CONVERSIONS
+
+// Default ctor
+FSLWorldStateBsonBuilder::FSLWorldStateBsonBuilder() : bHasKeyframe(false), LastKeyframeTime(0.f)
+{
+}
+
+// Set the compression parameters
+void FSLWorldStateBsonBuilder::Init(const FSLWorldWriterCompressionParams& InCompression)
+{
+	Compression = InCompression;
+	bHasKeyframe = false;
+}
+
+#if SL_WITH_LIBMONGO_C
+// Append the pre-encoded string (no conversion or length computation)
+static FORCEINLINE void AppendUtf8(bson_t* doc, const char* key, const FSLUtf8Str& Str)
+{
+	bson_append_utf8(doc, key, -1, Str.Get(), Str.Len());
+}
+
+// Add the entities that moved since the last logging to the document, returns the number of added entries
+uint32 FSLWorldStateBsonBuilder::AddWorldState(const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes,
+	const TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
+	const TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
+	const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
+	bson_t* out_doc)
+{
+	bson_t entities_arr;
+	bson_t sk_entities_arr;
+	uint32_t arr_idx = 0;
+	uint32 NumEntries = 0;
+
+	// Add timestamp
+	BSON_APPEND_DOUBLE(out_doc, "timestamp", Snapshot.Timestamp);
+
+	bool bKeyframe = false;
+	if (Compression.bEnabled)
+	{
+		if (NeedsKeyframe(Snapshot, ActorEntities.Num(), ComponentEntities.Num(), SkeletalEntities.Num()))
+		{
+			// Full poses of all entities, the next deltas are relative to these
+			BeginKeyframe(Snapshot, ActorEntities.Num(), ComponentEntities.Num(), SkeletalEntities.Num());
+			bKeyframe = true;
+
+			bson_t keyframe_obj;
+			BSON_APPEND_DOCUMENT_BEGIN(out_doc, "keyframe", &keyframe_obj);
+			BSON_APPEND_DOUBLE(&keyframe_obj, "loc_precision", Compression.LocPrecision);
+			bson_append_document_end(out_doc, &keyframe_obj);
+		}
+		else
+		{
+			// Only the quantized deltas of the moved entities
+			DeltaBuffer.Reset();
+			NumEntries += AddEntityDeltas(Snapshot.Actors, Changes.Actors, ActorSlots);
+			NumEntries += AddEntityDeltas(Snapshot.Components, Changes.Components, ComponentSlots);
+			// The deltas are already compact, the rigid children are written with their deltas as well
+			NumEntries += AddEntityDeltas(Snapshot.Actors, Changes.RigidActors, ActorSlots);
+			NumEntries += AddEntityDeltas(Snapshot.Components, Changes.RigidComponents, ComponentSlots);
+			NumEntries += AddSkeletalDeltas(Snapshot, Changes);
+			if (DeltaBuffer.Num() > 0)
+			{
+				BSON_APPEND_BINARY(out_doc, "deltas", BSON_SUBTYPE_BINARY, DeltaBuffer.GetData(), DeltaBuffer.Num());
+			}
+			AddGazeIfChanged(Snapshot.GazeData, out_doc, NumEntries);
+			return NumEntries;
+		}
+	}
+
+	// Keyframes contain all the valid entities, otherwise only the moved ones
+	auto GetIdxs = [this, bKeyframe](const FSLPoseArrays& Poses, const TArray<int32>& MovedIdxs) -> const TArray<int32>&
+	{
+		if (!bKeyframe)
+		{
+			return MovedIdxs;
+		}
+		Poses.GetValidIndexes(KeyframeIdxs);
+		return KeyframeIdxs;
+	};
+
+	// Add entities to array
+	BSON_APPEND_ARRAY_BEGIN(out_doc, "entities", &entities_arr);
+	AddActorEntities(ActorEntities, Snapshot.Actors, GetIdxs(Snapshot.Actors, Changes.Actors), bKeyframe, &entities_arr, arr_idx);
+	AddComponentEntities(ComponentEntities, Snapshot.Components, GetIdxs(Snapshot.Components, Changes.Components), bKeyframe, &entities_arr, arr_idx);
+	if (!bKeyframe)
+	{
+		AddRigidEntities(ActorEntities, Changes.RigidActors, Changes.RigidActorRoots, ActorEntities, ComponentEntities, &entities_arr, arr_idx);
+		AddRigidEntities(ComponentEntities, Changes.RigidComponents, Changes.RigidComponentRoots, ActorEntities, ComponentEntities, &entities_arr, arr_idx);
+	}
+	bson_append_array_end(out_doc, &entities_arr);
+	NumEntries += arr_idx;
+
+	// Avoid writing empty documents (this is empty if there are no skeletals in the map, not if there are no changes)
+	if(SkeletalEntities.Num() > 0)
+	{
+		// Add skel entities to array
+		BSON_APPEND_ARRAY_BEGIN(out_doc, "skel_entities", &sk_entities_arr);
+		// Reset array index
+		arr_idx = 0;
+		AddSkeletalEntities(SkeletalEntities, Snapshot, Changes, bKeyframe, &sk_entities_arr, arr_idx);
+		bson_append_array_end(out_doc, &sk_entities_arr);
+		NumEntries += arr_idx;
+	}
+
+	AddGazeIfChanged(Snapshot.GazeData, out_doc, NumEntries);
+	return NumEntries;
+}
+
+// Add the gaze data if it changed since the last logging
+void FSLWorldStateBsonBuilder::AddGazeIfChanged(const FSLGazeData& GazeData, bson_t* out_doc, uint32& NumEntries)
+{
+	if(GazeData.HasDataFast())
+	{
+		if(!PreviousGazeData.Equals(GazeData, 3.f))
+		{
+			AddGazeData(GazeData, out_doc);
+			PreviousGazeData = GazeData;
+			NumEntries++;
+		}
+	}
+}
+
+// Add non skeletal actors to array
+void FSLWorldStateBsonBuilder::AddActorEntities(const TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
+	const FSLPoseArrays& Poses, const TArray<int32>& Idxs, bool bKeyframe, bson_t* out_doc, uint32_t& idx)
+{
+	bson_t arr_obj;
+	char idx_str[16];
+	const char *idx_key;
+
+	// Iterate the moved (or with keyframes all valid) items
+	for (const int32 Idx : Idxs)
+	{
+		const TSLEntityPreviousPose<AActor>* Itr = &ActorEntities[Idx];
+		const FVector CurrLoc = Poses.GetLoc(Idx);
+		const FQuat CurrQuat = Poses.GetQuat(Idx);
+
+		bson_uint32_to_string(idx, &idx_key, idx_str, sizeof idx_str);
+		BSON_APPEND_DOCUMENT_BEGIN(out_doc, idx_key, &arr_obj);
+
+		AppendUtf8(&arr_obj, "id", Itr->Utf8->Id);
+		AddPoseChild(CurrLoc, CurrQuat, &arr_obj);
+
+		bson_append_document_end(out_doc, &arr_obj);
+		idx++;
+
+		if (bKeyframe)
+		{
+			ActorSlots[Idx] = PoseEncoder.AddSlot(GetLoggedLoc(CurrLoc));
+		}
+	}
+}
+
+// Add non skeletal components to array
+void FSLWorldStateBsonBuilder::AddComponentEntities(const TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
+	const FSLPoseArrays& Poses, const TArray<int32>& Idxs, bool bKeyframe, bson_t* out_doc, uint32_t& idx)
+{
+	bson_t arr_obj;
+	char idx_str[16];
+	const char *idx_key;
+
+	// Iterate the moved (or with keyframes all valid) items
+	for (const int32 Idx : Idxs)
+	{
+		const TSLEntityPreviousPose<USceneComponent>* Itr = &ComponentEntities[Idx];
+		const FVector CurrLoc = Poses.GetLoc(Idx);
+		const FQuat CurrQuat = Poses.GetQuat(Idx);
+
+		bson_uint32_to_string(idx, &idx_key, idx_str, sizeof idx_str);
+		BSON_APPEND_DOCUMENT_BEGIN(out_doc, idx_key, &arr_obj);
+
+		AppendUtf8(&arr_obj, "id", Itr->Utf8->Id);
+		AddPoseChild(CurrLoc, CurrQuat, &arr_obj);
+
+		bson_append_document_end(out_doc, &arr_obj);
+		idx++;
+
+		if (bKeyframe)
+		{
+			ComponentSlots[Idx] = PoseEncoder.AddSlot(GetLoggedLoc(CurrLoc));
+		}
+	}
+}
+
+// Add the markers of the rigid children to array
+template<typename T>
+void FSLWorldStateBsonBuilder::AddRigidEntities(const TArray<TSLEntityPreviousPose<T>>& Entities, const TArray<int32>& RigidIdxs,
+	const TArray<FSLGroupRoot>& Roots, const TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
+	const TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities, bson_t* out_doc, uint32_t& idx)
+{
+	bson_t arr_obj;
+	char idx_str[16];
+	const char *idx_key;
+
+	// The pose is the previous pose relative to the previous root pose applied to the root pose of this document
+	for (int32 ItrIdx = 0; ItrIdx < RigidIdxs.Num(); ++ItrIdx)
+	{
+		const FSLGroupRoot& Root = Roots[ItrIdx];
+		const FSLEntityUtf8& RootUtf8 = Root.bIsComponent ? *ComponentEntities[Root.Idx].Utf8 : *ActorEntities[Root.Idx].Utf8;
+
+		bson_uint32_to_string(idx, &idx_key, idx_str, sizeof idx_str);
+		BSON_APPEND_DOCUMENT_BEGIN(out_doc, idx_key, &arr_obj);
+
+		AppendUtf8(&arr_obj, "id", Entities[RigidIdxs[ItrIdx]].Utf8->Id);
+		AppendUtf8(&arr_obj, "rigid_root", RootUtf8.Id);
+
+		bson_append_document_end(out_doc, &arr_obj);
+		idx++;
+	}
+}
+
+// Add skeletal actors to array
+void FSLWorldStateBsonBuilder::AddSkeletalEntities(const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
+	const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes, bool bKeyframe, bson_t* out_doc, uint32_t& idx)
+{
+	bson_t arr_obj;
+	char idx_str[16];
+	const char *idx_key;
+	const FSLPoseArrays& Poses = Snapshot.Skeletals;
+
+	// Keyframes contain all valid items with all their bones, otherwise only the changed items with their moved bones
+	if (bKeyframe)
+	{
+		Poses.GetValidIndexes(KeyframeIdxs);
+	}
+	const TArray<int32>& Idxs = bKeyframe ? KeyframeIdxs : Changes.Skeletals;
+
+	for (int32 ItrIdx = 0; ItrIdx < Idxs.Num(); ++ItrIdx)
+	{
+		const int32 Idx = Idxs[ItrIdx];
+		const TSLEntityPreviousPose<USLSkeletalDataComponent>* Itr = &SkeletalEntities[Idx];
+		const FVector CurrLoc = Poses.GetLoc(Idx);
+		const FQuat CurrQuat = Poses.GetQuat(Idx);
+
+		bson_uint32_to_string(idx, &idx_key, idx_str, sizeof idx_str);
+		BSON_APPEND_DOCUMENT_BEGIN(out_doc, idx_key, &arr_obj);
+
+		AppendUtf8(&arr_obj, "id", Itr->Utf8->Id);
+		AddPoseChild(CurrLoc, CurrQuat, &arr_obj);
+
+		// The slot of the skeletal precedes the slots of its bones
+		if (bKeyframe)
+		{
+			SkeletalSlots[Idx] = PoseEncoder.AddSlot(GetLoggedLoc(CurrLoc));
+		}
+
+		// Add bones
+		if (Itr->Obj.IsValid())
+		{
+			TArrayView<const int32> BoneIdxs;
+			if (bKeyframe)
+			{
+				int32 FirstBoneIdx, LastBoneIdx;
+				Snapshot.GetBoneRange(Idx, FirstBoneIdx, LastBoneIdx);
+				KeyframeBoneIdxs.Reset();
+				for (int32 BoneIdx = FirstBoneIdx; BoneIdx < LastBoneIdx; ++BoneIdx)
+				{
+					KeyframeBoneIdxs.Add(BoneIdx);
+				}
+				BoneIdxs = KeyframeBoneIdxs;
+			}
+			else
+			{
+				BoneIdxs = Changes.GetMovedBones(ItrIdx);
+			}
+			AddSkeletalBones(Snapshot, BoneIdxs, Idx, *Itr, bKeyframe, &arr_obj);
+		}
+
+		bson_append_document_end(out_doc, &arr_obj);
+		idx++;
+	}
+}
+
+// Add gaze data to document
+void FSLWorldStateBsonBuilder::AddGazeData(const FSLGazeData& GazeData, bson_t* out_doc)
+{
+	FVector TargetLoc;
+	FVector OrigLoc;
+#if SL_WITH_ROS_CONVERSIONS
+	TargetLoc = FConversions::UToROS(GazeData.Target);
+	OrigLoc = FConversions::UToROS(GazeData.Origin);
+#else
+	TargetLoc = GazeData.Target;
+	OrigLoc = GazeData.Origin;
+#endif // SL_WITH_ROS_CONVERSIONS
+
+	// When nesting objects, parent needs to be init to a base state !!! 
+	bson_t gaze_obj = BSON_INITIALIZER; 
+	bson_t target_loc;
+	bson_t origin_loc;
+	
+	BSON_APPEND_UTF8(&gaze_obj, "entity_id", TCHAR_TO_UTF8(*GazeData.Entity.Id));
+	
+	BSON_APPEND_DOCUMENT_BEGIN(&gaze_obj, "target", &target_loc);
+	BSON_APPEND_DOUBLE(&target_loc, "x", TargetLoc.X);
+	BSON_APPEND_DOUBLE(&target_loc, "y", TargetLoc.Y);
+	BSON_APPEND_DOUBLE(&target_loc, "z", TargetLoc.Z);
+	bson_append_document_end(&gaze_obj, &target_loc);
+
+	BSON_APPEND_DOCUMENT_BEGIN(&gaze_obj, "origin", &origin_loc);
+	BSON_APPEND_DOUBLE(&origin_loc, "x", OrigLoc.X);
+	BSON_APPEND_DOUBLE(&origin_loc, "y", OrigLoc.Y);
+	BSON_APPEND_DOUBLE(&origin_loc, "z", OrigLoc.Z);
+	bson_append_document_end(&gaze_obj, &origin_loc);
+	
+	BSON_APPEND_DOCUMENT(out_doc, "gaze", &gaze_obj);
+}
+
+// Add the given captured bones of a skeletal entity to array
+void FSLWorldStateBsonBuilder::AddSkeletalBones(const FSLWorldStateSnapshot& Snapshot, TArrayView<const int32> BoneIdxs, int32 SkelIdx,
+	const TSLEntityPreviousPose<USLSkeletalDataComponent>& SkelEntity, bool bKeyframe, bson_t* out_doc)
+{
+	bson_t bones_arr;
+	bson_t arr_obj;
+	char idx_str[16];
+	const char *idx_key;
+	uint32_t arr_idx = 0;
+
+	// The pre-encoded bone strings are only valid if the skeletal mesh did not change since the init
+	int32 FirstBoneIdx, LastBoneIdx;
+	Snapshot.GetBoneRange(SkelIdx, FirstBoneIdx, LastBoneIdx);
+	const FSLEntityUtf8& Utf8 = *SkelEntity.Utf8;
+	const bool bHasUtf8Bones = Utf8.BoneNames.Num() == LastBoneIdx - FirstBoneIdx;
+
+	// Add entities to array
+	BSON_APPEND_ARRAY_BEGIN(out_doc, "bones", &bones_arr);
+
+	for (const int32 BoneIdx : BoneIdxs)
+	{
+		const FName& BoneName = Snapshot.BoneNames[BoneIdx];
+		const FVector CurrLoc = Snapshot.Bones.GetLoc(BoneIdx);
+		const FQuat CurrQuat = Snapshot.Bones.GetQuat(BoneIdx);
+
+		bson_uint32_to_string(arr_idx, &idx_key, idx_str, sizeof idx_str);
+		BSON_APPEND_DOCUMENT_BEGIN(&bones_arr, idx_key, &arr_obj);
+
+		if (bHasUtf8Bones)
+		{
+			AppendUtf8(&arr_obj, "name", Utf8.BoneNames[BoneIdx - FirstBoneIdx]);
+			const FSLUtf8Str& BoneId = Utf8.BoneIds[BoneIdx - FirstBoneIdx];
+			if (!BoneId.IsEmpty())
+			{
+				AppendUtf8(&arr_obj, "id", BoneId);
+			}
+		}
+		else
+		{
+			BSON_APPEND_UTF8(&arr_obj, "name", TCHAR_TO_UTF8(*BoneName.ToString()));
+			if(const FSLBoneData* BoneData = SkelEntity.Obj->SemanticBonesData.Find(BoneName))
+			{
+				//BSON_APPEND_UTF8(&arr_obj, "class", TCHAR_TO_UTF8(*BoneData->Class));
+				BSON_APPEND_UTF8(&arr_obj, "id", TCHAR_TO_UTF8(*BoneData->Id));
+			}
+		}
+
+		AddPoseChild(CurrLoc, CurrQuat, &arr_obj);
+
+		bson_append_document_end(&bones_arr, &arr_obj);
+		arr_idx++;
+
+		if (bKeyframe)
+		{
+			BoneSlots[BoneIdx] = PoseEncoder.AddSlot(GetLoggedLoc(CurrLoc));
+		}
+	}
+
+	bson_append_array_end(out_doc, &bones_arr);
+}
+
+// Add pose to document
+void FSLWorldStateBsonBuilder::AddPoseChild(const FVector& InLoc, const FQuat& InQuat, bson_t* out_doc)
+{
+	const FVector Loc = GetLoggedLoc(InLoc);
+	const FQuat Quat = GetLoggedQuat(InQuat);
+
+	bson_t child_obj_loc;
+	bson_t child_obj_rot;
+	
+	BSON_APPEND_DOCUMENT_BEGIN(out_doc, "loc", &child_obj_loc);
+	BSON_APPEND_DOUBLE(&child_obj_loc, "x", Loc.X);
+	BSON_APPEND_DOUBLE(&child_obj_loc, "y", Loc.Y);
+	BSON_APPEND_DOUBLE(&child_obj_loc, "z", Loc.Z);
+	bson_append_document_end(out_doc, &child_obj_loc);
+
+	BSON_APPEND_DOCUMENT_BEGIN(out_doc, "rot", &child_obj_rot);
+	BSON_APPEND_DOUBLE(&child_obj_rot, "x", Quat.X);
+	BSON_APPEND_DOUBLE(&child_obj_rot, "y", Quat.Y);
+	BSON_APPEND_DOUBLE(&child_obj_rot, "z", Quat.Z);
+	BSON_APPEND_DOUBLE(&child_obj_rot, "w", Quat.W);
+	bson_append_document_end(out_doc, &child_obj_rot);
+}
+
+// True if the next document has to be a keyframe
+bool FSLWorldStateBsonBuilder::NeedsKeyframe(const FSLWorldStateSnapshot& Snapshot,
+	int32 NumActors, int32 NumComponents, int32 NumSkeletals) const
+{
+	if (!bHasKeyframe || Snapshot.Timestamp - LastKeyframeTime >= Compression.KeyframeInterval)
+	{
+		return true;
+	}
+
+	// The entities changed since the last keyframe
+	if (ActorSlots.Num() != NumActors || ComponentSlots.Num() != NumComponents ||
+		SkeletalSlots.Num() != NumSkeletals || BoneSlots.Num() != Snapshot.Bones.Num())
+	{
+		return true;
+	}
+
+	// An entity became valid after the keyframe, it has no slot to write its deltas to
+	auto HasUnassignedSlot = [](const TArray<int32>& Slots, const FSLPoseArrays& Poses)
+	{
+		for (int32 Idx = 0; Idx < Slots.Num(); ++Idx)
+		{
+			if (Poses.Valid[Idx] && Slots[Idx] == INDEX_NONE)
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+	return HasUnassignedSlot(ActorSlots, Snapshot.Actors) ||
+		HasUnassignedSlot(ComponentSlots, Snapshot.Components) ||
+		HasUnassignedSlot(SkeletalSlots, Snapshot.Skeletals);
+}
+
+// Reset the slots, they are assigned while the keyframe is written
+void FSLWorldStateBsonBuilder::BeginKeyframe(const FSLWorldStateSnapshot& Snapshot,
+	int32 NumActors, int32 NumComponents, int32 NumSkeletals)
+{
+	PoseEncoder.Reset(Compression.LocPrecision);
+	ActorSlots.Init(INDEX_NONE, NumActors);
+	ComponentSlots.Init(INDEX_NONE, NumComponents);
+	SkeletalSlots.Init(INDEX_NONE, NumSkeletals);
+	BoneSlots.Init(INDEX_NONE, Snapshot.Bones.Num());
+	LastKeyframeTime = Snapshot.Timestamp;
+	bHasKeyframe = true;
+}
+
+// Add the deltas of the moved non skeletal entities, returns the number of added entities
+uint32 FSLWorldStateBsonBuilder::AddEntityDeltas(const FSLPoseArrays& Poses, const TArray<int32>& MovedIdxs,
+	const TArray<int32>& Slots)
+{
+	for (const int32 Idx : MovedIdxs)
+	{
+		PoseEncoder.AppendDelta(Slots[Idx], GetLoggedLoc(Poses.GetLoc(Idx)), GetLoggedQuat(Poses.GetQuat(Idx)), DeltaBuffer);
+	}
+	return MovedIdxs.Num();
+}
+
+// Add the deltas of the changed skeletal entities and their moved bones, returns the number of added skeletal entities
+uint32 FSLWorldStateBsonBuilder::AddSkeletalDeltas(const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes)
+{
+	const FSLPoseArrays& Poses = Snapshot.Skeletals;
+	for (int32 ItrIdx = 0; ItrIdx < Changes.Skeletals.Num(); ++ItrIdx)
+	{
+		const int32 Idx = Changes.Skeletals[ItrIdx];
+		PoseEncoder.AppendDelta(SkeletalSlots[Idx], GetLoggedLoc(Poses.GetLoc(Idx)), GetLoggedQuat(Poses.GetQuat(Idx)), DeltaBuffer);
+
+		// Bones without a slot were not part of the keyframe
+		for (const int32 BoneIdx : Changes.GetMovedBones(ItrIdx))
+		{
+			if (BoneSlots[BoneIdx] != INDEX_NONE)
+			{
+				PoseEncoder.AppendDelta(BoneSlots[BoneIdx], GetLoggedLoc(Snapshot.Bones.GetLoc(BoneIdx)),
+					GetLoggedQuat(Snapshot.Bones.GetQuat(BoneIdx)), DeltaBuffer);
+			}
+		}
+	}
+	return Changes.Skeletals.Num();
+}
+#endif //SL_WITH_LIBMONGO_C
+
+// Get the location as it is logged (ROS coordinates if available)
+FVector FSLWorldStateBsonBuilder::GetLoggedLoc(const FVector& InLoc)
+{
+#if SL_WITH_ROS_CONVERSIONS
+	return FConversions::UToROS(InLoc);
+#else
+	return InLoc;
+#endif // SL_WITH_ROS_CONVERSIONS
+}
+
+// Get the rotation as it is logged (ROS coordinates if available)
+FQuat FSLWorldStateBsonBuilder::GetLoggedQuat(const FQuat& InQuat)
+{
+#if SL_WITH_ROS_CONVERSIONS
+	return FConversions::UToROS(InQuat);
+#else
+	return InQuat;
+#endif // SL_WITH_ROS_CONVERSIONS
+}
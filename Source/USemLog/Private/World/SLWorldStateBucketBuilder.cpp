@@ -0,0 +1,201 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "World/SLWorldStateBucketBuilder.h"
+#include "World/SLWorldStateBsonBuilder.h"
+
+// Default ctor
+FSLWorldStateBucketBuilder::FSLWorldStateBucketBuilder() : WindowIdx(INDEX_NONE), NumSamples(0)
+{
+}
+
+// Set the bucket parameters
+void FSLWorldStateBucketBuilder::Init(const FSLWorldWriterMongoBucketParams& InParams)
+{
+	Params = InParams;
+	Params.BucketDuration = FMath::Max(Params.BucketDuration, 0.01f);
+	Buckets.Empty();
+	BucketIdxs.Empty();
+	WindowIdx = INDEX_NONE;
+	NumSamples = 0;
+}
+
+#if SL_WITH_LIBMONGO_C
+// Append the moved poses to their buckets, the documents of the buckets closed by the snapshot are added to the array
+void FSLWorldStateBucketBuilder::AddWorldState(const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes,
+	const TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
+	const TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
+	const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
+	TArray<bson_t*>& OutDocs)
+{
+	// The windows are aligned to the episode time so the buckets of all entities close together
+	const int64 SnapshotWindowIdx = FMath::FloorToInt(Snapshot.Timestamp / Params.BucketDuration);
+	if (SnapshotWindowIdx != WindowIdx)
+	{
+		BuildDocuments(OutDocs);
+		WindowIdx = SnapshotWindowIdx;
+	}
+
+	AddEntities(ActorEntities, Snapshot.Actors, Changes.Actors, Snapshot.Timestamp);
+	AddEntities(ComponentEntities, Snapshot.Components, Changes.Components, Snapshot.Timestamp);
+
+	// The trajectories are read per entity bucket, so the rigid children keep their own samples
+	AddEntities(ActorEntities, Snapshot.Actors, Changes.RigidActors, Snapshot.Timestamp);
+	AddEntities(ComponentEntities, Snapshot.Components, Changes.RigidComponents, Snapshot.Timestamp);
+	AddSkeletalEntities(SkeletalEntities, Snapshot, Changes);
+}
+
+// Create the documents of the open buckets (end of the episode)
+void FSLWorldStateBucketBuilder::CloseBuckets(TArray<bson_t*>& OutDocs)
+{
+	BuildDocuments(OutDocs);
+}
+
+// Create the documents of the non empty buckets and clear them
+void FSLWorldStateBucketBuilder::BuildDocuments(TArray<bson_t*>& OutDocs)
+{
+	if (NumSamples == 0)
+	{
+		return;
+	}
+
+	// Episode time of the window start as date (time series collections require a date time field)
+	const int64 WindowStartMs = static_cast<int64>(static_cast<double>(WindowIdx) * Params.BucketDuration * 1000.0);
+
+	for (FBucket& Bucket : Buckets)
+	{
+		const int32 Num = Bucket.Timestamps.Num();
+		if (Num == 0)
+		{
+			continue;
+		}
+
+		bson_t* doc = bson_new();
+		bson_t meta_obj;
+
+		BSON_APPEND_DATE_TIME(doc, FSLWorldStateBucketFormat::TimeField(), WindowStartMs);
+
+		BSON_APPEND_DOCUMENT_BEGIN(doc, FSLWorldStateBucketFormat::MetaField(), &meta_obj);
+		bson_append_utf8(&meta_obj, "id", -1, Bucket.Entity->Id.Get(), Bucket.Entity->Id.Len());
+		if (!Bucket.BoneName.IsEmpty())
+		{
+			bson_append_utf8(&meta_obj, "bone", -1, Bucket.BoneName.Get(), Bucket.BoneName.Len());
+			if (!Bucket.BoneId.IsEmpty())
+			{
+				bson_append_utf8(&meta_obj, "bone_id", -1, Bucket.BoneId.Get(), Bucket.BoneId.Len());
+			}
+		}
+		bson_append_document_end(doc, &meta_obj);
+
+		BSON_APPEND_DOUBLE(doc, "start", Bucket.StartTs);
+		BSON_APPEND_DOUBLE(doc, "end", Bucket.StartTs + Bucket.Timestamps.Last());
+		BSON_APPEND_INT32(doc, "num", Num);
+		BSON_APPEND_BINARY(doc, "timestamps", BSON_SUBTYPE_BINARY,
+			reinterpret_cast<const uint8_t*>(Bucket.Timestamps.GetData()), Num * sizeof(float));
+		BSON_APPEND_BINARY(doc, "locs", BSON_SUBTYPE_BINARY,
+			reinterpret_cast<const uint8_t*>(Bucket.Locs.GetData()), Num * 3 * sizeof(float));
+		BSON_APPEND_BINARY(doc, "quats", BSON_SUBTYPE_BINARY,
+			reinterpret_cast<const uint8_t*>(Bucket.Quats.GetData()), Num * 4 * sizeof(float));
+
+		OutDocs.Add(doc);
+
+		Bucket.Timestamps.Reset();
+		Bucket.Locs.Reset();
+		Bucket.Quats.Reset();
+	}
+	NumSamples = 0;
+}
+#endif //SL_WITH_LIBMONGO_C
+
+// Get (or create) the bucket of the entity
+FSLWorldStateBucketBuilder::FBucket& FSLWorldStateBucketBuilder::GetBucket(const TSharedPtr<const FSLEntityUtf8>& Entity, int32 LocalBoneIdx)
+{
+	const TPair<const FSLEntityUtf8*, int32> Key(Entity.Get(), LocalBoneIdx);
+	if (const int32* BucketIdx = BucketIdxs.Find(Key))
+	{
+		return Buckets[*BucketIdx];
+	}
+
+	const int32 BucketIdx = Buckets.AddDefaulted();
+	BucketIdxs.Add(Key, BucketIdx);
+	FBucket& Bucket = Buckets[BucketIdx];
+	Bucket.Entity = Entity;
+	return Bucket;
+}
+
+// Append the pose to the bucket
+void FSLWorldStateBucketBuilder::AddSample(FBucket& Bucket, double Timestamp, const FVector& InLoc, const FQuat& InQuat)
+{
+	const FVector Loc = FSLWorldStateBsonBuilder::GetLoggedLoc(InLoc);
+	const FQuat Quat = FSLWorldStateBsonBuilder::GetLoggedQuat(InQuat);
+	if (Bucket.Timestamps.Num() == 0)
+	{
+		Bucket.StartTs = Timestamp;
+	}
+	Bucket.Timestamps.Add(static_cast<float>(Timestamp - Bucket.StartTs));
+	Bucket.Locs.Append({ Loc.X, Loc.Y, Loc.Z });
+	Bucket.Quats.Append({ Quat.X, Quat.Y, Quat.Z, Quat.W });
+}
+
+// Add the given entities to their buckets
+template<typename T>
+void FSLWorldStateBucketBuilder::AddEntities(const TArray<TSLEntityPreviousPose<T>>& Entities, const FSLPoseArrays& Poses,
+	const TArray<int32>& MovedIdxs, float Timestamp)
+{
+	for (const int32 Idx : MovedIdxs)
+	{
+		AddSample(GetBucket(Entities[Idx].Utf8), Timestamp, Poses.GetLoc(Idx), Poses.GetQuat(Idx));
+	}
+	NumSamples += MovedIdxs.Num();
+}
+
+// Add the changed skeletal entities and their moved bones to their buckets
+void FSLWorldStateBucketBuilder::AddSkeletalEntities(const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
+	const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes)
+{
+	for (int32 ItrIdx = 0; ItrIdx < Changes.Skeletals.Num(); ++ItrIdx)
+	{
+		const int32 Idx = Changes.Skeletals[ItrIdx];
+		const TSLEntityPreviousPose<USLSkeletalDataComponent>& SkelEntity = SkeletalEntities[Idx];
+		AddSample(GetBucket(SkelEntity.Utf8), Snapshot.Timestamp, Snapshot.Skeletals.GetLoc(Idx), Snapshot.Skeletals.GetQuat(Idx));
+		NumSamples++;
+
+		if (!SkelEntity.Obj.IsValid())
+		{
+			continue;
+		}
+
+		int32 FirstBoneIdx, LastBoneIdx;
+		Snapshot.GetBoneRange(Idx, FirstBoneIdx, LastBoneIdx);
+		const FSLEntityUtf8& Utf8 = *SkelEntity.Utf8;
+		const bool bHasUtf8Bones = Utf8.BoneNames.Num() == LastBoneIdx - FirstBoneIdx;
+
+		for (const int32 BoneIdx : Changes.GetMovedBones(ItrIdx))
+		{
+			const int32 LocalBoneIdx = BoneIdx - FirstBoneIdx;
+			FBucket& Bucket = GetBucket(SkelEntity.Utf8, LocalBoneIdx);
+
+			// The bone strings are set when the bucket is created
+			if (Bucket.BoneName.IsEmpty())
+			{
+				if (bHasUtf8Bones)
+				{
+					Bucket.BoneName = Utf8.BoneNames[LocalBoneIdx];
+					Bucket.BoneId = Utf8.BoneIds[LocalBoneIdx];
+				}
+				else
+				{
+					const FName& BoneName = Snapshot.BoneNames[BoneIdx];
+					Bucket.BoneName = FSLUtf8Str(BoneName.ToString());
+					if (const FSLBoneData* BoneData = SkelEntity.Obj->SemanticBonesData.Find(BoneName))
+					{
+						Bucket.BoneId = FSLUtf8Str(BoneData->Id);
+					}
+				}
+			}
+
+			AddSample(Bucket, Snapshot.Timestamp, Snapshot.Bones.GetLoc(BoneIdx), Snapshot.Bones.GetQuat(BoneIdx));
+		}
+		NumSamples += Changes.GetMovedBones(ItrIdx).Num();
+	}
+}
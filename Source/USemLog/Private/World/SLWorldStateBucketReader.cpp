@@ -0,0 +1,288 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "World/SLWorldStateBucketReader.h"
+
+// Utils
+#if SL_WITH_ROS_CONVERSIONS
+#include "Conversions.h"
+#endif // SL_WITH_ROS_CONVERSIONS
+
+// Default ctor
+FSLWorldStateBucketReader::FSLWorldStateBucketReader() : bIsConnected(false)
+{
+#if SL_WITH_LIBMONGO_C
+	uri = nullptr;
+	client = nullptr;
+	collection = nullptr;
+#endif //SL_WITH_LIBMONGO_C
+}
+
+// Dtor
+FSLWorldStateBucketReader::~FSLWorldStateBucketReader()
+{
+	Disconnect();
+}
+
+// Connect to the episode collection
+bool FSLWorldStateBucketReader::Connect(const FString& DBName, const FString& CollectionName, const FString& ServerIp, uint16 ServerPort)
+{
+#if SL_WITH_LIBMONGO_C
+	Disconnect();
+
+	// Required to initialize libmongoc's internals
+	mongoc_init();
+
+	bson_error_t error;
+	FString Uri = TEXT("mongodb://") + ServerIp + TEXT(":") + FString::FromInt(ServerPort);
+	uri = mongoc_uri_new_with_error(TCHAR_TO_UTF8(*Uri), &error);
+	if (!uri)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s::%d Err.:%s; [Uri=%s]"),
+			*FString(__func__), __LINE__, *FString(error.message), *Uri);
+		return false;
+	}
+
+	client = mongoc_client_new_from_uri(uri);
+	if (!client)
+	{
+		Disconnect();
+		return false;
+	}
+	mongoc_client_set_appname(client, TCHAR_TO_UTF8(*("SLWorldReader_" + CollectionName)));
+	collection = mongoc_client_get_collection(client, TCHAR_TO_UTF8(*DBName), TCHAR_TO_UTF8(*CollectionName));
+
+	bIsConnected = true;
+	return true;
+#else
+	UE_LOG(LogTemp, Error, TEXT("%s::%d SL_WITH_LIBMONGO_C flag is 0, aborting.."),
+		*FString(__func__), __LINE__);
+	return false;
+#endif //SL_WITH_LIBMONGO_C
+}
+
+// Disconnect and clean db connection
+void FSLWorldStateBucketReader::Disconnect()
+{
+#if SL_WITH_LIBMONGO_C
+	if (collection)
+	{
+		mongoc_collection_destroy(collection);
+		collection = nullptr;
+	}
+	if (client)
+	{
+		mongoc_client_destroy(client);
+		client = nullptr;
+	}
+	if (uri)
+	{
+		mongoc_uri_destroy(uri);
+		uri = nullptr;
+	}
+	if (bIsConnected)
+	{
+		mongoc_cleanup();
+	}
+#endif //SL_WITH_LIBMONGO_C
+	bIsConnected = false;
+}
+
+// Get the poses of the entity in the interval
+bool FSLWorldStateBucketReader::GetEntityTrajectory(const FString& Id, float StartTs, float EndTs, TArray<FTransform>& OutTraj,
+	float DeltaT, TArray<float>* OutTimestamps) const
+{
+	return GetTrajectory(Id, nullptr, StartTs, EndTs, OutTraj, DeltaT, OutTimestamps);
+}
+
+// Get the poses of the bone of the skeletal entity in the interval
+bool FSLWorldStateBucketReader::GetBoneTrajectory(const FString& Id, const FString& BoneName, float StartTs, float EndTs,
+	TArray<FTransform>& OutTraj, float DeltaT, TArray<float>* OutTimestamps) const
+{
+	return GetTrajectory(Id, &BoneName, StartTs, EndTs, OutTraj, DeltaT, OutTimestamps);
+}
+
+// Query the buckets of the entity (or bone) overlapping the interval and unpack the samples
+bool FSLWorldStateBucketReader::GetTrajectory(const FString& Id, const FString* BoneName, float StartTs, float EndTs,
+	TArray<FTransform>& OutTraj, float DeltaT, TArray<float>* OutTimestamps) const
+{
+	OutTraj.Reset();
+	if (OutTimestamps)
+	{
+		OutTimestamps->Reset();
+	}
+
+	if (!bIsConnected)
+	{
+		return false;
+	}
+
+#if SL_WITH_LIBMONGO_C
+	// { meta.id: Id, meta.bone: BoneName | { $exists: false }, start: { $lte: EndTs }, end: { $gte: StartTs } }
+	bson_t* filter = CreateFilter(Id, BoneName);
+	BCON_APPEND(filter, "start", "{", "$lte", BCON_DOUBLE(EndTs), "}", "end", "{", "$gte", BCON_DOUBLE(StartTs), "}");
+
+	// The buckets are read in time order
+	bson_t* opts = BCON_NEW("sort", "{", FSLWorldStateBucketFormat::TimeField(), BCON_INT32(1), "}");
+
+	mongoc_cursor_t* cursor = mongoc_collection_find_with_opts(collection, filter, opts, NULL);
+	const bson_t* doc;
+	FReadState State;
+	while (mongoc_cursor_next(cursor, &doc))
+	{
+		ReadBucket(doc, StartTs, EndTs, DeltaT, State, OutTraj, OutTimestamps);
+	}
+
+	bson_error_t error;
+	bool bSuccess = !mongoc_cursor_error(cursor, &error);
+	if (!bSuccess)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s::%d Err.: %s"),
+			*FString(__func__), __LINE__, *FString(error.message));
+	}
+	mongoc_cursor_destroy(cursor);
+	bson_destroy(opts);
+	bson_destroy(filter);
+
+	// Entities are only logged when they move, without a sample at the interval start its pose is the last one logged before
+	const bool bStartsLater = State.FirstTs > StartTs;
+	if (bSuccess && bStartsLater && !State.bHasPrev)
+	{
+		// Latest bucket which ended before the interval
+		bson_t* prev_filter = CreateFilter(Id, BoneName);
+		BCON_APPEND(prev_filter, "end", "{", "$lt", BCON_DOUBLE(StartTs), "}");
+		bson_t* prev_opts = BCON_NEW("sort", "{", FSLWorldStateBucketFormat::TimeField(), BCON_INT32(-1), "}",
+			"limit", BCON_INT64(1));
+		mongoc_cursor_t* prev_cursor = mongoc_collection_find_with_opts(collection, prev_filter, prev_opts, NULL);
+		TArray<FTransform> NoTraj;
+		while (mongoc_cursor_next(prev_cursor, &doc))
+		{
+			ReadBucket(doc, StartTs, EndTs, DeltaT, State, NoTraj, nullptr);
+		}
+		bSuccess = !mongoc_cursor_error(prev_cursor, &error);
+		if (!bSuccess)
+		{
+			UE_LOG(LogTemp, Error, TEXT("%s::%d Err.: %s"),
+				*FString(__func__), __LINE__, *FString(error.message));
+		}
+		mongoc_cursor_destroy(prev_cursor);
+		bson_destroy(prev_opts);
+		bson_destroy(prev_filter);
+	}
+
+	if (bStartsLater && State.bHasPrev)
+	{
+		OutTraj.Insert(State.PrevPose, 0);
+		if (OutTimestamps)
+		{
+			OutTimestamps->Insert(static_cast<float>(State.PrevTs), 0);
+		}
+	}
+	return bSuccess;
+#else
+	return false;
+#endif //SL_WITH_LIBMONGO_C
+}
+
+#if SL_WITH_LIBMONGO_C
+// Create the filter of the buckets of the entity (or bone)
+bson_t* FSLWorldStateBucketReader::CreateFilter(const FString& Id, const FString* BoneName)
+{
+	bson_t* filter = BCON_NEW("meta.id", BCON_UTF8(TCHAR_TO_UTF8(*Id)));
+	if (BoneName)
+	{
+		BSON_APPEND_UTF8(filter, "meta.bone", TCHAR_TO_UTF8(**BoneName));
+	}
+	else
+	{
+		bson_t exists_obj;
+		BSON_APPEND_DOCUMENT_BEGIN(filter, "meta.bone", &exists_obj);
+		BSON_APPEND_BOOL(&exists_obj, "$exists", false);
+		bson_append_document_end(filter, &exists_obj);
+	}
+	return filter;
+}
+
+// Unpack the samples of the bucket document in the interval
+void FSLWorldStateBucketReader::ReadBucket(const bson_t* doc, double StartTs, double EndTs, float DeltaT, FReadState& State,
+	TArray<FTransform>& OutTraj, TArray<float>* OutTimestamps)
+{
+	bson_iter_t iter;
+	int32 Num = 0;
+	double BucketStartTs = 0.0;
+	const uint8_t* Timestamps = nullptr;
+	const uint8_t* Locs = nullptr;
+	const uint8_t* Quats = nullptr;
+	uint32_t TimestampsLen = 0, LocsLen = 0, QuatsLen = 0;
+	bson_subtype_t subtype;
+
+	if (bson_iter_init_find(&iter, doc, "num") && BSON_ITER_HOLDS_INT32(&iter))
+	{
+		Num = bson_iter_int32(&iter);
+	}
+	if (bson_iter_init_find(&iter, doc, "start") && BSON_ITER_HOLDS_DOUBLE(&iter))
+	{
+		BucketStartTs = bson_iter_double(&iter);
+	}
+	if (bson_iter_init_find(&iter, doc, "timestamps") && BSON_ITER_HOLDS_BINARY(&iter))
+	{
+		bson_iter_binary(&iter, &subtype, &TimestampsLen, &Timestamps);
+	}
+	if (bson_iter_init_find(&iter, doc, "locs") && BSON_ITER_HOLDS_BINARY(&iter))
+	{
+		bson_iter_binary(&iter, &subtype, &LocsLen, &Locs);
+	}
+	if (bson_iter_init_find(&iter, doc, "quats") && BSON_ITER_HOLDS_BINARY(&iter))
+	{
+		bson_iter_binary(&iter, &subtype, &QuatsLen, &Quats);
+	}
+
+	if (Num <= 0 || TimestampsLen != Num * sizeof(float) || LocsLen != Num * 3 * sizeof(float) || QuatsLen != Num * 4 * sizeof(float))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s::%d Skipping malformed bucket.."), *FString(__func__), __LINE__);
+		return;
+	}
+
+	// The binaries are not guaranteed to be aligned
+	float Offset, Loc[3], Quat[4];
+	for (int32 Idx = 0; Idx < Num; ++Idx)
+	{
+		FMemory::Memcpy(&Offset, Timestamps + Idx * sizeof(float), sizeof(float));
+		const double Ts = BucketStartTs + Offset;
+		if (Ts < StartTs)
+		{
+			// The buckets and their samples are in time order
+			FMemory::Memcpy(Loc, Locs + Idx * 3 * sizeof(float), sizeof(Loc));
+			FMemory::Memcpy(Quat, Quats + Idx * 4 * sizeof(float), sizeof(Quat));
+			State.bHasPrev = true;
+			State.PrevTs = Ts;
+			State.PrevPose = ToUnrealPose(Loc, Quat);
+			continue;
+		}
+		if (Ts > EndTs || (DeltaT > 0.f && Ts - State.LastTs < DeltaT))
+		{
+			continue;
+		}
+		FMemory::Memcpy(Loc, Locs + Idx * 3 * sizeof(float), sizeof(Loc));
+		FMemory::Memcpy(Quat, Quats + Idx * 4 * sizeof(float), sizeof(Quat));
+		OutTraj.Add(ToUnrealPose(Loc, Quat));
+		if (OutTimestamps)
+		{
+			OutTimestamps->Add(static_cast<float>(Ts));
+		}
+		State.FirstTs = FMath::Min(State.FirstTs, Ts);
+		State.LastTs = Ts;
+	}
+}
+#endif //SL_WITH_LIBMONGO_C
+
+// Convert the logged pose back to the unreal coordinates
+FTransform FSLWorldStateBucketReader::ToUnrealPose(const float* Loc, const float* Quat)
+{
+#if SL_WITH_ROS_CONVERSIONS
+	return FTransform(FConversions::ROSToU(FQuat(Quat[0], Quat[1], Quat[2], Quat[3])),
+		FConversions::ROSToU(FVector(Loc[0], Loc[1], Loc[2])));
+#else
+	return FTransform(FQuat(Quat[0], Quat[1], Quat[2], Quat[3]), FVector(Loc[0], Loc[1], Loc[2]));
+#endif // SL_WITH_ROS_CONVERSIONS
+}
@@ -0,0 +1,202 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "World/SLWorldStateBuffer.h"
+
+// Default ctor
+FSLWorldStateBuffer::FSLWorldStateBuffer() : Depth(0), WriteIdx(0), WriteSlot(INDEX_NONE), NumReaders(1)
+{
+	for (int32 Idx = 0; Idx < MaxReaders; ++Idx)
+	{
+		ReadIdxs[Idx] = 0;
+		ReadSlots[Idx] = INDEX_NONE;
+		NextReadIdxs[Idx] = 0;
+		NumSkipped[Idx] = 0;
+	}
+}
+
+// Allocate the snapshots
+void FSLWorldStateBuffer::Init(int32 InDepth, int32 NumActors, int32 NumComponents, int32 NumSkeletals, int32 NumBones, int32 InNumReaders)
+{
+	NumReaders = InNumReaders < 1 ? 1 : InNumReaders > MaxReaders ? static_cast<int32>(MaxReaders) : InNumReaders;
+	Depth = FMath::Max(InDepth, 1);
+
+	// Every following reader can hold one snapshot which is not pending anymore
+	const int32 NumSnapshots = Depth + NumReaders - 1;
+	Snapshots.Empty(NumSnapshots);
+	Snapshots.SetNum(NumSnapshots);
+	for (auto& Snapshot : Snapshots)
+	{
+		Snapshot.Reserve(NumActors, NumComponents, NumSkeletals, NumBones);
+	}
+	UsedSlots.SetNumZeroed(NumSnapshots);
+	WrittenSlots = MakeUnique<TAtomic<int32>[]>(Depth);
+	Reset();
+}
+
+// Remove all pending snapshots
+void FSLWorldStateBuffer::Reset()
+{
+	WriteIdx = 0;
+	WriteSlot = INDEX_NONE;
+	for (int32 Idx = 0; Idx < MaxReaders; ++Idx)
+	{
+		ReadIdxs[Idx] = 0;
+		ReadSlots[Idx] = INDEX_NONE;
+		NextReadIdxs[Idx] = 0;
+		NumSkipped[Idx] = 0;
+	}
+	for (int32 Idx = 0; Idx < Depth; ++Idx)
+	{
+		WrittenSlots[Idx] = INDEX_NONE;
+	}
+}
+
+// Producer: get the next free snapshot to fill, nullptr if the first reader is a buffer depth behind
+FSLWorldStateSnapshot* FSLWorldStateBuffer::BeginWrite()
+{
+	if (Snapshots.Num() == 0 || IsFull())
+	{
+		return nullptr;
+	}
+
+	// The following readers keep at most the snapshots the first reader can hold (the first reader is never behind these)
+	const uint64 CurrWriteIdx = WriteIdx.Load();
+	if (NumReaders > 1 && CurrWriteIdx >= static_cast<uint64>(Depth))
+	{
+		SkipLaggingReaders(CurrWriteIdx - Depth + 1);
+	}
+
+	WriteSlot = FindFreeSlot();
+	return WriteSlot != INDEX_NONE ? &Snapshots[WriteSlot] : nullptr;
+}
+
+// Producer: publish the snapshot returned by BeginWrite
+void FSLWorldStateBuffer::EndWrite()
+{
+	// Sequentially consistent stores, the snapshot data and its index are visible to the readers before the counter
+	const uint64 CurrWriteIdx = WriteIdx.Load();
+	WrittenSlots[CurrWriteIdx % Depth] = WriteSlot;
+	WriteIdx = CurrWriteIdx + 1;
+	WriteSlot = INDEX_NONE;
+}
+
+// Reader: get the oldest snapshot available to the reader, nullptr if there is none
+FSLWorldStateSnapshot* FSLWorldStateBuffer::BeginRead(int32 ReaderIdx)
+{
+	// The first reader is never skipped, its pending snapshots are not reused
+	if (ReaderIdx == 0)
+	{
+		const uint64 ReadIdx = ReadIdxs[0].Load();
+		return ReadIdx != WriteIdx.Load() ? &Snapshots[WrittenSlots[ReadIdx % Depth].Load()] : nullptr;
+	}
+
+	// The following readers only see the snapshots released by the first one
+	while (true)
+	{
+		const uint64 ReadIdx = ReadIdxs[ReaderIdx].Load();
+		if (ReadIdx == ReadIdxs[0].Load())
+		{
+			NumSkipped[ReaderIdx] += static_cast<int32>(ReadIdx - NextReadIdxs[ReaderIdx]);
+			NextReadIdxs[ReaderIdx] = ReadIdx;
+			return nullptr;
+		}
+
+		// Mark the snapshot as being read, if the producer skipped the reader meanwhile the snapshot might be reused
+		const int32 Slot = WrittenSlots[ReadIdx % Depth].Load();
+		ReadSlots[ReaderIdx] = Slot;
+		if (ReadIdxs[ReaderIdx].Load() == ReadIdx)
+		{
+			NumSkipped[ReaderIdx] += static_cast<int32>(ReadIdx - NextReadIdxs[ReaderIdx]);
+			NextReadIdxs[ReaderIdx] = ReadIdx + 1;
+			return &Snapshots[Slot];
+		}
+		ReadSlots[ReaderIdx] = INDEX_NONE;
+	}
+}
+
+// Reader: release the snapshot returned by BeginRead
+void FSLWorldStateBuffer::EndRead(int32 ReaderIdx)
+{
+	if (ReaderIdx == 0)
+	{
+		++ReadIdxs[0];
+		return;
+	}
+
+	// Fails if the producer already moved the reader past the snapshot
+	uint64 ReadIdx = NextReadIdxs[ReaderIdx] - 1;
+	ReadIdxs[ReaderIdx].CompareExchange(ReadIdx, ReadIdx + 1);
+	ReadSlots[ReaderIdx] = INDEX_NONE;
+}
+
+// True if every reader is done with all the snapshots
+bool FSLWorldStateBuffer::IsDrained() const
+{
+	const uint64 CurrWriteIdx = WriteIdx.Load();
+	for (int32 Idx = 0; Idx < NumReaders; ++Idx)
+	{
+		if (ReadIdxs[Idx].Load() != CurrWriteIdx)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Number of snapshots not yet released by the slowest reader
+int32 FSLWorldStateBuffer::GetNumUnread() const
+{
+	const uint64 CurrWriteIdx = WriteIdx.Load();
+	uint64 MinReadIdx = CurrWriteIdx;
+	for (int32 Idx = 0; Idx < NumReaders; ++Idx)
+	{
+		MinReadIdx = FMath::Min(MinReadIdx, ReadIdxs[Idx].Load());
+	}
+	return static_cast<int32>(CurrWriteIdx - MinReadIdx);
+}
+
+// Move the following readers behind the given counter to it, their older snapshots are skipped
+void FSLWorldStateBuffer::SkipLaggingReaders(uint64 MinIdx)
+{
+	for (int32 Idx = 1; Idx < NumReaders; ++Idx)
+	{
+		// Retried if the reader released a snapshot meanwhile
+		uint64 ReadIdx = ReadIdxs[Idx].Load();
+		while (ReadIdx < MinIdx && !ReadIdxs[Idx].CompareExchange(ReadIdx, MinIdx))
+		{
+		}
+	}
+}
+
+// Get a snapshot which is not pending for any reader nor being read
+int32 FSLWorldStateBuffer::FindFreeSlot()
+{
+	// The readers were moved to the last depth - 1 snapshots, these are the only pending ones
+	FMemory::Memzero(UsedSlots.GetData(), UsedSlots.Num() * sizeof(bool));
+	const uint64 CurrWriteIdx = WriteIdx.Load();
+	const uint64 FirstKeptIdx = CurrWriteIdx >= static_cast<uint64>(Depth) ? CurrWriteIdx - Depth + 1 : 0;
+	for (uint64 Idx = FirstKeptIdx; Idx < CurrWriteIdx; ++Idx)
+	{
+		UsedSlots[WrittenSlots[Idx % Depth].Load()] = true;
+	}
+
+	// Loaded after the readers were moved, a reader which marked a snapshot before that is still reading it
+	for (int32 Idx = 1; Idx < NumReaders; ++Idx)
+	{
+		const int32 Slot = ReadSlots[Idx].Load();
+		if (Slot != INDEX_NONE)
+		{
+			UsedSlots[Slot] = true;
+		}
+	}
+
+	for (int32 Slot = 0; Slot < UsedSlots.Num(); ++Slot)
+	{
+		if (!UsedSlots[Slot])
+		{
+			return Slot;
+		}
+	}
+	return INDEX_NONE;
+}
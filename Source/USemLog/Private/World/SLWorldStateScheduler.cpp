@@ -0,0 +1,185 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "World/SLWorldStateScheduler.h"
+
+// Default ctor
+FSLWorldStateScheduler::FSLWorldStateScheduler() : LastTimestamp(-1.f), bSortBaseIdxs(false)
+{
+}
+
+// Create the tiers from the update rates of the entities
+void FSLWorldStateScheduler::Init(const TArray<float>& ActorRates, const TArray<float>& ComponentRates, const TArray<float>& SkeletalRates)
+{
+	Tiers.Empty();
+	LastTimestamp = -1.f;
+	bSortBaseIdxs = false;
+	AddGroup(ESLScheduledGroup::Actors, ActorRates);
+	AddGroup(ESLScheduledGroup::Components, ComponentRates);
+	AddGroup(ESLScheduledGroup::Skeletals, SkeletalRates);
+}
+
+// Mark the tier entities which are due at the given capture time
+void FSLWorldStateScheduler::Advance(float Timestamp)
+{
+	if (LastTimestamp < 0.f)
+	{
+		// Initial capture, every entity is read
+		for (const FTier& Tier : Tiers)
+		{
+			for (const auto& Entry : Tier.Entries)
+			{
+				SetDue(Entry);
+			}
+		}
+	}
+	else
+	{
+		const float DeltaT = FMath::Max(Timestamp - LastTimestamp, 0.f);
+		for (FTier& Tier : Tiers)
+		{
+			// Every entry is read once per update rate, the reads are spread over the captures in between
+			const int32 NumEntries = Tier.Entries.Num();
+			Tier.Budget = FMath::Min(Tier.Budget + NumEntries * DeltaT / Tier.UpdateRate, static_cast<float>(NumEntries));
+			const int32 NumDue = FMath::FloorToInt(Tier.Budget);
+			Tier.Budget -= NumDue;
+			for (int32 Count = 0; Count < NumDue; ++Count)
+			{
+				SetDue(Tier.Entries[Tier.Cursor]);
+				Tier.Cursor = (Tier.Cursor + 1) % NumEntries;
+			}
+		}
+	}
+	LastTimestamp = Timestamp;
+
+	// The captured indexes are expected in ascending order
+	for (FSLScheduledGroup& Group : Groups)
+	{
+		Group.DueIdxs.Sort();
+		if (bSortBaseIdxs)
+		{
+			Group.BaseIdxs.Sort();
+			for (int32 Pos = 0; Pos < Group.BaseIdxs.Num(); ++Pos)
+			{
+				Group.EntryIdxs[Group.BaseIdxs[Pos]] = Pos;
+			}
+		}
+	}
+	bSortBaseIdxs = false;
+}
+
+// Clear the due flags of the tier entities after the capture
+void FSLWorldStateScheduler::ClearDue()
+{
+	for (FSLScheduledGroup& Group : Groups)
+	{
+		for (const int32 Idx : Group.DueIdxs)
+		{
+			Group.bIsDue[Idx] = false;
+		}
+		Group.DueIdxs.Reset();
+	}
+}
+
+// Add the entities of the group to the base list or to their tiers
+void FSLWorldStateScheduler::AddGroup(ESLScheduledGroup InGroup, const TArray<float>& Rates)
+{
+	FSLScheduledGroup& Group = Groups[static_cast<uint8>(InGroup)];
+	Group.BaseIdxs.Reset();
+	Group.DueIdxs.Reset();
+	Group.bIsDue.Init(true, Rates.Num());
+	Group.TierIdxs.Init(INDEX_NONE, Rates.Num());
+	Group.EntryIdxs.SetNumUninitialized(Rates.Num());
+	for (int32 Idx = 0; Idx < Rates.Num(); ++Idx)
+	{
+		if (Rates[Idx] <= 0.f)
+		{
+			Group.EntryIdxs[Idx] = Group.BaseIdxs.Add(Idx);
+			continue;
+		}
+
+		// Entities are only read when due
+		Group.bIsDue[Idx] = false;
+		FTier* Tier = Tiers.FindByPredicate([&](const FTier& T) { return FMath::IsNearlyEqual(T.UpdateRate, Rates[Idx]); });
+		if (!Tier)
+		{
+			Tier = &Tiers.AddDefaulted_GetRef();
+			Tier->UpdateRate = Rates[Idx];
+		}
+		Group.TierIdxs[Idx] = static_cast<int32>(Tier - Tiers.GetData());
+		Group.EntryIdxs[Idx] = Tier->Entries.Emplace(InGroup, Idx);
+	}
+}
+
+// Mark the tier entry as due
+void FSLWorldStateScheduler::SetDue(const TPair<ESLScheduledGroup, int32>& Entry)
+{
+	FSLScheduledGroup& Group = Groups[static_cast<uint8>(Entry.Key)];
+	if (!Group.bIsDue[Entry.Value])
+	{
+		Group.bIsDue[Entry.Value] = true;
+		Group.DueIdxs.Add(Entry.Value);
+	}
+}
+
+// Remove the entity of the group, the last entity of the group takes its index
+void FSLWorldStateScheduler::RemoveAtSwap(ESLScheduledGroup InGroup, int32 Idx)
+{
+	FSLScheduledGroup& Group = Groups[static_cast<uint8>(InGroup)];
+	if (!Group.bIsDue.IsValidIndex(Idx))
+	{
+		return;
+	}
+
+	// The removals happen between the captures, there are no due tier entities
+	RemoveEntry(InGroup, Idx);
+	const int32 LastIdx = Group.bIsDue.Num() - 1;
+	if (Idx != LastIdx)
+	{
+		const int32 TierIdx = Group.TierIdxs[LastIdx];
+		const int32 EntryIdx = Group.EntryIdxs[LastIdx];
+		if (TierIdx == INDEX_NONE)
+		{
+			Group.BaseIdxs[EntryIdx] = Idx;
+			bSortBaseIdxs = true;
+		}
+		else
+		{
+			Tiers[TierIdx].Entries[EntryIdx].Value = Idx;
+		}
+	}
+	Group.bIsDue.RemoveAtSwap(Idx, 1, false);
+	Group.TierIdxs.RemoveAtSwap(Idx, 1, false);
+	Group.EntryIdxs.RemoveAtSwap(Idx, 1, false);
+}
+
+// Remove the entity from its base list or tier entries
+void FSLWorldStateScheduler::RemoveEntry(ESLScheduledGroup InGroup, int32 Idx)
+{
+	FSLScheduledGroup& Group = Groups[static_cast<uint8>(InGroup)];
+	const int32 TierIdx = Group.TierIdxs[Idx];
+	const int32 EntryIdx = Group.EntryIdxs[Idx];
+	if (TierIdx == INDEX_NONE)
+	{
+		Group.BaseIdxs.RemoveAtSwap(EntryIdx, 1, false);
+		if (Group.BaseIdxs.IsValidIndex(EntryIdx))
+		{
+			Group.EntryIdxs[Group.BaseIdxs[EntryIdx]] = EntryIdx;
+			bSortBaseIdxs = true;
+		}
+	}
+	else
+	{
+		FTier& Tier = Tiers[TierIdx];
+		Tier.Entries.RemoveAtSwap(EntryIdx, 1, false);
+		if (Tier.Entries.IsValidIndex(EntryIdx))
+		{
+			const TPair<ESLScheduledGroup, int32>& Moved = Tier.Entries[EntryIdx];
+			Groups[static_cast<uint8>(Moved.Key)].EntryIdxs[Moved.Value] = EntryIdx;
+		}
+		if (Tier.Cursor >= Tier.Entries.Num())
+		{
+			Tier.Cursor = 0;
+		}
+	}
+}
@@ -0,0 +1,266 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "World/SLWorldTelemetry.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_STAT(STAT_SLWorldCapture);
+DEFINE_STAT(STAT_SLWorldDetect);
+DEFINE_STAT(STAT_SLWorldSerialize);
+DEFINE_STAT(STAT_SLWorldQueueDepth);
+DEFINE_STAT(STAT_SLWorldChangedEntities);
+DEFINE_STAT(STAT_SLWorldBytesPerFrame);
+DEFINE_STAT(STAT_SLWorldDroppedFrames);
+DEFINE_STAT(STAT_SLWorldLateFrames);
+
+// Add a sample
+void FSLLatencyHistogram::Add(double Seconds)
+{
+	const uint32 Us = static_cast<uint32>(FMath::Clamp(Seconds * 1e6, 1.0, static_cast<double>(MAX_uint32)));
+	Buckets[FMath::Min(static_cast<int32>(FMath::FloorLog2(Us)), NumBuckets - 1)]++;
+	Count++;
+	Sum += Seconds;
+	Max = FMath::Max(Max, Seconds);
+}
+
+// Add the samples of another histogram
+void FSLLatencyHistogram::Merge(const FSLLatencyHistogram& Other)
+{
+	for (int32 Idx = 0; Idx < NumBuckets; ++Idx)
+	{
+		Buckets[Idx] += Other.Buckets[Idx];
+	}
+	Count += Other.Count;
+	Sum += Other.Sum;
+	Max = FMath::Max(Max, Other.Max);
+}
+
+// Upper bound of the bucket containing the given percentile
+double FSLLatencyHistogram::GetPercentile(float Percentile) const
+{
+	const int64 Rank = FMath::CeilToInt(FMath::Clamp(Percentile, 0.f, 1.f) * Count);
+	int64 NumBelow = 0;
+	for (int32 Idx = 0; Idx < NumBuckets; ++Idx)
+	{
+		NumBelow += Buckets[Idx];
+		if (NumBelow >= Rank && NumBelow > 0)
+		{
+			// The open bucket is bounded by the max
+			return Idx < NumBuckets - 1 ? FMath::Min(static_cast<double>(1ull << (Idx + 1)) * 1e-6, Max) : Max;
+		}
+	}
+	return Max;
+}
+
+// Json object with the summary and the non-empty buckets
+FString FSLLatencyHistogram::ToJson() const
+{
+	FString Json = FString::Printf(TEXT("{\"count\":%lld,\"mean_ms\":%.4f,\"max_ms\":%.4f,\"p50_ms\":%.4f,\"p90_ms\":%.4f,\"p99_ms\":%.4f,\"buckets_us\":{"),
+		Count, GetMean() * 1e3, Max * 1e3, GetPercentile(0.5f) * 1e3, GetPercentile(0.9f) * 1e3, GetPercentile(0.99f) * 1e3);
+	bool bFirst = true;
+	for (int32 Idx = 0; Idx < NumBuckets; ++Idx)
+	{
+		if (Buckets[Idx] > 0)
+		{
+			Json += FString::Printf(TEXT("%s\"%u\":%u"), bFirst ? TEXT("") : TEXT(","), 1u << Idx, Buckets[Idx]);
+			bFirst = false;
+		}
+	}
+	Json += TEXT("}}");
+	return Json;
+}
+
+// Add the statistics of a written frame
+void FSLWorldWriterTelemetry::AddFrame(double Duration, int64 FrameBytes, bool bKeepFrames)
+{
+	SerializeLatencies.Add(Duration);
+	NumBytes += FrameBytes;
+	if (bKeepFrames)
+	{
+		FSLWorldWriteRecord& Record = Frames.AddDefaulted_GetRef();
+		Record.Duration = Duration;
+		Record.Num = static_cast<int32>(FrameBytes);
+	}
+	SET_DWORD_STAT(STAT_SLWorldBytesPerFrame, FrameBytes);
+}
+
+// Add frames skipped by the writer
+void FSLWorldWriterTelemetry::AddSkipped(int32 Num, bool bKeepFrames)
+{
+	NumSkipped += Num;
+	if (bKeepFrames)
+	{
+		for (int32 Idx = 0; Idx < Num; ++Idx)
+		{
+			Frames.AddDefaulted_GetRef().bSkipped = true;
+		}
+	}
+}
+
+// Default ctor
+FSLWorldTelemetry::FSLWorldTelemetry() :
+	bKeepFrames(false),
+	ExpectedInterval(0.f),
+	LastTimestamp(-1.f),
+	NumDropped(0),
+	NumLate(0),
+	MaxQueueDepth(0)
+{
+}
+
+// Create the writer slots
+void FSLWorldTelemetry::Init(const TArray<FString>& WriterNames, bool bInKeepFrames)
+{
+	bKeepFrames = bInKeepFrames;
+	Writers.Empty(WriterNames.Num());
+	for (const FString& Name : WriterNames)
+	{
+		Writers.AddDefaulted_GetRef().Name = Name;
+	}
+}
+
+// Add a capture
+void FSLWorldTelemetry::AddCapture(float Timestamp, double Duration, int32 QueueDepth, bool bDropped)
+{
+	// A capture is late if it came half an update later than expected
+	const bool bLate = ExpectedInterval > 0.f && LastTimestamp >= 0.f && Timestamp - LastTimestamp > 1.5f * ExpectedInterval;
+	LastTimestamp = Timestamp;
+
+	CaptureLatencies.Add(Duration);
+	MaxQueueDepth = FMath::Max(MaxQueueDepth, QueueDepth);
+	SET_DWORD_STAT(STAT_SLWorldQueueDepth, QueueDepth);
+	if (bDropped)
+	{
+		NumDropped++;
+		INC_DWORD_STAT(STAT_SLWorldDroppedFrames);
+	}
+	if (bLate)
+	{
+		NumLate++;
+		INC_DWORD_STAT(STAT_SLWorldLateFrames);
+	}
+
+	if (bKeepFrames)
+	{
+		FSLWorldCaptureRecord& Record = Captures.AddDefaulted_GetRef();
+		Record.Timestamp = Timestamp;
+		Record.CaptureTime = Duration;
+		Record.QueueDepth = QueueDepth;
+		Record.bDropped = bDropped;
+		Record.bLate = bLate;
+	}
+}
+
+// Add a change detection
+void FSLWorldTelemetry::AddDetection(double Duration, int32 NumChanged)
+{
+	DetectLatencies.Add(Duration);
+	SET_DWORD_STAT(STAT_SLWorldChangedEntities, NumChanged);
+	if (bKeepFrames)
+	{
+		FSLWorldWriteRecord& Record = Detections.AddDefaulted_GetRef();
+		Record.Duration = Duration;
+		Record.Num = NumChanged;
+	}
+}
+
+// Write the csv and json files
+void FSLWorldTelemetry::Dump(const FString& TaskId, const FString& EpisodeId) const
+{
+	FString EpisodesDirPath = FPaths::ProjectDir() + "/SemLog/" + TaskId + TEXT("/Episodes/");
+	FPaths::RemoveDuplicateSlashes(EpisodesDirPath);
+
+	if (bKeepFrames)
+	{
+		const FString CsvPath = EpisodesDirPath + EpisodeId + TEXT("_WS_Telemetry.csv");
+		if (!FFileHelper::SaveStringToFile(ToCsv(), *CsvPath))
+		{
+			UE_LOG(LogTemp, Error, TEXT("%s::%d Could not write %s.."), *FString(__func__), __LINE__, *CsvPath);
+		}
+	}
+
+	const FString JsonPath = EpisodesDirPath + EpisodeId + TEXT("_WS_Telemetry.json");
+	if (!FFileHelper::SaveStringToFile(ToJson(), *JsonPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s::%d Could not write %s.."), *FString(__func__), __LINE__, *JsonPath);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("%s::%d %lld captures (avg %.3f ms, max %.3f ms), %d dropped, %d late, max queue depth %d.."),
+		*FString(__func__), __LINE__, CaptureLatencies.Count, CaptureLatencies.GetMean() * 1e3, CaptureLatencies.Max * 1e3,
+		NumDropped, NumLate, MaxQueueDepth);
+	for (const auto& Writer : Writers)
+	{
+		if (Writer.NumSkipped > 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("%s::%d The %s writer fell behind and skipped %d frames.."),
+				*FString(__func__), __LINE__, *Writer.Name, Writer.NumSkipped);
+		}
+		if (Writer.NumSpilledBytes > 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("%s::%d The %s writer queued up to %lld bytes and spilled %lld bytes to its journal.."),
+				*FString(__func__), __LINE__, *Writer.Name, Writer.MaxQueuedBytes, Writer.NumSpilledBytes);
+		}
+	}
+}
+
+// Per frame csv rows
+FString FSLWorldTelemetry::ToCsv() const
+{
+	FString Csv = TEXT("timestamp,capture_ms,queue_depth,dropped,late,detect_ms,changed");
+	for (const auto& Writer : Writers)
+	{
+		Csv += FString::Printf(TEXT(",%s_ms,%s_bytes"), *Writer.Name, *Writer.Name);
+	}
+	Csv += TEXT("\n");
+
+	// The dropped frames were neither detected nor written
+	int32 WrittenIdx = 0;
+	for (const auto& Capture : Captures)
+	{
+		Csv += FString::Printf(TEXT("%f,%.4f,%d,%d,%d"), Capture.Timestamp, Capture.CaptureTime * 1e3f,
+			Capture.QueueDepth, Capture.bDropped ? 1 : 0, Capture.bLate ? 1 : 0);
+		if (!Capture.bDropped)
+		{
+			Csv += Detections.IsValidIndex(WrittenIdx)
+				? FString::Printf(TEXT(",%.4f,%d"), Detections[WrittenIdx].Duration * 1e3f, Detections[WrittenIdx].Num)
+				: TEXT(",,");
+			for (const auto& Writer : Writers)
+			{
+				Csv += Writer.Frames.IsValidIndex(WrittenIdx) && !Writer.Frames[WrittenIdx].bSkipped
+					? FString::Printf(TEXT(",%.4f,%d"), Writer.Frames[WrittenIdx].Duration * 1e3f, Writer.Frames[WrittenIdx].Num)
+					: TEXT(",,");
+			}
+			WrittenIdx++;
+		}
+		else
+		{
+			Csv += TEXT(",,");
+			for (int32 Idx = 0; Idx < Writers.Num(); ++Idx)
+			{
+				Csv += TEXT(",,");
+			}
+		}
+		Csv += TEXT("\n");
+	}
+	return Csv;
+}
+
+// Summary with the histograms
+FString FSLWorldTelemetry::ToJson() const
+{
+	FString Json = FString::Printf(TEXT("{\"num_captures\":%lld,\"num_dropped\":%d,\"num_late\":%d,\"max_queue_depth\":%d,"),
+		CaptureLatencies.Count, NumDropped, NumLate, MaxQueueDepth);
+	Json += TEXT("\"capture\":") + CaptureLatencies.ToJson();
+	Json += TEXT(",\"detect\":") + DetectLatencies.ToJson();
+	Json += TEXT(",\"writers\":[");
+	for (int32 Idx = 0; Idx < Writers.Num(); ++Idx)
+	{
+		const auto& Writer = Writers[Idx];
+		Json += FString::Printf(TEXT("%s{\"name\":\"%s\",\"bytes\":%lld,\"skipped\":%d,\"max_queued_bytes\":%lld,\"spilled_bytes\":%lld,\"serialize\":%s,\"round_trip\":%s}"),
+			Idx > 0 ? TEXT(",") : TEXT(""), *Writer.Name, Writer.NumBytes, Writer.NumSkipped, Writer.MaxQueuedBytes, Writer.NumSpilledBytes,
+			*Writer.SerializeLatencies.ToJson(), *Writer.RoundTripLatencies.ToJson());
+	}
+	Json += TEXT("]}\n");
+	return Json;
+}
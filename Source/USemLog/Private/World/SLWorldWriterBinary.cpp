@@ -0,0 +1,363 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "World/SLWorldWriterBinary.h"
+#include "HAL/PlatformFilemanager.h"
+
+// Utils
+#if SL_WITH_ROS_CONVERSIONS
+#include "Conversions.h"
+#endif // SL_WITH_ROS_CONVERSIONS
+
+// Constr
+FSLWorldWriterBinary::FSLWorldWriterBinary()
+{
+	bIsInit = false;
+	FileHandle = nullptr;
+}
+
+// Init constructor
+FSLWorldWriterBinary::FSLWorldWriterBinary(const FSLWorldWriterParams& InParams)
+{
+	bIsInit = false;
+	FileHandle = nullptr;
+	FSLWorldWriterBinary::Init(InParams);
+}
+
+// Destr
+FSLWorldWriterBinary::~FSLWorldWriterBinary()
+{
+	FSLWorldWriterBinary::Finish();
+	CompressedWriter.Reset();
+	if (FileHandle)
+	{
+		delete FileHandle;
+	}
+}
+
+// Init
+void FSLWorldWriterBinary::Init(const FSLWorldWriterParams& InParams)
+{
+	if (!bIsInit)
+	{
+		LinDistSqMin = InParams.LinearDistanceSquared;
+		AngDistMin = InParams.AngularDistance;
+		FileOffset = 0;
+		NumPendingDictEntries = 0;
+		NextHandle = 0;
+		OutBuffer.Reserve(FlushSize + FlushSize / 4);
+
+		if (SetFileHandle(InParams.TaskId, InParams.EpisodeId, InParams.FileCompression))
+		{
+			// File header
+			const uint32 Magic = FSLWorldBinaryFormat::Magic;
+			const uint16 Version = FSLWorldBinaryFormat::Version;
+			const uint16 Reserved = 0;
+			Append(&Magic, sizeof(Magic));
+			Append(&Version, sizeof(Version));
+			Append(&Reserved, sizeof(Reserved));
+			bIsInit = true;
+		}
+	}
+}
+
+// Finish
+void FSLWorldWriterBinary::Finish()
+{
+	if (bIsInit)
+	{
+		WriteSeekTable();
+		Flush();
+		if (CompressedWriter.IsValid())
+		{
+			CompressedWriter->Finish();
+		}
+		if (FileHandle)
+		{
+			FileHandle->Flush();
+		}
+		bIsInit = false;
+	}
+}
+
+// Called to write the data
+void FSLWorldWriterBinary::Write(const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes,
+	const TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
+	const TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
+	const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities)
+{
+	if (!bIsInit)
+	{
+		return;
+	}
+
+	FrameHandles.Reset();
+	FrameLocs.Reset();
+	FrameQuats.Reset();
+	FrameRigidHandles.Reset();
+
+	AddEntities(ActorEntities, Snapshot.Actors, Changes.Actors);
+	AddEntities(ComponentEntities, Snapshot.Components, Changes.Components);
+	AddRigidEntities(ActorEntities, Changes.RigidActors, Changes.RigidActorRoots, ActorEntities, ComponentEntities);
+	AddRigidEntities(ComponentEntities, Changes.RigidComponents, Changes.RigidComponentRoots, ActorEntities, ComponentEntities);
+	AddSkeletalEntities(SkeletalEntities, Snapshot, Changes);
+
+	// Avoid writing empty frames
+	if (FrameHandles.Num() > 0)
+	{
+		const int32 FrameStart = OutBuffer.Num();
+		WriteFrame(Snapshot.Timestamp);
+		NumBytesWritten += OutBuffer.Num() - FrameStart;
+	}
+
+	if (OutBuffer.Num() >= FlushSize)
+	{
+		Flush();
+	}
+}
+
+// Set the file handle for the logger
+bool FSLWorldWriterBinary::SetFileHandle(const FString& LogDirectory, const FString& InEpisodeId, ESLFileCompression InCompression)
+{
+	FString Filename = InEpisodeId + TEXT("_WS.bin");
+	if (InCompression != ESLFileCompression::None)
+	{
+		Filename += FSLCompressedFileFormat::GetExtension(InCompression);
+	}
+	FString EpisodesDirPath = FPaths::ProjectDir() + "/SemLog/" + LogDirectory + TEXT("/Episodes/");
+	FPaths::RemoveDuplicateSlashes(EpisodesDirPath);
+
+	const FString FilePath = EpisodesDirPath + Filename;
+
+	// Create logging directory path and the filehandle
+	FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*EpisodesDirPath);
+	FileHandle = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*FilePath);
+
+	// The blocks are compressed on a separate thread, the flushes only copy the data
+	if (FileHandle && InCompression != ESLFileCompression::None)
+	{
+		CompressedWriter = MakeUnique<FSLCompressedFileWriter>(FileHandle, InCompression);
+		if (!CompressedWriter->Start())
+		{
+			CompressedWriter.Reset();
+			delete FileHandle;
+			FileHandle = nullptr;
+		}
+	}
+
+	return FileHandle != nullptr;
+}
+
+// Get the handle of the entity, it is added to the dictionary if seen for the first time
+uint32 FSLWorldWriterBinary::GetHandle(const FSLEntity& Entity)
+{
+	// Keyed by the id, a new object reusing the address of a destroyed one does not inherit its handle
+	if (const uint32* Handle = EntityHandles.Find(Entity.Id))
+	{
+		return *Handle;
+	}
+	const uint32 NewHandle = AddDictionaryEntry(Entity.Id, Entity.Class, FString(), FSLWorldBinaryFormat::InvalidHandle);
+	EntityHandles.Add(Entity.Id, NewHandle);
+	return NewHandle;
+}
+
+// Get the handle of the first bone of the skeletal entity, the bones are added to the dictionary if seen for the first time
+uint32 FSLWorldWriterBinary::GetFirstBoneHandle(const TSLEntityPreviousPose<USLSkeletalDataComponent>& SkelEntity,
+	uint32 SkelHandle, const FSLWorldStateSnapshot& Snapshot, int32 SkelIdx)
+{
+	int32 FirstBoneIdx, LastBoneIdx;
+	Snapshot.GetBoneRange(SkelIdx, FirstBoneIdx, LastBoneIdx);
+	const int32 NumBones = LastBoneIdx - FirstBoneIdx;
+
+	// A changed bone count (e.g. new skeletal mesh) gets a new range of handles, the previous one is not referenced anymore
+	if (const TPair<uint32, int32>* BoneHandles = FirstBoneHandles.Find(SkelEntity.Entity.Id))
+	{
+		if (BoneHandles->Value == NumBones)
+		{
+			return BoneHandles->Key;
+		}
+	}
+
+	const uint32 FirstHandle = NextHandle;
+	for (int32 BoneIdx = FirstBoneIdx; BoneIdx < LastBoneIdx; ++BoneIdx)
+	{
+		const FName& BoneName = Snapshot.BoneNames[BoneIdx];
+		const FSLBoneData* BoneData = SkelEntity.Obj.IsValid() ? SkelEntity.Obj->AllBonesData.Find(BoneName) : nullptr;
+		AddDictionaryEntry(BoneData ? BoneData->Id : FString(), BoneData ? BoneData->Class : FString(),
+			BoneName.ToString(), SkelHandle);
+	}
+	FirstBoneHandles.Add(SkelEntity.Entity.Id, TPair<uint32, int32>(FirstHandle, NumBones));
+	return FirstHandle;
+}
+
+// Add a dictionary entry and return its handle
+uint32 FSLWorldWriterBinary::AddDictionaryEntry(const FString& Id, const FString& Class, const FString& Name, uint32 ParentHandle)
+{
+	const uint32 Handle = NextHandle++;
+	DictBuffer.Append(reinterpret_cast<const uint8*>(&Handle), sizeof(Handle));
+	DictBuffer.Append(reinterpret_cast<const uint8*>(&ParentHandle), sizeof(ParentHandle));
+	AppendString(DictBuffer, Id);
+	AppendString(DictBuffer, Class);
+	AppendString(DictBuffer, Name);
+	NumPendingDictEntries++;
+	return Handle;
+}
+
+// Add the moved non skeletal entities to the frame columns
+template<typename T>
+void FSLWorldWriterBinary::AddEntities(const TArray<TSLEntityPreviousPose<T>>& Entities, const FSLPoseArrays& Poses,
+	const TArray<int32>& MovedIdxs)
+{
+	for (const int32 Idx : MovedIdxs)
+	{
+		AddRow(GetHandle(Entities[Idx].Entity), Poses.GetLoc(Idx), Poses.GetQuat(Idx));
+	}
+}
+
+// Add the rigid children and their group roots to the rigid record of the frame
+template<typename T>
+void FSLWorldWriterBinary::AddRigidEntities(const TArray<TSLEntityPreviousPose<T>>& Entities, const TArray<int32>& RigidIdxs,
+	const TArray<FSLGroupRoot>& Roots, const TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
+	const TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities)
+{
+	for (int32 ItrIdx = 0; ItrIdx < RigidIdxs.Num(); ++ItrIdx)
+	{
+		const FSLGroupRoot& Root = Roots[ItrIdx];
+		FrameRigidHandles.Add(GetHandle(Entities[RigidIdxs[ItrIdx]].Entity));
+		FrameRigidHandles.Add(GetHandle(Root.bIsComponent ? ComponentEntities[Root.Idx].Entity : ActorEntities[Root.Idx].Entity));
+	}
+}
+
+// Add the changed skeletal entities and their moved bones to the frame columns
+void FSLWorldWriterBinary::AddSkeletalEntities(const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
+	const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes)
+{
+	const FSLPoseArrays& Poses = Snapshot.Skeletals;
+	for (int32 ItrIdx = 0; ItrIdx < Changes.Skeletals.Num(); ++ItrIdx)
+	{
+		const int32 Idx = Changes.Skeletals[ItrIdx];
+		const TSLEntityPreviousPose<USLSkeletalDataComponent>& Entity = SkeletalEntities[Idx];
+		const uint32 SkelHandle = GetHandle(Entity.Entity);
+		AddRow(SkelHandle, Poses.GetLoc(Idx), Poses.GetQuat(Idx));
+
+		// Bones are stored as separate rows, the handles of the bones of a skeletal entity are consecutive
+		const int32 FirstBoneIdx = Snapshot.BoneOffsets[Idx];
+		const uint32 FirstBoneHandle = GetFirstBoneHandle(Entity, SkelHandle, Snapshot, Idx);
+		for (const int32 BoneIdx : Changes.GetMovedBones(ItrIdx))
+		{
+			AddRow(FirstBoneHandle + (BoneIdx - FirstBoneIdx), Snapshot.Bones.GetLoc(BoneIdx), Snapshot.Bones.GetQuat(BoneIdx));
+		}
+	}
+}
+
+// Add row to the frame columns
+void FSLWorldWriterBinary::AddRow(uint32 Handle, const FVector& InLoc, const FQuat& InQuat)
+{
+	FVector Loc;
+	FQuat Quat;
+#if SL_WITH_ROS_CONVERSIONS
+	Loc = FConversions::UToROS(InLoc);
+	Quat = FConversions::UToROS(InQuat);
+#else
+	Loc = InLoc;
+	Quat = InQuat;
+#endif // SL_WITH_ROS_CONVERSIONS
+
+	FrameHandles.Add(Handle);
+	FrameLocs.Append({ Loc.X, Loc.Y, Loc.Z });
+	FrameQuats.Append({ Quat.X, Quat.Y, Quat.Z, Quat.W });
+}
+
+// Append the frame columns to the output buffer
+void FSLWorldWriterBinary::WriteFrame(float Timestamp)
+{
+	// New entities need to be in the dictionary before they are referenced
+	if (NumPendingDictEntries > 0)
+	{
+		const uint32 DictType = FSLWorldBinaryFormat::DictionaryRecord;
+		Append(&DictType, sizeof(DictType));
+		Append(&NumPendingDictEntries, sizeof(NumPendingDictEntries));
+		Append(DictBuffer.GetData(), DictBuffer.Num());
+		DictBuffer.Reset();
+
+		// Keep the following records 4 byte aligned
+		const uint32 Zero = 0;
+		Append(&Zero, Align(OutBuffer.Num(), 4) - OutBuffer.Num());
+		NumPendingDictEntries = 0;
+	}
+
+	SeekTable.Emplace(Timestamp, FileOffset + OutBuffer.Num());
+
+	const uint32 FrameType = FSLWorldBinaryFormat::FrameRecord;
+	const uint32 NumRows = FrameHandles.Num();
+	Append(&FrameType, sizeof(FrameType));
+	Append(&Timestamp, sizeof(Timestamp));
+	Append(&NumRows, sizeof(NumRows));
+	Append(FrameHandles.GetData(), FrameHandles.Num() * sizeof(uint32));
+	Append(FrameLocs.GetData(), FrameLocs.Num() * sizeof(float));
+	Append(FrameQuats.GetData(), FrameQuats.Num() * sizeof(float));
+
+	// The rigid children are never logged without their group root, so the record always follows a frame
+	if (FrameRigidHandles.Num() > 0)
+	{
+		const uint32 RigidType = FSLWorldBinaryFormat::RigidRecord;
+		const uint32 NumRigid = FrameRigidHandles.Num() / 2;
+		Append(&RigidType, sizeof(RigidType));
+		Append(&NumRigid, sizeof(NumRigid));
+		Append(FrameRigidHandles.GetData(), FrameRigidHandles.Num() * sizeof(uint32));
+	}
+}
+
+// Append the seek table and footer to the output buffer
+void FSLWorldWriterBinary::WriteSeekTable()
+{
+	const uint64 SeekTableOffset = FileOffset + OutBuffer.Num();
+	const uint32 SeekType = FSLWorldBinaryFormat::SeekTableRecord;
+	const uint32 NumFrames = SeekTable.Num();
+	Append(&SeekType, sizeof(SeekType));
+	Append(&NumFrames, sizeof(NumFrames));
+	for (const auto& Pair : SeekTable)
+	{
+		Append(&Pair.Key, sizeof(float));
+		Append(&Pair.Value, sizeof(uint64));
+	}
+
+	const uint32 FooterMagic = FSLWorldBinaryFormat::FooterMagic;
+	Append(&SeekTableOffset, sizeof(SeekTableOffset));
+	Append(&FooterMagic, sizeof(FooterMagic));
+}
+
+// Append raw bytes to the output buffer
+FORCEINLINE void FSLWorldWriterBinary::Append(const void* Data, int32 Num)
+{
+	OutBuffer.Append(static_cast<const uint8*>(Data), Num);
+}
+
+// Append a length prefixed utf8 string to the given buffer
+void FSLWorldWriterBinary::AppendString(TArray<uint8>& Buffer, const FString& Str)
+{
+	FTCHARToUTF8 Utf8Str(*Str);
+	const uint16 Len = static_cast<uint16>(FMath::Min(Utf8Str.Length(), static_cast<int32>(MAX_uint16)));
+	Buffer.Append(reinterpret_cast<const uint8*>(&Len), sizeof(Len));
+	Buffer.Append(reinterpret_cast<const uint8*>(Utf8Str.Get()), Len);
+}
+
+// Write the output buffer to file
+void FSLWorldWriterBinary::Flush()
+{
+	if (FileHandle && OutBuffer.Num() > 0)
+	{
+		// The offsets in the seek table are the uncompressed ones
+		const bool bWritten = CompressedWriter.IsValid()
+			? CompressedWriter->Write(OutBuffer.GetData(), OutBuffer.Num())
+			: FileHandle->Write(OutBuffer.GetData(), OutBuffer.Num());
+		if (!bWritten)
+		{
+			// The reader stops at the last complete record before the failed write
+			UE_LOG(LogTemp, Error, TEXT("%s::%d Could not write %d bytes to file (offset %llu).."),
+				*FString(__func__), __LINE__, OutBuffer.Num(), FileOffset);
+		}
+		FileOffset += OutBuffer.Num();
+		OutBuffer.Reset();
+	}
+}
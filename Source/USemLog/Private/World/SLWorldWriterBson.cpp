@@ -2,25 +2,28 @@
 // Author: Andrei Haidu (http://haidu.eu)
 
 #include "World/SLWorldWriterBson.h"
-#include "Animation/SkeletalMeshActor.h"
 #include "HAL/PlatformFilemanager.h"
 
 // Constr
 FSLWorldWriterBson::FSLWorldWriterBson()
 {
 	bIsInit = false;
+	FileHandle = nullptr;
 }
 
 // Init constructor
 FSLWorldWriterBson::FSLWorldWriterBson(const FSLWorldWriterParams& InParams)
 {
 	bIsInit = false;
+	FileHandle = nullptr;
 	FSLWorldWriterBson::Init(InParams);
 }
 
 // Destr
 FSLWorldWriterBson::~FSLWorldWriterBson()
 {
+	FSLWorldWriterBson::Finish();
+	CompressedWriter.Reset();
 	if (FileHandle)
 	{
 		delete FileHandle;
@@ -30,9 +33,23 @@ FSLWorldWriterBson::~FSLWorldWriterBson()
 // Init
 void FSLWorldWriterBson::Init(const FSLWorldWriterParams& InParams)
 {
-	LinDistSqMin = InParams.LinearDistanceSquared;
-	AngDistMin = InParams.AngularDistance;
-	bIsInit = SetFileHandle(InParams.TaskId, InParams.EpisodeId);
+#if SL_WITH_LIBMONGO_C
+	if (!bIsInit)
+	{
+		LinDistSqMin = InParams.LinearDistanceSquared;
+		AngDistMin = InParams.AngularDistance;
+		DocBuilder.Init(InParams.Compression);
+		OutBuffer.Reserve(FlushSize + FlushSize / 4);
+
+		if (SetFileHandle(InParams.TaskId, InParams.EpisodeId, InParams.FileCompression))
+		{
+			bson_init(&ws_doc);
+			bIsInit = true;
+		}
+	}
+#else
+	UE_LOG(LogTemp, Error, TEXT("%s::%d The bson writer requires SL_WITH_LIBMONGO_C.."), *FString(__func__), __LINE__);
+#endif //SL_WITH_LIBMONGO_C
 }
 
 // Finish
@@ -40,27 +57,60 @@ void FSLWorldWriterBson::Finish()
 {
 	if (bIsInit)
 	{
+		Flush();
+		if (CompressedWriter.IsValid())
+		{
+			CompressedWriter->Finish();
+		}
+		if (FileHandle)
+		{
+			FileHandle->Flush();
+		}
+#if SL_WITH_LIBMONGO_C
+		bson_destroy(&ws_doc);
+#endif //SL_WITH_LIBMONGO_C
 		bIsInit = false;
 	}
 }
 
 // Called to write the data
-void FSLWorldWriterBson::Write(float Timestamp,
-	TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
-	TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
-	TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
-	FSLGazeData& GazeData,
-	bool bCheckAndRemoveInvalidEntities)
+void FSLWorldWriterBson::Write(const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes,
+	const TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
+	const TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
+	const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities)
 {
-#if SL_WITH_LIBMONGO_CXX
+#if SL_WITH_LIBMONGO_C
+	if (!bIsInit)
+	{
+		return;
+	}
+
+	// Reuse the document buffer
+	bson_reinit(&ws_doc);
 
-#endif //SL_WITH_LIBMONGO_CXX
+	// Avoid writing empty documents
+	if (DocBuilder.AddWorldState(Snapshot, Changes, ActorEntities, ComponentEntities, SkeletalEntities, &ws_doc) > 0)
+	{
+		// The documents are stored back to back, this is the layout of a mongodump file
+		OutBuffer.Append(bson_get_data(&ws_doc), ws_doc.len);
+		NumBytesWritten += ws_doc.len;
+	}
+
+	if (OutBuffer.Num() >= FlushSize)
+	{
+		Flush();
+	}
+#endif //SL_WITH_LIBMONGO_C
 }
 
 // Set the file handle for the logger
-bool FSLWorldWriterBson::SetFileHandle(const FString& LogDirectory, const FString& InEpisodeId)
+bool FSLWorldWriterBson::SetFileHandle(const FString& LogDirectory, const FString& InEpisodeId, ESLFileCompression InCompression)
 {
-	const FString Filename = InEpisodeId + TEXT("_WS.bson");
+	FString Filename = InEpisodeId + TEXT("_WS.bson");
+	if (InCompression != ESLFileCompression::None)
+	{
+		Filename += FSLCompressedFileFormat::GetExtension(InCompression);
+	}
 	FString EpisodesDirPath = FPaths::ProjectDir() + "/SemLog/" + LogDirectory + TEXT("/Episodes/");
 	FPaths::RemoveDuplicateSlashes(EpisodesDirPath);
 
@@ -68,208 +118,36 @@ bool FSLWorldWriterBson::SetFileHandle(const FString& LogDirectory, const FStrin
 
 	// Create logging directory path and the filehandle
 	FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*EpisodesDirPath);
-	FileHandle = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*FilePath, true);
+	FileHandle = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*FilePath);
+
+	// The blocks are compressed on a separate thread, the flushes only copy the data
+	if (FileHandle && InCompression != ESLFileCompression::None)
+	{
+		CompressedWriter = MakeUnique<FSLCompressedFileWriter>(FileHandle, InCompression);
+		if (!CompressedWriter->Start())
+		{
+			CompressedWriter.Reset();
+			delete FileHandle;
+			FileHandle = nullptr;
+		}
+	}
 
 	return FileHandle != nullptr;
 }
-#if SL_WITH_LIBMONGO_CXX
-//// Add actors
-//void FSLWorldWriterBson::AddActors(bson_t& OutBsonEntitiesArr)
-//{
-//	// Iterate actors
-//	for (auto WorldStateActItr(WorkerParent->WorldStateActors.CreateIterator()); WorldStateActItr; ++WorldStateActItr)
-//	{
-//		// Check if pointer is valid
-//		if (WorldStateActItr->Entity.IsValid(/*false, true*/))
-//		{
-//			// Check if the entity moved more than the threshold
-//			const FVector CurrLoc = WorldStateActItr->Entity->GetActorLocation();
-//			const FQuat CurrQuat = WorldStateActItr->Entity->GetActorQuat();
-//			if (FVector::DistSquared(CurrLoc, WorldStateActItr->PrevLoc) > WorkerParent->LinearDistanceSquared)
-//			{
-//				// Update prev location
-//				WorldStateActItr->PrevLoc = CurrLoc;
-//
-//				// Get current entry as Bson object
-//				bson_t BsonActorEntry = FSLWorldWriterBson::GetAsBsonEntry(
-//					WorldStateActItr->Id, WorldStateActItr->Class, CurrLoc, CurrQuat);
-//				
-//				// If actor is skeletal, save bones data as well
-//				if (ASkeletalMeshActor* SkelAct = Cast<ASkeletalMeshActor>(WorldStateActItr->Entity))
-//				{
-//					// Bson array of bones
-//					bson_t BsonBonesArr;
-//					bson_init(&BsonBonesArr);
-//
-//					// automatic key generation 
-//					const char* key;
-//					char keybuf[16];
-//					size_t keylen;
-//					int keynum = 0;
-//
-//					// Get skeletal mesh component
-//					USkeletalMeshComponent* SkelComp = SkelAct->GetSkeletalMeshComponent();
-//
-//					// Get bone names
-//					TArray<FName> BoneNames;
-//					SkelComp->GetBoneNames(BoneNames);
-//
-//					BSON_APPEND_ARRAY_BEGIN(&BsonActorEntry, "bones", &BsonBonesArr);
-//
-//					// Iterate through the bones of the skeletal mesh
-//					for (const auto& BoneName : BoneNames)
-//					{
-//						const FVector CurrLoc = SkelComp->GetBoneLocation(BoneName);
-//						const FQuat CurrQuat = SkelComp->GetBoneQuaternion(BoneName);
-//
-//						// Get current entry as Bson object
-//						bson_t BsonBoneEntry = FSLWorldWriterBson::GetAsBsonEntry(
-//							TEXT(""), BoneName.ToString(), CurrLoc, CurrQuat);
-//						
-//						keylen = bson_uint32_to_string(keynum, &key, keybuf, sizeof keybuf);
-//						bson_append_document(&BsonBonesArr, key, keylen, &BsonBoneEntry);
-//						keynum++;						
-//
-//					}
-//					bson_append_array_end(&BsonActorEntry, &BsonBonesArr);					
-//																		
-//				}
-//				// Add entity to Bson array
-//				//OutBsonEntitiesArr.Add();
-//				bson_t BsonActorEntrydocument;
-//				bson_init(&BsonActorEntrydocument);
-//				BSON_APPEND_DOCUMENT(&BsonActorEntrydocument, "document", &BsonActorEntry);
-//				bson_concat(&OutBsonEntitiesArr, &BsonActorEntrydocument);
-//			}
-//		}
-//		else
-//		{
-//			WorldStateActItr.RemoveCurrent();
-//		}
-//	}
-//}
-//
-//// Add components
-//void FSLWorldWriterBson::AddComponents(bson_t& OutBsonEntitiesArr)
-//{
-//	// Iterate components
-//	for (auto WorldStateCompItr(WorkerParent->WorldStateComponents.CreateIterator()); WorldStateCompItr; ++WorldStateCompItr)
-//	{
-//		if (WorldStateCompItr->Entity.IsValid(/*false, true*/))
-//		{
-//			// Check if the entity moved more than the threshold
-//			const FVector CurrLoc = WorldStateCompItr->Entity->GetComponentLocation();
-//			const FQuat CurrQuat = WorldStateCompItr->Entity->GetComponentQuat();
-//			if (FVector::DistSquared(CurrLoc, WorldStateCompItr->PrevLoc) > WorkerParent->LinearDistanceSquared)
-//			{
-//				// Update prev location
-//				WorldStateCompItr->PrevLoc = CurrLoc;
-//
-//				// Get current entry as Bson object
-//				bson_t BsonCompEntry = FSLWorldWriterBson::GetAsBsonEntry(
-//					WorldStateCompItr->Id, WorldStateCompItr->Class, CurrLoc, CurrQuat);
-//				
-//				// If comp is skeletal, save bones data as well
-//				if (USkeletalMeshComponent* SkelComp = Cast<USkeletalMeshComponent>(WorldStateCompItr->Entity))
-//				{
-//					// Bson array of bones
-//					bson_t BsonBonesArr;
-//					bson_init(&BsonBonesArr);
-//
-//					// automatic key generation 
-//					const char* key;
-//					char keybuf[16];
-//					size_t keylen;
-//					int keynum = 0;
-//
-//					// Get bone names
-//					TArray<FName> BoneNames;
-//					SkelComp->GetBoneNames(BoneNames);
-//
-//					BSON_APPEND_ARRAY_BEGIN(&BsonCompEntry, "bones", &BsonBonesArr);
-//
-//					// Iterate through the bones of the skeletal mesh
-//					for (const auto& BoneName : BoneNames)
-//					{
-//						const FVector CurrLoc = SkelComp->GetBoneLocation(BoneName);
-//						const FQuat CurrQuat = SkelComp->GetBoneQuaternion(BoneName);
-//
-//						// Get current entry as Bson object
-//						bson_t BsonBoneEntry = FSLWorldWriterBson::GetAsBsonEntry(
-//							TEXT(""), BoneName.ToString(), CurrLoc, CurrQuat);
-//
-//
-//						keylen = bson_uint32_to_string(keynum, &key, keybuf, sizeof keybuf);
-//						bson_append_document(&BsonBonesArr, key, keylen, &BsonBoneEntry);
-//						keynum++;
-//						
-//					}
-//					bson_append_array_end(&BsonCompEntry, &BsonBonesArr);
-//
-//				}
-//				// Add entity to Bson array
-//				bson_t BsonCompEntrydocument;
-//				bson_init(&BsonCompEntrydocument);
-//				BSON_APPEND_DOCUMENT(&BsonCompEntrydocument, "document", &BsonCompEntry);
-//				bson_concat(&OutBsonEntitiesArr, &BsonCompEntrydocument);
-//			}
-//		}
-//		else
-//		{
-//			WorldStateCompItr.RemoveCurrent();
-//		}
-//	}
-//}
-//
-//// Get entry as Bson object
-//bson_t FSLWorldWriterBson::GetAsBsonEntry(const FString& InId,
-//	const FString& InClass,
-//	const FVector& InLoc,
-//	const FQuat& InQuat)
-//{
-//	// Switch to right handed ROS transformation
-//	const FVector ROSLoc = FConversions::UToROS(InLoc);
-//	const FQuat ROSQuat = FConversions::UToROS(InQuat);
-//
-//	// New Bson entity object
-//	bson_t BsonObj;
-//	bson_init(&BsonObj);
-//
-//	// Add "id" field if available (bones have no separate ids)
-//	if (!InId.IsEmpty())
-//	{
-//		BSON_APPEND_UTF8(&BsonObj, "id", TCHAR_TO_UTF8(*InId));
-//	}
-//
-//	// Add "class" field
-//	BSON_APPEND_UTF8(&BsonObj, "class", TCHAR_TO_UTF8(*InClass));
-//
-//	// Create and add "loc" field
-//	bson_t loc;
-//	bson_init(&loc);
-//	BSON_APPEND_DOUBLE(&loc, "x", ROSLoc.X);
-//	BSON_APPEND_DOUBLE(&loc, "y", ROSLoc.Y);
-//	BSON_APPEND_DOUBLE(&loc, "z", ROSLoc.Z);
-//	BSON_APPEND_DOCUMENT(&BsonObj, "loc", &loc);
-//
-//	// Create and add "rot" field
-//	bson_t rot;
-//	bson_init(&rot);
-//	BSON_APPEND_DOUBLE(&rot, "x", ROSQuat.X);
-//	BSON_APPEND_DOUBLE(&rot, "y", ROSQuat.Y);
-//	BSON_APPEND_DOUBLE(&rot, "z", ROSQuat.Z);
-//	BSON_APPEND_DOCUMENT(&BsonObj, "rot", &rot);
-//
-//	return BsonObj;
-//}
-//
-//// Write entry to file
-//void FSLWorldWriterBson::WriteData(uint8* memorybuffer, int64 bufferlen)
-//{
-//
-//	if (FileHandle)
-//	{
-//		FileHandle->Write(memorybuffer, bufferlen);
-//	}
-//}
-#endif //SL_WITH_LIBMONGO_CXX
+
+// Write the output buffer to file
+void FSLWorldWriterBson::Flush()
+{
+	if (FileHandle && OutBuffer.Num() > 0)
+	{
+		const bool bWritten = CompressedWriter.IsValid()
+			? CompressedWriter->Write(OutBuffer.GetData(), OutBuffer.Num())
+			: FileHandle->Write(OutBuffer.GetData(), OutBuffer.Num());
+		if (!bWritten)
+		{
+			UE_LOG(LogTemp, Error, TEXT("%s::%d Could not write %d bytes to file.."),
+				*FString(__func__), __LINE__, OutBuffer.Num());
+		}
+		OutBuffer.Reset();
+	}
+}
@@ -2,19 +2,25 @@
 // Author: Andrei Haidu (http://haidu.eu)
 
 #include "World/SLWorldWriterJson.h"
-#include "Animation/SkeletalMeshActor.h"
 #include "HAL/PlatformFilemanager.h"
 
+// Utils
+#if SL_WITH_ROS_CONVERSIONS
+#include "Conversions.h"
+#endif // SL_WITH_ROS_CONVERSIONS
+
 // Constructor
 FSLWorldWriterJson::FSLWorldWriterJson()
 {
 	bIsInit = false;
+	FileHandle = nullptr;
 }
 
 // Init constructor
 FSLWorldWriterJson::FSLWorldWriterJson(const FSLWorldWriterParams& InParams)
 {
 	bIsInit = false;
+	FileHandle = nullptr;
 	FSLWorldWriterJson::Init(InParams);
 }
 
@@ -22,6 +28,7 @@ FSLWorldWriterJson::FSLWorldWriterJson(const FSLWorldWriterParams& InParams)
 FSLWorldWriterJson::~FSLWorldWriterJson()
 {
 	FSLWorldWriterJson::Finish();
+	CompressedWriter.Reset();
 	if (FileHandle)
 	{
 		delete FileHandle;
@@ -31,9 +38,13 @@ FSLWorldWriterJson::~FSLWorldWriterJson()
 // Init
 void FSLWorldWriterJson::Init(const FSLWorldWriterParams& InParams)
 {
-	LinDistSqMin = InParams.LinearDistanceSquared;
-	AngDistMin = InParams.AngularDistance;
-	bIsInit = SetFileHandle(InParams.TaskId, InParams.EpisodeId);
+	if (!bIsInit)
+	{
+		LinDistSqMin = InParams.LinearDistanceSquared;
+		AngDistMin = InParams.AngularDistance;
+		OutBuffer.Reserve(FlushSize + FlushSize / 4);
+		bIsInit = SetFileHandle(InParams.TaskId, InParams.EpisodeId, InParams.FileCompression);
+	}
 }
 
 
@@ -42,49 +53,74 @@ void FSLWorldWriterJson::Finish()
 {
 	if (bIsInit)
 	{
+		Flush();
+		if (CompressedWriter.IsValid())
+		{
+			CompressedWriter->Finish();
+		}
+		if (FileHandle)
+		{
+			FileHandle->Flush();
+		}
 		bIsInit = false;
 	}
 }
 
-// Called to write the data (it also removes invalid item -> e.g. deleted ones)
-void FSLWorldWriterJson::Write(float Timestamp,
-	TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
-	TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
-	TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
-	FSLGazeData& GazeData,
-	bool bCheckAndRemoveInvalidEntities)
+// Called to write the data
+void FSLWorldWriterJson::Write(const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes,
+	const TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
+	const TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
+	const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities)
 {
-#if SL_WITH_JSON
-	// Json root object
-	TSharedPtr<FJsonObject> JsonRootObj = MakeShareable(new FJsonObject);
-
-	// Out Json array of entities
-	TArray<TSharedPtr<FJsonValue>> JsonEntitiesArr;
+	if (!bIsInit)
+	{
+		return;
+	}
 
-	// Add entities to json array
-	FSLWorldWriterJson::AddActorEntities(ActorEntities, JsonEntitiesArr);
-	FSLWorldWriterJson::AddComponentEntities(ComponentEntities, JsonEntitiesArr);
-	FSLWorldWriterJson::AddSkeletalEntities(SkeletalEntities, JsonEntitiesArr);
+	// The document is emitted directly (same pretty printed layout as the json serializer), it is discarded if no entity moved
+	const int32 DocStart = OutBuffer.Num();
+	AppendLiteral("{");
+	AppendLineBreak(OutBuffer, 1);
+	AppendLiteral("\"timestamp\": ");
+	AppendNumber(Snapshot.Timestamp);
+	AppendLiteral(",");
+	AppendLineBreak(OutBuffer, 1);
+	AppendLiteral("\"entities\": [");
+
+	int32 NumAdded = 0;
+	AddEntities(ActorEntities, Snapshot.Actors, Changes.Actors, NumAdded);
+	AddEntities(ComponentEntities, Snapshot.Components, Changes.Components, NumAdded);
+	// There is no json reader resolving the rigid group markers, the rigid children are written with their captured pose
+	AddEntities(ActorEntities, Snapshot.Actors, Changes.RigidActors, NumAdded);
+	AddEntities(ComponentEntities, Snapshot.Components, Changes.RigidComponents, NumAdded);
+	AddSkeletalEntities(SkeletalEntities, Snapshot, Changes, NumAdded);
 
 	// Avoid appending empty entries
-	if (JsonEntitiesArr.Num() > 0)
+	if (NumAdded == 0)
 	{
-		// Set timestamp
-		JsonRootObj->SetNumberField("timestamp", Timestamp);
-
-		// Add actors to Json root
-		JsonRootObj->SetArrayField("entities", JsonEntitiesArr);
+		OutBuffer.SetNum(DocStart, false);
+		return;
+	}
+	AppendLineBreak(OutBuffer, 1);
+	AppendLiteral("]");
+	AppendLineBreak(OutBuffer, 0);
+	AppendLiteral("}");
+	NumBytesWritten += OutBuffer.Num() - DocStart;
 
-		// Write entry to file
-		FSLWorldWriterJson::WriteToFile(JsonRootObj);
+	if (OutBuffer.Num() >= FlushSize)
+	{
+		Flush();
 	}
-#endif // SL_WITH_JSON
 }
 
 // Set the file handle for the logger
-bool FSLWorldWriterJson::SetFileHandle(const FString& LogDirectory, const FString& InEpisodeId)
+bool FSLWorldWriterJson::SetFileHandle(const FString& LogDirectory, const FString& InEpisodeId, ESLFileCompression InCompression)
 {
-	const FString Filename = InEpisodeId + TEXT("_WS.json");
+	FString Filename = InEpisodeId + TEXT("_WS.json");
+	if (InCompression != ESLFileCompression::None)
+	{
+		Filename += FSLCompressedFileFormat::GetExtension(InCompression);
+	}
 	FString EpisodesDirPath = FPaths::ProjectDir() + "/SemLog/" + LogDirectory + TEXT("/Episodes/");
 	FPaths::RemoveDuplicateSlashes(EpisodesDirPath);
 
@@ -94,204 +130,269 @@ bool FSLWorldWriterJson::SetFileHandle(const FString& LogDirectory, const FStrin
 	FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*EpisodesDirPath);
 	FileHandle = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*FilePath, true);
 
+	// The blocks are compressed on a separate thread, the flushes only copy the data
+	if (FileHandle && InCompression != ESLFileCompression::None)
+	{
+		CompressedWriter = MakeUnique<FSLCompressedFileWriter>(FileHandle, InCompression);
+		if (!CompressedWriter->Start())
+		{
+			CompressedWriter.Reset();
+			delete FileHandle;
+			FileHandle = nullptr;
+		}
+	}
+
 	return FileHandle != nullptr;
 }
 
-#if SL_WITH_JSON
-// Get non skeletal actors as json array
-void FSLWorldWriterJson::AddActorEntities(TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
-	TArray<TSharedPtr<FJsonValue>>& OutJsonEntitiesArr)
+// Add the moved non skeletal entities to the json array
+template<typename T>
+void FSLWorldWriterJson::AddEntities(const TArray<TSLEntityPreviousPose<T>>& Entities, const FSLPoseArrays& Poses,
+	const TArray<int32>& MovedIdxs, int32& NumAdded)
 {
-	// Iterate items
-	for (auto Itr(ActorEntities.CreateIterator()); Itr; ++Itr)
+	for (const int32 Idx : MovedIdxs)
 	{
-		// Check if pointer is valid
-		if (Itr->Obj.IsValid(/*false, true*/))
+		if (NumAdded > 0)
 		{
-			// Check if the entity moved more than the threshold since the last logging
-			const FVector CurrLoc = Itr->Obj->GetActorLocation();
-			const FQuat CurrQuat = Itr->Obj->GetActorQuat();
-
-			if (FVector::DistSquared(CurrLoc, Itr->PrevLoc) > LinDistSqMin ||
-				CurrQuat.AngularDistance(Itr->PrevQuat))
-			{
-				// Update prev state
-				Itr->PrevLoc = CurrLoc;
-				Itr->PrevQuat = CurrQuat;
-
-				// Get current entry as json object
-				TSharedPtr<FJsonObject> JsonEntry = FSLWorldWriterJson::GetAsJsonEntry(
-					TMap<FString, FString>{ {"id", Itr->Entity.Id}, { "class", Itr->Entity.Class } },
-					CurrLoc, CurrQuat);
-
-				// Add entity to json array
-				OutJsonEntitiesArr.Add(MakeShareable(new FJsonValueObject(JsonEntry)));
-			}
-		}
-		else
-		{
-			Itr.RemoveCurrent();
-			FSLEntitiesManager::GetInstance()->RemoveEntity(Itr->Obj.Get());
+			AppendLiteral(",");
 		}
+		AppendLineBreak(OutBuffer, EntityDepth);
+		OutBuffer.Append(GetEntityFields(Entities[Idx].Entity));
+		AppendPose(Poses.GetLoc(Idx), Poses.GetQuat(Idx), EntityDepth + 1);
+		AppendLineBreak(OutBuffer, EntityDepth);
+		AppendLiteral("}");
+		NumAdded++;
 	}
 }
 
-// Get non skeletal components as json array
-void FSLWorldWriterJson::AddComponentEntities(TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
-	TArray<TSharedPtr<FJsonValue>>& OutJsonEntitiesArr)
+// Add the changed skeletal entities and their moved bones to the json array
+void FSLWorldWriterJson::AddSkeletalEntities(const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
+	const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes, int32& NumAdded)
 {
-	// Iterate items
-	for (auto Itr(ComponentEntities.CreateIterator()); Itr; ++Itr)
+	const FSLPoseArrays& Poses = Snapshot.Skeletals;
+	for (int32 ItrIdx = 0; ItrIdx < Changes.Skeletals.Num(); ++ItrIdx)
 	{
-		// Check if pointer is valid
-		if (Itr->Obj.IsValid(/*false, true*/))
+		const int32 Idx = Changes.Skeletals[ItrIdx];
+		const TSLEntityPreviousPose<USLSkeletalDataComponent>& SkelEntity = SkeletalEntities[Idx];
+		if (NumAdded > 0)
 		{
-			// Check if the entity moved more than the threshold since the last logging
-			const FVector CurrLoc = Itr->Obj->GetComponentLocation();
-			const FQuat CurrQuat = Itr->Obj->GetComponentQuat();
-
-			if (FVector::DistSquared(CurrLoc, Itr->PrevLoc) > LinDistSqMin ||
-				CurrQuat.AngularDistance(Itr->PrevQuat))
+			AppendLiteral(",");
+		}
+		AppendLineBreak(OutBuffer, EntityDepth);
+		OutBuffer.Append(GetEntityFields(SkelEntity.Entity));
+		AppendPose(Poses.GetLoc(Idx), Poses.GetQuat(Idx), EntityDepth + 1);
+
+		// Iterate through the moved bones of the skeletal mesh
+		AppendLiteral(",");
+		AppendLineBreak(OutBuffer, EntityDepth + 1);
+		AppendLiteral("\"bones\": [");
+		const TArray<TArray<uint8>>& BoneFields = GetBoneFields(SkelEntity, Snapshot, Idx);
+		const int32 FirstBoneIdx = Snapshot.BoneOffsets[Idx];
+		bool bFirstBone = true;
+		for (const int32 BoneIdx : Changes.GetMovedBones(ItrIdx))
+		{
+			if (!bFirstBone)
 			{
-				// Update prev state
-				Itr->PrevLoc = CurrLoc;
-				Itr->PrevQuat = CurrQuat;
-
-				// Get current entry as json object
-				TSharedPtr<FJsonObject> JsonEntry = FSLWorldWriterJson::GetAsJsonEntry(
-					TMap<FString, FString>{ {"id", Itr->Entity.Id}, { "class", Itr->Entity.Class } },
-					CurrLoc, CurrQuat);
-
-				// Add entity to json array
-				OutJsonEntitiesArr.Add(MakeShareable(new FJsonValueObject(JsonEntry)));
+				AppendLiteral(",");
 			}
+			bFirstBone = false;
+			AppendLineBreak(OutBuffer, EntityDepth + 2);
+			OutBuffer.Append(BoneFields[BoneIdx - FirstBoneIdx]);
+			AppendPose(Snapshot.Bones.GetLoc(BoneIdx), Snapshot.Bones.GetQuat(BoneIdx), EntityDepth + 3);
+			AppendLineBreak(OutBuffer, EntityDepth + 2);
+			AppendLiteral("}");
 		}
-		else
+		if (!bFirstBone)
 		{
-			Itr.RemoveCurrent();
-			FSLEntitiesManager::GetInstance()->RemoveEntity(Itr->Obj.Get());
+			AppendLineBreak(OutBuffer, EntityDepth + 1);
 		}
+		AppendLiteral("]");
+		AppendLineBreak(OutBuffer, EntityDepth);
+		AppendLiteral("}");
+		NumAdded++;
 	}
 }
 
-// Get skeletal actors as json array
-void FSLWorldWriterJson::AddSkeletalEntities(TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
-	TArray<TSharedPtr<FJsonValue>>& OutJsonEntitiesArr)
+// Get the pre-escaped "id" and "class" fields of the entity
+const TArray<uint8>& FSLWorldWriterJson::GetEntityFields(const FSLEntity& Entity)
 {
-	// Iterate items
-	for (auto Itr(SkeletalEntities.CreateIterator()); Itr; ++Itr)
+	if (const TArray<uint8>* Fields = EntityFieldsCache.Find(Entity.Id))
 	{
-		// Check if pointer is valid
-		if (Itr->Obj.IsValid(/*false, true*/))
-		{
-			// Check if the entity moved more than the threshold since the last logging
-			const FVector CurrLoc = Itr->Obj->GetComponentLocation();
-			const FQuat CurrQuat = Itr->Obj->GetComponentQuat();
+		return *Fields;
+	}
+
+	TArray<uint8> Fields;
+	Fields.Add('{');
+	AppendLineBreak(Fields, EntityDepth + 1);
+	AppendStringField(Fields, "id", Entity.Id);
+	Fields.Add(',');
+	AppendLineBreak(Fields, EntityDepth + 1);
+	AppendStringField(Fields, "class", Entity.Class);
+	return EntityFieldsCache.Add(Entity.Id, MoveTemp(Fields));
+}
+
+// Get the pre-escaped fields of the bones of the skeletal entity (in capture order)
+const TArray<TArray<uint8>>& FSLWorldWriterJson::GetBoneFields(const TSLEntityPreviousPose<USLSkeletalDataComponent>& SkelEntity,
+	const FSLWorldStateSnapshot& Snapshot, int32 SkelIdx)
+{
+	int32 FirstBoneIdx, LastBoneIdx;
+	Snapshot.GetBoneRange(SkelIdx, FirstBoneIdx, LastBoneIdx);
 
-			if (FVector::DistSquared(CurrLoc, Itr->PrevLoc) > LinDistSqMin ||
-				CurrQuat.AngularDistance(Itr->PrevQuat))
+	TArray<TArray<uint8>>& BoneFields = BoneFieldsCache.FindOrAdd(SkelEntity.Entity.Id);
+	if (BoneFields.Num() == LastBoneIdx - FirstBoneIdx)
+	{
+		return BoneFields;
+	}
+
+	BoneFields.Empty(LastBoneIdx - FirstBoneIdx);
+	for (int32 BoneIdx = FirstBoneIdx; BoneIdx < LastBoneIdx; ++BoneIdx)
+	{
+		const FName& BoneName = Snapshot.BoneNames[BoneIdx];
+		TArray<uint8>& Fields = BoneFields.AddDefaulted_GetRef();
+		Fields.Add('{');
+		AppendLineBreak(Fields, EntityDepth + 3);
+		AppendStringField(Fields, "bone", BoneName.ToString());
+		const FSLBoneData* BoneData = SkelEntity.Obj.IsValid() ? SkelEntity.Obj->AllBonesData.Find(BoneName) : nullptr;
+		if (BoneData)
+		{
+			if (!BoneData->Class.IsEmpty())
 			{
-				// Update prev state
-				Itr->PrevLoc = CurrLoc;
-				Itr->PrevQuat = CurrQuat;
-
-				// Get current entry as json object
-				TSharedPtr<FJsonObject> JsonEntry = FSLWorldWriterJson::GetAsJsonEntry(
-					TMap<FString, FString>{ {"id", Itr->Entity.Id}, { "class", Itr->Entity.Class } },
-					CurrLoc, CurrQuat);
-
-				// Json array of bones
-				TArray<TSharedPtr<FJsonValue>> JsonBonesArr;
-
-				if (USkeletalMeshComponent* SkelComp = Itr->Obj->SkeletalMeshParent)
-				{
-					// Iterate through the bones of the skeletal mesh
-					for (const auto& Pair : Itr->Obj->AllBonesData)
-					{
-						const FVector CurrBoneLoc = SkelComp->GetBoneLocation(Pair.Key);
-						const FQuat CurrBoneQuat = SkelComp->GetBoneQuaternion(Pair.Key);
-
-						// Get current entry as json object
-						TMap<FString, FString> SemanticData;
-						SemanticData.Add("bone", Pair.Key.ToString());
-						if (!Pair.Value.Class.IsEmpty())
-						{
-							SemanticData.Add("class", Pair.Value.Class);
-						}
-						if (!Pair.Value.VisualMask.IsEmpty())
-						{
-							SemanticData.Add("mask_hex", Pair.Value.VisualMask);
-						}
-
-						TSharedPtr<FJsonObject> JsonBoneEntry = FSLWorldWriterJson::GetAsJsonEntry(
-							SemanticData, CurrBoneLoc, CurrBoneQuat);
-
-						// Add bone to Json array
-						JsonBonesArr.Add(MakeShareable(new FJsonValueObject(JsonBoneEntry)));
-					}
-				}
-				// Add bones to json entry
-				JsonEntry->SetArrayField("bones", JsonBonesArr);
-
-				// Add entity to json array
-				OutJsonEntitiesArr.Add(MakeShareable(new FJsonValueObject(JsonEntry)));
+				Fields.Add(',');
+				AppendLineBreak(Fields, EntityDepth + 3);
+				AppendStringField(Fields, "class", BoneData->Class);
+			}
+			if (!BoneData->VisualMask.IsEmpty())
+			{
+				Fields.Add(',');
+				AppendLineBreak(Fields, EntityDepth + 3);
+				AppendStringField(Fields, "mask_hex", BoneData->VisualMask);
 			}
-		}
-		else
-		{
-			Itr.RemoveCurrent();
-			FSLEntitiesManager::GetInstance()->RemoveEntity(Itr->Obj.Get());
 		}
 	}
+	return BoneFields;
 }
 
-// Get key value pairs as json entry
-TSharedPtr<FJsonObject> FSLWorldWriterJson::GetAsJsonEntry(const TMap<FString, FString>& InKeyValMap,
-	const FVector& InLoc, const FQuat& InQuat)
+// Append the "loc" and "rot" fields (at the given depth)
+void FSLWorldWriterJson::AppendPose(const FVector& InLoc, const FQuat& InQuat, int32 Depth)
 {
-	// New json entity object
-	TSharedPtr<FJsonObject> JsonObj = MakeShareable(new FJsonObject);
+#if SL_WITH_ROS_CONVERSIONS
+	// Switch to right handed ROS transformation
+	const FVector ROSLoc = FConversions::UToROS(InLoc);
+	const FQuat ROSQuat = FConversions::UToROS(InQuat);
+#else
+	const FVector& ROSLoc = InLoc;
+	const FQuat& ROSQuat = InQuat;
+#endif // SL_WITH_ROS_CONVERSIONS
+
+	AppendLiteral(",");
+	AppendLineBreak(OutBuffer, Depth);
+	AppendLiteral("\"loc\":");
+	AppendLineBreak(OutBuffer, Depth);
+	AppendLiteral("{");
+	AppendNumberField("x", ROSLoc.X, Depth + 1, false);
+	AppendNumberField("y", ROSLoc.Y, Depth + 1);
+	AppendNumberField("z", ROSLoc.Z, Depth + 1);
+	AppendLineBreak(OutBuffer, Depth);
+	AppendLiteral("},");
+	AppendLineBreak(OutBuffer, Depth);
+	AppendLiteral("\"rot\":");
+	AppendLineBreak(OutBuffer, Depth);
+	AppendLiteral("{");
+	AppendNumberField("x", ROSQuat.X, Depth + 1, false);
+	AppendNumberField("y", ROSQuat.Y, Depth + 1);
+	AppendNumberField("z", ROSQuat.Z, Depth + 1);
+	AppendNumberField("w", ROSQuat.W, Depth + 1);
+	AppendLineBreak(OutBuffer, Depth);
+	AppendLiteral("}");
+}
 
-	// Add key values pairs
-	for (const auto& Pair : InKeyValMap)
+// Append a "key": number field on a new line
+void FSLWorldWriterJson::AppendNumberField(const ANSICHAR* Key, double Value, int32 Depth, bool bComma)
+{
+	if (bComma)
 	{
-		JsonObj->SetStringField(Pair.Key, Pair.Value);
+		AppendLiteral(",");
 	}
+	AppendLineBreak(OutBuffer, Depth);
+	AppendLiteral("\"");
+	OutBuffer.Append(reinterpret_cast<const uint8*>(Key), FCStringAnsi::Strlen(Key));
+	AppendLiteral("\": ");
+	AppendNumber(Value);
+}
 
-	// Switch to right handed ROS transformation
-	const FVector ROSLoc = FConversions::UToROS(InLoc);
-	const FQuat ROSQuat = FConversions::UToROS(InQuat);
+// Append a number
+void FSLWorldWriterJson::AppendNumber(double Value)
+{
+	// Nan and inf are not valid json numbers
+	if (!FMath::IsFinite(Value))
+	{
+		AppendLiteral("null");
+		return;
+	}
 
-	// Create and add "loc" field
-	TSharedPtr<FJsonObject> LocObj = MakeShareable(new FJsonObject);
-	LocObj->SetNumberField("x", ROSLoc.X);
-	LocObj->SetNumberField("y", ROSLoc.Y);
-	LocObj->SetNumberField("z", ROSLoc.Z);
-	JsonObj->SetObjectField("loc", LocObj);
-
-	// Create and add "rot" field
-	TSharedPtr<FJsonObject> QuatObj = MakeShareable(new FJsonObject);
-	QuatObj->SetNumberField("x", ROSQuat.X);
-	QuatObj->SetNumberField("y", ROSQuat.Y);
-	QuatObj->SetNumberField("z", ROSQuat.Z);
-	QuatObj->SetNumberField("w", ROSQuat.W);
-	JsonObj->SetObjectField("rot", QuatObj);
-
-	return JsonObj;
+	// Format directly into the buffer (9 significant digits are enough to round trip the floats)
+	constexpr int32 MaxLen = 32;
+	const int32 Start = OutBuffer.AddUninitialized(MaxLen);
+	const int32 Len = FCStringAnsi::Snprintf(reinterpret_cast<ANSICHAR*>(OutBuffer.GetData() + Start), MaxLen, "%.9g", Value);
+	OutBuffer.SetNum(Start + FMath::Clamp(Len, 0, MaxLen - 1), false);
 }
 
-// Write entry to file
-void FSLWorldWriterJson::WriteToFile(const TSharedPtr<FJsonObject>& InRootObj)
+// Append a line terminator and the indentation of the given depth to the buffer
+void FSLWorldWriterJson::AppendLineBreak(TArray<uint8>& Buffer, int32 Depth)
 {
-	// Transform to string
-	FString JsonString;
-	TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&JsonString);
-	FJsonSerializer::Serialize(InRootObj.ToSharedRef(), JsonWriter);
+	Buffer.Append(reinterpret_cast<const uint8*>(LINE_TERMINATOR_ANSI), sizeof(LINE_TERMINATOR_ANSI) - 1);
+	const int32 Start = Buffer.AddUninitialized(Depth);
+	FMemory::Memset(Buffer.GetData() + Start, '\t', Depth);
+}
 
-	// Write to file
-	if (FileHandle)
+// Append a "key":"value" field with the value escaped to the given buffer
+void FSLWorldWriterJson::AppendStringField(TArray<uint8>& Buffer, const ANSICHAR* Key, const FString& Value)
+{
+	Buffer.Add('"');
+	Buffer.Append(reinterpret_cast<const uint8*>(Key), FCStringAnsi::Strlen(Key));
+	Buffer.Add('"');
+	Buffer.Add(':');
+	Buffer.Add(' ');
+	Buffer.Add('"');
+
+	static const ANSICHAR HexDigits[] = "0123456789abcdef";
+	const FTCHARToUTF8 Utf8(*Value);
+	const uint8* Chars = reinterpret_cast<const uint8*>(Utf8.Get());
+	for (int32 Idx = 0; Idx < Utf8.Length(); ++Idx)
 	{
-		FileHandle->Write((const uint8*)TCHAR_TO_ANSI(*JsonString), JsonString.Len());
+		const uint8 Char = Chars[Idx];
+		if (Char == '"' || Char == '\\')
+		{
+			Buffer.Add('\\');
+			Buffer.Add(Char);
+		}
+		else if (Char < 0x20)
+		{
+			Buffer.Append(reinterpret_cast<const uint8*>("\\u00"), 4);
+			Buffer.Add(HexDigits[Char >> 4]);
+			Buffer.Add(HexDigits[Char & 0xF]);
+		}
+		else
+		{
+			Buffer.Add(Char);
+		}
+	}
+	Buffer.Add('"');
+}
+
+// Write the output buffer to file
+void FSLWorldWriterJson::Flush()
+{
+	if (FileHandle && OutBuffer.Num() > 0)
+	{
+		const bool bWritten = CompressedWriter.IsValid()
+			? CompressedWriter->Write(OutBuffer.GetData(), OutBuffer.Num())
+			: FileHandle->Write(OutBuffer.GetData(), OutBuffer.Num());
+		if (!bWritten)
+		{
+			UE_LOG(LogTemp, Error, TEXT("%s::%d Could not write %d bytes to file.."),
+				*FString(__func__), __LINE__, OutBuffer.Num());
+		}
+		OutBuffer.Reset();
 	}
 }
-#endif // SL_WITH_JSON
\ No newline at end of file
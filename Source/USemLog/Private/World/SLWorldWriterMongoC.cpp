@@ -4,22 +4,36 @@
 #include "World/SLWorldWriterMongoC.h"
 #include "Animation/SkeletalMeshActor.h"
 #include "SLEntitiesManager.h"
-
-// Utils
-#if SL_WITH_ROS_CONVERSIONS
-#include "Conversions.h"
-#endif // SL_WITH_ROS_CONVERSIONS
+#include "Misc/Paths.h"
 
 // Constr
 FSLWorldWriterMongoC::FSLWorldWriterMongoC()
 {
 	bIsInit = false;
+	bEntityBuckets = false;
+	IndexMode = ESLMongoIndexMode::Background;
+	ServerPort = 0;
+#if SL_WITH_LIBMONGO_C
+	uri = nullptr;
+	client = nullptr;
+	database = nullptr;
+	collection = nullptr;
+#endif //SL_WITH_LIBMONGO_C
 }
 
 // Init constr
 FSLWorldWriterMongoC::FSLWorldWriterMongoC(const FSLWorldWriterParams& InParams)
 {
 	bIsInit = false;
+	bEntityBuckets = false;
+	IndexMode = ESLMongoIndexMode::Background;
+	ServerPort = 0;
+#if SL_WITH_LIBMONGO_C
+	uri = nullptr;
+	client = nullptr;
+	database = nullptr;
+	collection = nullptr;
+#endif //SL_WITH_LIBMONGO_C
 	Init(InParams);
 }
 
@@ -37,7 +51,9 @@ void FSLWorldWriterMongoC::Init(const FSLWorldWriterParams& InParams)
 {
 	if(!bIsInit)
 	{
-		if(!Connect(InParams.TaskId, InParams.EpisodeId, InParams.ServerIp, InParams.ServerPort, InParams.bOverwrite))
+		bEntityBuckets = InParams.MongoBuckets.bEnabled;
+		if(!Connect(InParams.TaskId, InParams.EpisodeId, InParams.ServerIp, InParams.ServerPort, InParams.bOverwrite,
+			bEntityBuckets && InParams.MongoBuckets.bTimeSeries))
 		{
 			UE_LOG(LogTemp, Error, TEXT("%s::%d Could not connect to db.."),
 				*FString(__func__), __LINE__);
@@ -45,6 +61,34 @@ void FSLWorldWriterMongoC::Init(const FSLWorldWriterParams& InParams)
 		}
 		LinDistSqMin = InParams.LinearDistanceSquared;
 		AngDistMin = InParams.AngularDistance;
+		DocBuilder.Init(InParams.Compression);
+		BucketBuilder.Init(InParams.MongoBuckets);
+
+		// Indexes created on the empty collection are maintained by the server while logging
+		IndexMode = InParams.MongoIndexMode;
+		ServerIp = InParams.ServerIp;
+		ServerPort = InParams.ServerPort;
+		DBName = InParams.TaskId;
+		CollName = InParams.EpisodeId;
+		CreateIndexes(ESLMongoIndexMode::UpFront);
+
+#if SL_WITH_LIBMONGO_C
+		// Insert the documents with bulk operations from a separate thread
+		if (InParams.MongoBatch.MaxNumDocs > 0)
+		{
+			// Documents which do not fit in the queue while the server stalls are spilled next to the file based episodes
+			FString JournalPath = FPaths::ProjectDir() + "/SemLog/" + InParams.TaskId + TEXT("/Episodes/") +
+				InParams.EpisodeId + TEXT("_WS.journal");
+			FPaths::RemoveDuplicateSlashes(JournalPath);
+			Flusher = MakeUnique<FSLWorldWriterMongoCFlusher>(collection, InParams.MongoBatch, JournalPath);
+			if (!Flusher->Start())
+			{
+				UE_LOG(LogTemp, Warning, TEXT("%s::%d Batching disabled, documents will be inserted one by one.."),
+					*FString(__func__), __LINE__);
+				Flusher.Reset();
+			}
+		}
+#endif //SL_WITH_LIBMONGO_C
 		bIsInit =  true;
 	}
 }
@@ -54,18 +98,36 @@ void FSLWorldWriterMongoC::Finish()
 {
 	if (bIsInit)
 	{
-		CreateIndexes();
+#if SL_WITH_LIBMONGO_C
+		// Write the buckets of the last time window
+		if (bEntityBuckets)
+		{
+			BucketBuilder.CloseBuckets(BucketDocs);
+			InsertBucketDocs();
+		}
+#endif //SL_WITH_LIBMONGO_C
+
+		// Insert the remaining batched documents, afterwards the collection is only accessed from this thread
+		if (Flusher.IsValid())
+		{
+			Flusher->Finish();
+			RoundTripLatencies.Merge(Flusher->GetFlushLatencies());
+			const FSLWorldWriterMongoQueueStats QueueStats = Flusher->GetQueueStats();
+			MaxQueuedBytes = FMath::Max(MaxQueuedBytes, QueueStats.MaxQueuedBytes);
+			NumSpilledBytes += QueueStats.NumSpilledBytes;
+			Flusher.Reset();
+		}
+		CreateIndexes(ESLMongoIndexMode::Background);
+		CreateIndexes(ESLMongoIndexMode::Blocking);
 		bIsInit = false;
 	}
 }
 
 // Write data to document
-void FSLWorldWriterMongoC::Write(float Timestamp,
-	TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
-	TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
-	TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
-	FSLGazeData& GazeData,
-	bool bCheckAndRemoveInvalidEntities)
+void FSLWorldWriterMongoC::Write(const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes,
+	const TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
+	const TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
+	const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities)
 {
 	// todo can be removed, the array size only changes when an entity is deleted from the world
 	// Avoid writing empty documents
@@ -75,55 +137,38 @@ void FSLWorldWriterMongoC::Write(float Timestamp,
 	}
 
 #if SL_WITH_LIBMONGO_C
+	// The poses are collected per entity, the documents are written when their time window closes
+	if (bEntityBuckets)
+	{
+		BucketBuilder.AddWorldState(Snapshot, Changes, ActorEntities, ComponentEntities, SkeletalEntities, BucketDocs);
+		InsertBucketDocs();
+		return;
+	}
+
 	bson_t* ws_doc;
-	bson_t entities_arr;
-	bson_t sk_entities_arr;
 	bson_error_t error;
 
-	uint32_t arr_idx = 0;
-
 	// Document to store the data
 	ws_doc = bson_new();
 
-	// Add timestamp
-	BSON_APPEND_DOUBLE(ws_doc, "timestamp", Timestamp);
+	// Add the entities which moved
+	DocBuilder.AddWorldState(Snapshot, Changes, ActorEntities, ComponentEntities, SkeletalEntities, ws_doc);
+	NumBytesWritten += ws_doc->len;
 
-	// TODO Avoid writing empty documents by checking the indexes or sending a bool reference
-	// Add entities to array
-	BSON_APPEND_ARRAY_BEGIN(ws_doc, "entities", &entities_arr);
-	AddActorEntities(ActorEntities, &entities_arr, arr_idx);
-	AddComponentEntities(ComponentEntities, &entities_arr, arr_idx);
-	bson_append_array_end(ws_doc, &entities_arr);
-
-	
-	// Avoid writing empty documents (this is empty if there are no skeletals in the map, not if there are no changes)
-	if(SkeletalEntities.Num() > 0)
+	// The flusher takes ownership of the document
+	if (Flusher.IsValid())
 	{
-		// Add skel entities to array
-		BSON_APPEND_ARRAY_BEGIN(ws_doc, "skel_entities", &sk_entities_arr);
-		// Reset array index
-		arr_idx = 0;
-		AddSkeletalEntities(SkeletalEntities, &sk_entities_arr, arr_idx);
-		bson_append_array_end(ws_doc, &sk_entities_arr);
-	}
-
-	if(GazeData.HasDataFast())
-	{
-		if(!PreviousGazeData.Equals(GazeData, 3.f))
-		{
-			AddGazeData(GazeData, ws_doc);
-			PreviousGazeData = GazeData;
-		}
+		Flusher->Add(ws_doc);
+		return;
 	}
 
-
-
+	const double StartTime = FPlatformTime::Seconds();
 	if (!mongoc_collection_insert_one(collection, ws_doc, NULL, NULL, &error))
 	{
 		UE_LOG(LogTemp, Error, TEXT("%s::%d Err.: %s"),
 			*FString(__func__), __LINE__, *FString(error.message));
-		bson_destroy(ws_doc);
 	}
+	RoundTripLatencies.Add(FPlatformTime::Seconds() - StartTime);
 
 	// Clean up
 	bson_destroy(ws_doc);
@@ -131,9 +176,51 @@ void FSLWorldWriterMongoC::Write(float Timestamp,
 #endif //SL_WITH_LIBMONGO_C
 }
 
+#if SL_WITH_LIBMONGO_C
+// Insert (or pass to the flusher) the closed bucket documents
+void FSLWorldWriterMongoC::InsertBucketDocs()
+{
+	if (BucketDocs.Num() == 0)
+	{
+		return;
+	}
+	for (const bson_t* doc : BucketDocs)
+	{
+		NumBytesWritten += doc->len;
+	}
+
+	// The flusher takes ownership of the documents
+	if (Flusher.IsValid())
+	{
+		for (bson_t* doc : BucketDocs)
+		{
+			Flusher->Add(doc);
+		}
+		BucketDocs.Reset();
+		return;
+	}
+
+	// All buckets of a window are inserted with one round-trip
+	bson_error_t error;
+	const double StartTime = FPlatformTime::Seconds();
+	if (!mongoc_collection_insert_many(collection, const_cast<const bson_t**>(BucketDocs.GetData()),
+		BucketDocs.Num(), NULL, NULL, &error))
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s::%d Err.: %s"),
+			*FString(__func__), __LINE__, *FString(error.message));
+	}
+	RoundTripLatencies.Add(FPlatformTime::Seconds() - StartTime);
+	for (bson_t* doc : BucketDocs)
+	{
+		bson_destroy(doc);
+	}
+	BucketDocs.Reset();
+}
+#endif //SL_WITH_LIBMONGO_C
+
 // Connect to the database
 bool FSLWorldWriterMongoC::Connect(const FString& DBName, const FString& CollectionName, const FString& ServerIp,
-	uint16 ServerPort, bool bOverwrite)
+	uint16 ServerPort, bool bOverwrite, bool bTimeSeries)
 {
 #if SL_WITH_LIBMONGO_C
 	// Required to initialize libmongoc's internals	
@@ -192,7 +279,27 @@ bool FSLWorldWriterMongoC::Connect(const FString& DBName, const FString& Collect
 			*FString(__func__), __LINE__, *DBName, *CollectionName);
 	}
 
-	collection = mongoc_client_get_collection(client, TCHAR_TO_UTF8(*DBName), TCHAR_TO_UTF8(*CollectionName));
+	// Time series collections have to be created explicitly
+	collection = nullptr;
+	if (bTimeSeries)
+	{
+		bson_t* ts_opts = BCON_NEW("timeseries", "{",
+			"timeField", BCON_UTF8(FSLWorldStateBucketFormat::TimeField()),
+			"metaField", BCON_UTF8(FSLWorldStateBucketFormat::MetaField()),
+			"granularity", BCON_UTF8("seconds"),
+			"}");
+		collection = mongoc_database_create_collection(database, TCHAR_TO_UTF8(*CollectionName), ts_opts, &error);
+		bson_destroy(ts_opts);
+		if (!collection)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("%s::%d Could not create the time series collection (requires MongoDB 5.0+), err.:%s; using a regular collection.."),
+				*FString(__func__), __LINE__, *FString(error.message));
+		}
+	}
+	if (!collection)
+	{
+		collection = mongoc_client_get_collection(client, TCHAR_TO_UTF8(*DBName), TCHAR_TO_UTF8(*CollectionName));
+	}
 
 	// Check server. Ping the "admin" database
 	bson_t* server_ping_cmd;
@@ -218,387 +325,76 @@ bool FSLWorldWriterMongoC::Connect(const FString& DBName, const FString& Collect
 void FSLWorldWriterMongoC::Disconnect()
 {
 #if SL_WITH_LIBMONGO_C
-	// Release handles and clean up mongoc
-	if(uri)
-	{
-		mongoc_uri_destroy(uri);
-	}
-	if(client)
+	// Release handles (in reverse order of creation, any of them can be unset if the connection failed) and clean up mongoc
+	if(collection)
 	{
-		mongoc_client_destroy(client);
+		mongoc_collection_destroy(collection);
+		collection = nullptr;
 	}
 	if(database)
 	{
 		mongoc_database_destroy(database);
+		database = nullptr;
 	}
-	if(collection)
-	{
-		mongoc_collection_destroy(collection);
-	}
-	mongoc_cleanup();
-#endif //SL_WITH_LIBMONGO_C
-}
-
-// Create indexes from the logged data, usually called after logging
-bool FSLWorldWriterMongoC::CreateIndexes() const
-{
-	if (!bIsInit)
+	if(client)
 	{
-		return false;
+		mongoc_client_destroy(client);
+		client = nullptr;
 	}
-#if SL_WITH_LIBMONGO_C
-
-	bson_t* index_command;
-	bson_error_t error;
-	
-	bson_t index;
-	bson_init(&index);
-	BSON_APPEND_INT32(&index, "timestamp", 1);
-	char* index_name = mongoc_collection_keys_to_index_string(&index);
-
-	bson_t index2;
-	bson_init(&index2);
-	BSON_APPEND_INT32(&index2, "entities.id", 1);
-	char* index_name2 = mongoc_collection_keys_to_index_string(&index2);
-
-	bson_t index3;
-	bson_init(&index3);
-	BSON_APPEND_INT32(&index3, "skel_entities.id", 1);
-	char* index_name3 = mongoc_collection_keys_to_index_string(&index3);
-
-	bson_t index4;
-	bson_init(&index4);
-	BSON_APPEND_INT32(&index4, "skel_entities.bones.name", 1);
-	char* index_name4 = mongoc_collection_keys_to_index_string(&index4);
-
-	//bson_t index5;
-	//bson_init(&index5);
-	//BSON_APPEND_INT32(&index5, "skel_entities.bones.class", 1);
-	//char* index_name5 = mongoc_collection_keys_to_index_string(&index5);
-
-	bson_t index5;
-	bson_init(&index5);
-	BSON_APPEND_INT32(&index5, "skel_entities.bones.id", 1);
-	char* index_name5 = mongoc_collection_keys_to_index_string(&index5);
-
-	bson_t index6;
-	bson_init(&index6);
-	BSON_APPEND_INT32(&index6, "gaze.entity_id", 1);
-	char* index_name6 = mongoc_collection_keys_to_index_string(&index6);
-
-
-	index_command = BCON_NEW("createIndexes",
-			BCON_UTF8(mongoc_collection_get_name(collection)),
-			"indexes",
-			"[",
-				"{",
-					"key",
-					BCON_DOCUMENT(&index),
-					"name",
-					BCON_UTF8(index_name),
-					"unique",
-					BCON_BOOL(true),
-				"}",
-				"{",
-					"key",
-					BCON_DOCUMENT(&index2),
-					"name",
-					BCON_UTF8(index_name2),
-					//"unique",
-					//BCON_BOOL(false),
-				"}",
-				"{",
-					"key",
-					BCON_DOCUMENT(&index3),
-					"name",
-					BCON_UTF8(index_name3),
-					//"unique",
-					//BCON_BOOL(false),
-				"}",
-				"{",
-					"key",
-					BCON_DOCUMENT(&index4),
-					"name",
-					BCON_UTF8(index_name4),
-					//"unique",
-					//BCON_BOOL(false),
-				"}",
-				"{",
-					"key",
-					BCON_DOCUMENT(&index5),
-					"name",
-					BCON_UTF8(index_name5),
-					//"unique",
-					//BCON_BOOL(false),
-				"}",
-				"{",
-					"key",
-					BCON_DOCUMENT(&index6),
-					"name",
-					BCON_UTF8(index_name6),
-					//"unique",
-					//BCON_BOOL(false),
-				"}",
-			"]");
-
-	if (!mongoc_collection_write_command_with_opts(collection, index_command, NULL/*opts*/, NULL/*reply*/, &error))
+	if(uri)
 	{
-		UE_LOG(LogTemp, Error, TEXT("%s::%d Create indexes err.: %s"),
-			*FString(__func__), __LINE__, *FString(error.message));
-		bson_destroy(index_command);
-		bson_free(index_name);
-		return false;
+		mongoc_uri_destroy(uri);
+		uri = nullptr;
 	}
 
-	// Clean up
-	bson_destroy(index_command);
-	bson_free(index_name);
-	return true;
-#else
-	return false;
-#endif //SL_WITH_LIBMONGO_C
-}
-
-#if SL_WITH_LIBMONGO_C
-// Add non skeletal actors to array
-void FSLWorldWriterMongoC::AddActorEntities(TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
-	bson_t* out_doc, uint32_t& idx) const
-{
-	bson_t arr_obj;
-	char idx_str[16];
-	const char *idx_key;
-
-	// Iterate items
-	for (auto Itr(ActorEntities.CreateIterator()); Itr; ++Itr)
+	// The background index thread uses its own connection, mongoc is only cleaned up after it finished
+	if (BackgroundIndexes.IsValid())
 	{
-		// Check if pointer is valid
-		if (Itr->Obj.IsValid(/*false, true*/))
+		if (!BackgroundIndexes.IsReady())
 		{
-			// Check if the entity moved more than the threshold since the last logging
-			const FVector CurrLoc = Itr->Obj->GetActorLocation();
-			const FQuat CurrQuat = Itr->Obj->GetActorQuat();
-
-			if (FVector::DistSquared(CurrLoc, Itr->PrevLoc) > LinDistSqMin ||
-				CurrQuat.AngularDistance(Itr->PrevQuat))
-			{
-				// Update prev state
-				Itr->PrevLoc = CurrLoc;
-				Itr->PrevQuat = CurrQuat;
-
-				bson_uint32_to_string(idx, &idx_key, idx_str, sizeof idx_str);
-				BSON_APPEND_DOCUMENT_BEGIN(out_doc, idx_key, &arr_obj);
-
-				BSON_APPEND_UTF8(&arr_obj, "id", TCHAR_TO_UTF8(*Itr->Entity.Id));
-				AddPoseChild(CurrLoc, CurrQuat, &arr_obj);
-
-				bson_append_document_end(out_doc, &arr_obj);
-				idx++;
-			}
-		}
-		else
-		{
-			Itr.RemoveCurrent();
-			FSLEntitiesManager::GetInstance()->RemoveEntity(Itr->Obj.Get());
+			UE_LOG(LogTemp, Log, TEXT("%s::%d Waiting for the background index creation of %s.%s.."),
+				*FString(__func__), __LINE__, *DBName, *CollName);
 		}
+		BackgroundIndexes.Wait();
+		BackgroundIndexes.Reset();
 	}
+	mongoc_cleanup();
+#endif //SL_WITH_LIBMONGO_C
 }
 
-// Add non skeletal components to array
-void FSLWorldWriterMongoC::AddComponentEntities(TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
-	bson_t* out_doc, uint32_t& idx) const
+// Create indexes from the logged data, up front (maintained by the server while logging), in background or blocking
+bool FSLWorldWriterMongoC::CreateIndexes(ESLMongoIndexMode InMode)
 {
-	bson_t arr_obj;
-	char idx_str[16];
-	const char *idx_key;
-
-	// Iterate items
-	for (auto Itr(ComponentEntities.CreateIterator()); Itr; ++Itr)
+	if (InMode != IndexMode)
 	{
-		// Check if pointer is valid
-		if (Itr->Obj.IsValid(/*false, true*/))
-		{
-			// Check if the entity moved more than the threshold since the last logging
-			const FVector CurrLoc = Itr->Obj->GetComponentLocation();
-			const FQuat CurrQuat = Itr->Obj->GetComponentQuat();
-
-			if (FVector::DistSquared(CurrLoc, Itr->PrevLoc) > LinDistSqMin ||
-				CurrQuat.AngularDistance(Itr->PrevQuat))
-			{
-				// Update prev state
-				Itr->PrevLoc = CurrLoc;
-				Itr->PrevQuat = CurrQuat;
-
-				bson_uint32_to_string(idx, &idx_key, idx_str, sizeof idx_str);
-				BSON_APPEND_DOCUMENT_BEGIN(out_doc, idx_key, &arr_obj);
-
-				BSON_APPEND_UTF8(&arr_obj, "id", TCHAR_TO_UTF8(*Itr->Entity.Id));
-				AddPoseChild(CurrLoc, CurrQuat, &arr_obj);
-
-				uint32_t arr_jdx = 10;
-
-
-				bson_append_document_end(out_doc, &arr_obj);
-				idx++;
-			}
-		}
-		else
-		{
-			Itr.RemoveCurrent();
-			FSLEntitiesManager::GetInstance()->RemoveEntity(Itr->Obj.Get());
-		}
+		return false;
 	}
-}
-
-// Add skeletal actors to array
-void FSLWorldWriterMongoC::AddSkeletalEntities(TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
-	bson_t* out_doc, uint32_t& idx) const
-{
-	bson_t arr_obj;
-	char idx_str[16];
-	const char *idx_key;
 
-	// Iterate items
-	for (auto Itr(SkeletalEntities.CreateIterator()); Itr; ++Itr)
+	TArray<FSLMongoIndex> Indexes;
+	if (bEntityBuckets)
 	{
-		// Check if the entity moved more than the threshold since the last logging
-		const FVector CurrLoc = Itr->Obj->GetComponentLocation();
-		const FQuat CurrQuat = Itr->Obj->GetComponentQuat();
-		
-		// Check if pointer is valid
-		if (Itr->Obj.IsValid(/*false, true*/))
-		{
-			if (FVector::DistSquared(CurrLoc, Itr->PrevLoc) > LinDistSqMin ||
-				CurrQuat.AngularDistance(Itr->PrevQuat))
-			{
-				// Update prev state
-				Itr->PrevLoc = CurrLoc;
-				Itr->PrevQuat = CurrQuat;
-
-				bson_uint32_to_string(idx, &idx_key, idx_str, sizeof idx_str);
-				BSON_APPEND_DOCUMENT_BEGIN(out_doc, idx_key, &arr_obj);
-
-				BSON_APPEND_UTF8(&arr_obj, "id", TCHAR_TO_UTF8(*Itr->Entity.Id));
-				AddPoseChild(CurrLoc, CurrQuat, &arr_obj);
-
-				// Add bones
-				if (Itr->Obj->SkeletalMeshParent)
-				{
-					AddSkeletalBones(Itr->Obj->SkeletalMeshParent, Itr->Obj->SemanticBonesData, &arr_obj);
-				}
-
-				bson_append_document_end(out_doc, &arr_obj);
-				idx++;
-			}
-		}
-		else
-		{
-			Itr.RemoveCurrent();
-			FSLEntitiesManager::GetInstance()->RemoveEntity(Itr->Obj.Get());
-		}
+		// Trajectory queries select the entity (and bone) and the time window
+		Indexes.Emplace(FSLMongoIndex({ TEXT("meta.id"), TEXT("meta.bone"), FSLWorldStateBucketFormat::TimeField() }));
 	}
-}
-
-// Add gaze data to document
-void FSLWorldWriterMongoC::AddGazeData(const FSLGazeData& GazeData, bson_t* out_doc) const
-{
-	FVector TargetLoc;
-	FVector OrigLoc;
-#if SL_WITH_ROS_CONVERSIONS
-	TargetLoc = FConversions::UToROS(GazeData.Target);
-	OrigLoc = FConversions::UToROS(GazeData.Origin);
-#else
-	TargetLoc = GazeData.Target;
-	OrigLoc = GazeData.Origin;
-#endif // SL_WITH_ROS_CONVERSIONS
-
-	// When nesting objects, parent needs to be init to a base state !!! 
-	bson_t gaze_obj = BSON_INITIALIZER; 
-	bson_t target_loc;
-	bson_t origin_loc;
-	
-	BSON_APPEND_UTF8(&gaze_obj, "entity_id", TCHAR_TO_UTF8(*GazeData.Entity.Id));
-	
-	BSON_APPEND_DOCUMENT_BEGIN(&gaze_obj, "target", &target_loc);
-	BSON_APPEND_DOUBLE(&target_loc, "x", TargetLoc.X);
-	BSON_APPEND_DOUBLE(&target_loc, "y", TargetLoc.Y);
-	BSON_APPEND_DOUBLE(&target_loc, "z", TargetLoc.Z);
-	bson_append_document_end(&gaze_obj, &target_loc);
-
-	BSON_APPEND_DOCUMENT_BEGIN(&gaze_obj, "origin", &origin_loc);
-	BSON_APPEND_DOUBLE(&origin_loc, "x", OrigLoc.X);
-	BSON_APPEND_DOUBLE(&origin_loc, "y", OrigLoc.Y);
-	BSON_APPEND_DOUBLE(&origin_loc, "z", OrigLoc.Z);
-	bson_append_document_end(&gaze_obj, &origin_loc);
-	
-	BSON_APPEND_DOCUMENT(out_doc, "gaze", &gaze_obj);
-}
-
-// Add skeletal bones to array
-void FSLWorldWriterMongoC::AddSkeletalBones(USkeletalMeshComponent* SkelComp, const TMap<FName, FSLBoneData>& BoneClassMap, bson_t* out_doc) const
-{
-	bson_t bones_arr;
-	bson_t arr_obj;
-	char idx_str[16];
-	const char *idx_key;
-	uint32_t arr_idx = 0;
-
-	// Add entities to array
-	BSON_APPEND_ARRAY_BEGIN(out_doc, "bones", &bones_arr);
-
-	TArray<FName> BoneNames;
-	SkelComp->GetBoneNames(BoneNames);
-	for (const auto& BoneName : BoneNames)
+	else
 	{
-		const FVector CurrLoc = SkelComp->GetBoneLocation(BoneName);
-		const FQuat CurrQuat = SkelComp->GetBoneQuaternion(BoneName);
-
-		bson_uint32_to_string(arr_idx, &idx_key, idx_str, sizeof idx_str);
-		BSON_APPEND_DOCUMENT_BEGIN(&bones_arr, idx_key, &arr_obj);
-
-		BSON_APPEND_UTF8(&arr_obj, "name", TCHAR_TO_UTF8(*BoneName.ToString()));
-
-		if(const FSLBoneData* BoneData = BoneClassMap.Find(BoneName))
-		{
-			//BSON_APPEND_UTF8(&arr_obj, "class", TCHAR_TO_UTF8(*BoneData->Class));
-			BSON_APPEND_UTF8(&arr_obj, "id", TCHAR_TO_UTF8(*BoneData->Id));
-		}
-
-		AddPoseChild(CurrLoc, CurrQuat, &arr_obj);
-
-		bson_append_document_end(&bones_arr, &arr_obj);
-		arr_idx++;
+		Indexes.Emplace(FSLMongoIndex({ TEXT("timestamp") }, true));
+		Indexes.Emplace(FSLMongoIndex({ TEXT("entities.id") }));
+		Indexes.Emplace(FSLMongoIndex({ TEXT("skel_entities.id") }));
+		Indexes.Emplace(FSLMongoIndex({ TEXT("skel_entities.bones.name") }));
+		//Indexes.Emplace(FSLMongoIndex({ TEXT("skel_entities.bones.class") }));
+		Indexes.Emplace(FSLMongoIndex({ TEXT("skel_entities.bones.id") }));
+		Indexes.Emplace(FSLMongoIndex({ TEXT("gaze.entity_id") }));
 	}
 
-	bson_append_array_end(out_doc, &bones_arr);
-}
-
-// Add pose to document
-void FSLWorldWriterMongoC::AddPoseChild(const FVector& InLoc, const FQuat& InQuat, bson_t* out_doc) const
-{
-	FVector Loc;
-	FQuat Quat;
-#if SL_WITH_ROS_CONVERSIONS
-	Loc = FConversions::UToROS(InLoc);
-	Quat = FConversions::UToROS(InQuat);
+	if (IndexMode == ESLMongoIndexMode::Background)
+	{
+		BackgroundIndexes = FSLMongoIndexes::CreateInBackground(ServerIp, ServerPort, DBName, CollName, Indexes);
+		return true;
+	}
+#if SL_WITH_LIBMONGO_C
+	return FSLMongoIndexes::Create(collection, Indexes);
 #else
-	Loc = InLoc;
-	Quat = InQuat;
-#endif // SL_WITH_ROS_CONVERSIONS
-
-	bson_t child_obj_loc;
-	bson_t child_obj_rot;
-	
-	BSON_APPEND_DOCUMENT_BEGIN(out_doc, "loc", &child_obj_loc);
-	BSON_APPEND_DOUBLE(&child_obj_loc, "x", Loc.X);
-	BSON_APPEND_DOUBLE(&child_obj_loc, "y", Loc.Y);
-	BSON_APPEND_DOUBLE(&child_obj_loc, "z", Loc.Z);
-	bson_append_document_end(out_doc, &child_obj_loc);
-
-	BSON_APPEND_DOCUMENT_BEGIN(out_doc, "rot", &child_obj_rot);
-	BSON_APPEND_DOUBLE(&child_obj_rot, "x", Quat.X);
-	BSON_APPEND_DOUBLE(&child_obj_rot, "y", Quat.Y);
-	BSON_APPEND_DOUBLE(&child_obj_rot, "z", Quat.Z);
-	BSON_APPEND_DOUBLE(&child_obj_rot, "w", Quat.W);
-	bson_append_document_end(out_doc, &child_obj_rot);
-}
+	return false;
 #endif //SL_WITH_LIBMONGO_C
+}
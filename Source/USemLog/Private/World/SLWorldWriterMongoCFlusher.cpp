@@ -0,0 +1,427 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "World/SLWorldWriterMongoCFlusher.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformFilemanager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "Misc/Paths.h"
+
+#if SL_WITH_LIBMONGO_C
+// Ctor
+FSLWorldWriterMongoCFlusher::FSLWorldWriterMongoCFlusher(mongoc_collection_t* InCollection,
+	const FSLWorldWriterMongoBatchParams& InParams, const FString& InJournalPath) :
+	collection(InCollection),
+	Params(InParams),
+	PendingBytes(0),
+	JournalPath(InJournalPath),
+	JournalWriter(nullptr),
+	JournalReader(nullptr),
+	JournalWriteOffset(0),
+	JournalReadOffset(0),
+	bIsSpilling(false),
+	WakeUpEvent(nullptr),
+	Thread(nullptr),
+	bStopRequested(false),
+	MaxFlushDuration(0.0),
+	TotalFlushDuration(0.0),
+	NumFlushes(0),
+	NumFlushedDocs(0)
+{
+	PendingDocs.Reserve(Params.MaxNumDocs);
+	FlushDocs.Reserve(Params.MaxNumDocs);
+
+	// Unordered inserts, the server continues with the remaining documents if one fails
+	bson_init(&bulk_opts);
+	BSON_APPEND_BOOL(&bulk_opts, "ordered", false);
+	mongoc_write_concern_t* write_concern = mongoc_write_concern_new();
+	mongoc_write_concern_set_w(write_concern, Params.WriteConcern);
+	mongoc_write_concern_append(write_concern, &bulk_opts);
+	mongoc_write_concern_destroy(write_concern);
+}
+#endif //SL_WITH_LIBMONGO_C
+
+// Dtor
+FSLWorldWriterMongoCFlusher::~FSLWorldWriterMongoCFlusher()
+{
+	Finish();
+#if SL_WITH_LIBMONGO_C
+	bson_destroy(&bulk_opts);
+#endif //SL_WITH_LIBMONGO_C
+}
+
+// Create the flush thread
+bool FSLWorldWriterMongoCFlusher::Start()
+{
+	if (Thread)
+	{
+		return true;
+	}
+	bStopRequested = false;
+	WakeUpEvent = FPlatformProcess::GetSynchEventFromPool();
+	Thread = FRunnableThread::Create(this, TEXT("SLWorldWriterMongoCFlusher"), 0, TPri_BelowNormal);
+	if (!Thread)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s::%d Could not create the flush thread.."), *FString(__func__), __LINE__);
+		FPlatformProcess::ReturnSynchEventToPool(WakeUpEvent);
+		WakeUpEvent = nullptr;
+		return false;
+	}
+	return true;
+}
+
+// Stop the flush thread and insert the remaining documents
+void FSLWorldWriterMongoCFlusher::Finish()
+{
+	if (Thread)
+	{
+		// The thread flushes the remaining documents before exiting
+		Stop();
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+		FPlatformProcess::ReturnSynchEventToPool(WakeUpEvent);
+		WakeUpEvent = nullptr;
+
+		if (NumFlushes > 0)
+		{
+			UE_LOG(LogTemp, Log, TEXT("%s::%d Inserted %lld documents in %d bulk operations, avg flush %.2f ms, max flush %.2f ms.."),
+				*FString(__func__), __LINE__, NumFlushedDocs, NumFlushes,
+				TotalFlushDuration * 1000.0 / NumFlushes, MaxFlushDuration * 1000.0);
+		}
+		UE_LOG(LogTemp, Log, TEXT("%s::%d Queue high-water mark %d documents (%lld bytes), %d spills, %lld documents (%lld bytes) spilled, %lld replayed.."),
+			*FString(__func__), __LINE__, QueueStats.MaxQueuedDocs, QueueStats.MaxQueuedBytes, QueueStats.NumSpills,
+			QueueStats.NumSpilledDocs, QueueStats.NumSpilledBytes, QueueStats.NumReplayedDocs);
+
+		CloseJournal();
+	}
+}
+
+// Get a copy of the queue statistics (thread safe)
+FSLWorldWriterMongoQueueStats FSLWorldWriterMongoCFlusher::GetQueueStats() const
+{
+	FScopeLock Lock(&PendingCS);
+	return QueueStats;
+}
+
+#if SL_WITH_LIBMONGO_C
+// Add document to the pending batch, or to the journal if the queue is full (takes ownership)
+void FSLWorldWriterMongoCFlusher::Add(bson_t* Doc)
+{
+	bool bBatchFull = false;
+	{
+		FScopeLock Lock(&PendingCS);
+
+		// The flush thread is stalled, spill the documents until it catches up
+		if (!bIsSpilling && Params.MaxQueueBytes > 0 && PendingBytes + Doc->len > Params.MaxQueueBytes && OpenJournal())
+		{
+			bIsSpilling = true;
+			QueueStats.NumSpills++;
+			UE_LOG(LogTemp, Warning, TEXT("%s::%d Queue full (%lld bytes), spilling the documents to %s.."),
+				*FString(__func__), __LINE__, PendingBytes, *JournalPath);
+		}
+
+		if (bIsSpilling)
+		{
+			// The bson data is length prefixed, no additional record header is needed
+			if (JournalWriter->Write(bson_get_data(Doc), Doc->len))
+			{
+				JournalWriteOffset += Doc->len;
+				QueueStats.NumSpilledDocs++;
+				QueueStats.NumSpilledBytes += Doc->len;
+				QueueStats.JournalBacklogBytes = JournalWriteOffset - JournalReadOffset;
+				bson_destroy(Doc);
+				return;
+			}
+			UE_LOG(LogTemp, Error, TEXT("%s::%d Could not write to the journal %s, the document is kept in memory.."),
+				*FString(__func__), __LINE__, *JournalPath);
+		}
+
+		PendingDocs.Add(Doc);
+		PendingBytes += Doc->len;
+		QueueStats.MaxQueuedDocs = FMath::Max(QueueStats.MaxQueuedDocs, PendingDocs.Num());
+		QueueStats.MaxQueuedBytes = FMath::Max(QueueStats.MaxQueuedBytes, PendingBytes);
+		bBatchFull = PendingDocs.Num() >= Params.MaxNumDocs || PendingBytes >= Params.MaxNumBytes;
+	}
+
+	if (bBatchFull && WakeUpEvent)
+	{
+		WakeUpEvent->Trigger();
+	}
+}
+#endif //SL_WITH_LIBMONGO_C
+
+// Flush loop
+uint32 FSLWorldWriterMongoCFlusher::Run()
+{
+	const uint32 WaitMs = FMath::Max(1, FMath::RoundToInt(Params.MaxInterval * 1000.f));
+	while (!bStopRequested)
+	{
+		// Woken up early if the batch is full, otherwise flush whatever accumulated during the interval
+		WakeUpEvent->Wait(WaitMs);
+		Flush();
+		ReplayJournal();
+	}
+
+	// Insert the documents added before stopping
+	Flush();
+	ReplayJournal();
+	return 0;
+}
+
+// Request the flush thread to exit
+void FSLWorldWriterMongoCFlusher::Stop()
+{
+	bStopRequested = true;
+	if (WakeUpEvent)
+	{
+		WakeUpEvent->Trigger();
+	}
+}
+
+// Insert the pending documents with a bulk operation
+void FSLWorldWriterMongoCFlusher::Flush()
+{
+#if SL_WITH_LIBMONGO_C
+	int64 FlushBytes = 0;
+	{
+		FScopeLock Lock(&PendingCS);
+		Swap(PendingDocs, FlushDocs);
+		FlushBytes = PendingBytes;
+		PendingBytes = 0;
+	}
+	InsertDocs(FlushDocs, FlushBytes);
+#endif //SL_WITH_LIBMONGO_C
+}
+
+// Insert the journal documents written so far, leaves the spilling mode if all of them were inserted
+void FSLWorldWriterMongoCFlusher::ReplayJournal()
+{
+#if SL_WITH_LIBMONGO_C
+	int64 EndOffset = 0;
+	{
+		FScopeLock Lock(&PendingCS);
+		if (!bIsSpilling)
+		{
+			return;
+		}
+		JournalWriter->Flush();
+		EndOffset = JournalWriteOffset;
+	}
+
+	if (!JournalReader)
+	{
+		JournalReader = FPlatformFileManager::Get().GetPlatformFile().OpenRead(*JournalPath, true);
+		if (!JournalReader)
+		{
+			UE_LOG(LogTemp, Error, TEXT("%s::%d Could not open the journal %s for reading.."),
+				*FString(__func__), __LINE__, *JournalPath);
+			return;
+		}
+	}
+
+	// Insert the journal in batches of the same size as the in memory ones
+	TArray<uint8> Buffer;
+	JournalReader->Seek(JournalReadOffset);
+	while (JournalReadOffset < EndOffset)
+	{
+		int64 NumBytes = 0;
+		while (JournalReadOffset < EndOffset && FlushDocs.Num() < Params.MaxNumDocs && NumBytes < Params.MaxNumBytes)
+		{
+			int32 DocLen = 0;
+			if (!JournalReader->Read(reinterpret_cast<uint8*>(&DocLen), sizeof(int32)) || DocLen < 5 ||
+				JournalReadOffset + DocLen > EndOffset)
+			{
+				UE_LOG(LogTemp, Error, TEXT("%s::%d Corrupted journal %s at offset %lld, the remaining documents are skipped.."),
+					*FString(__func__), __LINE__, *JournalPath, JournalReadOffset);
+				JournalReadOffset = EndOffset;
+				break;
+			}
+			Buffer.SetNumUninitialized(DocLen, false);
+			FMemory::Memcpy(Buffer.GetData(), &DocLen, sizeof(int32));
+			if (!JournalReader->Read(Buffer.GetData() + sizeof(int32), DocLen - sizeof(int32)))
+			{
+				JournalReadOffset = EndOffset;
+				break;
+			}
+			JournalReadOffset += DocLen;
+			if (bson_t* Doc = bson_new_from_data(Buffer.GetData(), DocLen))
+			{
+				FlushDocs.Add(Doc);
+				NumBytes += DocLen;
+			}
+		}
+
+		// If the server is still unreachable the batch was appended to the journal again, the replay is retried at the next flush
+		const int32 NumDocs = FlushDocs.Num();
+		const bool bInserted = InsertDocs(FlushDocs, NumBytes);
+
+		FScopeLock Lock(&PendingCS);
+		QueueStats.NumReplayedDocs += bInserted ? NumDocs : 0;
+		QueueStats.JournalBacklogBytes = JournalWriteOffset - JournalReadOffset;
+		if (!bInserted)
+		{
+			break;
+		}
+	}
+
+	// New documents are kept in memory again only if nothing was appended in the meantime
+	FScopeLock Lock(&PendingCS);
+	if (JournalReadOffset == JournalWriteOffset)
+	{
+		bIsSpilling = false;
+		UE_LOG(LogTemp, Log, TEXT("%s::%d Journal %s replayed (%lld bytes).."),
+			*FString(__func__), __LINE__, *JournalPath, JournalReadOffset);
+	}
+#endif //SL_WITH_LIBMONGO_C
+}
+
+// Open the journal for appending (called with the pending lock held)
+bool FSLWorldWriterMongoCFlusher::OpenJournal()
+{
+	if (JournalWriter)
+	{
+		return true;
+	}
+	if (JournalPath.IsEmpty())
+	{
+		return false;
+	}
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(JournalPath));
+	JournalWriter = PlatformFile.OpenWrite(*JournalPath, false, true);
+	if (!JournalWriter)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s::%d Could not create the journal %s, the queue grows unbounded.."),
+			*FString(__func__), __LINE__, *JournalPath);
+		JournalPath.Empty();
+		return false;
+	}
+	JournalWriteOffset = 0;
+	JournalReadOffset = 0;
+	return true;
+}
+
+// Close the journal, it is removed if all its documents were inserted
+void FSLWorldWriterMongoCFlusher::CloseJournal()
+{
+	if (JournalReader)
+	{
+		delete JournalReader;
+		JournalReader = nullptr;
+	}
+	if (JournalWriter)
+	{
+		delete JournalWriter;
+		JournalWriter = nullptr;
+		if (JournalReadOffset == JournalWriteOffset)
+		{
+			FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*JournalPath);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Error, TEXT("%s::%d %lld bytes of the journal %s were not inserted, the file is kept.."),
+				*FString(__func__), __LINE__, JournalWriteOffset - JournalReadOffset, *JournalPath);
+		}
+	}
+	bIsSpilling = false;
+}
+
+#if SL_WITH_LIBMONGO_C
+// Insert the documents with a bulk operation and destroy them, if nothing was inserted the batch is spilled to the journal
+bool FSLWorldWriterMongoCFlusher::InsertDocs(TArray<bson_t*>& Docs, int64 NumBytes)
+{
+	if (Docs.Num() == 0)
+	{
+		return true;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	bson_error_t error;
+	bson_t reply;
+	mongoc_bulk_operation_t* bulk = mongoc_collection_create_bulk_operation_with_opts(collection, &bulk_opts);
+	for (bson_t* Doc : Docs)
+	{
+		if (!mongoc_bulk_operation_insert_with_opts(bulk, Doc, NULL, &error))
+		{
+			UE_LOG(LogTemp, Error, TEXT("%s::%d Bulk insert err.: %s"),
+				*FString(__func__), __LINE__, *FString(error.message));
+		}
+	}
+
+	// The documents are kept until the batch reached the server
+	bool bSpill = false;
+	if (!mongoc_bulk_operation_execute(bulk, &reply, &error))
+	{
+		// Nothing was inserted (e.g. server unreachable), the batch is retried from the journal, partial failures are not
+		// retried since the inserted documents would be duplicated
+		bson_iter_t iter;
+		bSpill = !(bson_iter_init_find(&iter, &reply, "nInserted") && BSON_ITER_HOLDS_INT32(&iter) && bson_iter_int32(&iter) > 0);
+		UE_LOG(LogTemp, Error, TEXT("%s::%d Bulk execute err.: %s%s"),
+			*FString(__func__), __LINE__, *FString(error.message), bSpill ? TEXT(", the batch is spilled to the journal..") : TEXT(""));
+	}
+	bson_destroy(&reply);
+	mongoc_bulk_operation_destroy(bulk);
+
+	if (!bSpill || !SpillDocs(Docs))
+	{
+		for (bson_t* Doc : Docs)
+		{
+			bson_destroy(Doc);
+		}
+	}
+
+	// Report the flush latency
+	const double Duration = FPlatformTime::Seconds() - StartTime;
+	MaxFlushDuration = FMath::Max(MaxFlushDuration, Duration);
+	TotalFlushDuration += Duration;
+	NumFlushes++;
+	NumFlushedDocs += bSpill ? 0 : Docs.Num();
+	FlushLatencies.Add(Duration);
+	UE_LOG(LogTemp, Verbose, TEXT("%s::%d Flushed %d documents (%lld bytes) in %.2f ms.."),
+		*FString(__func__), __LINE__, Docs.Num(), NumBytes, Duration * 1000.0);
+
+	Docs.Reset();
+	return !bSpill;
+}
+
+// Append the documents of a failed batch to the journal, they are inserted by the next replay (keeps the documents on failure)
+bool FSLWorldWriterMongoCFlusher::SpillDocs(TArray<bson_t*>& Docs)
+{
+	FScopeLock Lock(&PendingCS);
+	if (!OpenJournal())
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s::%d No journal, %d documents are lost.."), *FString(__func__), __LINE__, Docs.Num());
+		return false;
+	}
+
+	// The documents added from now on are appended after the batch
+	if (!bIsSpilling)
+	{
+		bIsSpilling = true;
+		QueueStats.NumSpills++;
+	}
+	for (bson_t* Doc : Docs)
+	{
+		if (!JournalWriter->Write(bson_get_data(Doc), Doc->len))
+		{
+			UE_LOG(LogTemp, Error, TEXT("%s::%d Could not write to the journal %s, the remaining documents of the batch are lost.."),
+				*FString(__func__), __LINE__, *JournalPath);
+			break;
+		}
+		JournalWriteOffset += Doc->len;
+		QueueStats.NumSpilledDocs++;
+		QueueStats.NumSpilledBytes += Doc->len;
+	}
+	QueueStats.JournalBacklogBytes = JournalWriteOffset - JournalReadOffset;
+	for (bson_t* Doc : Docs)
+	{
+		bson_destroy(Doc);
+	}
+	return true;
+}
+#endif //SL_WITH_LIBMONGO_C
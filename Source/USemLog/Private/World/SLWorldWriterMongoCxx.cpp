@@ -89,12 +89,10 @@ void FSLWorldWriterMongoCxx::Finish()
 //#endif //SL_WITH_LIBMONGO_CXX
 //}
 
-void FSLWorldWriterMongoCxx::Write(float Timestamp,
-	TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
-	TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
-	TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities,
-	FSLGazeData& GazeData,
-	bool bCheckAndRemoveInvalidEntities)
+void FSLWorldWriterMongoCxx::Write(const FSLWorldStateSnapshot& Snapshot, const FSLWorldStateChanges& Changes,
+	const TArray<TSLEntityPreviousPose<AActor>>& ActorEntities,
+	const TArray<TSLEntityPreviousPose<USceneComponent>>& ComponentEntities,
+	const TArray<TSLEntityPreviousPose<USLSkeletalDataComponent>>& SkeletalEntities)
 {
 
 }
@@ -209,7 +207,7 @@ void FSLWorldWriterMongoCxx::AddNonSkeletalActors(TArray<TSLEntityPreviousPose<A
 			const FQuat CurrQuat = Itr->Entity->GetActorQuat();
 
 			if (FVector::DistSquared(CurrLoc, Itr->PrevLoc) > LinDistSqMin ||
-				CurrQuat.AngularDistance(Itr->PrevQuat))
+				CurrQuat.AngularDistance(Itr->PrevQuat) > AngDistMin)
 			{
 				// Update prev state
 				Itr->PrevLoc = CurrLoc;
@@ -252,7 +250,7 @@ void FSLWorldWriterMongoCxx::AddSkeletalActors(TArray<TSLEntityPreviousPose<ASLS
 			const FQuat CurrQuat = Itr->Entity->GetActorQuat();
 
 			if (FVector::DistSquared(CurrLoc, Itr->PrevLoc) > LinDistSqMin ||
-				CurrQuat.AngularDistance(Itr->PrevQuat))
+				CurrQuat.AngularDistance(Itr->PrevQuat) > AngDistMin)
 			{
 				// Update prev state
 				Itr->PrevLoc = CurrLoc;
@@ -326,7 +324,7 @@ void FSLWorldWriterMongoCxx::AddNonSkeletalComponents(TArray<TSLEntityPreviousPo
 			const FQuat CurrQuat = Itr->Entity->GetComponentQuat();
 
 			if (FVector::DistSquared(CurrLoc, Itr->PrevLoc) > LinDistSqMin ||
-				CurrQuat.AngularDistance(Itr->PrevQuat))
+				CurrQuat.AngularDistance(Itr->PrevQuat) > AngDistMin)
 			{
 				// Update prev state
 				Itr->PrevLoc = CurrLoc;
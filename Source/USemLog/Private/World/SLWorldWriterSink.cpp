@@ -0,0 +1,147 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "World/SLWorldWriterSink.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+
+// Ctor
+FSLWorldWriterSink::FSLWorldWriterSink(TSharedPtr<ISLWorldWriter> InWriter, FSLWorldStateBuffer* InBuffer, int32 InReaderIdx,
+	FSLWorldWriterTelemetry* InTelemetry, bool bInKeepFrames, FEvent* InIdleEvent) :
+	Writer(InWriter),
+	Buffer(InBuffer),
+	ReaderIdx(InReaderIdx),
+	Telemetry(InTelemetry),
+	bKeepFrames(bInKeepFrames),
+	WakeUpEvent(nullptr),
+	IdleEvent(InIdleEvent),
+	Thread(nullptr),
+	bStopRequested(false),
+	bSkipRemaining(false),
+	LastNumSkipped(0)
+{
+}
+
+// Dtor
+FSLWorldWriterSink::~FSLWorldWriterSink()
+{
+	Finish();
+}
+
+// Create the writer thread
+bool FSLWorldWriterSink::Start()
+{
+	if (Thread)
+	{
+		return true;
+	}
+	bStopRequested = false;
+	bSkipRemaining = false;
+	WakeUpEvent = FPlatformProcess::GetSynchEventFromPool();
+	Thread = FRunnableThread::Create(this, *FString::Printf(TEXT("SLWorldWriterSink%d"), ReaderIdx), 0, TPri_BelowNormal);
+	if (!Thread)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s::%d Could not create the writer thread.."), *FString(__func__), __LINE__);
+		FPlatformProcess::ReturnSynchEventToPool(WakeUpEvent);
+		WakeUpEvent = nullptr;
+		return false;
+	}
+	return true;
+}
+
+// Wake up the writer thread, new snapshots are available
+void FSLWorldWriterSink::Notify()
+{
+	if (WakeUpEvent)
+	{
+		WakeUpEvent->Trigger();
+	}
+}
+
+// Stop the writer thread, with bWriteRemaining after it wrote the remaining snapshots, otherwise after the current one
+void FSLWorldWriterSink::Finish(bool bWriteRemaining)
+{
+	if (Thread)
+	{
+		bSkipRemaining = !bWriteRemaining;
+		Stop();
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+		FPlatformProcess::ReturnSynchEventToPool(WakeUpEvent);
+		WakeUpEvent = nullptr;
+	}
+}
+
+// Write loop
+uint32 FSLWorldWriterSink::Run()
+{
+	while (!bStopRequested)
+	{
+		// The timeout covers a notification sent before the thread started waiting
+		WakeUpEvent->Wait(100);
+		WriteAvailableSnapshots();
+	}
+
+	// Write the snapshots released before stopping
+	WriteAvailableSnapshots();
+	return 0;
+}
+
+// Request the writer thread to exit
+void FSLWorldWriterSink::Stop()
+{
+	bStopRequested = true;
+	if (WakeUpEvent)
+	{
+		WakeUpEvent->Trigger();
+	}
+}
+
+// Write all the snapshots available to this sink
+void FSLWorldWriterSink::WriteAvailableSnapshots()
+{
+	while (!bSkipRemaining)
+	{
+		const FSLWorldStateSnapshot* Snapshot = Buffer->BeginRead(ReaderIdx);
+		if (!Snapshot)
+		{
+			break;
+		}
+		AddSkippedSnapshots();
+		{
+			SCOPE_CYCLE_COUNTER(STAT_SLWorldSerialize);
+			const double StartTime = FPlatformTime::Seconds();
+			const int64 StartBytes = Writer->GetNumBytesWritten();
+			const FSLWorldEntityLayout& Layout = *Snapshot->EntityLayout;
+			Writer->Write(*Snapshot, Snapshot->Changes, Layout.Actors, Layout.Components, Layout.Skeletals);
+			if (Telemetry)
+			{
+				Telemetry->AddFrame(FPlatformTime::Seconds() - StartTime, Writer->GetNumBytesWritten() - StartBytes, bKeepFrames);
+			}
+		}
+		Buffer->EndRead(ReaderIdx);
+	}
+	AddSkippedSnapshots();
+
+	// Wake up the worker waiting for the sinks to catch up
+	if (IdleEvent)
+	{
+		IdleEvent->Trigger();
+	}
+}
+
+// Count the snapshots skipped since the last read (the sink was a buffer depth behind the change detector)
+void FSLWorldWriterSink::AddSkippedSnapshots()
+{
+	const int32 NumSkipped = Buffer->GetNumSkipped(ReaderIdx);
+	if (NumSkipped > LastNumSkipped)
+	{
+		if (Telemetry)
+		{
+			Telemetry->AddSkipped(NumSkipped - LastNumSkipped, bKeepFrames);
+		}
+		LastNumSkipped = NumSkipped;
+	}
+}
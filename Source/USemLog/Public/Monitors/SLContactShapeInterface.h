@@ -6,32 +6,10 @@
 #include "Components/MeshComponent.h"
 #include "Components/ShapeComponent.h"
 #include "SLStructs.h"
+#include "Monitors/SLOverlapEndScheduler.h"
 #include "TimerManager.h"
 #include "SLContactShapeInterface.generated.h"
 
-/**
- * Structure holding the OverlapEnd event data,
- * cached for a small period of time in case it should be concatenated with the follow-up event
- */
-struct FSLOverlapEndEvent
-{
-	// Default ctor
-	FSLOverlapEndEvent() = default;
-
-	// Init ctor
-	FSLOverlapEndEvent(UPrimitiveComponent* InOtherComp, const FSLEntity& InOtherItem, float InTime) :
-		OtherComp(InOtherComp), OtherItem(InOtherItem), Time(InTime) {};
-
-	// Overlap component
-	UPrimitiveComponent* OtherComp;
-	
-	// Other item of the overlap end
-	FSLEntity OtherItem;
-
-	// Time
-	float Time;
-};
-
 
 /** Notiy the begin/end of a supported by event */
 DECLARE_MULTICAST_DELEGATE_FourParams(FSLBeginSupportedBySignature, const FSLEntity& /*Supported*/, const FSLEntity& /*Supporting*/, float /*Time*/, const uint64 /*PairId*/);
@@ -60,6 +38,9 @@ public:
 	// Stop publishing overlap events
 	void Finish(bool bForced = false);
 
+	// Delay the overlap ends with the shared scheduler (without it the ends are published directly, no concatenation)
+	void SetOverlapEndScheduler(FSLOverlapEndScheduler* InScheduler);
+
 	// Get init state
 	bool IsInit() const { return bIsInit; };
 
@@ -127,11 +108,8 @@ protected:
 		UPrimitiveComponent* OtherComp,
 		int32 OtherBodyIndex);
 
-	// Delayed call of sending the finished event to check for possible concatenation of jittering events of the same type
-	void DelayedOverlapEndEventCallback();
-
-	// Broadcast delayed overlaps, if curr time < 0, it guarantees a publish
-	bool PublishDelayedOverlapEndEvent(const FSLOverlapEndEvent& Ev, float CurrTime = -1.f);
+	// Broadcast the (delayed) overlap end
+	void PublishOverlapEndEvent(const FSLOverlapEndEvent& Ev);
 
 	// Skip publishing overlap event if it can be concatenated with the current event start
 	bool SkipOverlapEndEventBroadcast(const FSLEntity& InItem, float StartTime);
@@ -186,13 +164,10 @@ protected:
 	FTimerDelegate SBTimerDelegate;
 
 	// Send finished events with a delay to check for possible concatenation of equal and consecutive events with small time gaps in between
-	FTimerHandle DelayTimerHandle;
-
-	// Can only bind the timer handle to UObjects or FTimerDelegates
-	FTimerDelegate DelayTimerDelegate;
+	FSLOverlapEndScheduler* OverlapEndScheduler = nullptr;
 
-	// Array of recently ended overlaps
-	TArray<FSLOverlapEndEvent> RecentlyEndedOverlapEvents;
+	// Id of the shape in the scheduler
+	int32 OverlapEndPublisherId = INDEX_NONE;
 
 	/* Constants */
 	constexpr static const char* TagTypeName = "SemLogColl";
@@ -86,6 +86,9 @@ public:
 	// Stop publishing grasp events
 	void Finish(bool bForced = false);
 
+	// Set the shared scheduler delaying the overlap ends of the bone overlaps (call before start)
+	void SetOverlapEndScheduler(class FSLOverlapEndScheduler* InScheduler) { OverlapEndScheduler = InScheduler; };
+
 	// Get init state
 	bool IsInit() const { return bIsInit; };
 
@@ -230,6 +233,9 @@ private:
 	// Semantic data of the owner
 	FSLEntity SemanticOwner;
 
+	// Shared scheduler of the bone overlap ends
+	class FSLOverlapEndScheduler* OverlapEndScheduler;
+
 	
 	/* Grasp related */
 	// Opposing group A for testing for grasps
@@ -7,6 +7,7 @@
 #include "Components/SphereComponent.h"
 #include "Engine/StaticMeshActor.h"
 #include "Components/SkeletalMeshComponent.h"
+#include "Monitors/SLOverlapEndScheduler.h"
 #include "SLManipulatorOverlapSphere.generated.h"
 
 /**
@@ -19,25 +20,6 @@ enum class ESLManipulatorOverlapGroup : uint8
 	B					UMETA(DisplayName = "B"),
 };
 
-/**
- * Overlap event end data
- */
-struct FSLManipulatorOverlapEndEvent
-{
-	// Default ctor
-	FSLManipulatorOverlapEndEvent() = default;
-
-	// Init ctor
-	FSLManipulatorOverlapEndEvent(AActor* InOtherActor, float InTime) :
-		OtherActor(InOtherActor), Time(InTime) {};
-
-	// Overlap component
-	AActor* OtherActor;
-
-	// End time of the event 
-	float Time;
-};
-
 /** Delegate to notify that a contact begins between the grasp overlap and an item**/
 DECLARE_MULTICAST_DELEGATE_OneParam(FSLManipulatorOverlapBeginSignature, AActor* /*OtherActor*/);
 
@@ -71,6 +53,9 @@ public:
 	// Stop publishing overlap events
 	void Finish(bool bForced = false);
 
+	// Delay the overlap ends with the shared scheduler (without it the ends are published directly, no concatenation)
+	void SetOverlapEndScheduler(FSLOverlapEndScheduler* InScheduler);
+
 	// Get init state
 	bool IsInit() const { return bIsInit; };
 
@@ -118,8 +103,8 @@ private:
 		UPrimitiveComponent* OtherComp,
 		int32 OtherBodyIndex);
 
-	// Delayed call of sending the finished event to check for possible concatenation of jittering events of the same type
-	void DelayedGraspOverlapEndEventCallback();
+	// Broadcast the (delayed) grasp overlap end
+	void PublishGraspOverlapEndEvent(const FSLOverlapEndEvent& Ev);
 
 	// Check if this begin event happened right after the previous one ended
 	// if so remove it from the array, and cancel publishing the begin event
@@ -145,8 +130,8 @@ private:
 		UPrimitiveComponent* OtherComp,
 		int32 OtherBodyIndex);
 
-	// Delayed call of sending the finished event to check for possible concatenation of jittering events of the same type
-	void DelayedContactOverlapEndEventCallback();
+	// Broadcast the (delayed) contact overlap end
+	void PublishContactOverlapEndEvent(const FSLOverlapEndEvent& Ev);
 
 	// Check if this begin event happened right after the previous one ended
 	// if so remove it from the array, and cancel publishing the begin event
@@ -211,17 +196,11 @@ private:
 
 
 	// Send finished events with a delay to check for possible concatenation of equal and consecutive events with small time gaps in between
-	FTimerHandle GraspDelayTimerHandle;
-
-	// Array of recently ended events
-	TArray<FSLManipulatorOverlapEndEvent> RecentlyEndedGraspOverlapEvents;
-	
-	
-	// Send finished events with a delay to check for possible concatenation of equal and consecutive events with small time gaps in between
-	FTimerHandle ContactDelayTimerHandle;
+	FSLOverlapEndScheduler* OverlapEndScheduler;
 
-	// Array of recently ended events
-	TArray<FSLManipulatorOverlapEndEvent> RecentlyEndedContactOverlapEvents;
+	// Ids of the grasp and contact overlap ends in the scheduler
+	int32 GraspPublisherId;
+	int32 ContactPublisherId;
 	
 
 	/* Constants */
@@ -0,0 +1,149 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "SLStructs.h" // FSLEntity
+
+/**
+ * Structure holding the OverlapEnd event data,
+ * cached for a small period of time in case it should be concatenated with the follow-up event
+ */
+struct FSLOverlapEndEvent
+{
+	// Default ctor
+	FSLOverlapEndEvent() = default;
+
+	// Init ctor
+	FSLOverlapEndEvent(UObject* InOther, const FSLEntity& InOtherItem, float InTime) :
+		Other(InOther), OtherItem(InOtherItem), Time(InTime) {};
+
+	// Init ctor without semantic data
+	FSLOverlapEndEvent(UObject* InOther, float InTime) :
+		Other(InOther), Time(InTime) {};
+
+	// Other overlap component or actor
+	UObject* Other = nullptr;
+
+	// Other item of the overlap end (optional)
+	FSLEntity OtherItem;
+
+	// Time
+	float Time = 0.f;
+};
+
+/** Publish a delayed overlap end */
+DECLARE_DELEGATE_OneParam(FSLOverlapEndPublishSignature, const FSLOverlapEndEvent& /*Event*/);
+
+/**
+ * Holds the recently ended overlaps of all the shapes in a hashed timing wheel, the ends are published
+ * in one batch per tick once their time gap passed, a restart of the same pair within the gap concatenates the two events
+ */
+class USEMLOG_API FSLOverlapEndScheduler : public FTickableGameObject
+{
+public:
+	// Default ctor
+	FSLOverlapEndScheduler();
+
+	// Set the world (time source) and start ticking
+	void Init(UWorld* InWorld);
+
+	// Publish all the pending ends and stop
+	void Finish();
+
+	// Register a publisher (one for every shape and overlap type), return its id
+	int32 AddPublisher(float InMaxTimeGap, const FSLOverlapEndPublishSignature& InPublishDelegate);
+
+	// Publish the pending ends of the publisher and unregister it
+	void RemovePublisher(int32 PublisherId);
+
+	// Delay publishing the end of the overlap with the other object
+	void Schedule(int32 PublisherId, uint32 OtherId, const FSLOverlapEndEvent& Event);
+
+	// Called on a begin, true if it concatenates with the pending end of the pair (the begin should not be published),
+	// a pending end that is too old to be concatenated is published before returning
+	bool ConcatenateOrPublish(int32 PublisherId, uint32 OtherId, float StartTime);
+
+	// Number of pending ends
+	int32 Num() const { return KeyToEntryIdx.Num(); };
+
+protected:
+	/** Begin FTickableGameObject interface */
+	// Publish the expired ends
+	virtual void Tick(float DeltaTime) override;
+
+	// Only tick while there are pending ends
+	virtual bool IsTickable() const override;
+
+	// Return the stat id to use for this tickable
+	virtual TStatId GetStatId() const override;
+	/** End FTickableGameObject interface */
+
+private:
+	// Pending end, linked in the list of its wheel slot
+	struct FPendingEnd
+	{
+		uint64 Key;
+		int32 PublisherId;
+		float ExpireTime;
+		int32 Slot;
+		int32 Prev;
+		int32 Next;
+		FSLOverlapEndEvent Event;
+	};
+
+	// Registered publisher
+	struct FPublisher
+	{
+		float MaxTimeGap;
+		FSLOverlapEndPublishSignature PublishDelegate;
+	};
+
+	// Visit the slots up to the current time and publish the expired ends
+	void Sweep(float CurrTime);
+
+	// Remove the entry and add it to the batch to be published
+	void RemoveToBatch(int32 EntryIdx);
+
+	// Publish the batched ends in the order they ended
+	void PublishBatch();
+
+	// Insert the entry at the end of its slot list
+	void Link(int32 EntryIdx);
+
+	// Remove the entry from its slot list
+	void Unlink(int32 EntryIdx);
+
+	// Wheel tick of the given time
+	static int64 GetTick(float Time) { return static_cast<int64>(FMath::FloorToDouble(Time / SlotWidth)); };
+
+private:
+	// Time source
+	UWorld* World;
+
+	// First tick which was not fully swept yet
+	int64 NextSweepTick;
+
+	// Registered publishers
+	TSparseArray<FPublisher> Publishers;
+
+	// Pending ends
+	TSparseArray<FPendingEnd> Entries;
+
+	// Pending end of every pair
+	TMap<uint64, int32> KeyToEntryIdx;
+
+	// First and last entry of every slot
+	TArray<int32> SlotHeads;
+	TArray<int32> SlotTails;
+
+	// Expired ends waiting to be published
+	TArray<TPair<int32, FSLOverlapEndEvent>> Batch;
+
+	/* Constants */
+	// Must be a power of two, the wheel covers NumSlots * SlotWidth seconds, longer gaps wait for additional rounds
+	constexpr static int32 NumSlots = 64;
+	constexpr static float SlotWidth = 1.f / 60.f;
+};
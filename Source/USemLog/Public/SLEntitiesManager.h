@@ -48,6 +48,12 @@ public:
 	// Try to add the given object as a semantic object (return false if the object is not properly annotated)
 	bool AddObject(UObject* Object);
 
+	// Register an actor spawned after init with its annotated components, returns false if nothing was added
+	bool AddActor(AActor* Actor);
+
+	// Unregister an actor and its annotated components (e.g. on destruction), returns false if nothing was removed
+	bool RemoveActor(AActor* Actor);
+
 	// Get semantic object structure, from object
 	FSLEntity GetEntity(UObject* Object) const;
 
@@ -204,6 +210,26 @@ public:
 		return FString();
 	};
 
+	// Get the pre-encoded strings of the entity (nullptr if not found)
+	TSharedPtr<const FSLEntityUtf8> GetEntityUtf8(UObject* Object) const
+	{
+		if (auto* Value = ObjectsUtf8Data.Find(Object))
+		{
+			return *Value;
+		}
+		return nullptr;
+	};
+
+	// Get the pre-encoded strings of the skeletal entity, including its bones (nullptr if not found)
+	TSharedPtr<const FSLEntityUtf8> GetSkeletalUtf8(USLSkeletalDataComponent* SkelData) const
+	{
+		if (auto* Value = SkeletalUtf8Data.Find(SkelData))
+		{
+			return *Value;
+		}
+		return nullptr;
+	};
+
 	// Get skeletal entity id (empty string if not found)
 	FORCEINLINE USLSkeletalDataComponent* GetSkeletalDataComponent(UObject* Object) const
 	{
@@ -214,6 +240,16 @@ public:
 		return nullptr;
 	};
 	
+private:
+	// Add the semantic data of the actor and of its components, returns false if the actor itself is not annotated
+	bool AddActorData(AActor* Actor);
+
+	// Convert the ids, classes and bone names of the entities to utf8
+	void BuildUtf8Data();
+
+	// Create the pre-encoded strings of a skeletal entity
+	static TSharedPtr<const FSLEntityUtf8> CreateSkeletalUtf8(USLSkeletalDataComponent* SkelData);
+
 private:
 	// Instance of the singleton
 	static TSharedPtr<FSLEntitiesManager> StaticInstance;
@@ -229,6 +265,12 @@ private:
 	// Map of UObject (Owner -- actor or component) to skeletal data component
 	TMap<UObject*, USLSkeletalDataComponent*> ObjectsSemanticSkelData;
 
+	// Pre-encoded (immutable) strings of the semantic entities, built once at init
+	TMap<UObject*, TSharedPtr<const FSLEntityUtf8>> ObjectsUtf8Data;
+
+	// Pre-encoded (immutable) strings of the skeletal entities and their bones
+	TMap<USLSkeletalDataComponent*, TSharedPtr<const FSLEntityUtf8>> SkeletalUtf8Data;
+
 	// Map of Camera View Actors pointer to object structure
 	TMap<ASLVisionCamera*, FSLEntity> CameraViewSemanticData;
 
@@ -198,6 +198,11 @@ private:
 	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bLogWorldState"), meta = (ClampMin = 0))
 	float WorldStateUpdateRate;
 
+	// Slower update rates (s) of the given entity classes, the entities are read in turns spread over the frames
+	// (single entities can be tagged with SemLog;UpdateRate,<s>;)
+	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bLogWorldState"))
+	TMap<FString, float> WorldStateClassUpdateRates;
+
 	// Distance (cm) threshold difference for logging a given item
 	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bLogWorldState"), meta = (ClampMin = 0))
 	float LinearDistance;
@@ -206,10 +211,82 @@ private:
 	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bLogWorldState"), meta = (ClampMin = 0))
 	float AngularDistance;
 
+	// Only read and check the actors and components whose transform was updated since the last capture
+	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bLogWorldState"))
+	bool bWorldStateDirtyTracking;
+
+	// Only log a marker with the group root for the attached entities which moved rigidly with their topmost logged parent (not applied to json)
+	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bLogWorldState"))
+	bool bWorldStateRigidGroups;
+
+	// Dump the capture, serialization and database latencies of the world state logger (csv per frame, json summary)
+	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bLogWorldState"))
+	bool bWorldStateTelemetry;
+
 	// Writer type
 	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bLogWorldState"))
 	ESLWorldWriterType WriterType;
 
+	// Additional writers fed from the same capture (e.g. a local binary copy of the mongo episode), each writes from its own thread
+	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bLogWorldState"))
+	TArray<ESLWorldWriterType> AdditionalWriterTypes;
+
+	// Number of captured frames which can wait for the writer before frames are dropped
+	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bLogWorldState"), meta = (ClampMin = 1))
+	int32 WorldStateBufferDepth;
+
+	// Insert the world states in batches from a separate thread (mongo writer only)
+	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bLogWorldState"))
+	bool bWorldStateMongoBatch;
+
+	// Max number of documents in a batch
+	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bWorldStateMongoBatch"), meta = (ClampMin = 1))
+	int32 WorldStateMongoBatchNumDocs;
+
+	// Max size (KB) of a batch
+	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bWorldStateMongoBatch"), meta = (ClampMin = 1))
+	int32 WorldStateMongoBatchSizeKB;
+
+	// Max time (s) a world state waits in a batch before it is inserted
+	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bWorldStateMongoBatch"), meta = (ClampMin = 0.01))
+	float WorldStateMongoBatchInterval;
+
+	// Write concern of the batch inserts (0 - unacknowledged, 1 - primary, n - n members of the replica set)
+	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bWorldStateMongoBatch"), meta = (ClampMin = 0))
+	int32 WorldStateMongoWriteConcern;
+
+	// Max size (MB) of the world states waiting to be inserted, the overflow is spilled to a local journal and replayed later (0 - unbounded)
+	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bWorldStateMongoBatch"), meta = (ClampMin = 0))
+	int32 WorldStateMongoQueueSizeMB;
+
+	// When to create the indexes of the mongo collection (up front they are maintained by the server while logging)
+	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bLogWorldState"))
+	ESLMongoIndexMode WorldStateMongoIndexMode;
+
+	// Write one document per entity (and bone) and time window instead of one document per frame (mongo writer only)
+	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bLogWorldState"))
+	bool bWorldStateMongoEntityBuckets;
+
+	// Length (s) of the time window of the entity buckets
+	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bWorldStateMongoEntityBuckets"), meta = (ClampMin = 0.01))
+	float WorldStateMongoBucketDuration;
+
+	// Write keyframes with the full poses and quantized deltas in between (mongo and bson writers only)
+	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bLogWorldState"))
+	bool bWorldStateCompression;
+
+	// Time (s) between two keyframes
+	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bWorldStateCompression"), meta = (ClampMin = 0.1))
+	float WorldStateKeyframeInterval;
+
+	// Location quantization step of the deltas (m with the ROS conversions, cm otherwise)
+	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bWorldStateCompression"), meta = (ClampMin = 0.000001))
+	float WorldStateLocPrecision;
+
+	// Streaming compression of the file based world state outputs (json, bson and binary writers only)
+	UPROPERTY(EditAnywhere, Category = "Semantic Logger|World State Logger", meta = (editcondition = "bLogWorldState"))
+	ESLFileCompression WorldStateFileCompression;
+
 	// World state logger, use UPROPERTY to avoid GC
 	UPROPERTY()
 	USLWorldLogger* WorldStateLogger;
@@ -247,6 +324,10 @@ private:
 	UPROPERTY(EditAnywhere, Category = "Semantic Logger|Event Data Logger", meta = (editcondition = "bLogEventData"))
 	bool bWriteTimelines;
 
+	// Compression of the owl event file
+	UPROPERTY(EditAnywhere, Category = "Semantic Logger|Event Data Logger", meta = (editcondition = "bLogEventData"))
+	ESLFileCompression EventFileCompression;
+
 	// Includes the related events in the episode (TODO)
 	UPROPERTY(EditAnywhere, Category = "Semantic Logger|Event Data Logger", meta = (editcondition = "bLogEventData"))
 	bool bWriteEpisodeMetadata;
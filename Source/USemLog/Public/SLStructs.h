@@ -126,6 +126,60 @@ struct FSLEntityPair
 	}
 };
 
+/**
+* Immutable null terminated utf8 copy of a string, converted once so the writers can append the raw bytes
+*/
+struct FSLUtf8Str
+{
+	// Default constructor (empty string)
+	FSLUtf8Str() = default;
+
+	// Convert the string
+	explicit FSLUtf8Str(const FString& InStr)
+	{
+		const FTCHARToUTF8 Converted(*InStr);
+		Data.SetNumUninitialized(Converted.Length() + 1);
+		FMemory::Memcpy(Data.GetData(), Converted.Get(), Converted.Length());
+		Data[Converted.Length()] = '\0';
+	}
+
+	// Null terminated utf8 bytes
+	FORCEINLINE const ANSICHAR* Get() const { return Data.Num() > 0 ? Data.GetData() : ""; }
+
+	// Number of bytes without the terminator
+	FORCEINLINE int32 Len() const { return Data.Num() > 0 ? Data.Num() - 1 : 0; }
+
+	// True if the string is empty
+	FORCEINLINE bool IsEmpty() const { return Len() == 0; }
+
+private:
+	// Converted bytes with the null terminator
+	TArray<ANSICHAR> Data;
+};
+
+/**
+* Pre-encoded strings of an entity used by the world state writers
+*/
+struct FSLEntityUtf8
+{
+	// Semantic id
+	FSLUtf8Str Id;
+
+	// Semantic class
+	FSLUtf8Str Class;
+
+	// Bone names in bone index order (skeletal entities only)
+	TArray<FSLUtf8Str> BoneNames;
+
+	// Bone ids in bone index order, empty for bones without semantic data (skeletal entities only)
+	TArray<FSLUtf8Str> BoneIds;
+
+	// Default constructor
+	FSLEntityUtf8() = default;
+
+	// Init constructor
+	FSLEntityUtf8(const FSLEntity& InEntity) : Id(InEntity.Id), Class(InEntity.Class) {};
+};
 
 /**
 * Templated data structure of entities with semantic and previous transform information
@@ -146,6 +200,9 @@ struct TSLEntityPreviousPose
 	// Its previous rotation
 	FQuat PrevQuat;
 
+	// Pre-encoded id and class (shared with the entities manager)
+	TSharedPtr<const FSLEntityUtf8> Utf8;
+
 	// Default constructor
 	TSLEntityPreviousPose() {};
 
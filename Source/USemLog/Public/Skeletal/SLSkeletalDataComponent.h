@@ -93,6 +93,12 @@ public:
 	// Get the id of the skeletal component
 	FString GetId() const { return OwnerSemanticData.Id; };
 
+	// Resolve the bone names of the skeletal parent once, in bone index order
+	void CacheBoneNames();
+
+	// Bone names indexed by the bone index (avoids the name to index lookups while logging)
+	const TArray<FName>& GetCachedBoneNames() const { return CachedBoneNames; };
+
 private:
 	// Update the data from the data asset
 	void LoadFromDataAsset();
@@ -140,6 +146,10 @@ public:
 	// Semantic data of the owner	
 	FSLEntity OwnerSemanticData;
 
+private:
+	// Bone names of the skeletal parent indexed by the bone index
+	TArray<FName> CachedBoneNames;
+
 private:
 	// Flag marking the component as init (and valid) for runtime 
 	bool bInit;
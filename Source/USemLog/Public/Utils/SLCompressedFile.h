@@ -0,0 +1,173 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "Containers/Queue.h"
+#include "SLCompressedFile.generated.h"
+
+class IFileHandle;
+class FRunnableThread;
+class FEvent;
+
+/**
+* Compression of the file outputs
+*/
+UENUM()
+enum class ESLFileCompression : uint8
+{
+	None					UMETA(DisplayName = "None"),
+	LZ4						UMETA(DisplayName = "LZ4 (fast)"),
+	Zlib					UMETA(DisplayName = "Zlib (archival)")
+};
+
+/**
+* Layout of the compressed files, both are standard formats so the files can be read with gzip/zcat and lz4 -d:
+* Zlib: gzip file with one member per block, the size of the member is stored in an "SL" extra subfield (as bgzip does)
+*       so the blocks can be located without inflating them
+* LZ4:  one LZ4 frame per block (independent block, content size set), a block is stored as is if it does not compress
+* concatenated files (e.g. appended episodes) are valid files of the same format
+*/
+struct FSLCompressedFileFormat
+{
+	// Magic of the gzip members
+	static const uint8 GzipId1 = 0x1F;
+	static const uint8 GzipId2 = 0x8B;
+
+	// Size of the gzip member header with the "SL" extra subfield
+	static const int32 GzipHeaderSize = 20;
+
+	// Size of the gzip member trailer (crc32, uncompressed size)
+	static const int32 GzipTrailerSize = 8;
+
+	// Magic of the LZ4 frames
+	static const uint32 Lz4FrameMagic = 0x184D2204;
+
+	// Size of the LZ4 frame header with the content size
+	static const int32 Lz4FrameHeaderSize = 15;
+
+	// Max uncompressed size of a block (max block size of the LZ4 frames)
+	static const int32 MaxBlockSize = 4 * 1024 * 1024;
+
+	// Extension appended to the compressed files
+	static const TCHAR* GetExtension(ESLFileCompression Compression) { return Compression == ESLFileCompression::LZ4 ? TEXT(".lz4") : TEXT(".gz"); }
+
+	// Engine compression format of the codec
+	static FName GetFormatName(ESLFileCompression Compression);
+
+	// Header checksum of the LZ4 frame descriptor (second byte of the xxh32 hash)
+	static uint8 GetLz4HeaderChecksum(const uint8* Descriptor, int32 Num);
+};
+
+/**
+ * Streaming block compression between the serialization and the file handle, the full blocks are compressed and
+ * written from a separate thread so the writers only copy the data
+ */
+class USEMLOG_API FSLCompressedFileWriter : public FRunnable
+{
+public:
+	// Ctor, the file handle is not owned and has to stay valid until the writer is finished
+	FSLCompressedFileWriter(IFileHandle* InFileHandle, ESLFileCompression InCompression, int32 InBlockSize = 1024 * 1024);
+
+	// Dtor
+	virtual ~FSLCompressedFileWriter();
+
+	// Create the compression thread (without thread the blocks are compressed on write)
+	bool Start();
+
+	// Append the data, full blocks are passed to the compression thread
+	bool Write(const uint8* Data, int64 NumBytes);
+
+	// Pass the partial block to the compression thread and flush the file once it is written (smaller blocks compress worse)
+	void Flush();
+
+	// Compress and write the remaining data, stop the compression thread
+	void Finish();
+
+	// Compress the data and save it to the given file (the compressed file extension is not added)
+	static bool SaveToFile(const TArray<uint8>& Data, const FString& FilePath, ESLFileCompression InCompression);
+
+	/* Begin FRunnable interface */
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	/* End FRunnable interface */
+
+private:
+	// Pass the current block to the compression thread
+	void SubmitBlock();
+
+	// Compress and write the queued blocks
+	void WriteQueuedBlocks();
+
+	// Compress and write a block
+	bool WriteBlock(const TArray<uint8>& Block);
+
+private:
+	// Output file
+	IFileHandle* FileHandle;
+
+	// Codec
+	ESLFileCompression Compression;
+
+	// Engine compression format
+	FName FormatName;
+
+	// Uncompressed size of the blocks
+	int32 BlockSize;
+
+	// Block being filled by the writer
+	TArray<uint8> CurrBlock;
+
+	// Full blocks waiting to be compressed
+	TQueue<TArray<uint8>, EQueueMode::Spsc> QueuedBlocks;
+
+	// Number of queued blocks (bounds the memory if the disk is slower than the writer)
+	TAtomic<int32> NumQueuedBlocks;
+
+	// Compression output (compression thread only)
+	TArray<uint8> CompressedBlock;
+
+	// Wakes up the compression thread
+	FEvent* WakeUpEvent;
+
+	// Compression thread
+	FRunnableThread* Thread;
+
+	// Set when the compression thread should exit
+	TAtomic<bool> bStopRequested;
+
+	// Set when the file handle should be flushed after writing the queued blocks
+	TAtomic<bool> bFlushRequested;
+
+	// Set if a block could not be written
+	TAtomic<bool> bWriteFailed;
+
+	// Set when the writer is started
+	bool bIsStarted;
+};
+
+/**
+ * Transparent loading of the (optionally) compressed files
+ */
+class USEMLOG_API FSLCompressedFileReader
+{
+public:
+	// True if the data starts with a gzip member or a LZ4 frame
+	static bool IsCompressed(const uint8* Data, int64 Size);
+
+	// Decompress all the gzip members or LZ4 frames (concatenated compressed files are supported, e.g. appended episodes),
+	// gzip files of other tools are only read if they have a single member, LZ4 frames only if they have the content size and one compressed block
+	static bool Decompress(const uint8* Data, int64 Size, TArray<uint8>& OutData);
+
+	// Load the file, it is decompressed if it is a gzip or LZ4 file
+	static bool LoadFileToArray(TArray<uint8>& OutData, const FString& FilePath);
+
+private:
+	// Decompress the gzip member at the start of the data, returns its size (INDEX_NONE on error)
+	static int64 DecompressGzipMember(const uint8* Data, int64 Size, TArray<uint8>& OutData);
+
+	// Decompress the LZ4 frame at the start of the data, returns its size (INDEX_NONE on error)
+	static int64 DecompressLz4Frame(const uint8* Data, int64 Size, TArray<uint8>& OutData);
+};
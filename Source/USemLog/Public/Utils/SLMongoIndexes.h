@@ -0,0 +1,68 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#if SL_WITH_LIBMONGO_C
+THIRD_PARTY_INCLUDES_START
+	#if PLATFORM_WINDOWS
+	#include "Windows/AllowWindowsPlatformTypes.h"
+	#include <mongoc/mongoc.h>
+	#include "Windows/HideWindowsPlatformTypes.h"
+	#else
+	#include <mongoc/mongoc.h>
+	#endif // #if PLATFORM_WINDOWS
+THIRD_PARTY_INCLUDES_END
+#endif //SL_WITH_LIBMONGO_C
+#include "SLMongoIndexes.generated.h"
+
+// Notify when the indexes of a collection are created (broadcast on the game thread)
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FSLMongoIndexesCreatedSignature, const FString& /*DBName*/, const FString& /*CollName*/, bool /*bSuccess*/);
+
+/**
+* When to create the indexes of the logged collections
+*/
+UENUM()
+enum class ESLMongoIndexMode : uint8
+{
+	UpFront					UMETA(DisplayName = "Up front (maintained while logging)"),
+	Background				UMETA(DisplayName = "Background (after logging)"),
+	Blocking				UMETA(DisplayName = "Blocking (after logging)")
+};
+
+/**
+* Ascending index on one or more fields
+*/
+struct FSLMongoIndex
+{
+	// Indexed fields
+	TArray<FString> Keys;
+
+	// Unique values
+	bool bUnique = false;
+
+	// Ctor
+	FSLMongoIndex(std::initializer_list<FString> InKeys, bool bInUnique = false) : Keys(InKeys), bUnique(bInUnique) {};
+};
+
+/**
+ * Creates the indexes of the logged collections, either directly or from a background thread with its own connection
+ */
+class USEMLOG_API FSLMongoIndexes
+{
+public:
+#if SL_WITH_LIBMONGO_C
+	// Create the indexes on the collection (blocks until the server built them)
+	static bool Create(mongoc_collection_t* collection, const TArray<FSLMongoIndex>& Indexes);
+#endif //SL_WITH_LIBMONGO_C
+
+	// Create the indexes from a background thread, the game thread is notified through the delegate when done,
+	// the future has to be waited for before mongoc_cleanup is called
+	static TFuture<bool> CreateInBackground(const FString& ServerIp, uint16 ServerPort, const FString& DBName, const FString& CollName,
+		const TArray<FSLMongoIndex>& Indexes);
+
+	// Broadcast when the indexes of a collection are created
+	static FSLMongoIndexesCreatedSignature& OnIndexesCreated();
+};
@@ -90,6 +90,7 @@ public class USemLog : ModuleRules
 				new string[]
 				{
 					"UnrealEd",
+					"Json",				// the automation tests compare the json writer output with the json serializer
 				}
 				);
 		}
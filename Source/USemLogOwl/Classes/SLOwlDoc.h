@@ -42,10 +42,6 @@ public:
 	// Id of the document
 	FString Id;
 
-protected:
-	// Current state of the indentation for writing to string
-	FString Indent;
-
 public:
 	// Default constructor
 	FSLOwlDoc() {}
@@ -185,17 +181,66 @@ public:
 	}
 
 	// Return document as string
-	FString ToString()
-	{
-		FString DocStr = TEXT("<?xml version=\"1.0\" encoding=\"utf-8\"?>\n\n");
-		DocStr += EntityDefinitions.ToString();
-		FSLOwlNode Root(FSLOwlPrefixName("rdf", "RDF"), Namespaces);
-		Root.AddChildNode(OntologyImports);
-		Root.AddChildNodes(PropertyDefinitions);
-		Root.AddChildNodes(DatatypeDefinitions);
-		Root.AddChildNodes(ClassDefinitions);
-		Root.AddChildNodes(Individuals);
-		DocStr += Root.ToString(Indent);
-		return DocStr;
+	FString ToString() const
+	{
+		FSLOwlWriteBuffer Out;
+		WriteTo(Out);
+		return Out.ToString();
+	}
+
+	// Write the document to the buffer in one pass (utf8)
+	void WriteTo(FSLOwlWriteBuffer& Out) const
+	{
+		WriteHeaderTo(Out);
+		for (const auto& Individual : Individuals)
+		{
+			Individual.WriteTo(Out, 1);
+		}
+		WriteFooterTo(Out);
+	}
+
+	// Return the start of the document (declarations, root tag, ontology imports and definitions),
+	// the individuals can then be streamed with the indentation of the root children
+	FString ToHeaderString() const
+	{
+		FSLOwlWriteBuffer Out;
+		WriteHeaderTo(Out);
+		return Out.ToString();
+	}
+
+	// Write the start of the document to the buffer
+	void WriteHeaderTo(FSLOwlWriteBuffer& Out) const
+	{
+		Out.Append("<?xml version=\"1.0\" encoding=\"utf-8\"?>\n\n");
+		EntityDefinitions.WriteTo(Out);
+
+		// The root always has children (the imports node), it is left open for the individuals
+		FSLOwlNode::WriteStartTag(Out, FSLOwlPrefixName("rdf", "RDF"), Namespaces, 0);
+		Out.Append(">\n");
+		OntologyImports.WriteTo(Out, 1);
+		for (const auto& Node : PropertyDefinitions)
+		{
+			Node.WriteTo(Out, 1);
+		}
+		for (const auto& Node : DatatypeDefinitions)
+		{
+			Node.WriteTo(Out, 1);
+		}
+		for (const auto& Node : ClassDefinitions)
+		{
+			Node.WriteTo(Out, 1);
+		}
+	}
+
+	// Return the end of the document (closing root tag)
+	static FString ToFooterString()
+	{
+		return TEXT("</rdf:RDF>\n");
+	}
+
+	// Write the end of the document to the buffer
+	static void WriteFooterTo(FSLOwlWriteBuffer& Out)
+	{
+		Out.Append("</rdf:RDF>\n");
 	}
 };
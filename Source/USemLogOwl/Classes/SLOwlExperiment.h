@@ -109,6 +109,18 @@ public:
 
 	}
 
+	// Move the individuals added since the last call out of the document (first seen timepoints and objects,
+	// then the events), only the registered keys are kept, used for streaming the document
+	void MoveNewIndividuals(TArray<FSLOwlNode>& OutIndividuals)
+	{
+		OutIndividuals.Append(MoveTemp(TimepointIndividuals));
+		OutIndividuals.Append(MoveTemp(ObjectIndividuals));
+		OutIndividuals.Append(MoveTemp(Individuals));
+		TimepointIndividuals.Reset();
+		ObjectIndividuals.Reset();
+		Individuals.Reset();
+	}
+
 	// Add object individuals
 	void AddObjectIndividuals()
 	{
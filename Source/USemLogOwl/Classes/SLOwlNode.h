@@ -143,81 +143,92 @@ public:
 	~FSLOwlNode() {}
 
 	// Return node as string
-	FString ToString(FString& Indent)
+	FString ToString(FString& Indent) const
+	{
+		FSLOwlWriteBuffer Out;
+		WriteTo(Out, Indent.Len() / INDENT_STEP.Len());
+		return Out.ToString();
+	}
+
+	// Write node to the buffer in one pass, the indentation is emitted from the depth
+	void WriteTo(FSLOwlWriteBuffer& Out, int32 Depth) const
 	{
-		FString NodeStr;
 		// Add comment
 		if (!Comment.IsEmpty())
 		{
-			NodeStr += TEXT("\n") + Indent + TEXT("<!-- ") + Comment + TEXT(" -->\n");
+			Out.Append("\n");
+			Out.AppendIndent(Depth);
+			Out.Append("<!-- ");
+			Out.Append(Comment);
+			Out.Append(" -->\n");
 		}
 
 		// Comment only OR empty node
-		if (Name.ToString().IsEmpty())
+		if (Name.IsEmpty())
 		{
-			return NodeStr;
+			return;
 		}
 
-		// Add node name
-		NodeStr += Indent + TEXT("<") + Name.ToString();
-
-		// Add attributes to tag
-		for (int32 i = 0; i < Attributes.Num(); ++i)
-		{
-			if (Attributes.Num() == 1)
-			{
-				NodeStr += TEXT(" ") + Attributes[i].ToString();
-			}
-			else
-			{
-				if (i < (Attributes.Num() - 1))
-				{
-					NodeStr += TEXT(" ") + Attributes[i].ToString() + TEXT("\n") + Indent + INDENT_STEP;
-				}
-				else
-				{
-					// Last attribute does not have new line
-					NodeStr += TEXT(" ") + Attributes[i].ToString();
-				}
-			}
-		}
+		// Add node name and attributes
+		WriteStartTag(Out, Name, Attributes, Depth);
 
 		// Check node data (children/value)
 		bool bHasChildren = ChildNodes.Num() != 0;
 		bool bHasValue = !Value.IsEmpty();
-			
+
 		// Node cannot have value and children
 		if (!bHasChildren && !bHasValue)
 		{
 			// No children nor value, close tag
-			NodeStr += TEXT("/>\n");
+			Out.Append("/>\n");
 		}
 		else if (bHasValue)
 		{
 			// Node has a value, add value
-			NodeStr += TEXT(">") + Value + TEXT("</") + Name.ToString() + TEXT(">\n");
+			Out.Append(">");
+			Out.Append(Value);
+			WriteEndTag(Out, Name, 0);
 		}
-		else if(bHasChildren)
+		else if (bHasChildren)
 		{
-			// Node has children, add children
-			NodeStr += TEXT(">\n");
-			
-			// Increase indentation
-			Indent += INDENT_STEP;
-			
-			// Iterate children and add nodes
-			for (auto& ChildItr : ChildNodes)
+			// Node has children, add children one level deeper
+			Out.Append(">\n");
+			for (const auto& ChildItr : ChildNodes)
 			{
-				NodeStr += ChildItr.ToString(Indent);
+				ChildItr.WriteTo(Out, Depth + 1);
 			}
-			
-			// Decrease indentation
-			Indent.RemoveFromEnd(INDENT_STEP);
-			
-			// Close tag
-			NodeStr += Indent + Value + TEXT("</") + Name.ToString() + TEXT(">\n");
+			WriteEndTag(Out, Name, Depth);
 		}
-		return NodeStr;
+	}
+
+	// Write the indented open tag with the attributes, without the closing bracket
+	static void WriteStartTag(FSLOwlWriteBuffer& Out, const FSLOwlPrefixName& InName,
+		const TArray<FSLOwlAttribute>& InAttributes, int32 Depth)
+	{
+		Out.AppendIndent(Depth);
+		Out.Append("<");
+		InName.WriteTo(Out);
+
+		// Multiple attributes are written on separate lines
+		for (int32 i = 0; i < InAttributes.Num(); ++i)
+		{
+			if (i > 0)
+			{
+				Out.Append("\n");
+				Out.AppendIndent(Depth + 1);
+			}
+			Out.Append(" ");
+			InAttributes[i].WriteTo(Out);
+		}
+	}
+
+	// Write the (indented) end tag
+	static void WriteEndTag(FSLOwlWriteBuffer& Out, const FSLOwlPrefixName& InName, int32 Depth)
+	{
+		Out.AppendIndent(Depth);
+		Out.Append("</");
+		InName.WriteTo(Out);
+		Out.Append(">\n");
 	}
 };
 
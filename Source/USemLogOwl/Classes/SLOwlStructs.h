@@ -11,6 +11,56 @@ typedef TPair<FString, FString> TPairString;
 // Indent step
 static const FString INDENT_STEP = TEXT("\t");
 
+/**
+*  Growable utf8 output buffer, the documents are serialized into it in a single pass
+*/
+struct FSLOwlWriteBuffer
+{
+public:
+	// Serialized bytes (utf8, not null terminated)
+	TArray<uint8> Bytes;
+
+public:
+	// Append an ascii literal
+	void Append(const ANSICHAR* Literal)
+	{
+		Bytes.Append(reinterpret_cast<const uint8*>(Literal), FCStringAnsi::Strlen(Literal));
+	}
+
+	// Append the string as utf8
+	void Append(const FString& Str)
+	{
+		if (Str.Len() > 0)
+		{
+			FTCHARToUTF8 Utf8Str(*Str, Str.Len());
+			Bytes.Append(reinterpret_cast<const uint8*>(Utf8Str.Get()), Utf8Str.Length());
+		}
+	}
+
+	// Append the indentation of the given depth (one INDENT_STEP per level)
+	void AppendIndent(int32 Depth)
+	{
+		if (Depth > 0)
+		{
+			const int32 Offset = Bytes.AddUninitialized(Depth);
+			FMemory::Memset(Bytes.GetData() + Offset, '\t', Depth);
+		}
+	}
+
+	// Number of serialized bytes
+	int32 Num() const { return Bytes.Num(); };
+
+	// Clear the data, keep the allocation
+	void Reset() { Bytes.Reset(); };
+
+	// Convert the buffer to a string
+	FString ToString() const
+	{
+		FUTF8ToTCHAR Str(reinterpret_cast<const ANSICHAR*>(Bytes.GetData()), Bytes.Num());
+		return FString(Str.Length(), Str.Get());
+	}
+};
+
 /**
 	*  Example: "owl:Class", "rdf:resource"
 	*  Prefix:  "rdf", "owl" (expansion "http://www.w3.org/1999/02/22-rdf-syntax-ns#", "http://www.w3.org/2002/07/owl#")
@@ -42,6 +92,17 @@ public:
 		return LocalName.IsEmpty() ? Prefix : FString(Prefix + TEXT(":") + LocalName);
 	}
 
+	// Write name to the buffer
+	void WriteTo(FSLOwlWriteBuffer& Out) const
+	{
+		Out.Append(Prefix);
+		if (!LocalName.IsEmpty())
+		{
+			Out.Append(":");
+			Out.Append(LocalName);
+		}
+	}
+
 	// True if all data is empty
 	bool IsEmpty() const
 	{
@@ -88,6 +149,23 @@ public:
 			: FString(TEXT("\"&") + Ns + TEXT(";") + LocalValue + TEXT("\""));
 	}
 
+	// Write value to the buffer
+	void WriteTo(FSLOwlWriteBuffer& Out) const
+	{
+		if (Ns.IsEmpty())
+		{
+			Out.Append("\"");
+		}
+		else
+		{
+			Out.Append("\"&");
+			Out.Append(Ns);
+			Out.Append(";");
+		}
+		Out.Append(LocalValue);
+		Out.Append("\"");
+	}
+
 	// True if all data is empty
 	bool IsEmpty() const
 	{
@@ -130,6 +208,14 @@ public:
 		return Key.ToString() + TEXT("=") + Value.ToString();
 	}
 
+	// Write attribute to the buffer
+	void WriteTo(FSLOwlWriteBuffer& Out) const
+	{
+		Key.WriteTo(Out);
+		Out.Append("=");
+		Value.WriteTo(Out);
+	}
+
 	// True if all data is empty
 	bool IsEmpty() const
 	{
@@ -196,18 +282,31 @@ public:
 
 	// Get entity declaration string
 	FString ToString() const
+	{
+		FSLOwlWriteBuffer Out;
+		WriteTo(Out);
+		return Out.ToString();
+	}
+
+	// Write entity declaration to the buffer
+	void WriteTo(FSLOwlWriteBuffer& Out) const
 	{
 		if (EntityPairs.Num() == 0)
-			return FString();
+			return;
 
-		FString DTDStr = TEXT("<!DOCTYPE ") + Name.ToString() + TEXT("[\n");
+		Out.Append("<!DOCTYPE ");
+		Name.WriteTo(Out);
+		Out.Append("[\n");
 		for (const auto& EntityItr : EntityPairs)
 		{
-			DTDStr += INDENT_STEP + TEXT("<!ENTITY ") + EntityItr.Key +
-				TEXT(" \"") + EntityItr.Value + TEXT("\">\n");
+			Out.AppendIndent(1);
+			Out.Append("<!ENTITY ");
+			Out.Append(EntityItr.Key);
+			Out.Append(" \"");
+			Out.Append(EntityItr.Value);
+			Out.Append("\">\n");
 		}
-		DTDStr += TEXT("]>\n\n");
-		return DTDStr;
+		Out.Append("]>\n\n");
 	}
 
 	// True if all data is empty
@@ -0,0 +1,151 @@
+// Copyright 2017-2020, Institute for Artificial Intelligence - University of Bremen
+// Author: Andrei Haidu (http://haidu.eu)
+
+#include "Misc/AutomationTest.h"
+#include "SLOwlSemanticMapStatics.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SLOwlDocTest
+{
+	// Previous recursive serializer of the nodes, every subtree is concatenated once per nesting level
+	FString LegacyNodeToString(const FSLOwlNode& Node, FString& Indent)
+	{
+		FString NodeStr;
+		if (!Node.Comment.IsEmpty())
+		{
+			NodeStr += TEXT("\n") + Indent + TEXT("<!-- ") + Node.Comment + TEXT(" -->\n");
+		}
+
+		if (Node.Name.ToString().IsEmpty())
+		{
+			return NodeStr;
+		}
+
+		NodeStr += Indent + TEXT("<") + Node.Name.ToString();
+		for (int32 i = 0; i < Node.Attributes.Num(); ++i)
+		{
+			if (Node.Attributes.Num() == 1 || i == Node.Attributes.Num() - 1)
+			{
+				NodeStr += TEXT(" ") + Node.Attributes[i].ToString();
+			}
+			else
+			{
+				NodeStr += TEXT(" ") + Node.Attributes[i].ToString() + TEXT("\n") + Indent + INDENT_STEP;
+			}
+		}
+
+		if (Node.ChildNodes.Num() == 0 && Node.Value.IsEmpty())
+		{
+			NodeStr += TEXT("/>\n");
+		}
+		else if (!Node.Value.IsEmpty())
+		{
+			NodeStr += TEXT(">") + Node.Value + TEXT("</") + Node.Name.ToString() + TEXT(">\n");
+		}
+		else
+		{
+			NodeStr += TEXT(">\n");
+			Indent += INDENT_STEP;
+			for (const auto& ChildItr : Node.ChildNodes)
+			{
+				NodeStr += LegacyNodeToString(ChildItr, Indent);
+			}
+			Indent.RemoveFromEnd(INDENT_STEP);
+			NodeStr += Indent + Node.Value + TEXT("</") + Node.Name.ToString() + TEXT(">\n");
+		}
+		return NodeStr;
+	}
+
+	// Previous serializer of the document, the individuals are copied into a temporary root node
+	FString LegacyDocToString(const FSLOwlDoc& Doc)
+	{
+		FString DocStr = TEXT("<?xml version=\"1.0\" encoding=\"utf-8\"?>\n\n");
+		if (Doc.EntityDefinitions.EntityPairs.Num() > 0)
+		{
+			DocStr += TEXT("<!DOCTYPE ") + Doc.EntityDefinitions.Name.ToString() + TEXT("[\n");
+			for (const auto& EntityItr : Doc.EntityDefinitions.EntityPairs)
+			{
+				DocStr += INDENT_STEP + TEXT("<!ENTITY ") + EntityItr.Key + TEXT(" \"") + EntityItr.Value + TEXT("\">\n");
+			}
+			DocStr += TEXT("]>\n\n");
+		}
+
+		FSLOwlNode Root(FSLOwlPrefixName("rdf", "RDF"), Doc.Namespaces);
+		Root.AddChildNode(Doc.OntologyImports);
+		Root.AddChildNodes(Doc.PropertyDefinitions);
+		Root.AddChildNodes(Doc.DatatypeDefinitions);
+		Root.AddChildNodes(Doc.ClassDefinitions);
+		Root.AddChildNodes(Doc.Individuals);
+		FString Indent;
+		DocStr += LegacyNodeToString(Root, Indent);
+		return DocStr;
+	}
+
+	// Default semantic map with the given number of object individuals, each with its pose individual
+	TSharedPtr<FSLOwlSemanticMap> CreateSemanticMap(int32 NumIndividuals, const FString& ClassName)
+	{
+		const FString DocId = TEXT("BenchmarkMap");
+		TSharedPtr<FSLOwlSemanticMap> SemMap = FSLOwlSemanticMapStatics::CreateDefaultSemanticMap(DocId);
+		const FString& Prefix = SemMap->Prefix;
+		FRandomStream Rand(NumIndividuals);
+		for (int32 Idx = 0; Idx < NumIndividuals; ++Idx)
+		{
+			const FString Id = FString::Printf(TEXT("Obj%d"), Idx);
+			const FString PoseId = FString::Printf(TEXT("Pose%d"), Idx);
+			FSLOwlNode ObjIndividual = FSLOwlSemanticMapStatics::CreateObjectIndividual(Prefix, Id, ClassName);
+			ObjIndividual.AddChildNode(FSLOwlSemanticMapStatics::CreateDescribedInMapProperty(Prefix, DocId));
+			ObjIndividual.AddChildNode(FSLOwlSemanticMapStatics::CreatePoseProperty(Prefix, PoseId));
+			ObjIndividual.AddChildNode(FSLOwlSemanticMapStatics::CreateMobilityProperty(TEXT("Movable")));
+			SemMap->AddIndividual(ObjIndividual);
+			SemMap->AddIndividual(FSLOwlSemanticMapStatics::CreatePoseIndividual(Prefix, PoseId,
+				Rand.GetUnitVector() * 100.f, FQuat(Rand.GetUnitVector(), Rand.FRandRange(0.f, PI))));
+		}
+		return SemMap;
+	}
+}
+
+// Times the serialization of a 50k individual semantic map against the previous serializer, the outputs have to be byte identical
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSLOwlDocSerializeBenchmark, "USemLog.Owl.SemanticMap.SerializeBenchmark",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter | EAutomationTestFlags::PerfFilter)
+
+bool FSLOwlDocSerializeBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace SLOwlDocTest;
+
+	// 50k individuals (25k objects and their poses), ascii content was written as ansi by the previous file writer, which is the same as utf8
+	const TSharedPtr<FSLOwlSemanticMap> SemMap = CreateSemanticMap(25000, TEXT("Cup"));
+
+	double StartTime = FPlatformTime::Seconds();
+	const FString LegacyStr = LegacyDocToString(*SemMap);
+	const double LegacyTime = FPlatformTime::Seconds() - StartTime;
+
+	StartTime = FPlatformTime::Seconds();
+	FSLOwlWriteBuffer Out;
+	SemMap->WriteTo(Out);
+	const double WriteTime = FPlatformTime::Seconds() - StartTime;
+
+	StartTime = FPlatformTime::Seconds();
+	const FString Str = SemMap->ToString();
+	const double ToStringTime = FPlatformTime::Seconds() - StartTime;
+
+	FTCHARToUTF8 LegacyUtf8(*LegacyStr, LegacyStr.Len());
+	TestEqual(TEXT("Same output size"), Out.Num(), LegacyUtf8.Length());
+	TestTrue(TEXT("Byte identical output"), Out.Num() == LegacyUtf8.Length() &&
+		FMemory::Memcmp(Out.Bytes.GetData(), LegacyUtf8.Get(), Out.Num()) == 0);
+	TestTrue(TEXT("Identical ToString"), Str.Equals(LegacyStr, ESearchCase::CaseSensitive));
+	AddInfo(FString::Printf(TEXT("%d individuals (%d bytes): previous %.1f ms, WriteTo %.1f ms, ToString %.1f ms"),
+		SemMap->Individuals.Num(), Out.Num(), LegacyTime * 1000.0, WriteTime * 1000.0, ToStringTime * 1000.0));
+
+	// Non ascii content is encoded as utf8
+	const TSharedPtr<FSLOwlSemanticMap> Utf8SemMap = CreateSemanticMap(100, TEXT("M\u00FCslischale"));
+	const FString Utf8LegacyStr = LegacyDocToString(*Utf8SemMap);
+	FTCHARToUTF8 Utf8LegacyUtf8(*Utf8LegacyStr, Utf8LegacyStr.Len());
+	FSLOwlWriteBuffer Utf8Out;
+	Utf8SemMap->WriteTo(Utf8Out);
+	TestTrue(TEXT("Byte identical utf8 output"), Utf8Out.Num() == Utf8LegacyUtf8.Length() &&
+		FMemory::Memcmp(Utf8Out.Bytes.GetData(), Utf8LegacyUtf8.Get(), Utf8Out.Num()) == 0);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS